@@ -0,0 +1,65 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VISIOBATCHDOCUMENT_H__
+#define __VISIOBATCHDOCUMENT_H__
+
+#include <functional>
+#include <memory>
+
+#include <librevenge/librevenge.h>
+
+#include "VisioParseOptions.h"
+#include "VisioParseStats.h"
+
+namespace libvisio
+{
+
+/**
+A document for VisioDocument::parseBatch, and the outcome of its parse.
+*/
+struct VisioBatchDocument
+{
+  VisioBatchDocument()
+    : input(nullptr), createPainter(), status(VISIO_PARSE_OK), stats()
+  {
+  }
+
+  VisioBatchDocument(librevenge::RVNGInputStream *input_,
+                     const std::function<std::unique_ptr<librevenge::RVNGDrawingInterface>()> &createPainter_)
+    : input(input_), createPainter(createPainter_), status(VISIO_PARSE_OK), stats()
+  {
+  }
+
+  /** Copies refer to the same input stream, which stays owned by the
+      caller. */
+  VisioBatchDocument(const VisioBatchDocument &) = default;
+  VisioBatchDocument &operator=(const VisioBatchDocument &) = default;
+
+  /** The input stream of the document. Only the thread that parses the
+      document uses it. */
+  librevenge::RVNGInputStream *input;
+
+  /** Returns the painter for the document. It is called on the thread
+      that parses the document, right before the parse, so it may run for
+      several documents at once. The painter is destroyed on the same
+      thread as soon as the parse is over. */
+  std::function<std::unique_ptr<librevenge::RVNGDrawingInterface>()> createPainter;
+
+  /** Receives the outcome of the parse. */
+  VisioParseStatus status;
+
+  /** Receives the statistics of the parse. */
+  VisioParseStats stats;
+};
+
+} // namespace libvisio
+
+#endif //  __VISIOBATCHDOCUMENT_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
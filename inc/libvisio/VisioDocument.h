@@ -10,8 +10,14 @@
 #ifndef __VISIODOCUMENT_H__
 #define __VISIODOCUMENT_H__
 
+#include <vector>
+
 #include <librevenge/librevenge.h>
 
+#include "VisioBatchDocument.h"
+#include "VisioParseOptions.h"
+#include "VisioParseStats.h"
+
 #ifdef DLL_EXPORT
 #ifdef LIBVISIO_BUILD
 #define VSDAPI __declspec(dllexport)
@@ -29,6 +35,8 @@
 namespace libvisio
 {
 
+class VisioDocumentModel;
+
 class VisioDocument
 {
 public:
@@ -37,7 +45,39 @@ public:
 
   static VSDAPI bool parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter);
 
+  static VSDAPI bool parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const VisioParseOptions &options);
+
+  static VSDAPI bool parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const VisioParseOptions &options,
+                           VisioParseStatus &status);
+
+  static VSDAPI bool parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const VisioParseOptions &options,
+                           VisioParseStatus &status, VisioParseStats &stats);
+
+  static VSDAPI bool parse(librevenge::RVNGInputStream *input, VisioDocumentModel &model);
+
+  static VSDAPI bool parse(librevenge::RVNGInputStream *input, VisioDocumentModel &model, const VisioParseOptions &options);
+
+  static VSDAPI bool parse(librevenge::RVNGInputStream *input, VisioDocumentModel &model, const VisioParseOptions &options,
+                           VisioParseStatus &status);
+
+  static VSDAPI bool parse(librevenge::RVNGInputStream *input, VisioDocumentModel &model, const VisioParseOptions &options,
+                           VisioParseStatus &status, VisioParseStats &stats);
+
+  static VSDAPI bool parseBatch(std::vector<VisioBatchDocument> &documents, unsigned threads, const VisioParseOptions &options);
+
   static VSDAPI bool parseStencils(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter);
+
+  static VSDAPI bool parseStencils(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const VisioParseOptions &options);
+
+  static VSDAPI bool parseMetaData(librevenge::RVNGInputStream *input, librevenge::RVNGPropertyList &metaData);
+
+  static VSDAPI bool writeCache(librevenge::RVNGInputStream *input, const VisioDocumentModel &model, librevenge::RVNGBinaryData &cache);
+
+  static VSDAPI bool drawCache(librevenge::RVNGInputStream *input, const unsigned char *cache, unsigned long cacheSize,
+                               librevenge::RVNGDrawingInterface *painter);
+
+  static VSDAPI bool drawCache(librevenge::RVNGInputStream *input, const unsigned char *cache, unsigned long cacheSize,
+                               const VisioParseOptions &options, librevenge::RVNGDrawingInterface *painter);
 };
 
 } // namespace libvisio
@@ -0,0 +1,57 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VISIODOCUMENTMODEL_H__
+#define __VISIODOCUMENTMODEL_H__
+
+#include <memory>
+
+#include <librevenge/librevenge.h>
+
+#include "VisioDocument.h"
+
+namespace libvisio
+{
+
+class VSDPages;
+
+/**
+The pages of a document, parsed once by VisioDocument::parse. The model
+does not refer to the input stream, so it can be drawn any number of
+times, to any painter, after the input is gone.
+*/
+class VisioDocumentModel
+{
+public:
+  VSDAPI VisioDocumentModel();
+  VSDAPI ~VisioDocumentModel();
+
+  /** Whether the model holds no page to draw. */
+  VSDAPI bool empty() const;
+
+  /** Makes the same calls on painter that VisioDocument::parse would
+      have made while parsing the document. */
+  VSDAPI void draw(librevenge::RVNGDrawingInterface *painter) const;
+
+  VSDAPI void clear();
+
+private:
+  VisioDocumentModel(const VisioDocumentModel &);
+  VisioDocumentModel &operator=(const VisioDocumentModel &);
+
+  friend class VisioDocument;
+  std::unique_ptr<VSDPages> m_pages;
+  // Hash of the options that selected the pages and the content, for the model cache
+  unsigned long long m_optionsHash;
+};
+
+} // namespace libvisio
+
+#endif //  __VISIODOCUMENTMODEL_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,142 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VISIOPARSEOPTIONS_H__
+#define __VISIOPARSEOPTIONS_H__
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <string>
+
+namespace libvisio
+{
+
+/**
+The outcome of a call of VisioDocument::parse.
+*/
+enum VisioParseStatus
+{
+  /** The document was parsed. */
+  VISIO_PARSE_OK,
+  /** The input is not a supported document, or it could not be read. */
+  VISIO_PARSE_ERROR,
+  /** VisioParseOptions::cancel was set before the parse finished. */
+  VISIO_PARSE_CANCELLED,
+  /** VisioParseOptions::deadline passed before the parse finished. */
+  VISIO_PARSE_TIMED_OUT,
+  /** The document exceeds one of VisioParseOptions::limits. */
+  VISIO_PARSE_LIMIT_EXCEEDED
+};
+
+/**
+Upper bounds on what a single parse may use, to keep hostile documents
+from exhausting memory. A parse that would go over any of them stops with
+the status VISIO_PARSE_LIMIT_EXCEEDED. 0 means no limit.
+*/
+struct VisioParseLimits
+{
+  VisioParseLimits()
+    : maxDecompressedBytes(0), maxShapesPerPage(0), maxPathPoints(0), maxEmbeddedBytes(0), maxStreamDepth(0)
+  {
+  }
+
+  /** Bytes of all decompressed streams of a binary document together, or
+      of the XML that an XML document keeps in memory for its second pass. */
+  unsigned long maxDecompressedBytes;
+
+  /** Shapes on a single page, counting the shapes inside groups. */
+  unsigned maxShapesPerPage;
+
+  /** Points of all polylines and tessellated NURBS curves together. */
+  unsigned long maxPathPoints;
+
+  /** Bytes of all embedded images and objects together. */
+  unsigned long maxEmbeddedBytes;
+
+  /** Nesting depth of the streams of a binary document. */
+  unsigned maxStreamDepth;
+};
+
+/**
+Settings that tune a single call of VisioDocument::parse. The defaults
+give the same behaviour as the overloads that take no options.
+*/
+struct VisioParseOptions
+{
+  VisioParseOptions()
+    : streamCacheLimit(0), decompressionThreads(0), singlePass(false), progressive(false), pages(), pageNames(),
+      deadline(std::chrono::steady_clock::time_point::max()), cancel(nullptr), limits(), textOnly(false), pageThreads(0)
+  {
+  }
+
+  /** Copies share the cancel flag, which stays owned by the caller. */
+  VisioParseOptions(const VisioParseOptions &) = default;
+  VisioParseOptions &operator=(const VisioParseOptions &) = default;
+
+  /** Maximal number of bytes of decompressed streams kept between the
+      two passes over a binary document; 0 means no limit. */
+  unsigned long streamCacheLimit;
+
+  /** Number of threads that decompress sibling streams of a binary
+      document ahead of time; 0 or 1 disables it. */
+  unsigned decompressionThreads;
+
+  /** Parse a binary document in one walk over its streams instead of
+      two. Documents whose styles, stencils or fonts come after their pages
+      are still parsed in two passes. */
+  bool singlePass;
+
+  /** Draw each page as soon as it and its background pages are parsed,
+      instead of keeping the whole document until the end. The painter
+      gets the same calls, in the same order. */
+  bool progressive;
+
+  /** Indices of the pages to produce, counted from 0 in document order
+      without the background pages. Other pages are not parsed. When
+      both pages and pageNames are empty, all pages are produced. */
+  std::set<unsigned> pages;
+
+  /** UTF-8 names of the pages to produce, in addition to those selected
+      by pages. */
+  std::set<std::string> pageNames;
+
+  /** Point in time at which the parse gives up, with the status
+      VISIO_PARSE_TIMED_OUT. The painter may then have got only a part of
+      the document. The default, time_point::max(), means no deadline. */
+  std::chrono::steady_clock::time_point deadline;
+
+  /** Flag that another thread sets to stop the parse, with the status
+      VISIO_PARSE_CANCELLED. The painter may then have got only a part of
+      the document. The flag has to outlive the parse; null means the
+      parse cannot be cancelled. */
+  const std::atomic<bool> *cancel;
+
+  /** Resources the parse may use. */
+  VisioParseLimits limits;
+
+  /** Produce only the text of the document, for painters that discard
+      graphics. The pages and the text objects of their shapes come in
+      the usual order, with fields filled in, but no geometry, images or
+      embedded objects are read or drawn. */
+  bool textOnly;
+
+  /** Number of threads that parse the masters and the pages of a VSDX
+      document at the same time, before drawing them in document order;
+      0 or 1 disables it. The pages are parsed this way only when all of
+      them are produced. As all the pages are parsed before the first is
+      drawn, they are all kept in memory at the same time, so together
+      with progressive, the pages take as much memory as without it. */
+  unsigned pageThreads;
+};
+
+} // namespace libvisio
+
+#endif //  __VISIOPARSEOPTIONS_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
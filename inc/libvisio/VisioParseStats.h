@@ -0,0 +1,102 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VISIOPARSESTATS_H__
+#define __VISIOPARSESTATS_H__
+
+namespace libvisio
+{
+
+/**
+Where a single call of VisioDocument::parse spent its time, and how much
+of the document it went through. The numbers are filled in also when the
+parse fails, up to the point where it stopped.
+*/
+struct VisioParseStats
+{
+  VisioParseStats()
+    : detectionSeconds(0.0), decompressionSeconds(0.0), firstPassSeconds(0.0), secondPassSeconds(0.0), drawSeconds(0.0),
+      passes(0), streams(0), chunks(0), shapes(0), pathNodes(0), textSpans(0), embeddedBytes(0),
+      streamCacheHits(0), streamCacheMisses(0), streamCacheSavedBytes(0), peakBufferedPages(0), peakBufferedElements(0),
+      parallelParts(0)
+  {
+  }
+
+  /** Time spent finding out the format of the input. */
+  double detectionSeconds;
+
+  /** Time spent decompressing the streams of a binary document. It is
+      a part of the time of the passes. */
+  double decompressionSeconds;
+
+  /** Time of the pass that collects styles and stencils; 0 when the
+      document is parsed in a single pass. */
+  double firstPassSeconds;
+
+  /** Time of the pass that collects the pages, including drawing
+      them. */
+  double secondPassSeconds;
+
+  /** Time spent drawing the pages that were kept until all of them
+      were collected; 0 when parsing into a VisioDocumentModel. */
+  double drawSeconds;
+
+  /** Passes over the document: 2, or 1 when a binary document was
+      parsed in a single pass. */
+  unsigned passes;
+
+  /** Streams of a binary document, or parts of a VSDX document, that
+      were parsed; each pass counts them again. */
+  unsigned long streams;
+
+  /** Chunks of a binary document, or nodes of an XML document, that
+      were parsed; each pass counts them again. */
+  unsigned long chunks;
+
+  /** Shapes on the pages. */
+  unsigned long shapes;
+
+  /** Nodes of the drawn paths. */
+  unsigned long pathNodes;
+
+  /** Spans of the drawn text. */
+  unsigned long textSpans;
+
+  /** Bytes of the embedded images and objects. */
+  unsigned long embeddedBytes;
+
+  /** Compressed streams of a binary document that were found already
+      decompressed, because an earlier pass or the decompression threads
+      had done it. */
+  unsigned long streamCacheHits;
+
+  /** Compressed streams of a binary document that had to be
+      decompressed when they were opened. */
+  unsigned long streamCacheMisses;
+
+  /** Decompressed bytes of the streams that were found in the cache. */
+  unsigned long streamCacheSavedBytes;
+
+  /** Largest number of pages that were kept at a time before drawing
+      them. */
+  unsigned long peakBufferedPages;
+
+  /** Largest number of drawing calls that were kept at a time in those
+      pages. */
+  unsigned long peakBufferedElements;
+
+  /** Master and page parts of a VSDX document that the page threads
+      parsed, and that were then drawn from what they parsed. */
+  unsigned long parallelParts;
+};
+
+} // namespace libvisio
+
+#endif //  __VISIOPARSESTATS_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -11,6 +11,7 @@
 #define __LIBVISIO_H__
 
 #include "VisioDocument.h"
+#include "VisioDocumentModel.h"
 
 #endif
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
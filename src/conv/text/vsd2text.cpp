@@ -78,7 +78,9 @@ int main(int argc, char *argv[])
 
   librevenge::RVNGStringVector pages;
   librevenge::RVNGTextDrawingGenerator painter(pages);
-  if (!libvisio::VisioDocument::parse(&input, &painter))
+  libvisio::VisioParseOptions options;
+  options.textOnly = true;
+  if (!libvisio::VisioDocument::parse(&input, &painter, options))
   {
     fprintf(stderr, "ERROR: Parsing of document failed!\n");
     return 1;
@@ -17,13 +17,15 @@
 #include "libvisio_utils.h"
 #include "libvisio_xml.h"
 #include "VSDContentCollector.h"
+#include "VSDParseControl.h"
 #include "VSDStylesCollector.h"
+#include "VSDTextCollector.h"
 #include "VSDXMLHelper.h"
 #include "VSDXMLTokenMap.h"
 
 
 libvisio::VDXParser::VDXParser(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter)
-  : VSDXMLParserBase(), m_input(input), m_painter(painter)
+  : VSDXMLParserBase(), m_input(input), m_painter(painter), m_tape(), m_stringData()
 {
 }
 
@@ -44,17 +46,33 @@ bool libvisio::VDXParser::parseMain()
 
     VSDStylesCollector stylesCollector(groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders);
     m_collector = &stylesCollector;
+    m_tape.clear();
     m_input->seek(0, librevenge::RVNG_SEEK_SET);
-    if (!processXmlDocument(m_input))
-      return false;
+    {
+      if (m_parseControl)
+        m_parseControl->addPass();
+      VSDParseTimer timer(m_parseControl, &VisioParseStats::firstPassSeconds);
+      if (!processXmlDocument(m_input))
+        return false;
+    }
 
     VSDStyles styles = stylesCollector.getStyleSheets();
 
-    VSDContentCollector contentCollector(m_painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, m_stencils);
-    m_collector = &contentCollector;
+    const std::unique_ptr<VSDContentCollector> contentCollector =
+      makeContentCollector(m_textOnly, m_painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, m_stencils);
+    contentCollector->setPagesOutput(m_pagesOutput);
+    contentCollector->setProgressive(m_progressive);
+    contentCollector->setParseControl(m_parseControl);
+    m_collector = contentCollector.get();
     m_input->seek(0, librevenge::RVNG_SEEK_SET);
-    if (!processXmlDocument(m_input))
-      return false;
+    {
+      if (m_parseControl)
+        m_parseControl->addPass();
+      VSDParseTimer timer(m_parseControl, &VisioParseStats::secondPassSeconds);
+      if (!processXmlDocument(m_input))
+        return false;
+    }
+    m_tape.clear();
 
     return true;
   }
@@ -72,29 +90,41 @@ bool libvisio::VDXParser::extractStencils()
 
 bool libvisio::VDXParser::processXmlDocument(librevenge::RVNGInputStream *input)
 {
-  if (!input)
-    return false;
-
-  auto reader = xmlReaderForStream(input);
-  if (!reader)
-    return false;
-  int ret = xmlTextReaderRead(reader.get());
+  // Record the document the first time it is read, replay it afterwards
+  std::unique_ptr<xmlTextReader, void (*)(xmlTextReaderPtr)> xmlReader(nullptr, xmlFreeTextReader);
+  std::unique_ptr<VSDXMLReader> reader;
+  if (m_tape.isComplete())
+    reader.reset(new VSDXMLReader(m_tape));
+  else
+  {
+    if (!input)
+      return false;
+    xmlReader = xmlReaderForStream(input);
+    if (!xmlReader)
+      return false;
+    reader.reset(new VSDXMLReader(xmlReader.get(), m_tape, m_parseControl));
+  }
+  if (m_parseControl)
+    m_parseControl->addStream();
+  int ret = reader->read();
   while (1 == ret)
   {
+    if (m_parseControl)
+      m_parseControl->addChunk();
     processXmlNode(reader.get());
 
-    ret = xmlTextReaderRead(reader.get());
+    ret = reader->read();
   }
 
   return true;
 }
 
-void libvisio::VDXParser::processXmlNode(xmlTextReaderPtr reader)
+void libvisio::VDXParser::processXmlNode(VSDXMLReader *reader)
 {
   if (!reader)
     return;
   int tokenId = getElementToken(reader);
-  int tokenType = xmlTextReaderNodeType(reader);
+  int tokenType = reader->getNodeType();
   _handleLevelChange((unsigned)getElementDepth(reader));
   switch (tokenId)
   {
@@ -121,7 +151,7 @@ void libvisio::VDXParser::processXmlNode(xmlTextReaderPtr reader)
       handleMasterEnd(reader);
     break;
   case XML_MASTERS:
-    if (XML_READER_TYPE_ELEMENT == tokenType && !xmlTextReaderIsEmptyElement(reader))
+    if (XML_READER_TYPE_ELEMENT == tokenType && !reader->isEmptyElement())
       handleMastersStart(reader);
     else if (XML_READER_TYPE_END_ELEMENT == tokenType)
       handleMastersEnd(reader);
@@ -195,13 +225,13 @@ void libvisio::VDXParser::processXmlNode(xmlTextReaderPtr reader)
       int ret = 0;
       do
       {
-        ret = xmlTextReaderRead(reader);
+        ret = reader->read();
 #if 0
         // SolutionXML inside VDX file can have invalid namespace URIs
         xmlResetLastError();
 #endif
         tokenId = getElementToken(reader);
-        tokenType = xmlTextReaderNodeType(reader);
+        tokenType = reader->getNodeType();
       }
       while ((XML_SOLUTIONXML != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
     }
@@ -280,21 +310,21 @@ void libvisio::VDXParser::processXmlNode(xmlTextReaderPtr reader)
   }
 
 #ifdef DEBUG
-  const xmlChar *name = xmlTextReaderConstName(reader);
-  const xmlChar *value = xmlTextReaderConstValue(reader);
-  int isEmptyElement = xmlTextReaderIsEmptyElement(reader);
+  const xmlChar *name = reader->getName();
+  const xmlChar *value = reader->getValue();
+  int isEmptyElement = reader->isEmptyElement();
 
   for (int i=0; i<getElementDepth(reader); ++i)
   {
     VSD_DEBUG_MSG((" "));
   }
   VSD_DEBUG_MSG(("%i %i %s", isEmptyElement, tokenType, name ? (const char *)name : ""));
-  if (xmlTextReaderNodeType(reader) == 1)
+  if (reader->getNodeType() == 1)
   {
-    while (xmlTextReaderMoveToNextAttribute(reader))
+    while (reader->moveToNextAttribute())
     {
-      const xmlChar *name1 = xmlTextReaderConstName(reader);
-      const xmlChar *value1 = xmlTextReaderConstValue(reader);
+      const xmlChar *name1 = reader->getName();
+      const xmlChar *value1 = reader->getValue();
       printf(" %s=\"%s\"", name1, value1);
     }
   }
@@ -310,7 +340,7 @@ void libvisio::VDXParser::processXmlNode(xmlTextReaderPtr reader)
 
 // Functions reading the DiagramML document content
 
-void libvisio::VDXParser::readLine(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readLine(VSDXMLReader *reader)
 {
   boost::optional<double> strokeWidth;
   boost::optional<Colour> colour;
@@ -326,13 +356,13 @@ void libvisio::VDXParser::readLine(xmlTextReaderPtr reader)
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VDXParser::readLine: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VDXParser::readLine: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_LINEWEIGHT:
@@ -375,7 +405,7 @@ void libvisio::VDXParser::readLine(xmlTextReaderPtr reader)
     m_shape.m_lineStyle.override(VSDOptionalLineStyle(strokeWidth, colour, linePattern, startMarker, endMarker, lineCap, rounding, -1, -1));
 }
 
-void libvisio::VDXParser::readFillAndShadow(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readFillAndShadow(VSDXMLReader *reader)
 {
   boost::optional<Colour> fillColourFG;
   boost::optional<double> fillFGTransparency;
@@ -394,13 +424,13 @@ void libvisio::VDXParser::readFillAndShadow(xmlTextReaderPtr reader)
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VDXParser::readFillAndShadow: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VDXParser::readFillAndShadow: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_FILLFOREGND:
@@ -463,20 +493,20 @@ void libvisio::VDXParser::readFillAndShadow(xmlTextReaderPtr reader)
   }
 }
 
-void libvisio::VDXParser::readMisc(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readMisc(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VDXParser::readMisc: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VDXParser::readMisc: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_HIDETEXT:
@@ -506,20 +536,20 @@ void libvisio::VDXParser::readMisc(xmlTextReaderPtr reader)
   while ((XML_MISC != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VDXParser::readXFormData(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readXFormData(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VDXParser::readXFormData: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VDXParser::readXFormData: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_PINX:
@@ -565,20 +595,20 @@ void libvisio::VDXParser::readXFormData(xmlTextReaderPtr reader)
   while ((XML_XFORM != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VDXParser::readLayerMem(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readLayerMem(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VDXParser::readLayerMem: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VDXParser::readLayerMem: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_LAYERMEMBER:
@@ -592,20 +622,20 @@ void libvisio::VDXParser::readLayerMem(xmlTextReaderPtr reader)
   while ((XML_LAYERMEM != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VDXParser::readTxtXForm(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readTxtXForm(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VDXParser::readTxtXForm: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VDXParser::readTxtXForm: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_TXTPINX:
@@ -671,20 +701,20 @@ void libvisio::VDXParser::readTxtXForm(xmlTextReaderPtr reader)
   while ((XML_TEXTXFORM != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VDXParser::readXForm1D(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readXForm1D(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VDXParser::readXForm1D: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VDXParser::readXForm1D: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_BEGINX:
@@ -726,7 +756,7 @@ void libvisio::VDXParser::readXForm1D(xmlTextReaderPtr reader)
   while ((XML_XFORM1D != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VDXParser::readPageProps(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readPageProps(VSDXMLReader *reader)
 {
   double pageWidth = 0.0;
   double pageHeight = 0.0;
@@ -741,13 +771,13 @@ void libvisio::VDXParser::readPageProps(xmlTextReaderPtr reader)
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VDXParser::readPageProps: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VDXParser::readPageProps: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_PAGEWIDTH:
@@ -792,29 +822,29 @@ void libvisio::VDXParser::readPageProps(xmlTextReaderPtr reader)
   }
 }
 
-void libvisio::VDXParser::readFonts(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readFonts(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VDXParser::readFonts: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VDXParser::readFonts: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     if (XML_FACENAME == tokenId)
     {
-      std::unique_ptr<xmlChar, decltype(xmlFree)> id(xmlTextReaderGetAttribute(reader, BAD_CAST("ID")), xmlFree);
-      std::unique_ptr<xmlChar, decltype(xmlFree)> name(xmlTextReaderGetAttribute(reader, BAD_CAST("Name")), xmlFree);
+      const xmlChar *const id = reader->getConstAttribute(BAD_CAST("ID"));
+      const xmlChar *const name = reader->getConstAttribute(BAD_CAST("Name"));
       if (id && name)
       {
-        auto idx = (unsigned)xmlStringToLong(id.get());
-        librevenge::RVNGBinaryData textStream(name.get(), xmlStrlen(name.get()));
+        auto idx = (unsigned)xmlStringToLong(id);
+        librevenge::RVNGBinaryData textStream(name, xmlStrlen(name));
         m_fonts[idx] = VSDName(textStream, libvisio::VSD_TEXT_UTF8);
       }
     }
@@ -822,7 +852,7 @@ void libvisio::VDXParser::readFonts(xmlTextReaderPtr reader)
   while ((XML_FACENAMES != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VDXParser::readTextBlock(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readTextBlock(VSDXMLReader *reader)
 {
   double leftMargin = 0.0;
   double rightMargin = 0.0;
@@ -840,9 +870,9 @@ void libvisio::VDXParser::readTextBlock(xmlTextReaderPtr reader)
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_LEFTMARGIN:
@@ -904,38 +934,42 @@ void libvisio::VDXParser::readTextBlock(xmlTextReaderPtr reader)
                                                                 !!bgClrId, bgColour, defaultTabStop, textDirection));
 }
 
-xmlChar *libvisio::VDXParser::readStringData(xmlTextReaderPtr reader)
+const xmlChar *libvisio::VDXParser::readStringData(VSDXMLReader *reader)
 {
-  int ret = xmlTextReaderRead(reader);
-  if (1 == ret && XML_READER_TYPE_TEXT == xmlTextReaderNodeType(reader))
+  int ret = reader->read();
+  if (1 == ret && XML_READER_TYPE_TEXT == reader->getNodeType())
   {
-    std::unique_ptr<xmlChar, void (*)(void *)> stringValue(xmlTextReaderValue(reader), xmlFree);
-    ret = xmlTextReaderRead(reader);
-    if (1 == ret && stringValue)
+    // The value is in a text node, so it has to outlive the read of the end of the cell
+    const xmlChar *const value = reader->getValue();
+    if (!value)
+      return nullptr;
+    m_stringData.assign((const char *)value);
+    ret = reader->read();
+    if (1 == ret)
     {
-      VSD_DEBUG_MSG(("VDXParser::readStringData stringValue %s\n", (const char *)stringValue.get()));
-      return stringValue.release();
+      VSD_DEBUG_MSG(("VDXParser::readStringData stringValue %s\n", m_stringData.c_str()));
+      return BAD_CAST(m_stringData.c_str());
     }
   }
   return nullptr;
 }
 
-int libvisio::VDXParser::getElementToken(xmlTextReaderPtr reader)
+int libvisio::VDXParser::getElementToken(VSDXMLReader *reader)
 {
-  return VSDXMLTokenMap::getTokenId(xmlTextReaderConstName(reader));
+  return reader->getToken();
 }
 
-int libvisio::VDXParser::getElementDepth(xmlTextReaderPtr reader)
+int libvisio::VDXParser::getElementDepth(VSDXMLReader *reader)
 {
-  return xmlTextReaderDepth(reader);
+  return reader->getDepth();
 }
 
-void libvisio::VDXParser::getBinaryData(xmlTextReaderPtr reader)
+void libvisio::VDXParser::getBinaryData(VSDXMLReader *reader)
 {
-  const int ret = xmlTextReaderRead(reader);
-  if (1 == ret && XML_READER_TYPE_TEXT == xmlTextReaderNodeType(reader))
+  const int ret = reader->read();
+  if (1 == ret && XML_READER_TYPE_TEXT == reader->getNodeType() && !m_textOnly)
   {
-    const xmlChar *data = xmlTextReaderConstValue(reader);
+    const xmlChar *data = reader->getValue();
     if (data)
     {
       if (!m_shape.m_foreign)
@@ -946,20 +980,20 @@ void libvisio::VDXParser::getBinaryData(xmlTextReaderPtr reader)
   }
 }
 
-void libvisio::VDXParser::readForeignInfo(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readForeignInfo(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VDXParser::readForeignInfo: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VDXParser::readForeignInfo: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_IMGOFFSETX:
@@ -1001,7 +1035,7 @@ void libvisio::VDXParser::readForeignInfo(xmlTextReaderPtr reader)
   while ((XML_FOREIGN != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VDXParser::readTabs(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readTabs(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -1009,7 +1043,7 @@ void libvisio::VDXParser::readTabs(xmlTextReaderPtr reader)
   unsigned ix = getIX(reader);
   m_currentTabSet = &(m_shape.m_tabSets[ix].m_tabStops);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
     m_currentTabSet->clear();
   }
@@ -1017,13 +1051,13 @@ void libvisio::VDXParser::readTabs(xmlTextReaderPtr reader)
   {
     do
     {
-      ret = xmlTextReaderRead(reader);
+      ret = reader->read();
       tokenId = getElementToken(reader);
       if (XML_TOKEN_INVALID == tokenId)
       {
-        VSD_DEBUG_MSG(("VDXParser::readTabs: unknown token %s\n", xmlTextReaderConstName(reader)));
+        VSD_DEBUG_MSG(("VDXParser::readTabs: unknown token %s\n", reader->getName()));
       }
-      tokenType = xmlTextReaderNodeType(reader);
+      tokenType = reader->getNodeType();
       if (XML_TAB == tokenId && XML_READER_TYPE_ELEMENT == tokenType)
         readTab(reader);
     }
@@ -1032,14 +1066,14 @@ void libvisio::VDXParser::readTabs(xmlTextReaderPtr reader)
   m_currentTabSet = nullptr;
 }
 
-void libvisio::VDXParser::readTab(xmlTextReaderPtr reader)
+void libvisio::VDXParser::readTab(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
   int tokenType = -1;
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
     m_currentTabSet->erase(ix);
   }
@@ -1047,13 +1081,13 @@ void libvisio::VDXParser::readTab(xmlTextReaderPtr reader)
   {
     do
     {
-      ret = xmlTextReaderRead(reader);
+      ret = reader->read();
       tokenId = getElementToken(reader);
       if (XML_TOKEN_INVALID == tokenId)
       {
-        VSD_DEBUG_MSG(("VDXParser::readTab: unknown token %s\n", xmlTextReaderConstName(reader)));
+        VSD_DEBUG_MSG(("VDXParser::readTab: unknown token %s\n", reader->getName()));
       }
-      tokenType = xmlTextReaderNodeType(reader);
+      tokenType = reader->getNodeType();
       switch (tokenId)
       {
       case XML_POSITION:
@@ -10,6 +10,7 @@
 #ifndef __VDXPARSER_H__
 #define __VDXPARSER_H__
 
+#include <string>
 #include <librevenge/librevenge.h>
 #include "VSDXMLParserBase.h"
 
@@ -39,38 +40,42 @@ private:
 
   // Helper functions
 
-  xmlChar *readStringData(xmlTextReaderPtr reader) override;
+  const xmlChar *readStringData(VSDXMLReader *reader) override;
 
-  int getElementToken(xmlTextReaderPtr reader) override;
-  int getElementDepth(xmlTextReaderPtr reader) override;
+  int getElementToken(VSDXMLReader *reader) override;
+  int getElementDepth(VSDXMLReader *reader) override;
 
   // Functions to read the DatadiagramML document structure
 
   bool processXmlDocument(librevenge::RVNGInputStream *input);
-  void processXmlNode(xmlTextReaderPtr reader);
+  void processXmlNode(VSDXMLReader *reader);
 
   // Functions reading the DiagramML document content
 
-  void readLine(xmlTextReaderPtr reader);
-  void readFillAndShadow(xmlTextReaderPtr reader);
-  void readXFormData(xmlTextReaderPtr reader);
-  void readMisc(xmlTextReaderPtr reader);
-  void readTxtXForm(xmlTextReaderPtr reader);
-  void readXForm1D(xmlTextReaderPtr reader);
-  void readPageProps(xmlTextReaderPtr reader);
-  void readFonts(xmlTextReaderPtr reader);
-  void readTextBlock(xmlTextReaderPtr reader);
-  void readForeignInfo(xmlTextReaderPtr reader);
-  void readLayerMem(xmlTextReaderPtr reader);
-  void readTabs(xmlTextReaderPtr reader);
-  void readTab(xmlTextReaderPtr reader);
-
-  void getBinaryData(xmlTextReaderPtr reader) override;
+  void readLine(VSDXMLReader *reader);
+  void readFillAndShadow(VSDXMLReader *reader);
+  void readXFormData(VSDXMLReader *reader);
+  void readMisc(VSDXMLReader *reader);
+  void readTxtXForm(VSDXMLReader *reader);
+  void readXForm1D(VSDXMLReader *reader);
+  void readPageProps(VSDXMLReader *reader);
+  void readFonts(VSDXMLReader *reader);
+  void readTextBlock(VSDXMLReader *reader);
+  void readForeignInfo(VSDXMLReader *reader);
+  void readLayerMem(VSDXMLReader *reader);
+  void readTabs(VSDXMLReader *reader);
+  void readTab(VSDXMLReader *reader);
+
+  void getBinaryData(VSDXMLReader *reader) override;
 
   // Private data
 
   librevenge::RVNGInputStream *m_input;
   librevenge::RVNGDrawingInterface *m_painter;
+  // The document as the first pass read it, for the second pass to replay
+  VSDXMLTape m_tape;
+  // The value readStringData returned last
+  std::string m_stringData;
 };
 
 } // namespace libvisio
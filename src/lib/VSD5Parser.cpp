@@ -22,82 +22,24 @@
 
 libvisio::VSD5Parser::VSD5Parser(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter)
   : VSD6Parser(input, painter)
-{}
+{
+  m_shortIntegers = true;
+}
 
 libvisio::VSD5Parser::~VSD5Parser()
 {}
 
-void libvisio::VSD5Parser::readPointer(librevenge::RVNGInputStream *input, Pointer &ptr)
+void libvisio::VSD5Parser::handleChunks(VSDCursor *input, unsigned level)
 {
-  ptr.Type = readU16(input) & 0x00ff;
-  ptr.Format = readU16(input) & 0x00ff;
-  input->seek(4, librevenge::RVNG_SEEK_CUR); // Skip dword
-  ptr.Offset = readU32(input);
-  ptr.Length = readU32(input);
+  _handleChunks<VSD5Traits>(input, level);
 }
 
-void libvisio::VSD5Parser::readPointerInfo(librevenge::RVNGInputStream *input, unsigned ptrType, unsigned shift, unsigned &listSize, int &pointerCount)
+bool libvisio::VSD5Parser::buildStreamIndex()
 {
-  VSD_DEBUG_MSG(("VSD5Parser::readPointerInfo\n"));
-  switch (ptrType)
-  {
-  case VSD_TRAILER_STREAM:
-    input->seek(shift+0x82, librevenge::RVNG_SEEK_SET);
-    break;
-  case VSD_PAGE:
-    input->seek(shift+0x42, librevenge::RVNG_SEEK_SET);
-    break;
-  case VSD_FONT_LIST:
-    input->seek(shift+0x2e, librevenge::RVNG_SEEK_SET);
-    break;
-  case VSD_STYLES:
-    input->seek(shift+0x12, librevenge::RVNG_SEEK_SET);
-    break;
-  case VSD_STENCILS:
-  case VSD_SHAPE_FOREIGN:
-    input->seek(shift+0x1e, librevenge::RVNG_SEEK_SET);
-    break;
-  case VSD_STENCIL_PAGE:
-    input->seek(shift+0x36, librevenge::RVNG_SEEK_SET);
-    break;
-  default:
-    if (ptrType > 0x45)
-      input->seek(shift+0x1e, librevenge::RVNG_SEEK_SET);
-    else
-      input->seek(shift+0xa, librevenge::RVNG_SEEK_SET);
-    break;
-  }
-  pointerCount = readS16(input);
-  listSize = 0;
-  VSD_DEBUG_MSG(("VSD5Parser::readPointerInfo ptrType %u shift %u pointerCount %i\n", ptrType, shift, pointerCount));
+  return _buildStreamIndex<VSD5Traits>();
 }
 
-bool libvisio::VSD5Parser::getChunkHeader(librevenge::RVNGInputStream *input)
-{
-  unsigned char tmpChar = 0;
-  while (!input->isEnd() && !tmpChar)
-    tmpChar = readU8(input);
-
-  if (input->isEnd())
-    return false;
-  else
-    input->seek(-1, librevenge::RVNG_SEEK_CUR);
-
-  m_header.chunkType = getUInt(input);
-  m_header.id = getUInt(input);
-  m_header.level = readU8(input);
-  m_header.unknown = readU8(input);
-
-  m_header.trailer = 0;
-
-  m_header.list = getUInt(input);
-
-  m_header.dataLength = readU32(input);
-
-  return true;
-}
-
-void libvisio::VSD5Parser::handleChunkRecords(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::handleChunkRecords(VSDCursor *input)
 {
   long startPosition = input->tell();
   long endPosition = input->tell() + m_header.dataLength;
@@ -109,6 +51,8 @@ void libvisio::VSD5Parser::handleChunkRecords(librevenge::RVNGInputStream *input
   unsigned endOffset = readU16(input);
   if (long(endOffset) > (headerPosition - startPosition))
     endOffset = unsigned(headerPosition - startPosition); // try to read something anyway
+  if (input->isTruncated())
+    return;
   std::map<unsigned, ChunkHeader> records;
   input->seek(headerPosition, librevenge::RVNG_SEEK_SET);
   unsigned i = 0;
@@ -135,10 +79,12 @@ void libvisio::VSD5Parser::handleChunkRecords(librevenge::RVNGInputStream *input
     m_header.id = i++;
     input->seek(startPosition + record.first, librevenge::RVNG_SEEK_SET);
     handleChunk(input);
+    if (input->isTruncated())
+      return;
   }
 }
 
-void libvisio::VSD5Parser::readGeomList(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readGeomList(VSDCursor *input)
 {
   VSD_DEBUG_MSG(("VSD5Parser::readGeomList\n"));
   if (!m_shape.m_geometries.empty() && m_currentGeometryList && m_currentGeometryList->empty())
@@ -150,56 +96,56 @@ void libvisio::VSD5Parser::readGeomList(librevenge::RVNGInputStream *input)
   handleChunkRecords(input);
 }
 
-void libvisio::VSD5Parser::readList(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readList(VSDCursor *input)
 {
   if (!m_isStencilStarted)
     m_collector->collectUnhandledChunk(m_header.id, m_header.level);
   handleChunkRecords(input);
 }
 
-void libvisio::VSD5Parser::readCharList(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readCharList(VSDCursor *input)
 {
   VSD_DEBUG_MSG(("VSD5Parser::readCharList\n"));
   readList(input);
 }
 
-void libvisio::VSD5Parser::readParaList(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readParaList(VSDCursor *input)
 {
   VSD_DEBUG_MSG(("VSD5Parser::readParaList\n"));
   readList(input);
 }
 
-void libvisio::VSD5Parser::readShapeList(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readShapeList(VSDCursor *input)
 {
   VSD_DEBUG_MSG(("VSD5Parser::readShapeList\n"));
   readList(input);
 }
 
-void libvisio::VSD5Parser::readPropList(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readPropList(VSDCursor *input)
 {
   VSD_DEBUG_MSG(("VSD5Parser::readPropList\n"));
   readList(input);
 }
 
-void libvisio::VSD5Parser::readFieldList(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readFieldList(VSDCursor *input)
 {
   VSD_DEBUG_MSG(("VSD5Parser::readFieldList\n"));
   readList(input);
 }
 
-void libvisio::VSD5Parser::readNameList2(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readNameList2(VSDCursor *input)
 {
   VSD_DEBUG_MSG(("VSD5Parser::readNameList2\n"));
   readList(input);
 }
 
-void libvisio::VSD5Parser::readTabsDataList(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readTabsDataList(VSDCursor *input)
 {
   VSD_DEBUG_MSG(("VSD5Parser::readTabsDataList\n"));
   readList(input);
 }
 
-void libvisio::VSD5Parser::readLine(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readLine(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double strokeWidth = readDouble(input);
@@ -212,6 +158,8 @@ void libvisio::VSD5Parser::readLine(librevenge::RVNGInputStream *input)
   unsigned char startMarker = readU8(input);
   unsigned char endMarker = readU8(input);
   unsigned char lineCap = readU8(input);
+  if (input->isTruncated())
+    return;
 
   if (m_isInStyles)
     m_collector->collectLineStyle(m_header.level, strokeWidth, c, linePattern, startMarker, endMarker, lineCap, rounding, -1, -1);
@@ -219,7 +167,7 @@ void libvisio::VSD5Parser::readLine(librevenge::RVNGInputStream *input)
     m_shape.m_lineStyle.override(VSDOptionalLineStyle(strokeWidth, c, linePattern, startMarker, endMarker, lineCap, rounding, -1, -1));
 }
 
-void libvisio::VSD5Parser::readParaIX(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readParaIX(VSDCursor *input)
 {
   unsigned charCount = readU16(input);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
@@ -235,6 +183,8 @@ void libvisio::VSD5Parser::readParaIX(librevenge::RVNGInputStream *input)
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double spAfter = readDouble(input);
   unsigned char align = readU8(input);
+  if (input->isTruncated())
+    return;
 
   unsigned char bullet(0);
   VSDName bulletStr;
@@ -264,7 +214,7 @@ void libvisio::VSD5Parser::readParaIX(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSD5Parser::readCharIX(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readCharIX(VSDCursor *input)
 {
   unsigned charCount = readU16(input);
   unsigned fontID = readU16(input);
@@ -307,6 +257,8 @@ void libvisio::VSD5Parser::readCharIX(librevenge::RVNGInputStream *input)
   if (fontMod & 4) strikeout = true;
   if (fontMod & 0x20) doublestrikeout = true;
 #endif
+  if (input->isTruncated())
+    return;
 
   if (m_isInStyles)
     m_collector->collectCharIXStyle(m_header.id, m_header.level, charCount, font, fontColour, fontSize,
@@ -328,7 +280,7 @@ void libvisio::VSD5Parser::readCharIX(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSD5Parser::readFillAndShadow(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readFillAndShadow(VSDCursor *input)
 {
   Colour colourFG = _colourFromIndex(readU8(input));
   Colour colourBG = _colourFromIndex(readU8(input));
@@ -336,6 +288,8 @@ void libvisio::VSD5Parser::readFillAndShadow(librevenge::RVNGInputStream *input)
   Colour shfgc = _colourFromIndex(readU8(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR); // Shadow Background Colour skipped
   unsigned char shadowPattern = readU8(input);
+  if (input->isTruncated())
+    return;
 
   if (m_isInStyles)
     m_collector->collectFillStyle(m_header.level, colourFG, colourBG, fillPattern,
@@ -361,17 +315,19 @@ void libvisio::VSD5Parser::readFillAndShadow(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSD5Parser::readStyleSheet(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readStyleSheet(VSDCursor *input)
 {
   input->seek(10, librevenge::RVNG_SEEK_CUR);
-  unsigned lineStyle = getUInt(input);
-  unsigned fillStyle = getUInt(input);
-  unsigned textStyle = getUInt(input);
+  unsigned lineStyle = VSD5Traits::getUInt(input);
+  unsigned fillStyle = VSD5Traits::getUInt(input);
+  unsigned textStyle = VSD5Traits::getUInt(input);
+  if (input->isTruncated())
+    return;
 
   m_collector->collectStyleSheet(m_header.id, m_header.level, lineStyle, fillStyle, textStyle);
 }
 
-void libvisio::VSD5Parser::readShape(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readShape(VSDCursor *input)
 {
   m_currentGeomListCount = 0;
   m_currentGeometryList = nullptr;
@@ -387,20 +343,21 @@ void libvisio::VSD5Parser::readShape(librevenge::RVNGInputStream *input)
   auto fillStyle = MINUS_ONE;
   auto textStyle = MINUS_ONE;
 
-  try
-  {
-    input->seek(2, librevenge::RVNG_SEEK_CUR);
-    parent = getUInt(input);
-    input->seek(2, librevenge::RVNG_SEEK_CUR);
-    masterPage = getUInt(input);
-    masterShape = getUInt(input);
-    lineStyle = getUInt(input);
-    fillStyle = getUInt(input);
-    textStyle = getUInt(input);
-  }
-  catch (const EndOfStreamException &)
+  // Fields past the end of a truncated chunk keep their defaults
+  const auto readField = [this, input](unsigned &field)
   {
-  }
+    const unsigned value = VSD5Traits::getUInt(input);
+    if (!input->isTruncated())
+      field = value;
+  };
+  input->seek(2, librevenge::RVNG_SEEK_CUR);
+  readField(parent);
+  input->seek(2, librevenge::RVNG_SEEK_CUR);
+  readField(masterPage);
+  readField(masterShape);
+  readField(lineStyle);
+  readField(fillStyle);
+  readField(textStyle);
 
   m_shape.clear();
   const VSDShape *tmpShape = m_stencils.getStencilShape(masterPage, masterShape);
@@ -422,13 +379,15 @@ void libvisio::VSD5Parser::readShape(librevenge::RVNGInputStream *input)
   m_currentShapeID = MINUS_ONE;
 }
 
-void libvisio::VSD5Parser::readPage(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readPage(VSDCursor *input)
 {
-  unsigned backgroundPageID = getUInt(input);
+  unsigned backgroundPageID = VSD5Traits::getUInt(input);
+  if (input->isTruncated())
+    return;
   m_collector->collectPage(m_header.id, m_header.level, backgroundPageID, m_isBackgroundPage, m_currentPageName);
 }
 
-void libvisio::VSD5Parser::readTextBlock(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readTextBlock(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double leftMargin = readDouble(input);
@@ -444,6 +403,8 @@ void libvisio::VSD5Parser::readTextBlock(librevenge::RVNGInputStream *input)
   Colour c;
   if (isBgFilled)
     c = _colourFromIndex(colourIndex-1);
+  if (input->isTruncated())
+    return;
 
   if (m_isInStyles)
     m_collector->collectTextBlockStyle(m_header.level, leftMargin, rightMargin, topMargin, bottomMargin,
@@ -453,22 +414,26 @@ void libvisio::VSD5Parser::readTextBlock(librevenge::RVNGInputStream *input)
                                                                 verticalAlign, isBgFilled, c, 0.0, (unsigned char)0));
 }
 
-void libvisio::VSD5Parser::readTextField(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readTextField(VSDCursor *input)
 {
   input->seek(3, librevenge::RVNG_SEEK_CUR);
   if (0xe8 == readU8(input))
   {
     int nameId = readS16(input);
+    if (input->isTruncated())
+      return;
     m_shape.m_fields.addTextField(m_header.id, m_header.level, nameId, 0xffff);
   }
   else
   {
     double numericValue = readDouble(input);
+    if (input->isTruncated())
+      return;
     m_shape.m_fields.addNumericField(m_header.id, m_header.level, VSD_FIELD_FORMAT_Unknown, CELL_TYPE_NoCast, numericValue, 0xffff);
   }
 }
 
-void libvisio::VSD5Parser::readNameIDX(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readNameIDX(VSDCursor *input)
 {
   VSD_DEBUG_MSG(("VSD5Parser::readNameIDX\n"));
   std::map<unsigned, VSDName> names;
@@ -483,41 +448,41 @@ void libvisio::VSD5Parser::readNameIDX(librevenge::RVNGInputStream *input)
     if (iter != m_names.end())
       names[elementId] = iter->second;
   }
+  if (input->isTruncated())
+    return;
   m_namesMapMap[m_header.level] = names;
 }
 
-void libvisio::VSD5Parser::readMisc(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readMisc(VSDCursor *input)
 {
   unsigned char flags = readU8(input);
+  if (input->isTruncated())
+    return;
   if (flags & 0x20)
     m_shape.m_misc.m_hideText = true;
   else
     m_shape.m_misc.m_hideText = false;
 }
 
-void libvisio::VSD5Parser::readXForm1D(librevenge::RVNGInputStream *input)
+void libvisio::VSD5Parser::readXForm1D(VSDCursor *input)
 {
-  if (!m_shape.m_xform1d)
-    m_shape.m_xform1d = make_unique<XForm1D>();
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform1d->beginX = readDouble(input);
+  const double beginX = readDouble(input);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform1d->beginY = readDouble(input);
+  const double beginY = readDouble(input);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform1d->endX = readDouble(input);
+  const double endX = readDouble(input);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform1d->endY = readDouble(input);
-}
-
-unsigned libvisio::VSD5Parser::getUInt(librevenge::RVNGInputStream *input)
-{
-  int value = readS16(input);
-  return (unsigned)value;
-}
+  const double endY = readDouble(input);
+  if (input->isTruncated())
+    return;
 
-int libvisio::VSD5Parser::getInt(librevenge::RVNGInputStream *input)
-{
-  return readS16(input);
+  if (!m_shape.m_xform1d)
+    m_shape.m_xform1d = make_unique<XForm1D>();
+  m_shape.m_xform1d->beginX = beginX;
+  m_shape.m_xform1d->beginY = beginY;
+  m_shape.m_xform1d->endX = endX;
+  m_shape.m_xform1d->endY = endY;
 }
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
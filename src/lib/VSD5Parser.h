@@ -26,48 +26,44 @@ public:
   ~VSD5Parser() override;
 
 protected:
-  void readPointer(librevenge::RVNGInputStream *input, Pointer &ptr) override;
-  bool getChunkHeader(librevenge::RVNGInputStream *input) override;
-  void readPointerInfo(librevenge::RVNGInputStream *input, unsigned ptrType, unsigned shift, unsigned &listSize, int &pointerCount) override;
+  void handleChunks(VSDCursor *input, unsigned level) override;
+  bool buildStreamIndex() override;
 
-  void readGeomList(librevenge::RVNGInputStream *input) override;
-  void readCharList(librevenge::RVNGInputStream *input) override;
-  void readParaList(librevenge::RVNGInputStream *input) override;
-  void readShapeList(librevenge::RVNGInputStream *input) override;
-  void readPropList(librevenge::RVNGInputStream *input) override;
-  void readFieldList(librevenge::RVNGInputStream *input) override;
-  void readNameList2(librevenge::RVNGInputStream *input) override;
-  void readTabsDataList(librevenge::RVNGInputStream *input) override;
+  void readGeomList(VSDCursor *input) override;
+  void readCharList(VSDCursor *input) override;
+  void readParaList(VSDCursor *input) override;
+  void readShapeList(VSDCursor *input) override;
+  void readPropList(VSDCursor *input) override;
+  void readFieldList(VSDCursor *input) override;
+  void readNameList2(VSDCursor *input) override;
+  void readTabsDataList(VSDCursor *input) override;
 
-  void readLine(librevenge::RVNGInputStream *input) override;
-  void readFillAndShadow(librevenge::RVNGInputStream *input) override;
-  void readTextBlock(librevenge::RVNGInputStream *input) override;
-  void readCharIX(librevenge::RVNGInputStream *input) override;
-  void readParaIX(librevenge::RVNGInputStream *input) override;
-  void readTextField(librevenge::RVNGInputStream *input) override;
+  void readLine(VSDCursor *input) override;
+  void readFillAndShadow(VSDCursor *input) override;
+  void readTextBlock(VSDCursor *input) override;
+  void readCharIX(VSDCursor *input) override;
+  void readParaIX(VSDCursor *input) override;
+  void readTextField(VSDCursor *input) override;
 
-  void readShape(librevenge::RVNGInputStream *input) override;
-  void readPage(librevenge::RVNGInputStream *input) override;
+  void readShape(VSDCursor *input) override;
+  void readPage(VSDCursor *input) override;
 
-  virtual void handleChunkRecords(librevenge::RVNGInputStream *input);
+  virtual void handleChunkRecords(VSDCursor *input);
 
-  void readStyleSheet(librevenge::RVNGInputStream *input) override;
+  void readStyleSheet(VSDCursor *input) override;
 
-  void readNameIDX(librevenge::RVNGInputStream *input) override;
+  void readNameIDX(VSDCursor *input) override;
 
-  void readMisc(librevenge::RVNGInputStream *input) override;
+  void readMisc(VSDCursor *input) override;
 
-  void readXForm1D(librevenge::RVNGInputStream *input) override;
-
-  unsigned getUInt(librevenge::RVNGInputStream *input) override;
-  int getInt(librevenge::RVNGInputStream *input) override;
+  void readXForm1D(VSDCursor *input) override;
 
 private:
   VSD5Parser();
   VSD5Parser(const VSDParser &);
   VSD5Parser &operator=(const VSDParser &);
 
-  void readList(librevenge::RVNGInputStream *input);
+  void readList(VSDCursor *input);
 };
 
 } // namespace libvisio
@@ -26,45 +26,17 @@ libvisio::VSD6Parser::VSD6Parser(librevenge::RVNGInputStream *input, librevenge:
 libvisio::VSD6Parser::~VSD6Parser()
 {}
 
-bool libvisio::VSD6Parser::getChunkHeader(librevenge::RVNGInputStream *input)
+void libvisio::VSD6Parser::handleChunks(VSDCursor *input, unsigned level)
 {
-  unsigned char tmpChar = 0;
-  while (!input->isEnd() && !tmpChar)
-    tmpChar = readU8(input);
+  _handleChunks<VSD6Traits>(input, level);
+}
 
-  if (input->isEnd())
-    return false;
-  else
-    input->seek(-1, librevenge::RVNG_SEEK_CUR);
-
-  m_header.chunkType = readU32(input);
-  m_header.id = readU32(input);
-  m_header.list = readU32(input);
-
-  // Certain chunk types seem to always have a trailer
-  m_header.trailer = 0;
-  if (m_header.list != 0 || m_header.chunkType == 0x76 || m_header.chunkType == 0x73 ||
-      m_header.chunkType == 0x72 || m_header.chunkType == 0x71 || m_header.chunkType == 0x70 ||
-      m_header.chunkType == 0x6f || m_header.chunkType == 0x6e || m_header.chunkType == 0x6d ||
-      m_header.chunkType == 0x6c || m_header.chunkType == 0x6b || m_header.chunkType == 0x6a ||
-      m_header.chunkType == 0x69 || m_header.chunkType == 0x68 || m_header.chunkType == 0x67 ||
-      m_header.chunkType == 0x66 || m_header.chunkType == 0x65 || m_header.chunkType == 0x64 ||
-      m_header.chunkType == 0x2c || m_header.chunkType == 0xd)
-    m_header.trailer += 8; // 8 byte trailer
-
-  m_header.dataLength = readU32(input);
-  m_header.level = readU16(input);
-  m_header.unknown = readU8(input);
-
-  // 0x1f (OLE data) and 0xc9 (Name ID) never have trailer
-  if (m_header.chunkType == 0x1f || m_header.chunkType == 0xc9)
-  {
-    m_header.trailer = 0;
-  }
-  return true;
+bool libvisio::VSD6Parser::buildStreamIndex()
+{
+  return _buildStreamIndex<VSD6Traits>();
 }
 
-void libvisio::VSD6Parser::readText(librevenge::RVNGInputStream *input)
+void libvisio::VSD6Parser::readText(VSDCursor *input)
 {
   input->seek(8, librevenge::RVNG_SEEK_CUR);
   librevenge::RVNGBinaryData  textStream;
@@ -85,7 +57,7 @@ void libvisio::VSD6Parser::readText(librevenge::RVNGInputStream *input)
   m_shape.m_textFormat = libvisio::VSD_TEXT_ANSI;
 }
 
-void libvisio::VSD6Parser::readLayerMem(librevenge::RVNGInputStream *input)
+void libvisio::VSD6Parser::readLayerMem(VSDCursor *input)
 {
   input->seek(13, librevenge::RVNG_SEEK_CUR);
   unsigned textLength = readU8(input);
@@ -102,7 +74,7 @@ void libvisio::VSD6Parser::readLayerMem(librevenge::RVNGInputStream *input)
 
 }
 
-void libvisio::VSD6Parser::readCharIX(librevenge::RVNGInputStream *input)
+void libvisio::VSD6Parser::readCharIX(VSDCursor *input)
 {
   unsigned charCount = readU32(input);
   unsigned fontID = readU16(input);
@@ -148,6 +120,8 @@ void libvisio::VSD6Parser::readCharIX(librevenge::RVNGInputStream *input)
   if (fontMod & 1) doubleunderline = true;
   if (fontMod & 4) strikeout = true;
   if (fontMod & 0x20) doublestrikeout = true;
+  if (input->isTruncated())
+    return;
 
   if (m_isInStyles)
     m_collector->collectCharIXStyle(m_header.id, m_header.level, charCount, font, fontColour, fontSize,
@@ -169,7 +143,7 @@ void libvisio::VSD6Parser::readCharIX(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSD6Parser::readParaIX(librevenge::RVNGInputStream *input)
+void libvisio::VSD6Parser::readParaIX(VSDCursor *input)
 {
   long startPosition = input->tell();
   unsigned charCount = readU32(input);
@@ -221,6 +195,8 @@ void libvisio::VSD6Parser::readParaIX(librevenge::RVNGInputStream *input)
     input->seek(blockEnd, librevenge::RVNG_SEEK_SET);
     remainingData -= blockLength;
   }
+  if (input->isTruncated())
+    return;
 
   if (m_isInStyles)
     m_collector->collectParaIXStyle(m_header.id, m_header.level, charCount, indFirst, indLeft, indRight,
@@ -242,7 +218,7 @@ void libvisio::VSD6Parser::readParaIX(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSD6Parser::readFillAndShadow(librevenge::RVNGInputStream *input)
+void libvisio::VSD6Parser::readFillAndShadow(VSDCursor *input)
 {
   unsigned char colourFGIndex = readU8(input);
   Colour colourFG;
@@ -285,6 +261,8 @@ void libvisio::VSD6Parser::readFillAndShadow(librevenge::RVNGInputStream *input)
   }
 
   unsigned char shadowPattern = readU8(input);
+  if (input->isTruncated())
+    return;
 
   if (m_isInStyles)
     m_collector->collectFillStyle(m_header.level, colourFG, colourBG, fillPattern,
@@ -310,7 +288,7 @@ void libvisio::VSD6Parser::readFillAndShadow(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSD6Parser::readName(librevenge::RVNGInputStream *input)
+void libvisio::VSD6Parser::readName(VSDCursor *input)
 {
   unsigned long numBytesRead = 0;
   const unsigned char *tmpBuffer = input->read(m_header.dataLength, numBytesRead);
@@ -321,7 +299,7 @@ void libvisio::VSD6Parser::readName(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSD6Parser::readName2(librevenge::RVNGInputStream *input)
+void libvisio::VSD6Parser::readName2(VSDCursor *input)
 {
   unsigned char character = 0;
   librevenge::RVNGBinaryData name;
@@ -329,10 +307,12 @@ void libvisio::VSD6Parser::readName2(librevenge::RVNGInputStream *input)
   while ((character = readU8(input)))
     name.append(character);
   name.append(character);
+  if (input->isTruncated())
+    return;
   m_names[m_header.id] = VSDName(name, libvisio::VSD_TEXT_ANSI);
 }
 
-void libvisio::VSD6Parser::readTextField(librevenge::RVNGInputStream *input)
+void libvisio::VSD6Parser::readTextField(VSDCursor *input)
 {
   unsigned long initialPosition = input->tell();
   input->seek(7, librevenge::RVNG_SEEK_CUR);
@@ -342,6 +322,8 @@ void libvisio::VSD6Parser::readTextField(librevenge::RVNGInputStream *input)
     int nameId = readS32(input);
     input->seek(6, librevenge::RVNG_SEEK_CUR);
     int formatStringId = readS32(input);
+    if (input->isTruncated())
+      return;
     m_shape.m_fields.addTextField(m_header.id, m_header.level, nameId, formatStringId);
   }
   else
@@ -401,10 +383,12 @@ void libvisio::VSD6Parser::readTextField(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSD6Parser::readMisc(librevenge::RVNGInputStream *input)
+void libvisio::VSD6Parser::readMisc(VSDCursor *input)
 {
   unsigned long initialPosition = input->tell();
   unsigned char flags = readU8(input);
+  if (input->isTruncated())
+    return;
   if (flags & 0x20)
     m_shape.m_misc.m_hideText = true;
   else
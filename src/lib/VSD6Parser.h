@@ -25,17 +25,18 @@ public:
   explicit VSD6Parser(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter);
   ~VSD6Parser() override;
 protected:
-  bool getChunkHeader(librevenge::RVNGInputStream *input) override;
+  void handleChunks(VSDCursor *input, unsigned level) override;
+  bool buildStreamIndex() override;
 private:
-  void readText(librevenge::RVNGInputStream *input) override;
-  void readCharIX(librevenge::RVNGInputStream *input) override;
-  void readParaIX(librevenge::RVNGInputStream *input) override;
-  void readFillAndShadow(librevenge::RVNGInputStream *input) override;
-  void readName(librevenge::RVNGInputStream *input) override;
-  void readName2(librevenge::RVNGInputStream *input) override;
-  void readTextField(librevenge::RVNGInputStream *input) override;
-  void readLayerMem(librevenge::RVNGInputStream *input) override;
-  void readMisc(librevenge::RVNGInputStream *input) override;
+  void readText(VSDCursor *input) override;
+  void readCharIX(VSDCursor *input) override;
+  void readParaIX(VSDCursor *input) override;
+  void readFillAndShadow(VSDCursor *input) override;
+  void readName(VSDCursor *input) override;
+  void readName2(VSDCursor *input) override;
+  void readTextField(VSDCursor *input) override;
+  void readLayerMem(VSDCursor *input) override;
+  void readMisc(VSDCursor *input) override;
 
 
   VSD6Parser();
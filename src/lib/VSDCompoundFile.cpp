@@ -0,0 +1,554 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDCompoundFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <utility>
+
+#include "libvisio_utils.h"
+#include "VSDInternalStream.h"
+
+namespace
+{
+
+const uint32_t END_OF_CHAIN = 0xfffffffe;
+const uint32_t MAX_REGULAR_SECTOR = 0xfffffffa;
+const uint32_t NO_STREAM = 0xffffffff;
+
+const unsigned HEADER_SIZE = 512;
+const unsigned HEADER_DIFAT_ENTRIES = 109;
+const unsigned DIRECTORY_ENTRY_SIZE = 128;
+
+const unsigned char SIGNATURE[] = { 0xd0, 0xcf, 0x11, 0xe0, 0xa1, 0xb1, 0x1a, 0xe1 };
+
+// Directory entry types
+const unsigned char STORAGE_OBJECT = 1;
+const unsigned char STREAM_OBJECT = 2;
+const unsigned char ROOT_STORAGE_OBJECT = 5;
+
+uint16_t getU16(const unsigned char *p)
+{
+  return uint16_t(p[0] | (p[1] << 8));
+}
+
+uint32_t getU32(const unsigned char *p)
+{
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+std::vector<uint32_t> toTable(const std::vector<unsigned char> &data)
+{
+  std::vector<uint32_t> table(data.size() / 4);
+  for (std::size_t i = 0; i < table.size(); ++i)
+    table[i] = getU32(&data[4 * i]);
+  return table;
+}
+
+// Converts the UTF-16 name of a directory entry to UTF-8
+std::string decodeName(const unsigned char *entry)
+{
+  std::string name;
+  const unsigned length = std::min(getU16(entry + 0x40) / 2, 32);
+  for (unsigned i = 0; i + 1 < length; ++i)
+  {
+    const uint16_t c = getU16(entry + 2 * i);
+    if (c < 0x80)
+      name.push_back(char(c));
+    else if (c < 0x800)
+    {
+      name.push_back(char(0xc0 | (c >> 6)));
+      name.push_back(char(0x80 | (c & 0x3f)));
+    }
+    else
+    {
+      name.push_back(char(0xe0 | (c >> 12)));
+      name.push_back(char(0x80 | ((c >> 6) & 0x3f)));
+      name.push_back(char(0x80 | (c & 0x3f)));
+    }
+  }
+  return name;
+}
+
+// Names of compound file entries are compared case-insensitively
+bool isSameName(const std::string &name1, const char *name2)
+{
+  std::size_t i = 0;
+  for (; i < name1.size() && name2[i]; ++i)
+  {
+    const unsigned char c1 = name1[i];
+    const unsigned char c2 = name2[i];
+    if (c1 != c2 && !(c1 < 0x80 && c2 < 0x80 && std::tolower(c1) == std::tolower(c2)))
+      return false;
+  }
+  return i == name1.size() && !name2[i];
+}
+
+class VSDCompoundStream : public librevenge::RVNGInputStream
+{
+public:
+  struct Run
+  {
+    unsigned long start;  // position in the stream
+    unsigned long offset; // position in the container
+    unsigned long length;
+  };
+
+  VSDCompoundStream(librevenge::RVNGInputStream *container, const std::vector<Run> &runs, unsigned long size)
+    : m_container(container), m_runs(runs), m_size(size), m_offset(0), m_buffer() {}
+  ~VSDCompoundStream() override {}
+
+  bool isStructured() override
+  {
+    return false;
+  }
+  unsigned subStreamCount() override
+  {
+    return 0;
+  }
+  const char *subStreamName(unsigned) override
+  {
+    return nullptr;
+  }
+  bool existsSubStream(const char *) override
+  {
+    return false;
+  }
+  librevenge::RVNGInputStream *getSubStreamByName(const char *) override
+  {
+    return nullptr;
+  }
+  librevenge::RVNGInputStream *getSubStreamById(unsigned) override
+  {
+    return nullptr;
+  }
+  const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead) override;
+  int seek(long offset, librevenge::RVNG_SEEK_TYPE seekType) override;
+  long tell() override
+  {
+    return m_offset;
+  }
+  bool isEnd() override
+  {
+    return (unsigned long)m_offset >= m_size;
+  }
+
+  const unsigned char *getContiguousBuffer(unsigned long &size) const;
+
+private:
+  VSDCompoundStream(const VSDCompoundStream &);
+  VSDCompoundStream &operator=(const VSDCompoundStream &);
+
+  librevenge::RVNGInputStream *m_container;
+  const std::vector<Run> m_runs;
+  const unsigned long m_size;
+  long m_offset;
+  std::vector<unsigned char> m_buffer;
+};
+
+const unsigned char *VSDCompoundStream::read(unsigned long numBytes, unsigned long &numBytesRead)
+{
+  numBytesRead = 0;
+  if (numBytes == 0 || isEnd())
+    return nullptr;
+  numBytes = std::min(numBytes, m_size - m_offset);
+
+  const unsigned long position = m_offset;
+  auto run = std::upper_bound(m_runs.begin(), m_runs.end(), position, [](unsigned long pos, const Run &r)
+  {
+    return pos < r.start;
+  }) - 1;
+
+  if (position + numBytes <= run->start + run->length)
+  {
+    // The whole range is contiguous in the container, so hand out its buffer
+    if (m_container->seek(long(run->offset + position - run->start), librevenge::RVNG_SEEK_SET))
+      return nullptr;
+    const unsigned char *const buffer = m_container->read(numBytes, numBytesRead);
+    m_offset += numBytesRead;
+    return buffer;
+  }
+
+  // The range crosses sectors that are not adjacent; gather it
+  m_buffer.resize(numBytes);
+  unsigned long gathered = 0;
+  for (; gathered < numBytes && run != m_runs.end(); ++run)
+  {
+    const unsigned long inRun = position + gathered - run->start;
+    const unsigned long length = std::min(run->length - inRun, numBytes - gathered);
+    if (m_container->seek(long(run->offset + inRun), librevenge::RVNG_SEEK_SET))
+      break;
+    unsigned long lengthRead = 0;
+    const unsigned char *const buffer = m_container->read(length, lengthRead);
+    if (lengthRead)
+      std::memcpy(&m_buffer[gathered], buffer, lengthRead);
+    gathered += lengthRead;
+    if (lengthRead < length)
+      break;
+  }
+  numBytesRead = gathered;
+  m_offset += gathered;
+  return gathered ? m_buffer.data() : nullptr;
+}
+
+const unsigned char *VSDCompoundStream::getContiguousBuffer(unsigned long &size) const
+{
+  size = 0;
+  if (m_runs.size() != 1)
+    return nullptr;
+  unsigned long containerSize = 0;
+  const unsigned char *const buffer = libvisio::getContiguousBuffer(m_container, containerSize);
+  if (!buffer || m_runs[0].offset > containerSize || m_runs[0].length > containerSize - m_runs[0].offset)
+    return nullptr;
+  size = m_size;
+  return buffer + m_runs[0].offset;
+}
+
+int VSDCompoundStream::seek(long offset, librevenge::RVNG_SEEK_TYPE seekType)
+{
+  if (seekType == librevenge::RVNG_SEEK_CUR)
+    m_offset += offset;
+  else if (seekType == librevenge::RVNG_SEEK_SET)
+    m_offset = offset;
+  else if (seekType == librevenge::RVNG_SEEK_END)
+    m_offset = long(m_size) + offset;
+
+  if (m_offset < 0)
+  {
+    m_offset = 0;
+    return 1;
+  }
+  if ((unsigned long)m_offset > m_size)
+  {
+    m_offset = long(m_size);
+    return 1;
+  }
+  return 0;
+}
+
+void addRun(std::vector<VSDCompoundStream::Run> &runs, unsigned long offset, unsigned long length)
+{
+  if (!runs.empty() && runs.back().offset + runs.back().length == offset)
+  {
+    runs.back().length += length;
+    return;
+  }
+  VSDCompoundStream::Run run;
+  run.start = runs.empty() ? 0 : runs.back().start + runs.back().length;
+  run.offset = offset;
+  run.length = length;
+  runs.push_back(run);
+}
+
+} // anonymous namespace
+
+libvisio::VSDCompoundFile::VSDCompoundFile(librevenge::RVNGInputStream *input)
+  : m_input(input), m_fileSize(0), m_sectorShift(0), m_miniSectorShift(0), m_miniStreamCutoff(0),
+    m_fat(), m_miniFat(), m_miniStreamChain(), m_streams()
+{
+}
+
+libvisio::VSDCompoundFile::~VSDCompoundFile()
+{
+}
+
+std::unique_ptr<libvisio::VSDCompoundFile> libvisio::VSDCompoundFile::open(librevenge::RVNGInputStream *input)
+{
+  if (!input)
+    return nullptr;
+
+  std::unique_ptr<VSDCompoundFile> file(new VSDCompoundFile(input));
+  bool loaded = false;
+  try
+  {
+    loaded = file->_load();
+  }
+  catch (...)
+  {
+  }
+  input->seek(0, librevenge::RVNG_SEEK_SET);
+  if (!loaded)
+    return nullptr;
+  return file;
+}
+
+bool libvisio::VSDCompoundFile::_load()
+{
+  m_input->seek(0, librevenge::RVNG_SEEK_END);
+  m_fileSize = (unsigned long)m_input->tell();
+
+  std::vector<unsigned char> header;
+  if (!_appendBlock(0, HEADER_SIZE, header) || !std::equal(SIGNATURE, SIGNATURE + VSD_NUM_ELEMENTS(SIGNATURE), header.begin()))
+    return false;
+  if (getU16(&header[0x1c]) != 0xfffe)
+    return false;
+  m_sectorShift = getU16(&header[0x1e]);
+  m_miniSectorShift = getU16(&header[0x20]);
+  if ((m_sectorShift != 9 && m_sectorShift != 12) || m_miniSectorShift != 6)
+    return false;
+  const unsigned long sectorSize = 1ul << m_sectorShift;
+
+  const uint32_t numFatSectors = getU32(&header[0x2c]);
+  const uint32_t firstDirectorySector = getU32(&header[0x30]);
+  m_miniStreamCutoff = getU32(&header[0x38]);
+  const uint32_t firstMiniFatSector = getU32(&header[0x3c]);
+  const uint32_t numMiniFatSectors = getU32(&header[0x40]);
+  uint32_t difatSector = getU32(&header[0x44]);
+  const uint32_t numDifatSectors = getU32(&header[0x48]);
+  if (numFatSectors > (m_fileSize >> m_sectorShift))
+    return false;
+
+  // The first FAT sectors are listed in the header, the others in the chain of DIFAT sectors
+  std::vector<uint32_t> fatSectors;
+  for (unsigned i = 0; i < HEADER_DIFAT_ENTRIES && fatSectors.size() < numFatSectors; ++i)
+    fatSectors.push_back(getU32(&header[0x4c + 4 * i]));
+  std::vector<unsigned char> difat;
+  for (uint32_t i = 0; fatSectors.size() < numFatSectors; ++i)
+  {
+    difat.clear();
+    if (i >= numDifatSectors || difatSector > MAX_REGULAR_SECTOR ||
+        !_appendBlock(((unsigned long)difatSector + 1) << m_sectorShift, sectorSize, difat))
+      return false;
+    for (unsigned long j = 0; j + 1 < sectorSize / 4 && fatSectors.size() < numFatSectors; ++j)
+      fatSectors.push_back(getU32(&difat[4 * j]));
+    difatSector = getU32(&difat[sectorSize - 4]);
+  }
+
+  std::vector<unsigned char> data;
+  if (!_readSectors(fatSectors, data))
+    return false;
+  m_fat = toTable(data);
+
+  std::vector<uint32_t> chain;
+  if (!_getChain(m_fat, firstDirectorySector, chain) || !_readSectors(chain, data) || data.empty())
+    return false;
+  const std::vector<unsigned char> directory(std::move(data));
+  if (directory[0x42] != ROOT_STORAGE_OBJECT)
+    return false;
+
+  // Streams shorter than the cutoff are stored in the mini stream, which is the content of the root entry
+  if (!_getChain(m_fat, getU32(&directory[0x74]), m_miniStreamChain))
+    return false;
+  if (numMiniFatSectors)
+  {
+    if (!_getChain(m_fat, firstMiniFatSector, chain) || !_readSectors(chain, data))
+      return false;
+    m_miniFat = toTable(data);
+  }
+
+  _addStreams(directory, getU32(&directory[0x4c]));
+  return true;
+}
+
+bool libvisio::VSDCompoundFile::_appendBlock(unsigned long offset, unsigned long length, std::vector<unsigned char> &data)
+{
+  if (offset > m_fileSize || length > m_fileSize - offset)
+    return false;
+  if (m_input->seek(long(offset), librevenge::RVNG_SEEK_SET))
+    return false;
+  unsigned long numBytesRead = 0;
+  const unsigned char *const buffer = m_input->read(length, numBytesRead);
+  if (numBytesRead != length)
+    return false;
+  data.insert(data.end(), buffer, buffer + length);
+  return true;
+}
+
+bool libvisio::VSDCompoundFile::_readSectors(const std::vector<uint32_t> &sectors, std::vector<unsigned char> &data)
+{
+  data.clear();
+  const unsigned long sectorSize = 1ul << m_sectorShift;
+  data.reserve(sectors.size() * sectorSize);
+  for (uint32_t sector : sectors)
+  {
+    if (sector > MAX_REGULAR_SECTOR || !_appendBlock(((unsigned long)sector + 1) << m_sectorShift, sectorSize, data))
+      return false;
+  }
+  return true;
+}
+
+bool libvisio::VSDCompoundFile::_getChain(const std::vector<uint32_t> &table, uint32_t start, std::vector<uint32_t> &chain) const
+{
+  chain.clear();
+  for (uint32_t sector = start; sector != END_OF_CHAIN; sector = table[sector])
+  {
+    // A chain can neither leave the table nor be longer than it, unless it loops
+    if (sector >= table.size() || chain.size() >= table.size())
+      return false;
+    chain.push_back(sector);
+  }
+  return true;
+}
+
+void libvisio::VSDCompoundFile::_addStreams(const std::vector<unsigned char> &directory, uint32_t firstEntry)
+{
+  const std::size_t numEntries = directory.size() / DIRECTORY_ENTRY_SIZE;
+  std::vector<bool> visited(numEntries, false);
+  visited[0] = true;
+
+  // The entries of a storage form a tree of siblings; walk it without recursion, as it can be degenerate
+  std::vector<std::pair<uint32_t, std::string> > pending(1, std::make_pair(firstEntry, std::string()));
+  while (!pending.empty())
+  {
+    const uint32_t id = pending.back().first;
+    const std::string path(std::move(pending.back().second));
+    pending.pop_back();
+    if (id == NO_STREAM || id >= numEntries || visited[id])
+      continue;
+    visited[id] = true;
+
+    const unsigned char *const entry = &directory[id * DIRECTORY_ENTRY_SIZE];
+    pending.push_back(std::make_pair(getU32(entry + 0x44), path));
+    pending.push_back(std::make_pair(getU32(entry + 0x48), path));
+    if (entry[0x42] == STORAGE_OBJECT)
+      pending.push_back(std::make_pair(getU32(entry + 0x4c), path + decodeName(entry) + "/"));
+    else if (entry[0x42] == STREAM_OBJECT)
+    {
+      Stream stream;
+      stream.name = path + decodeName(entry);
+      stream.start = getU32(entry + 0x74);
+      // Only version 4 files use the upper half of the size, and no stream of a Visio document needs it
+      stream.size = getU32(entry + 0x78);
+      m_streams.push_back(stream);
+    }
+  }
+}
+
+int libvisio::VSDCompoundFile::_findStream(const char *name) const
+{
+  if (!name)
+    return -1;
+  for (std::size_t i = 0; i < m_streams.size(); ++i)
+  {
+    if (isSameName(m_streams[i].name, name))
+      return int(i);
+  }
+  return -1;
+}
+
+librevenge::RVNGInputStream *libvisio::VSDCompoundFile::_openStream(const Stream &stream)
+{
+  const bool isMini = stream.size < m_miniStreamCutoff;
+  std::vector<uint32_t> chain;
+  if (!_getChain(isMini ? m_miniFat : m_fat, stream.start, chain))
+    return nullptr;
+
+  const unsigned shift = isMini ? m_miniSectorShift : m_sectorShift;
+  std::vector<VSDCompoundStream::Run> runs;
+  unsigned long remaining = stream.size;
+  for (std::size_t i = 0; i < chain.size() && remaining; ++i)
+  {
+    const unsigned long length = std::min(remaining, 1ul << shift);
+    unsigned long offset = 0;
+    if (isMini)
+    {
+      // Locate the mini sector in the sectors of the mini stream
+      const unsigned long miniOffset = (unsigned long)chain[i] << m_miniSectorShift;
+      const unsigned long index = miniOffset >> m_sectorShift;
+      if (index >= m_miniStreamChain.size())
+        return nullptr;
+      offset = (((unsigned long)m_miniStreamChain[index] + 1) << m_sectorShift) + (miniOffset & ((1ul << m_sectorShift) - 1));
+    }
+    else
+      offset = ((unsigned long)chain[i] + 1) << m_sectorShift;
+    if (offset > m_fileSize || length > m_fileSize - offset)
+      return nullptr;
+    addRun(runs, offset, length);
+    remaining -= length;
+  }
+  if (remaining)
+    return nullptr;
+  return new VSDCompoundStream(m_input, runs, stream.size);
+}
+
+unsigned libvisio::VSDCompoundFile::subStreamCount()
+{
+  return unsigned(m_streams.size());
+}
+
+const char *libvisio::VSDCompoundFile::subStreamName(unsigned id)
+{
+  if (id >= m_streams.size())
+    return nullptr;
+  return m_streams[id].name.c_str();
+}
+
+bool libvisio::VSDCompoundFile::existsSubStream(const char *name)
+{
+  return _findStream(name) >= 0;
+}
+
+librevenge::RVNGInputStream *libvisio::VSDCompoundFile::getSubStreamByName(const char *name)
+{
+  const int id = _findStream(name);
+  if (id < 0)
+    return nullptr;
+  return _openStream(m_streams[id]);
+}
+
+librevenge::RVNGInputStream *libvisio::VSDCompoundFile::getSubStreamById(unsigned id)
+{
+  if (id >= m_streams.size())
+    return nullptr;
+  return _openStream(m_streams[id]);
+}
+
+const unsigned char *libvisio::VSDCompoundFile::read(unsigned long numBytes, unsigned long &numBytesRead)
+{
+  return m_input->read(numBytes, numBytesRead);
+}
+
+int libvisio::VSDCompoundFile::seek(long offset, librevenge::RVNG_SEEK_TYPE seekType)
+{
+  return m_input->seek(offset, seekType);
+}
+
+long libvisio::VSDCompoundFile::tell()
+{
+  return m_input->tell();
+}
+
+bool libvisio::VSDCompoundFile::isEnd()
+{
+  return m_input->isEnd();
+}
+
+const unsigned char *libvisio::getContiguousBuffer(librevenge::RVNGInputStream *input, unsigned long &size)
+{
+  size = 0;
+  if (!input)
+    return nullptr;
+  if (const VSDInternalStream *const internal = dynamic_cast<VSDInternalStream *>(input))
+  {
+    size = internal->getSize();
+    return internal->getDataBuffer();
+  }
+  if (const VSDCompoundStream *const compound = dynamic_cast<VSDCompoundStream *>(input))
+    return compound->getContiguousBuffer(size);
+  if (!dynamic_cast<librevenge::RVNGStringStream *>(input))
+    return nullptr;
+
+  // A string stream hands out pointers into the string it keeps
+  const long position = input->tell();
+  if (input->seek(0, librevenge::RVNG_SEEK_END))
+    return nullptr;
+  const long end = input->tell();
+  input->seek(0, librevenge::RVNG_SEEK_SET);
+  unsigned long numBytesRead = 0;
+  const unsigned char *const buffer = end > 0 ? input->read((unsigned long)end, numBytesRead) : nullptr;
+  input->seek(position, librevenge::RVNG_SEEK_SET);
+  if (!buffer || numBytesRead != (unsigned long)end)
+    return nullptr;
+  size = numBytesRead;
+  return buffer;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,96 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDCOMPOUNDFILE_H__
+#define __VSDCOMPOUNDFILE_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <librevenge-stream/librevenge-stream.h>
+
+namespace libvisio
+{
+
+/* Read-only reader of OLE2 compound files. The FAT, the MiniFAT and the
+ * directory are read once when the file is opened. Sub-streams are views
+ * that read their sectors straight from the container, so opening a
+ * stream does not copy it. Reads and seeks that are not on a sub-stream
+ * go to the container itself.
+ *
+ * Sub-streams share the position of the container and must not outlive
+ * it. A pointer returned by read() of a sub-stream is only valid until
+ * the next read from the container or any of its sub-streams.
+ */
+class VSDCompoundFile : public librevenge::RVNGInputStream
+{
+public:
+  // Returns nullptr if input is not a compound file this reader understands
+  static std::unique_ptr<VSDCompoundFile> open(librevenge::RVNGInputStream *input);
+  ~VSDCompoundFile() override;
+
+  bool isStructured() override
+  {
+    return true;
+  }
+  unsigned subStreamCount() override;
+  const char *subStreamName(unsigned id) override;
+  bool existsSubStream(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamByName(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamById(unsigned id) override;
+
+  const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead) override;
+  int seek(long offset, librevenge::RVNG_SEEK_TYPE seekType) override;
+  long tell() override;
+  bool isEnd() override;
+
+private:
+  struct Stream
+  {
+    Stream() : name(), start(0), size(0) {}
+    std::string name; // full path, with '/' between storages
+    uint32_t start;
+    unsigned long size;
+  };
+
+  explicit VSDCompoundFile(librevenge::RVNGInputStream *input);
+  VSDCompoundFile(const VSDCompoundFile &);
+  VSDCompoundFile &operator=(const VSDCompoundFile &);
+
+  bool _load();
+  bool _appendBlock(unsigned long offset, unsigned long length, std::vector<unsigned char> &data);
+  bool _readSectors(const std::vector<uint32_t> &sectors, std::vector<unsigned char> &data);
+  bool _getChain(const std::vector<uint32_t> &table, uint32_t start, std::vector<uint32_t> &chain) const;
+  void _addStreams(const std::vector<unsigned char> &directory, uint32_t firstEntry);
+  int _findStream(const char *name) const;
+  librevenge::RVNGInputStream *_openStream(const Stream &stream);
+
+  librevenge::RVNGInputStream *m_input;
+  unsigned long m_fileSize;
+  unsigned m_sectorShift;
+  unsigned m_miniSectorShift;
+  unsigned long m_miniStreamCutoff;
+  std::vector<uint32_t> m_fat;
+  std::vector<uint32_t> m_miniFat;
+  std::vector<uint32_t> m_miniStreamChain;
+  std::vector<Stream> m_streams;
+};
+
+/* Returns the whole content of input if it is held in one buffer that
+ * stays valid as long as input does, and stores its size in size.
+ * Returns nullptr if the content would have to be copied or gathered to
+ * be in one piece, e.g. a sub-stream whose sectors are not adjacent.
+ */
+const unsigned char *getContiguousBuffer(librevenge::RVNGInputStream *input, unsigned long &size);
+
+} // namespace libvisio
+
+#endif // __VSDCOMPOUNDFILE_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
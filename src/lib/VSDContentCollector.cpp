@@ -21,14 +21,16 @@
 
 #include "VSDParser.h"
 #include "VSDInternalStream.h"
+#include "VSDParseControl.h"
 
 #ifndef DUMP_BITMAP
 #define DUMP_BITMAP 0
 #endif
 
 #if DUMP_BITMAP
-static unsigned bitmapId = 0;
+#include <atomic>
 #include <sstream>
+static std::atomic<unsigned> bitmapId(0);
 #endif
 
 #ifndef M_PI
@@ -139,7 +141,7 @@ libvisio::VSDContentCollector::VSDContentCollector(
   m_charFormats(), m_paraFormats(), m_lineStyle(), m_fillStyle(), m_textBlockStyle(),
   m_defaultCharStyle(), m_defaultParaStyle(), m_currentStyleSheet(0), m_styles(styles),
   m_stencils(stencils), m_stencilShape(nullptr), m_isStencilStarted(false), m_currentGeometryCount(0),
-  m_backgroundPageID(MINUS_ONE), m_currentPageID(0), m_currentPage(), m_pages(), m_layerList(),
+  m_backgroundPageID(MINUS_ONE), m_currentPageID(0), m_currentPage(), m_pages(), m_parseControl(nullptr), m_pagesOutput(nullptr), m_layerList(),
   m_splineControlPoints(), m_splineKnotVector(), m_splineX(0.0), m_splineY(0.0),
   m_splineLastKnot(0.0), m_splineDegree(0), m_splineLevel(0), m_currentShapeLevel(0),
   m_isBackgroundPage(false), m_currentLayerList(), m_currentLayerMem(), m_tabSets(), m_documentTheme(nullptr)
@@ -438,6 +440,8 @@ void libvisio::VSDContentCollector::_flushCurrentPath(unsigned shapeId)
     {
       librevenge::RVNGPropertyListVector path;
       _convertToPath(tmpPath, path, m_scale*m_lineStyle.rounding);
+      if (m_parseControl)
+        m_parseControl->addPathNodes(path.count());
       m_shapeOutputDrawing->addStyle(fillPathProps);
       librevenge::RVNGPropertyList propList;
       propList.insert("svg:d", path);
@@ -528,6 +532,8 @@ void libvisio::VSDContentCollector::_flushCurrentPath(unsigned shapeId)
     {
       librevenge::RVNGPropertyListVector path;
       _convertToPath(tmpPath, path, m_scale*m_lineStyle.rounding);
+      if (m_parseControl)
+        m_parseControl->addPathNodes(path.count());
       m_shapeOutputDrawing->addStyle(linePathProps);
       librevenge::RVNGPropertyList propList;
       propList.insert("svg:d", path);
@@ -835,6 +841,8 @@ void libvisio::VSDContentCollector::_flushText()
 #endif
         }
         m_shapeOutputText->addOpenSpan(textProps);
+        if (m_parseControl)
+          m_parseControl->addTextSpan();
         isSpanOpened = true;
         isParagraphWithoutSpan = false;
       }
@@ -1010,6 +1018,8 @@ void libvisio::VSDContentCollector::_flushText()
 #endif
         }
         m_shapeOutputText->addOpenSpan(textProps);
+        if (m_parseControl)
+          m_parseControl->addTextSpan();
         isSpanOpened = true;
         isParagraphWithoutSpan = false;
       }
@@ -1716,11 +1726,15 @@ void libvisio::VSDContentCollector::collectOLEList(unsigned /* id */, unsigned l
 void libvisio::VSDContentCollector::collectOLEData(unsigned /* id */, unsigned level, const librevenge::RVNGBinaryData &oleData)
 {
   _handleLevelChange(level);
+  if (m_parseControl)
+    m_parseControl->addEmbeddedBytes(oleData.size());
   m_currentForeignData.append(oleData);
 }
 
 void libvisio::VSDContentCollector::_handleForeignData(const librevenge::RVNGBinaryData &binaryData)
 {
+  if (m_parseControl)
+    m_parseControl->addEmbeddedBytes(binaryData.size());
   if (m_foreignType == 0 || m_foreignType == 1 || m_foreignType == 4) // Image
   {
     m_currentForeignData.clear();
@@ -2012,6 +2026,8 @@ void libvisio::VSDContentCollector::_generateBezierSegmentsFromNURBS(unsigned de
 {
   if (controlPoints.size() <= degree || knotVector.empty() || degree == 0)
     return;
+  if (m_parseControl)
+    m_parseControl->addPathPoints(controlPoints.size());
 
   /* Decomposition of a uniform spline of a given degree into Bezier segments
    * adapted from the algorithm DecomposeCurve (Les Piegl, Wayne Tiller:
@@ -2126,6 +2142,8 @@ void libvisio::VSDContentCollector::_generatePolylineFromNURBS(unsigned degree,
   if (m_noShow)
     return;
 
+  if (m_parseControl)
+    m_parseControl->addPathPoints(VSD_NUM_POLYLINES_PER_KNOT * knotVector.size());
   if (!m_noFill)
     m_currentFillGeometry.reserve(VSD_NUM_POLYLINES_PER_KNOT * knotVector.size());
   if (!m_noLine)
@@ -2133,6 +2151,8 @@ void libvisio::VSDContentCollector::_generatePolylineFromNURBS(unsigned degree,
 
   for (size_t i = 0; i < VSD_NUM_POLYLINES_PER_KNOT * knotVector.size(); i++)
   {
+    if (m_parseControl)
+      m_parseControl->check();
     librevenge::RVNGPropertyList node;
 
     node.insert("librevenge:path-action", "L");
@@ -2303,6 +2323,8 @@ void libvisio::VSDContentCollector::collectNURBSTo(unsigned id, unsigned level,
 void libvisio::VSDContentCollector::collectPolylineTo(unsigned /* id */, unsigned level, double x, double y, unsigned char xType, unsigned char yType, const std::vector<std::pair<double, double> > &points)
 {
   _handleLevelChange(level);
+  if (m_parseControl)
+    m_parseControl->addPathPoints(points.size() + 1);
 
   librevenge::RVNGPropertyList polyline;
   std::vector<std::pair<double, double> > tmpPoints(points);
@@ -2585,6 +2607,8 @@ void libvisio::VSDContentCollector::collectShape(unsigned id, unsigned level, un
 {
   _handleLevelChange(level);
   m_currentShapeLevel = level;
+  if (m_parseControl && m_isPageStarted)
+    m_parseControl->addShape();
 
   m_foreignType = (unsigned)-1; // Tracks current foreign data type
   m_foreignFormat = 0; // Tracks foreign data format
@@ -2846,6 +2870,14 @@ void libvisio::VSDContentCollector::_convertDataToString(librevenge::RVNGString
   appendCharacters(result, tmpData, format);
 }
 
+librevenge::RVNGString libvisio::VSDContentCollector::nameToString(const VSDName &name)
+{
+  librevenge::RVNGString result;
+  if (!name.empty())
+    _convertDataToString(result, name.m_data, name.m_format);
+  return result;
+}
+
 void libvisio::VSDContentCollector::collectName(unsigned id, unsigned level, const librevenge::RVNGBinaryData &name, TextFormat format)
 {
   _handleLevelChange(level);
@@ -3597,6 +3629,8 @@ void libvisio::VSDContentCollector::startPage(unsigned pageId)
   m_currentPage = libvisio::VSDPage();
   m_currentPage.m_currentPageID = pageId;
   m_isPageStarted = true;
+  if (m_parseControl)
+    m_parseControl->startPage();
 }
 
 void libvisio::VSDContentCollector::endPage()
@@ -3620,7 +3654,15 @@ void libvisio::VSDContentCollector::endPage()
 
 void libvisio::VSDContentCollector::endPages()
 {
-  m_pages.draw(m_painter);
+  if (m_parseControl)
+    m_parseControl->setPeakBuffers(m_pages.getPeakPages(), m_pages.getPeakElements());
+  if (m_pagesOutput)
+    m_pagesOutput->swap(m_pages);
+  else
+  {
+    VSDParseTimer timer(m_parseControl, &VisioParseStats::drawSeconds);
+    m_pages.draw(m_painter);
+  }
 }
 
 bool libvisio::VSDContentCollector::parseFormatId(const char *formatString, unsigned short &result)
@@ -3708,52 +3750,53 @@ void libvisio::VSDContentCollector::appendCharacters(librevenge::RVNGString &tex
   else
   {
     UErrorCode status = U_ZERO_ERROR;
-    UConverter *conv = nullptr;
+    const char *charset = nullptr;
     switch (format)
     {
     case VSD_TEXT_JAPANESE:
-      conv = ucnv_open("windows-932", &status);
+      charset = "windows-932";
       break;
     case VSD_TEXT_KOREAN:
-      conv = ucnv_open("windows-949", &status);
+      charset = "windows-949";
       break;
     case VSD_TEXT_CHINESE_SIMPLIFIED:
-      conv = ucnv_open("windows-936", &status);
+      charset = "windows-936";
       break;
     case VSD_TEXT_CHINESE_TRADITIONAL:
-      conv = ucnv_open("windows-950", &status);
+      charset = "windows-950";
       break;
     case VSD_TEXT_GREEK:
-      conv = ucnv_open("windows-1253", &status);
+      charset = "windows-1253";
       break;
     case VSD_TEXT_TURKISH:
-      conv = ucnv_open("windows-1254", &status);
+      charset = "windows-1254";
       break;
     case VSD_TEXT_VIETNAMESE:
-      conv = ucnv_open("windows-1258", &status);
+      charset = "windows-1258";
       break;
     case VSD_TEXT_HEBREW:
-      conv = ucnv_open("windows-1255", &status);
+      charset = "windows-1255";
       break;
     case VSD_TEXT_ARABIC:
-      conv = ucnv_open("windows-1256", &status);
+      charset = "windows-1256";
       break;
     case VSD_TEXT_BALTIC:
-      conv = ucnv_open("windows-1257", &status);
+      charset = "windows-1257";
       break;
     case VSD_TEXT_RUSSIAN:
-      conv = ucnv_open("windows-1251", &status);
+      charset = "windows-1251";
       break;
     case VSD_TEXT_THAI:
-      conv = ucnv_open("windows-874", &status);
+      charset = "windows-874";
       break;
     case VSD_TEXT_CENTRAL_EUROPE:
-      conv = ucnv_open("windows-1250", &status);
+      charset = "windows-1250";
       break;
     default:
-      conv = ucnv_open("windows-1252", &status);
+      charset = "windows-1252";
       break;
     }
+    UConverter *const conv = getThreadConverter(charset);
     if (U_SUCCESS(status) && conv)
     {
       const auto *src = (const char *)&characters[0];
@@ -3770,17 +3813,15 @@ void libvisio::VSDContentCollector::appendCharacters(librevenge::RVNGString &tex
         }
       }
     }
-    if (conv)
-      ucnv_close(conv);
   }
 }
 
 void libvisio::VSDContentCollector::appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters)
 {
   UErrorCode status = U_ZERO_ERROR;
-  UConverter *conv = ucnv_open("UTF-16LE", &status);
+  UConverter *const conv = getThreadConverter("UTF-16LE");
 
-  if (U_SUCCESS(status) && conv)
+  if (conv)
   {
     const auto *src = (const char *)&characters[0];
     const char *srcLimit = (const char *)src + characters.size();
@@ -3791,8 +3832,6 @@ void libvisio::VSDContentCollector::appendCharacters(librevenge::RVNGString &tex
         appendUCS4(text, ucs4Character);
     }
   }
-  if (conv)
-    ucnv_close(conv);
 }
 
 void libvisio::VSDContentCollector::_appendField(librevenge::RVNGString &text)
@@ -176,6 +176,31 @@ public:
   void endPage() override;
   void endPages() override;
 
+  // Keep the pages in pages at the end, instead of drawing them
+  void setPagesOutput(VSDPages *pages)
+  {
+    m_pagesOutput = pages;
+  }
+
+  // Draw each page as soon as it is complete, instead of all pages in endPages
+  void setProgressive(bool progressive)
+  {
+    m_pages.setPainter(progressive ? m_painter : nullptr);
+  }
+
+  // Lets long computations stop when the parse is interrupted
+  void setParseControl(VSDParseControl *control)
+  {
+    m_parseControl = control;
+  }
+
+  // The UTF-8 text of a name, as it appears in the output
+  static librevenge::RVNGString nameToString(const VSDName &name);
+
+protected:
+  void _handleLevelChange(unsigned level);
+
+  virtual void _handleForeignData(const librevenge::RVNGBinaryData &data);
 
 private:
   VSDContentCollector(const VSDContentCollector &);
@@ -196,10 +221,6 @@ private:
   void _flushCurrentForeignData();
   void _flushCurrentPage();
 
-  void _handleLevelChange(unsigned level);
-
-  void _handleForeignData(const librevenge::RVNGBinaryData &data);
-
   void _lineProperties(const VSDLineStyle &style, librevenge::RVNGPropertyList &styleProps);
   void _fillAndShadowProperties(const VSDFillStyle &style, librevenge::RVNGPropertyList &styleProps);
 
@@ -208,9 +229,9 @@ private:
   const char *_linePropertiesMarkerPath(unsigned marker);
   double _linePropertiesMarkerScale(unsigned marker);
 
-  void appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters, TextFormat format);
-  void appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters);
-  void _convertDataToString(librevenge::RVNGString &result, const librevenge::RVNGBinaryData &data, TextFormat format);
+  static void appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters, TextFormat format);
+  static void appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters);
+  static void _convertDataToString(librevenge::RVNGString &result, const librevenge::RVNGBinaryData &data, TextFormat format);
   bool parseFormatId(const char *formatString, unsigned short &result);
   void _appendField(librevenge::RVNGString &text);
 
@@ -305,6 +326,8 @@ private:
   unsigned m_currentPageID;
   VSDPage m_currentPage;
   VSDPages m_pages;
+  VSDParseControl *m_parseControl;
+  VSDPages *m_pagesOutput;
 
   VSDLayerList m_layerList;
 
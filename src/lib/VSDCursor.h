@@ -0,0 +1,183 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDCURSOR_H__
+#define __VSDCURSOR_H__
+
+#include <cstring>
+#include <boost/cstdint.hpp>
+#include <librevenge-stream/librevenge-stream.h>
+
+namespace libvisio
+{
+
+/* Non-virtual reader over a contiguous stream in memory, used by the
+ * chunk readers of the binary parsers. It keeps the seek, tell and read
+ * semantics of VSDInternalStream. A fixed-size read that runs past the
+ * end returns 0 and marks the cursor as truncated instead of throwing
+ * EndOfStreamException.
+ */
+class VSDCursor
+{
+public:
+  VSDCursor(const unsigned char *data, unsigned long size)
+    : m_data(data), m_size(size), m_offset(0), m_truncated(false) {}
+
+  const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead)
+  {
+    numBytesRead = 0;
+    if (numBytes == 0 || isEnd())
+      return nullptr;
+    numBytesRead = numBytes < m_size - m_offset ? numBytes : m_size - m_offset;
+    const unsigned char *const p = m_data + m_offset;
+    m_offset += numBytesRead;
+    return p;
+  }
+  int seek(long offset, librevenge::RVNG_SEEK_TYPE seekType)
+  {
+    long newOffset = offset;
+    if (seekType == librevenge::RVNG_SEEK_CUR)
+      newOffset += long(m_offset);
+    else if (seekType == librevenge::RVNG_SEEK_END)
+      newOffset += long(m_size);
+
+    if (newOffset < 0)
+    {
+      m_offset = 0;
+      return 1;
+    }
+    if (newOffset > long(m_size))
+    {
+      m_offset = m_size;
+      return 1;
+    }
+    m_offset = (unsigned long)newOffset;
+    return 0;
+  }
+  long tell() const
+  {
+    return long(m_offset);
+  }
+  bool isEnd() const
+  {
+    return m_offset >= m_size;
+  }
+  unsigned long getSize() const
+  {
+    return m_size;
+  }
+  unsigned long getRemainingLength() const
+  {
+    return m_size - m_offset;
+  }
+  // Whether a fixed-size read ran past the end since the cursor was created
+  bool isTruncated() const
+  {
+    return m_truncated;
+  }
+
+  uint8_t readU8()
+  {
+    const unsigned char *const p = _take(1);
+    return p ? p[0] : 0;
+  }
+  uint16_t readU16()
+  {
+    const unsigned char *const p = _take(2);
+    return p ? uint16_t(p[0] | (p[1] << 8)) : 0;
+  }
+  uint32_t readU32()
+  {
+    const unsigned char *const p = _take(4);
+    return p ? uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24) : 0;
+  }
+  uint64_t readU64()
+  {
+    const unsigned char *const p = _take(8);
+    if (!p)
+      return 0;
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i)
+      value = (value << 8) | p[i];
+    return value;
+  }
+  double readDouble()
+  {
+    const uint64_t u = readU64();
+    double d;
+    std::memcpy(&d, &u, sizeof(d));
+    return d;
+  }
+
+private:
+  const unsigned char *_take(unsigned long numBytes)
+  {
+    if (m_offset >= m_size || m_size - m_offset < numBytes)
+    {
+      m_offset = m_size;
+      m_truncated = true;
+      return nullptr;
+    }
+    const unsigned char *const p = m_data + m_offset;
+    m_offset += numBytes;
+    return p;
+  }
+
+  const unsigned char *m_data;
+  unsigned long m_size;
+  unsigned long m_offset;
+  bool m_truncated;
+};
+
+// Overloads of the stream readers from libvisio_utils.h, so the chunk readers decode the same way from a cursor
+
+inline uint8_t readU8(VSDCursor *input)
+{
+  return input->readU8();
+}
+
+inline uint16_t readU16(VSDCursor *input)
+{
+  return input->readU16();
+}
+
+inline int16_t readS16(VSDCursor *input)
+{
+  return (int16_t)input->readU16();
+}
+
+inline uint32_t readU32(VSDCursor *input)
+{
+  return input->readU32();
+}
+
+inline int32_t readS32(VSDCursor *input)
+{
+  return (int32_t)input->readU32();
+}
+
+inline uint64_t readU64(VSDCursor *input)
+{
+  return input->readU64();
+}
+
+inline double readDouble(VSDCursor *input)
+{
+  return input->readDouble();
+}
+
+inline unsigned long getRemainingLength(VSDCursor *input)
+{
+  return input->getRemainingLength();
+}
+
+} // namespace libvisio
+
+#endif // __VSDCURSOR_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,664 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDDeferredCollector.h"
+
+#include <string.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "VSDLayerList.h"
+
+namespace
+{
+
+using libvisio::VSDCollector;
+using libvisio::Colour;
+using libvisio::NURBSData;
+using libvisio::PolylineData;
+
+typedef std::vector<unsigned char> Tape;
+typedef std::vector<std::shared_ptr<const void> > TapeObjects;
+
+class TapeReader
+{
+public:
+  TapeReader(const Tape &tape, const TapeObjects &objects)
+    : m_pos(tape.data()), m_end(tape.data() + tape.size()), m_objects(objects)
+  {
+  }
+
+  bool isEnd() const
+  {
+    return m_pos == m_end;
+  }
+
+  template<typename T>
+  T readBytes()
+  {
+    T value;
+    memcpy(&value, m_pos, sizeof(T));
+    m_pos += sizeof(T);
+    return value;
+  }
+
+  const unsigned char *readBlock(std::size_t size)
+  {
+    const unsigned char *const block = m_pos;
+    m_pos += size;
+    return block;
+  }
+
+  const void *getObject(std::size_t index) const
+  {
+    return m_objects[index].get();
+  }
+
+private:
+  TapeReader(const TapeReader &);
+  TapeReader &operator=(const TapeReader &);
+
+  const unsigned char *m_pos;
+  const unsigned char *const m_end;
+  const TapeObjects &m_objects;
+};
+
+template<typename T>
+void writeBytes(Tape &tape, const T &value)
+{
+  const std::size_t pos = tape.size();
+  tape.resize(pos + sizeof(T));
+  memcpy(&tape[pos], &value, sizeof(T));
+}
+
+/* How a value of type T is written to the tape and read back. Plain
+ * values are copied as bytes, containers and names member by member,
+ * and anything else is kept aside as an object whose index is written.
+ */
+template<typename T>
+struct PlainValue
+{
+  typedef T ReadType;
+
+  static void write(Tape &tape, TapeObjects &, const T &value)
+  {
+    writeBytes(tape, value);
+  }
+
+  static T read(TapeReader &reader)
+  {
+    return reader.readBytes<T>();
+  }
+};
+
+template<typename T>
+struct ObjectValue
+{
+  typedef const T &ReadType;
+
+  static void write(Tape &tape, TapeObjects &objects, const T &value)
+  {
+    writeBytes(tape, objects.size());
+    objects.push_back(std::make_shared<T>(value));
+  }
+
+  static const T &read(TapeReader &reader)
+  {
+    return *static_cast<const T *>(reader.getObject(reader.readBytes<std::size_t>()));
+  }
+};
+
+template<typename T>
+struct TapeValue : std::conditional<std::is_trivially_copyable<T>::value, PlainValue<T>, ObjectValue<T> >::type
+{
+};
+
+template<typename T>
+struct TapeValue<boost::optional<T> >
+{
+  typedef boost::optional<T> ReadType;
+
+  static void write(Tape &tape, TapeObjects &objects, const boost::optional<T> &value)
+  {
+    writeBytes(tape, bool(value));
+    if (value)
+      TapeValue<T>::write(tape, objects, value.get());
+  }
+
+  static boost::optional<T> read(TapeReader &reader)
+  {
+    if (!reader.readBytes<bool>())
+      return boost::optional<T>();
+    return boost::optional<T>(TapeValue<T>::read(reader));
+  }
+};
+
+template<typename T1, typename T2>
+struct TapeValue<std::pair<T1, T2> >
+{
+  typedef std::pair<T1, T2> ReadType;
+
+  static void write(Tape &tape, TapeObjects &objects, const std::pair<T1, T2> &value)
+  {
+    TapeValue<T1>::write(tape, objects, value.first);
+    TapeValue<T2>::write(tape, objects, value.second);
+  }
+
+  static std::pair<T1, T2> read(TapeReader &reader)
+  {
+    const T1 first = TapeValue<T1>::read(reader);
+    return std::pair<T1, T2>(first, TapeValue<T2>::read(reader));
+  }
+};
+
+template<typename T>
+struct TapeValue<std::vector<T> >
+{
+  typedef std::vector<T> ReadType;
+
+  static void write(Tape &tape, TapeObjects &objects, const std::vector<T> &value)
+  {
+    writeBytes(tape, value.size());
+    for (const auto &element : value)
+      TapeValue<T>::write(tape, objects, element);
+  }
+
+  static std::vector<T> read(TapeReader &reader)
+  {
+    std::vector<T> value(reader.readBytes<std::size_t>());
+    for (auto &element : value)
+      element = TapeValue<T>::read(reader);
+    return value;
+  }
+};
+
+template<>
+struct TapeValue<librevenge::RVNGBinaryData>
+{
+  typedef librevenge::RVNGBinaryData ReadType;
+
+  static void write(Tape &tape, TapeObjects &, const librevenge::RVNGBinaryData &value)
+  {
+    const std::size_t size = value.size();
+    writeBytes(tape, size);
+    if (size)
+      tape.insert(tape.end(), value.getDataBuffer(), value.getDataBuffer() + size);
+  }
+
+  static librevenge::RVNGBinaryData read(TapeReader &reader)
+  {
+    const std::size_t size = reader.readBytes<std::size_t>();
+    if (!size)
+      return librevenge::RVNGBinaryData();
+    return librevenge::RVNGBinaryData(reader.readBlock(size), (unsigned long)size);
+  }
+};
+
+template<>
+struct TapeValue<libvisio::VSDName>
+{
+  typedef libvisio::VSDName ReadType;
+
+  static void write(Tape &tape, TapeObjects &objects, const libvisio::VSDName &value)
+  {
+    TapeValue<librevenge::RVNGBinaryData>::write(tape, objects, value.m_data);
+    writeBytes(tape, value.m_format);
+  }
+
+  static libvisio::VSDName read(TapeReader &reader)
+  {
+    const librevenge::RVNGBinaryData data = TapeValue<librevenge::RVNGBinaryData>::read(reader);
+    return libvisio::VSDName(data, reader.readBytes<libvisio::TextFormat>());
+  }
+};
+
+template<typename... Values, typename... Args>
+void writeValues(Tape &tape, TapeObjects &objects, const Args &... args)
+{
+  // The elements of a braced list are evaluated in order
+  const int order[] = { 0, (TapeValue<Values>::write(tape, objects, args), 0)... };
+  (void)order;
+}
+
+template<unsigned... I>
+struct Indices
+{
+};
+
+template<unsigned N, unsigned... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...>
+{
+};
+
+template<unsigned... I>
+struct MakeIndices<0, I...>
+{
+  typedef Indices<I...> Type;
+};
+
+typedef void (*Replay)(VSDCollector &, TapeReader &);
+
+// Replays a call of a collector method with parameters Params
+template<typename... Params>
+struct Call
+{
+  typedef void (VSDCollector::*Method)(Params...);
+  typedef std::tuple<typename TapeValue<typename std::decay<Params>::type>::ReadType...> Arguments;
+
+  static void replay(VSDCollector &collector, TapeReader &reader)
+  {
+    const Method method = reader.readBytes<Method>();
+    // The elements of a braced list are evaluated in order
+    Arguments arguments{TapeValue<typename std::decay<Params>::type>::read(reader)...};
+    invoke(collector, method, arguments, typename MakeIndices<sizeof...(Params)>::Type());
+  }
+
+  template<unsigned... I>
+  static void invoke(VSDCollector &collector, Method method, Arguments &arguments, Indices<I...>)
+  {
+    (collector.*method)(std::get<I>(std::move(arguments))...);
+  }
+};
+
+// The collector methods that are overloaded, so that _defer can tell them apart
+typedef void (VSDCollector::*CollectFillAndShadowWithQuickStyle)(unsigned, const boost::optional<Colour> &, const boost::optional<Colour> &, const boost::optional<unsigned char> &, const boost::optional<double> &, const boost::optional<double> &, const boost::optional<unsigned char> &, const boost::optional<Colour> &, const boost::optional<double> &, const boost::optional<double> &, const boost::optional<long> &, const boost::optional<long> &, const boost::optional<long> &);
+typedef void (VSDCollector::*CollectFillAndShadow)(unsigned, const boost::optional<Colour> &, const boost::optional<Colour> &, const boost::optional<unsigned char> &, const boost::optional<double> &, const boost::optional<double> &, const boost::optional<unsigned char> &, const boost::optional<Colour> &);
+typedef void (VSDCollector::*CollectNURBSToWithPoints)(unsigned, unsigned, double, double, unsigned char, unsigned char, unsigned, const std::vector<std::pair<double, double> > &, const std::vector<double> &, const std::vector<double> &);
+typedef void (VSDCollector::*CollectNURBSToWithDataId)(unsigned, unsigned, double, double, double, double, double, double, unsigned);
+typedef void (VSDCollector::*CollectNURBSToWithData)(unsigned, unsigned, double, double, double, double, double, double, const NURBSData &);
+typedef void (VSDCollector::*CollectPolylineToWithPoints)(unsigned, unsigned, double, double, unsigned char, unsigned char, const std::vector<std::pair<double, double> > &);
+typedef void (VSDCollector::*CollectPolylineToWithDataId)(unsigned, unsigned, double, double, unsigned);
+typedef void (VSDCollector::*CollectPolylineToWithData)(unsigned, unsigned, double, double, const PolylineData &);
+typedef void (VSDCollector::*CollectNURBSShapeData)(unsigned, unsigned, unsigned char, unsigned char, unsigned, double, std::vector<std::pair<double, double> >, std::vector<double>, std::vector<double>);
+typedef void (VSDCollector::*CollectPolylineShapeData)(unsigned, unsigned, unsigned char, unsigned char, std::vector<std::pair<double, double> >);
+typedef void (VSDCollector::*CollectFillStyleWithQuickStyle)(unsigned, const boost::optional<Colour> &, const boost::optional<Colour> &, const boost::optional<unsigned char> &, const boost::optional<double> &, const boost::optional<double> &, const boost::optional<unsigned char> &, const boost::optional<Colour> &, const boost::optional<double> &, const boost::optional<double> &, const boost::optional<long> &, const boost::optional<long> &, const boost::optional<long> &);
+typedef void (VSDCollector::*CollectFillStyle)(unsigned, const boost::optional<Colour> &, const boost::optional<Colour> &, const boost::optional<unsigned char> &, const boost::optional<double> &, const boost::optional<double> &, const boost::optional<unsigned char> &, const boost::optional<Colour> &);
+
+} // anonymous namespace
+
+libvisio::VSDDeferredCollector::VSDDeferredCollector(VSDCollector &collector, const std::function<VSDCollector &()> &getTarget)
+  : m_collector(&collector), m_getTarget(getTarget), m_tape(), m_objects(), m_mark(0), m_objectMark(0)
+{
+}
+
+libvisio::VSDDeferredCollector::VSDDeferredCollector(const std::function<VSDCollector &()> &getTarget)
+  : m_collector(nullptr), m_getTarget(getTarget), m_tape(), m_objects(), m_mark(0), m_objectMark(0)
+{
+}
+
+void libvisio::VSDDeferredCollector::flush()
+{
+  if (m_tape.empty())
+    return;
+  VSDCollector &target = m_getTarget();
+  Tape tape;
+  tape.swap(m_tape);
+  TapeObjects objects;
+  objects.swap(m_objects);
+  m_mark = 0;
+  m_objectMark = 0;
+  TapeReader reader(tape, objects);
+  while (!reader.isEnd())
+    reader.readBytes<Replay>()(target, reader);
+}
+
+void libvisio::VSDDeferredCollector::setMark()
+{
+  m_mark = m_tape.size();
+  m_objectMark = m_objects.size();
+}
+
+void libvisio::VSDDeferredCollector::rewindToMark()
+{
+  if (m_mark < m_tape.size())
+    m_tape.resize(m_mark);
+  if (m_objectMark < m_objects.size())
+    m_objects.resize(m_objectMark);
+}
+
+template<typename... Params, typename... Args>
+void libvisio::VSDDeferredCollector::_defer(void (VSDCollector::*method)(Params...), const Args &... args)
+{
+  if (m_collector)
+    (m_collector->*method)(args...);
+  writeBytes(m_tape, &Call<Params...>::replay);
+  writeBytes(m_tape, method);
+  writeValues<typename std::decay<Params>::type...>(m_tape, m_objects, args...);
+}
+
+void libvisio::VSDDeferredCollector::collectDocumentTheme(const VSDXTheme *theme)
+{
+  _defer(&VSDCollector::collectDocumentTheme, theme);
+}
+
+void libvisio::VSDDeferredCollector::collectEllipticalArcTo(unsigned id, unsigned level, double x3, double y3, double x2, double y2, double angle, double ecc)
+{
+  _defer(&VSDCollector::collectEllipticalArcTo, id, level, x3, y3, x2, y2, angle, ecc);
+}
+
+void libvisio::VSDDeferredCollector::collectForeignData(unsigned level, const librevenge::RVNGBinaryData &binaryData)
+{
+  _defer(&VSDCollector::collectForeignData, level, binaryData);
+}
+
+void libvisio::VSDDeferredCollector::collectOLEList(unsigned id, unsigned level)
+{
+  _defer(&VSDCollector::collectOLEList, id, level);
+}
+
+void libvisio::VSDDeferredCollector::collectOLEData(unsigned id, unsigned level, const librevenge::RVNGBinaryData &oleData)
+{
+  _defer(&VSDCollector::collectOLEData, id, level, oleData);
+}
+
+void libvisio::VSDDeferredCollector::collectEllipse(unsigned id, unsigned level, double cx, double cy, double xleft, double yleft, double xtop, double ytop)
+{
+  _defer(&VSDCollector::collectEllipse, id, level, cx, cy, xleft, yleft, xtop, ytop);
+}
+
+void libvisio::VSDDeferredCollector::collectLine(unsigned level, const boost::optional<double> &strokeWidth, const boost::optional<Colour> &c, const boost::optional<unsigned char> &linePattern, const boost::optional<unsigned char> &startMarker, const boost::optional<unsigned char> &endMarker, const boost::optional<unsigned char> &lineCap, const boost::optional<double> &rounding, const boost::optional<long> &qsLineColour, const boost::optional<long> &qsLineMatrix)
+{
+  _defer(&VSDCollector::collectLine, level, strokeWidth, c, linePattern, startMarker, endMarker, lineCap, rounding, qsLineColour, qsLineMatrix);
+}
+
+void libvisio::VSDDeferredCollector::collectFillAndShadow(unsigned level, const boost::optional<Colour> &colourFG, const boost::optional<Colour> &colourBG, const boost::optional<unsigned char> &fillPattern, const boost::optional<double> &fillFGTransparency, const boost::optional<double> &fillBGTransparency, const boost::optional<unsigned char> &shadowPattern, const boost::optional<Colour> &shfgc, const boost::optional<double> &shadowOffsetX, const boost::optional<double> &shadowOffsetY, const boost::optional<long> &qsFc, const boost::optional<long> &qsSc, const boost::optional<long> &qsLm)
+{
+  _defer(CollectFillAndShadowWithQuickStyle(&VSDCollector::collectFillAndShadow), level, colourFG, colourBG, fillPattern, fillFGTransparency, fillBGTransparency, shadowPattern, shfgc, shadowOffsetX, shadowOffsetY, qsFc, qsSc, qsLm);
+}
+
+void libvisio::VSDDeferredCollector::collectFillAndShadow(unsigned level, const boost::optional<Colour> &colourFG, const boost::optional<Colour> &colourBG, const boost::optional<unsigned char> &fillPattern, const boost::optional<double> &fillFGTransparency, const boost::optional<double> &fillBGTransparency, const boost::optional<unsigned char> &shadowPattern, const boost::optional<Colour> &shfgc)
+{
+  _defer(CollectFillAndShadow(&VSDCollector::collectFillAndShadow), level, colourFG, colourBG, fillPattern, fillFGTransparency, fillBGTransparency, shadowPattern, shfgc);
+}
+
+void libvisio::VSDDeferredCollector::collectGeometry(unsigned id, unsigned level, bool noFill, bool noLine, bool noShow)
+{
+  _defer(&VSDCollector::collectGeometry, id, level, noFill, noLine, noShow);
+}
+
+void libvisio::VSDDeferredCollector::collectMoveTo(unsigned id, unsigned level, double x, double y)
+{
+  _defer(&VSDCollector::collectMoveTo, id, level, x, y);
+}
+
+void libvisio::VSDDeferredCollector::collectLineTo(unsigned id, unsigned level, double x, double y)
+{
+  _defer(&VSDCollector::collectLineTo, id, level, x, y);
+}
+
+void libvisio::VSDDeferredCollector::collectArcTo(unsigned id, unsigned level, double x2, double y2, double bow)
+{
+  _defer(&VSDCollector::collectArcTo, id, level, x2, y2, bow);
+}
+
+void libvisio::VSDDeferredCollector::collectNURBSTo(unsigned id, unsigned level, double x2, double y2, unsigned char xType, unsigned char yType, unsigned degree, const std::vector<std::pair<double, double> > &ctrlPnts, const std::vector<double> &kntVec, const std::vector<double> &weights)
+{
+  _defer(CollectNURBSToWithPoints(&VSDCollector::collectNURBSTo), id, level, x2, y2, xType, yType, degree, ctrlPnts, kntVec, weights);
+}
+
+void libvisio::VSDDeferredCollector::collectNURBSTo(unsigned id, unsigned level, double x2, double y2, double knot, double knotPrev, double weight, double weightPrev, unsigned dataID)
+{
+  _defer(CollectNURBSToWithDataId(&VSDCollector::collectNURBSTo), id, level, x2, y2, knot, knotPrev, weight, weightPrev, dataID);
+}
+
+void libvisio::VSDDeferredCollector::collectNURBSTo(unsigned id, unsigned level, double x2, double y2, double knot, double knotPrev, double weight, double weightPrev, const NURBSData &data)
+{
+  _defer(CollectNURBSToWithData(&VSDCollector::collectNURBSTo), id, level, x2, y2, knot, knotPrev, weight, weightPrev, data);
+}
+
+void libvisio::VSDDeferredCollector::collectPolylineTo(unsigned id, unsigned level, double x, double y, unsigned char xType, unsigned char yType, const std::vector<std::pair<double, double> > &points)
+{
+  _defer(CollectPolylineToWithPoints(&VSDCollector::collectPolylineTo), id, level, x, y, xType, yType, points);
+}
+
+void libvisio::VSDDeferredCollector::collectPolylineTo(unsigned id, unsigned level, double x, double y, unsigned dataID)
+{
+  _defer(CollectPolylineToWithDataId(&VSDCollector::collectPolylineTo), id, level, x, y, dataID);
+}
+
+void libvisio::VSDDeferredCollector::collectPolylineTo(unsigned id, unsigned level, double x, double y, const PolylineData &data)
+{
+  _defer(CollectPolylineToWithData(&VSDCollector::collectPolylineTo), id, level, x, y, data);
+}
+
+void libvisio::VSDDeferredCollector::collectShapeData(unsigned id, unsigned level, unsigned char xType, unsigned char yType, unsigned degree, double lastKnot, std::vector<std::pair<double, double> > controlPoints, std::vector<double> knotVector, std::vector<double> weights)
+{
+  _defer(CollectNURBSShapeData(&VSDCollector::collectShapeData), id, level, xType, yType, degree, lastKnot, controlPoints, knotVector, weights);
+}
+
+void libvisio::VSDDeferredCollector::collectShapeData(unsigned id, unsigned level, unsigned char xType, unsigned char yType, std::vector<std::pair<double, double> > points)
+{
+  _defer(CollectPolylineShapeData(&VSDCollector::collectShapeData), id, level, xType, yType, points);
+}
+
+void libvisio::VSDDeferredCollector::collectXFormData(unsigned level, const XForm &xform)
+{
+  _defer(&VSDCollector::collectXFormData, level, xform);
+}
+
+void libvisio::VSDDeferredCollector::collectTxtXForm(unsigned level, const XForm &txtxform)
+{
+  _defer(&VSDCollector::collectTxtXForm, level, txtxform);
+}
+
+void libvisio::VSDDeferredCollector::collectShapesOrder(unsigned id, unsigned level, const std::vector<unsigned> &shapeIds)
+{
+  _defer(&VSDCollector::collectShapesOrder, id, level, shapeIds);
+}
+
+void libvisio::VSDDeferredCollector::collectForeignDataType(unsigned level, unsigned foreignType, unsigned foreignFormat, double offsetX, double offsetY, double width, double height)
+{
+  _defer(&VSDCollector::collectForeignDataType, level, foreignType, foreignFormat, offsetX, offsetY, width, height);
+}
+
+void libvisio::VSDDeferredCollector::collectPageProps(unsigned id, unsigned level, double pageWidth, double pageHeight, double shadowOffsetX, double shadowOffsetY, double scale)
+{
+  _defer(&VSDCollector::collectPageProps, id, level, pageWidth, pageHeight, shadowOffsetX, shadowOffsetY, scale);
+}
+
+void libvisio::VSDDeferredCollector::collectPage(unsigned id, unsigned level, unsigned backgroundPageID, bool isBackgroundPage, const VSDName &pageName)
+{
+  _defer(&VSDCollector::collectPage, id, level, backgroundPageID, isBackgroundPage, pageName);
+}
+
+void libvisio::VSDDeferredCollector::collectShape(unsigned id, unsigned level, unsigned parent, unsigned masterPage, unsigned masterShape, unsigned lineStyle, unsigned fillStyle, unsigned textStyle)
+{
+  _defer(&VSDCollector::collectShape, id, level, parent, masterPage, masterShape, lineStyle, fillStyle, textStyle);
+}
+
+void libvisio::VSDDeferredCollector::collectSplineStart(unsigned id, unsigned level, double x, double y, double secondKnot, double firstKnot, double lastKnot, unsigned degree)
+{
+  _defer(&VSDCollector::collectSplineStart, id, level, x, y, secondKnot, firstKnot, lastKnot, degree);
+}
+
+void libvisio::VSDDeferredCollector::collectSplineKnot(unsigned id, unsigned level, double x, double y, double knot)
+{
+  _defer(&VSDCollector::collectSplineKnot, id, level, x, y, knot);
+}
+
+void libvisio::VSDDeferredCollector::collectSplineEnd()
+{
+  _defer(&VSDCollector::collectSplineEnd);
+}
+
+void libvisio::VSDDeferredCollector::collectInfiniteLine(unsigned id, unsigned level, double x1, double y1, double x2, double y2)
+{
+  _defer(&VSDCollector::collectInfiniteLine, id, level, x1, y1, x2, y2);
+}
+
+void libvisio::VSDDeferredCollector::collectRelCubBezTo(unsigned id, unsigned level, double x, double y, double a, double b, double c, double d)
+{
+  _defer(&VSDCollector::collectRelCubBezTo, id, level, x, y, a, b, c, d);
+}
+
+void libvisio::VSDDeferredCollector::collectRelEllipticalArcTo(unsigned id, unsigned level, double x, double y, double a, double b, double c, double d)
+{
+  _defer(&VSDCollector::collectRelEllipticalArcTo, id, level, x, y, a, b, c, d);
+}
+
+void libvisio::VSDDeferredCollector::collectRelLineTo(unsigned id, unsigned level, double x, double y)
+{
+  _defer(&VSDCollector::collectRelLineTo, id, level, x, y);
+}
+
+void libvisio::VSDDeferredCollector::collectRelMoveTo(unsigned id, unsigned level, double x, double y)
+{
+  _defer(&VSDCollector::collectRelMoveTo, id, level, x, y);
+}
+
+void libvisio::VSDDeferredCollector::collectRelQuadBezTo(unsigned id, unsigned level, double x, double y, double a, double b)
+{
+  _defer(&VSDCollector::collectRelQuadBezTo, id, level, x, y, a, b);
+}
+
+void libvisio::VSDDeferredCollector::collectUnhandledChunk(unsigned id, unsigned level)
+{
+  _defer(&VSDCollector::collectUnhandledChunk, id, level);
+}
+
+void libvisio::VSDDeferredCollector::collectText(unsigned level, const librevenge::RVNGBinaryData &textStream, TextFormat format)
+{
+  _defer(&VSDCollector::collectText, level, textStream, format);
+}
+
+void libvisio::VSDDeferredCollector::collectCharIX(unsigned id, unsigned level, unsigned charCount, const boost::optional<VSDName> &font, const boost::optional<Colour> &fontColour, const boost::optional<double> &fontSize, const boost::optional<bool> &bold, const boost::optional<bool> &italic, const boost::optional<bool> &underline, const boost::optional<bool> &doubleunderline, const boost::optional<bool> &strikeout, const boost::optional<bool> &doublestrikeout, const boost::optional<bool> &allcaps, const boost::optional<bool> &initcaps, const boost::optional<bool> &smallcaps, const boost::optional<bool> &superscript, const boost::optional<bool> &subscript, const boost::optional<double> &scaleWidth)
+{
+  _defer(&VSDCollector::collectCharIX, id, level, charCount, font, fontColour, fontSize, bold, italic, underline, doubleunderline, strikeout, doublestrikeout, allcaps, initcaps, smallcaps, superscript, subscript, scaleWidth);
+}
+
+void libvisio::VSDDeferredCollector::collectDefaultCharStyle(unsigned charCount, const boost::optional<VSDName> &font, const boost::optional<Colour> &fontColour, const boost::optional<double> &fontSize, const boost::optional<bool> &bold, const boost::optional<bool> &italic, const boost::optional<bool> &underline, const boost::optional<bool> &doubleunderline, const boost::optional<bool> &strikeout, const boost::optional<bool> &doublestrikeout, const boost::optional<bool> &allcaps, const boost::optional<bool> &initcaps, const boost::optional<bool> &smallcaps, const boost::optional<bool> &superscript, const boost::optional<bool> &subscript, const boost::optional<double> &scaleWidth)
+{
+  _defer(&VSDCollector::collectDefaultCharStyle, charCount, font, fontColour, fontSize, bold, italic, underline, doubleunderline, strikeout, doublestrikeout, allcaps, initcaps, smallcaps, superscript, subscript, scaleWidth);
+}
+
+void libvisio::VSDDeferredCollector::collectParaIX(unsigned id, unsigned level, unsigned charCount, const boost::optional<double> &indFirst, const boost::optional<double> &indLeft, const boost::optional<double> &indRight, const boost::optional<double> &spLine, const boost::optional<double> &spBefore, const boost::optional<double> &spAfter, const boost::optional<unsigned char> &align, const boost::optional<unsigned char> &bullet, const boost::optional<VSDName> &bulletStr, const boost::optional<VSDName> &bulletFont, const boost::optional<double> &bulletFontSize, const boost::optional<double> &textPosAfterBullet, const boost::optional<unsigned> &flags)
+{
+  _defer(&VSDCollector::collectParaIX, id, level, charCount, indFirst, indLeft, indRight, spLine, spBefore, spAfter, align, bullet, bulletStr, bulletFont, bulletFontSize, textPosAfterBullet, flags);
+}
+
+void libvisio::VSDDeferredCollector::collectDefaultParaStyle(unsigned charCount, const boost::optional<double> &indFirst, const boost::optional<double> &indLeft, const boost::optional<double> &indRight, const boost::optional<double> &spLine, const boost::optional<double> &spBefore, const boost::optional<double> &spAfter, const boost::optional<unsigned char> &align, const boost::optional<unsigned char> &bullet, const boost::optional<VSDName> &bulletStr, const boost::optional<VSDName> &bulletFont, const boost::optional<double> &bulletFontSize, const boost::optional<double> &textPosAfterBullet, const boost::optional<unsigned> &flags)
+{
+  _defer(&VSDCollector::collectDefaultParaStyle, charCount, indFirst, indLeft, indRight, spLine, spBefore, spAfter, align, bullet, bulletStr, bulletFont, bulletFontSize, textPosAfterBullet, flags);
+}
+
+void libvisio::VSDDeferredCollector::collectTextBlock(unsigned level, const boost::optional<double> &leftMargin, const boost::optional<double> &rightMargin, const boost::optional<double> &topMargin, const boost::optional<double> &bottomMargin, const boost::optional<unsigned char> &verticalAlign, const boost::optional<bool> &isBgFilled, const boost::optional<Colour> &bgColour, const boost::optional<double> &defaultTabStop, const boost::optional<unsigned char> &textDirection)
+{
+  _defer(&VSDCollector::collectTextBlock, level, leftMargin, rightMargin, topMargin, bottomMargin, verticalAlign, isBgFilled, bgColour, defaultTabStop, textDirection);
+}
+
+void libvisio::VSDDeferredCollector::collectNameList(unsigned id, unsigned level)
+{
+  _defer(&VSDCollector::collectNameList, id, level);
+}
+
+void libvisio::VSDDeferredCollector::collectName(unsigned id, unsigned level, const librevenge::RVNGBinaryData &name, TextFormat format)
+{
+  _defer(&VSDCollector::collectName, id, level, name, format);
+}
+
+void libvisio::VSDDeferredCollector::collectPageSheet(unsigned id, unsigned level)
+{
+  _defer(&VSDCollector::collectPageSheet, id, level);
+}
+
+void libvisio::VSDDeferredCollector::collectMisc(unsigned level, const VSDMisc &misc)
+{
+  _defer(&VSDCollector::collectMisc, level, misc);
+}
+
+void libvisio::VSDDeferredCollector::collectLayer(unsigned id, unsigned level, const VSDLayer &layer)
+{
+  _defer(&VSDCollector::collectLayer, id, level, layer);
+}
+
+void libvisio::VSDDeferredCollector::collectLayerMem(unsigned level, const VSDName &layerMem)
+{
+  _defer(&VSDCollector::collectLayerMem, level, layerMem);
+}
+
+void libvisio::VSDDeferredCollector::collectTabsDataList(unsigned level, const std::map<unsigned, VSDTabSet> &tabSets)
+{
+  _defer(&VSDCollector::collectTabsDataList, level, tabSets);
+}
+
+void libvisio::VSDDeferredCollector::collectStyleSheet(unsigned id, unsigned level,unsigned parentLineStyle, unsigned parentFillStyle, unsigned parentTextStyle)
+{
+  _defer(&VSDCollector::collectStyleSheet, id, level, parentLineStyle, parentFillStyle, parentTextStyle);
+}
+
+void libvisio::VSDDeferredCollector::collectLineStyle(unsigned level, const boost::optional<double> &strokeWidth, const boost::optional<Colour> &c, const boost::optional<unsigned char> &linePattern, const boost::optional<unsigned char> &startMarker, const boost::optional<unsigned char> &endMarker, const boost::optional<unsigned char> &lineCap, const boost::optional<double> &rounding, const boost::optional<long> &qsLineColour, const boost::optional<long> &qsLineMatrix)
+{
+  _defer(&VSDCollector::collectLineStyle, level, strokeWidth, c, linePattern, startMarker, endMarker, lineCap, rounding, qsLineColour, qsLineMatrix);
+}
+
+void libvisio::VSDDeferredCollector::collectFillStyle(unsigned level, const boost::optional<Colour> &colourFG, const boost::optional<Colour> &colourBG, const boost::optional<unsigned char> &fillPattern, const boost::optional<double> &fillFGTransparency, const boost::optional<double> &fillBGTransparency, const boost::optional<unsigned char> &shadowPattern, const boost::optional<Colour> &shfgc, const boost::optional<double> &shadowOffsetX, const boost::optional<double> &shadowOffsetY, const boost::optional<long> &qsFillColour, const boost::optional<long> &qsShadowColour, const boost::optional<long> &qsFillMatrix)
+{
+  _defer(CollectFillStyleWithQuickStyle(&VSDCollector::collectFillStyle), level, colourFG, colourBG, fillPattern, fillFGTransparency, fillBGTransparency, shadowPattern, shfgc, shadowOffsetX, shadowOffsetY, qsFillColour, qsShadowColour, qsFillMatrix);
+}
+
+void libvisio::VSDDeferredCollector::collectFillStyle(unsigned level, const boost::optional<Colour> &colourFG, const boost::optional<Colour> &colourBG, const boost::optional<unsigned char> &fillPattern, const boost::optional<double> &fillFGTransparency, const boost::optional<double> &fillBGTransparency, const boost::optional<unsigned char> &shadowPattern, const boost::optional<Colour> &shfgc)
+{
+  _defer(CollectFillStyle(&VSDCollector::collectFillStyle), level, colourFG, colourBG, fillPattern, fillFGTransparency, fillBGTransparency, shadowPattern, shfgc);
+}
+
+void libvisio::VSDDeferredCollector::collectCharIXStyle(unsigned id, unsigned level, unsigned charCount, const boost::optional<VSDName> &font, const boost::optional<Colour> &fontColour, const boost::optional<double> &fontSize, const boost::optional<bool> &bold, const boost::optional<bool> &italic, const boost::optional<bool> &underline, const boost::optional<bool> &doubleunderline, const boost::optional<bool> &strikeout, const boost::optional<bool> &doublestrikeout, const boost::optional<bool> &allcaps, const boost::optional<bool> &initcaps, const boost::optional<bool> &smallcaps, const boost::optional<bool> &superscript, const boost::optional<bool> &subscript, const boost::optional<double> &scaleWidth)
+{
+  _defer(&VSDCollector::collectCharIXStyle, id, level, charCount, font, fontColour, fontSize, bold, italic, underline, doubleunderline, strikeout, doublestrikeout, allcaps, initcaps, smallcaps, superscript, subscript, scaleWidth);
+}
+
+void libvisio::VSDDeferredCollector::collectParaIXStyle(unsigned id, unsigned level, unsigned charCount, const boost::optional<double> &indFirst, const boost::optional<double> &indLeft, const boost::optional<double> &indRight, const boost::optional<double> &spLine, const boost::optional<double> &spBefore, const boost::optional<double> &spAfter, const boost::optional<unsigned char> &align, const boost::optional<unsigned char> &bullet, const boost::optional<VSDName> &bulletStr, const boost::optional<VSDName> &bulletFont, const boost::optional<double> &bulletFontSize, const boost::optional<double> &textPosAfterBullet, const boost::optional<unsigned> &flags)
+{
+  _defer(&VSDCollector::collectParaIXStyle, id, level, charCount, indFirst, indLeft, indRight, spLine, spBefore, spAfter, align, bullet, bulletStr, bulletFont, bulletFontSize, textPosAfterBullet, flags);
+}
+
+void libvisio::VSDDeferredCollector::collectTextBlockStyle(unsigned level, const boost::optional<double> &leftMargin, const boost::optional<double> &rightMargin, const boost::optional<double> &topMargin, const boost::optional<double> &bottomMargin, const boost::optional<unsigned char> &verticalAlign, const boost::optional<bool> &isBgFilled, const boost::optional<Colour> &bgColour, const boost::optional<double> &defaultTabStop, const boost::optional<unsigned char> &textDirection)
+{
+  _defer(&VSDCollector::collectTextBlockStyle, level, leftMargin, rightMargin, topMargin, bottomMargin, verticalAlign, isBgFilled, bgColour, defaultTabStop, textDirection);
+}
+
+void libvisio::VSDDeferredCollector::collectFieldList(unsigned id, unsigned level)
+{
+  _defer(&VSDCollector::collectFieldList, id, level);
+}
+
+void libvisio::VSDDeferredCollector::collectTextField(unsigned id, unsigned level, int nameId, int formatStringId)
+{
+  _defer(&VSDCollector::collectTextField, id, level, nameId, formatStringId);
+}
+
+void libvisio::VSDDeferredCollector::collectNumericField(unsigned id, unsigned level, unsigned short format, unsigned short cellType, double number, int formatStringId)
+{
+  _defer(&VSDCollector::collectNumericField, id, level, format, cellType, number, formatStringId);
+}
+
+void libvisio::VSDDeferredCollector::collectMetaData(const librevenge::RVNGPropertyList &metaData)
+{
+  _defer(&VSDCollector::collectMetaData, metaData);
+}
+
+void libvisio::VSDDeferredCollector::startPage(unsigned pageId)
+{
+  _defer(&VSDCollector::startPage, pageId);
+}
+
+void libvisio::VSDDeferredCollector::endPage()
+{
+  _defer(&VSDCollector::endPage);
+  if (m_collector)
+    flush();
+}
+
+void libvisio::VSDDeferredCollector::endPages()
+{
+  _defer(&VSDCollector::endPages);
+  if (m_collector)
+    flush();
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -59,10 +59,10 @@ librevenge::RVNGString libvisio::VSDNumericField::datetimeToString(const char *f
   librevenge::RVNGString result;
   char buffer[MAX_BUFFER];
   auto timer = (time_t)(86400 * datetime - 2209161600.0);
-  const struct tm *const time = gmtime(&timer);
-  if (time)
+  struct tm time;
+  if (getUTCTime(timer, time))
   {
-    strftime(&buffer[0], MAX_BUFFER-1, format, time);
+    strftime(&buffer[0], MAX_BUFFER-1, format, &time);
     result.append(&buffer[0]);
   }
   return result;
@@ -0,0 +1,80 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDFormatTraits.h"
+
+#include "libvisio_utils.h"
+#include "VSDDocumentStructure.h"
+
+void libvisio::VSD11Traits::readPointer(librevenge::RVNGInputStream *input, Pointer &ptr)
+{
+  ptr.Type = readU32(input);
+  input->seek(4, librevenge::RVNG_SEEK_CUR); // Skip dword
+  ptr.Offset = readU32(input);
+  ptr.Length = readU32(input);
+  ptr.Format = readU16(input);
+}
+
+void libvisio::VSD11Traits::readPointerInfo(librevenge::RVNGInputStream *input, unsigned /* ptrType */, unsigned shift, unsigned &listSize, int &pointerCount)
+{
+  VSD_DEBUG_MSG(("VSD11Traits::readPointerInfo\n"));
+  input->seek(shift, librevenge::RVNG_SEEK_SET);
+  unsigned offset = readU32(input);
+  input->seek(offset+shift-4, librevenge::RVNG_SEEK_SET);
+  listSize = readU32(input);
+  pointerCount = readS32(input);
+  input->seek(4, librevenge::RVNG_SEEK_CUR);
+}
+
+void libvisio::VSD5Traits::readPointer(librevenge::RVNGInputStream *input, Pointer &ptr)
+{
+  ptr.Type = readU16(input) & 0x00ff;
+  ptr.Format = readU16(input) & 0x00ff;
+  input->seek(4, librevenge::RVNG_SEEK_CUR); // Skip dword
+  ptr.Offset = readU32(input);
+  ptr.Length = readU32(input);
+}
+
+void libvisio::VSD5Traits::readPointerInfo(librevenge::RVNGInputStream *input, unsigned ptrType, unsigned shift, unsigned &listSize, int &pointerCount)
+{
+  VSD_DEBUG_MSG(("VSD5Traits::readPointerInfo\n"));
+  switch (ptrType)
+  {
+  case VSD_TRAILER_STREAM:
+    input->seek(shift+0x82, librevenge::RVNG_SEEK_SET);
+    break;
+  case VSD_PAGE:
+    input->seek(shift+0x42, librevenge::RVNG_SEEK_SET);
+    break;
+  case VSD_FONT_LIST:
+    input->seek(shift+0x2e, librevenge::RVNG_SEEK_SET);
+    break;
+  case VSD_STYLES:
+    input->seek(shift+0x12, librevenge::RVNG_SEEK_SET);
+    break;
+  case VSD_STENCILS:
+  case VSD_SHAPE_FOREIGN:
+    input->seek(shift+0x1e, librevenge::RVNG_SEEK_SET);
+    break;
+  case VSD_STENCIL_PAGE:
+    input->seek(shift+0x36, librevenge::RVNG_SEEK_SET);
+    break;
+  default:
+    if (ptrType > 0x45)
+      input->seek(shift+0x1e, librevenge::RVNG_SEEK_SET);
+    else
+      input->seek(shift+0xa, librevenge::RVNG_SEEK_SET);
+    break;
+  }
+  pointerCount = readS16(input);
+  listSize = 0;
+  VSD_DEBUG_MSG(("VSD5Traits::readPointerInfo ptrType %u shift %u pointerCount %i\n", ptrType, shift, pointerCount));
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,182 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDFORMATTRAITS_H__
+#define __VSDFORMATTRAITS_H__
+
+#include <librevenge-stream/librevenge-stream.h>
+#include "VSDCursor.h"
+#include "VSDTypes.h"
+
+namespace libvisio
+{
+
+/* Decoding of the structures that differ between the versions of the
+ * binary format. The chunk and pointer loops of VSDParser are templates
+ * instantiated with one of these, so the per-chunk and per-pointer
+ * decoding is resolved at compile time instead of by virtual calls.
+ */
+
+// Visio 2003 (version 11)
+struct VSD11Traits
+{
+  static unsigned getUInt(VSDCursor *input)
+  {
+    return readU32(input);
+  }
+  static int getInt(VSDCursor *input)
+  {
+    return readS32(input);
+  }
+  static inline bool getChunkHeader(VSDCursor *input, ChunkHeader &header);
+  static void readPointer(librevenge::RVNGInputStream *input, Pointer &ptr);
+  static void readPointerInfo(librevenge::RVNGInputStream *input, unsigned ptrType, unsigned shift, unsigned &listSize, int &pointerCount);
+};
+
+// Visio 2000 (version 6) only differs in the chunk header
+struct VSD6Traits : public VSD11Traits
+{
+  static inline bool getChunkHeader(VSDCursor *input, ChunkHeader &header);
+};
+
+// Visio 5
+struct VSD5Traits
+{
+  static unsigned getUInt(VSDCursor *input)
+  {
+    int value = readS16(input);
+    return (unsigned)value;
+  }
+  static int getInt(VSDCursor *input)
+  {
+    return readS16(input);
+  }
+  static inline bool getChunkHeader(VSDCursor *input, ChunkHeader &header);
+  static void readPointer(librevenge::RVNGInputStream *input, Pointer &ptr);
+  static void readPointerInfo(librevenge::RVNGInputStream *input, unsigned ptrType, unsigned shift, unsigned &listSize, int &pointerCount);
+};
+
+// Skips the padding in front of a chunk; returns false at the end of the stream
+inline bool skipChunkPadding(VSDCursor *input)
+{
+  unsigned char tmpChar = 0;
+  while (!input->isEnd() && !tmpChar)
+    tmpChar = readU8(input);
+
+  if (input->isEnd())
+    return false;
+  input->seek(-1, librevenge::RVNG_SEEK_CUR);
+  return true;
+}
+
+bool VSD11Traits::getChunkHeader(VSDCursor *input, ChunkHeader &header)
+{
+  if (!skipChunkPadding(input))
+    return false;
+
+  header.chunkType = readU32(input);
+  header.id = readU32(input);
+  header.list = readU32(input);
+
+  // Certain chunk types seem to always have a trailer
+  header.trailer = 0;
+  if (header.list != 0 || header.chunkType == 0x71 || header.chunkType == 0x70 ||
+      header.chunkType == 0x6b || header.chunkType == 0x6a || header.chunkType == 0x69 ||
+      header.chunkType == 0x66 || header.chunkType == 0x65 || header.chunkType == 0x2c)
+    header.trailer += 8; // 8 byte trailer
+
+  header.dataLength = readU32(input);
+  header.level = readU16(input);
+  header.unknown = readU8(input);
+
+  unsigned trailerChunks [14] = {0x64, 0x65, 0x66, 0x69, 0x6a, 0x6b, 0x6f, 0x71,
+                                 0x92, 0xa9, 0xb4, 0xb6, 0xb9, 0xc7
+                                };
+  // Add word separator under certain circumstances for v11
+  // Below are known conditions, may be more or a simpler pattern
+  if (header.list != 0 || (header.level == 2 && header.unknown == 0x55) ||
+      (header.level == 2 && header.unknown == 0x54 && header.chunkType == 0xaa)
+      || (header.level == 3 && header.unknown != 0x50 && header.unknown != 0x54))
+  {
+    header.trailer += 4;
+  }
+
+  for (unsigned int trailerChunk : trailerChunks)
+  {
+    if (header.chunkType == trailerChunk && header.trailer != 12 && header.trailer != 4)
+    {
+      header.trailer += 4;
+      break;
+    }
+  }
+
+  // Some chunks never have a trailer
+  if (header.chunkType == 0x1f || header.chunkType == 0xc9 ||
+      header.chunkType == 0x2d || header.chunkType == 0xd1)
+  {
+    header.trailer = 0;
+  }
+  return true;
+}
+
+bool VSD6Traits::getChunkHeader(VSDCursor *input, ChunkHeader &header)
+{
+  if (!skipChunkPadding(input))
+    return false;
+
+  header.chunkType = readU32(input);
+  header.id = readU32(input);
+  header.list = readU32(input);
+
+  // Certain chunk types seem to always have a trailer
+  header.trailer = 0;
+  if (header.list != 0 || header.chunkType == 0x76 || header.chunkType == 0x73 ||
+      header.chunkType == 0x72 || header.chunkType == 0x71 || header.chunkType == 0x70 ||
+      header.chunkType == 0x6f || header.chunkType == 0x6e || header.chunkType == 0x6d ||
+      header.chunkType == 0x6c || header.chunkType == 0x6b || header.chunkType == 0x6a ||
+      header.chunkType == 0x69 || header.chunkType == 0x68 || header.chunkType == 0x67 ||
+      header.chunkType == 0x66 || header.chunkType == 0x65 || header.chunkType == 0x64 ||
+      header.chunkType == 0x2c || header.chunkType == 0xd)
+    header.trailer += 8; // 8 byte trailer
+
+  header.dataLength = readU32(input);
+  header.level = readU16(input);
+  header.unknown = readU8(input);
+
+  // 0x1f (OLE data) and 0xc9 (Name ID) never have trailer
+  if (header.chunkType == 0x1f || header.chunkType == 0xc9)
+  {
+    header.trailer = 0;
+  }
+  return true;
+}
+
+bool VSD5Traits::getChunkHeader(VSDCursor *input, ChunkHeader &header)
+{
+  if (!skipChunkPadding(input))
+    return false;
+
+  header.chunkType = getUInt(input);
+  header.id = getUInt(input);
+  header.level = readU8(input);
+  header.unknown = readU8(input);
+
+  header.trailer = 0;
+
+  header.list = getUInt(input);
+
+  header.dataLength = readU32(input);
+
+  return true;
+}
+
+} // namespace libvisio
+
+#endif // __VSDFORMATTRAITS_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
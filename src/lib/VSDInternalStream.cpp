@@ -10,11 +10,15 @@
 #include "VSDInternalStream.h"
 
 #include <string.h>
+#include <algorithm>
+#include <utility>
 
 VSDInternalStream::VSDInternalStream(librevenge::RVNGInputStream *input, unsigned long size, bool compressed) :
   librevenge::RVNGInputStream(),
   m_offset(0),
-  m_buffer()
+  m_buffer(),
+  m_data(nullptr),
+  m_size(0)
 {
   unsigned long tmpNumBytesRead = 0;
 
@@ -24,55 +28,147 @@ VSDInternalStream::VSDInternalStream(librevenge::RVNGInputStream *input, unsigne
     return;
 
   if (!compressed)
-  {
     m_buffer.assign(tmpBuffer, tmpBuffer + tmpNumBytesRead);
-  }
   else
+    decompress(tmpBuffer, tmpNumBytesRead, m_buffer);
+  m_data = m_buffer.data();
+  m_size = m_buffer.size();
+}
+
+VSDInternalStream::VSDInternalStream(std::vector<unsigned char> buffer) :
+  librevenge::RVNGInputStream(),
+  m_offset(0),
+  m_buffer(std::move(buffer)),
+  m_data(m_buffer.data()),
+  m_size(m_buffer.size())
+{
+}
+
+VSDInternalStream::VSDInternalStream(const unsigned char *data, unsigned long size) :
+  librevenge::RVNGInputStream(),
+  m_offset(0),
+  m_buffer(),
+  m_data(data),
+  m_size(data ? size : 0)
+{
+}
+
+namespace
+{
+
+// Visio LZ streams refer back into a 4 KB window whose slots start zeroed
+const unsigned long VSD_LZ_WINDOW_SIZE = 4096;
+// Longest match; the output gets this much slack so matches can be copied in one fixed-size block
+const unsigned long VSD_LZ_MAX_MATCH = 18;
+
+} // anonymous namespace
+
+unsigned long VSDInternalStream::getDecompressedSize(const unsigned char *input, unsigned long size)
+{
+  unsigned long outputSize = 0;
+  unsigned long offset = 0;
+
+  while (offset < size)
   {
-    unsigned char buffer[4096] = { 0 };
-    unsigned pos = 0;
-    unsigned offset = 0;
+    unsigned flag = input[offset++];
+    if (offset > size-1)
+      break;
 
-    while (offset < tmpNumBytesRead)
+    for (unsigned bit = 0; bit < 8 && offset < size; ++bit)
     {
-      unsigned flag = tmpBuffer[offset++];
-      if (offset > tmpNumBytesRead-1)
-        break;
+      if (flag & (1 << bit))
+      {
+        ++offset;
+        ++outputSize;
+      }
+      else
+      {
+        if (offset > size-2)
+          break;
+        outputSize += (input[offset+1] & 15) + 3;
+        offset += 2;
+      }
+    }
+  }
+  return outputSize;
+}
+
+void VSDInternalStream::decompress(const unsigned char *input, unsigned long size, std::vector<unsigned char> &output)
+{
+  output.clear();
+  const unsigned long outputSize = getDecompressedSize(input, size);
+  if (!outputSize)
+    return;
+  output.resize(outputSize + VSD_LZ_MAX_MATCH);
 
-      unsigned mask = 1;
-      for (unsigned bit = 0; bit < 8 && offset < tmpNumBytesRead; ++bit)
+  unsigned char *const out = &output[0];
+  unsigned long pos = 0;
+  unsigned long offset = 0;
+
+  while (offset < size)
+  {
+    unsigned flag = input[offset++];
+    if (offset > size-1)
+      break;
+
+    if (flag == 0xff && offset + 8 <= size)
+    {
+      memcpy(out + pos, input + offset, 8);
+      pos += 8;
+      offset += 8;
+      continue;
+    }
+
+    for (unsigned bit = 0; bit < 8 && offset < size; ++bit)
+    {
+      if (flag & (1 << bit))
       {
-        if (flag & mask)
+        out[pos++] = input[offset++];
+      }
+      else
+      {
+        if (offset > size-2)
+          break;
+        unsigned char addr1 = input[offset++];
+        unsigned char addr2 = input[offset++];
+
+        unsigned long length = (addr2&15) + 3;
+        unsigned long pointer = (((unsigned long)addr2 & 0xF0) << 4) | addr1;
+        if (pointer > 4078)
+          pointer -= 4078;
+        else
+          pointer += 18;
+
+        /* The window slot of output byte n is n % 4096, so the match starts
+         * at the most recent output byte that lives in slot 'pointer'.
+         * Slots that were never written still hold zeros.
+         */
+        unsigned long distance = (pos - pointer) & (VSD_LZ_WINDOW_SIZE - 1);
+        if (!distance)
+          distance = VSD_LZ_WINDOW_SIZE;
+
+        unsigned char *dst = out + pos;
+        if (distance > pos)
         {
-          buffer[pos&4095] = tmpBuffer[offset++];
-          m_buffer.push_back(buffer[pos&4095]);
-          pos++;
+          const unsigned long zeros = std::min(length, distance - pos);
+          memset(dst, 0, zeros);
+          for (unsigned long j = zeros; j < length; ++j)
+            dst[j] = out[pos + j - distance];
         }
+        else if (distance >= VSD_LZ_MAX_MATCH)
+          memcpy(dst, dst - distance, VSD_LZ_MAX_MATCH);
         else
         {
-          if (offset > tmpNumBytesRead-2)
-            break;
-          unsigned char addr1 = tmpBuffer[offset++];
-          unsigned char addr2 = tmpBuffer[offset++];
-
-          unsigned length = (addr2&15) + 3;
-          unsigned pointer = (((unsigned)addr2 & 0xF0) << 4) | addr1;
-          if (pointer > 4078)
-            pointer -= 4078;
-          else
-            pointer += 18;
-
-          for (unsigned j = 0; j < length; ++j)
-          {
-            buffer[(pos+j) & 4095] = buffer[(pointer+j) & 4095];
-            m_buffer.push_back(buffer[(pointer+j) & 4095]);
-          }
-          pos += length;
+          // overlapping match repeats the last 'distance' bytes
+          const unsigned char *src = dst - distance;
+          for (unsigned long j = 0; j < length; ++j)
+            dst[j] = src[j];
         }
-        mask = mask << 1;
+        pos += length;
       }
     }
   }
+  output.resize(outputSize);
 }
 
 const unsigned char *VSDInternalStream::read(unsigned long numBytes, unsigned long &numBytesRead)
@@ -84,10 +180,10 @@ const unsigned char *VSDInternalStream::read(unsigned long numBytes, unsigned lo
 
   int numBytesToRead;
 
-  if (numBytes < m_buffer.size() - m_offset)
+  if (numBytes < m_size - m_offset)
     numBytesToRead = numBytes;
   else
-    numBytesToRead = m_buffer.size() - m_offset;
+    numBytesToRead = m_size - m_offset;
 
   numBytesRead = numBytesToRead; // about as paranoid as we can be..
 
@@ -97,7 +193,7 @@ const unsigned char *VSDInternalStream::read(unsigned long numBytes, unsigned lo
   long oldOffset = m_offset;
   m_offset += numBytesToRead;
 
-  return &m_buffer[oldOffset];
+  return m_data + oldOffset;
 }
 
 int VSDInternalStream::seek(long offset, librevenge::RVNG_SEEK_TYPE seekType)
@@ -107,16 +203,16 @@ int VSDInternalStream::seek(long offset, librevenge::RVNG_SEEK_TYPE seekType)
   else if (seekType == librevenge::RVNG_SEEK_SET)
     m_offset = offset;
   else if (seekType == librevenge::RVNG_SEEK_END)
-    m_offset = long(static_cast<unsigned long>(m_buffer.size())) + offset;
+    m_offset = long(m_size) + offset;
 
   if (m_offset < 0)
   {
     m_offset = 0;
     return 1;
   }
-  if ((long)m_offset > (long)m_buffer.size())
+  if ((long)m_offset > (long)m_size)
   {
-    m_offset = m_buffer.size();
+    m_offset = m_size;
     return 1;
   }
 
@@ -130,7 +226,7 @@ long VSDInternalStream::tell()
 
 bool VSDInternalStream::isEnd()
 {
-  if ((long)m_offset >= (long)m_buffer.size())
+  if ((long)m_offset >= (long)m_size)
     return true;
 
   return false;
@@ -19,6 +19,9 @@ class VSDInternalStream : public librevenge::RVNGInputStream
 {
 public:
   VSDInternalStream(librevenge::RVNGInputStream *input, unsigned long size, bool compressed=false);
+  explicit VSDInternalStream(std::vector<unsigned char> buffer);
+  // Non-owning view; the data must outlive the stream
+  VSDInternalStream(const unsigned char *data, unsigned long size);
   ~VSDInternalStream() override {}
 
   bool isStructured() override
@@ -51,12 +54,22 @@ public:
   bool isEnd() override;
   unsigned long getSize() const
   {
-    return m_buffer.size();
+    return m_size;
   };
+  const unsigned char *getDataBuffer() const
+  {
+    return m_data;
+  }
+
+  // Size of the output of decompress, found without decompressing
+  static unsigned long getDecompressedSize(const unsigned char *input, unsigned long size);
+  static void decompress(const unsigned char *input, unsigned long size, std::vector<unsigned char> &output);
 
 private:
   volatile long m_offset;
   std::vector<unsigned char> m_buffer;
+  const unsigned char *m_data;
+  unsigned long m_size;
   VSDInternalStream(const VSDInternalStream &);
   VSDInternalStream &operator=(const VSDInternalStream &);
 };
@@ -271,7 +271,7 @@ librevenge::RVNGString libvisio::VSDMetaData::readCodePageString(librevenge::RVN
     {
     case 1252:
       // http://msdn.microsoft.com/en-us/goglobal/bb964654
-      conv = ucnv_open("windows-1252", &status);
+      conv = getThreadConverter("windows-1252");
       break;
     }
 
@@ -287,9 +287,6 @@ librevenge::RVNGString libvisio::VSDMetaData::readCodePageString(librevenge::RVN
           appendUCS4(string, ucs4Character);
       }
     }
-
-    if (conv)
-      ucnv_close(conv);
   }
 
   return string;
@@ -331,12 +328,12 @@ bool libvisio::VSDMetaData::parseTimes(librevenge::RVNGInputStream *input)
   // modifiedTime is number of 100ns since Jan 1 1601
   const uint64_t epoch = uint64_t(116444736UL) * 100;
   time_t sec = (modifiedTime / 10000000) - epoch;
-  const struct tm *time = localtime(&sec);
-  if (time)
+  struct tm time;
+  if (getLocalTime(sec, time))
   {
     static const int MAX_BUFFER = 1024;
     char buffer[MAX_BUFFER];
-    strftime(&buffer[0], MAX_BUFFER-1, "%Y-%m-%dT%H:%M:%SZ", time);
+    strftime(&buffer[0], MAX_BUFFER-1, "%Y-%m-%dT%H:%M:%SZ", &time);
     librevenge::RVNGString result;
     result.append(buffer);
     // Visio UI uses modifiedTime for both purposes.
@@ -347,6 +344,27 @@ bool libvisio::VSDMetaData::parseTimes(librevenge::RVNGInputStream *input)
   return false;
 }
 
+bool libvisio::VSDMetaData::parseStorage(librevenge::RVNGInputStream *storage)
+{
+  if (!storage)
+    return false;
+  storage->seek(0, librevenge::RVNG_SEEK_SET);
+  if (!storage->isStructured())
+    return false;
+
+  const RVNGInputStreamPtr_t sumaryInfo(storage->getSubStreamByName("\x05SummaryInformation"));
+  if (bool(sumaryInfo))
+    parse(sumaryInfo.get());
+
+  const RVNGInputStreamPtr_t docSumaryInfo(storage->getSubStreamByName("\005DocumentSummaryInformation"));
+  if (bool(docSumaryInfo))
+    parse(docSumaryInfo.get());
+
+  storage->seek(0, librevenge::RVNG_SEEK_SET);
+  parseTimes(storage);
+  return true;
+}
+
 const librevenge::RVNGPropertyList &libvisio::VSDMetaData::getMetaData()
 {
   return m_metaData;
@@ -27,6 +27,8 @@ public:
   ~VSDMetaData();
   bool parse(librevenge::RVNGInputStream *input);
   bool parseTimes(librevenge::RVNGInputStream *input);
+  // Property sets and times of a structured VSD storage
+  bool parseStorage(librevenge::RVNGInputStream *storage);
   const librevenge::RVNGPropertyList &getMetaData();
 
 private:
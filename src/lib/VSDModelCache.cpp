@@ -0,0 +1,808 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDModelCache.h"
+
+#include <cstring>
+#include <string>
+#include "libvisio_utils.h"
+#include "VSDCursor.h"
+
+namespace libvisio
+{
+
+namespace
+{
+
+// Bump when the layout changes
+const uint32_t MODEL_CACHE_VERSION = 2;
+
+const unsigned char MODEL_CACHE_MAGIC[] = { 'V', 'S', 'D', 'M', 'O', 'D', 'E', 'L' };
+
+const unsigned long MODEL_CACHE_HEADER_SIZE = 48;
+const unsigned long MODEL_CACHE_PAYLOAD_SIZE_OFFSET = 40;
+
+const unsigned MAX_VECTOR_DEPTH = 32;
+
+#ifdef PACKAGE_VERSION
+const char LIBRARY_VERSION[] = PACKAGE_VERSION;
+#else
+const char LIBRARY_VERSION[] = "";
+#endif
+
+enum ModelCacheOpcode
+{
+  OP_START_DOCUMENT = 1,
+  OP_END_DOCUMENT,
+  OP_SET_DOCUMENT_META_DATA,
+  OP_DEFINE_EMBEDDED_FONT,
+  OP_START_PAGE,
+  OP_END_PAGE,
+  OP_START_MASTER_PAGE,
+  OP_END_MASTER_PAGE,
+  OP_SET_STYLE,
+  OP_START_LAYER,
+  OP_END_LAYER,
+  OP_START_EMBEDDED_GRAPHICS,
+  OP_END_EMBEDDED_GRAPHICS,
+  OP_OPEN_GROUP,
+  OP_CLOSE_GROUP,
+  OP_DRAW_RECTANGLE,
+  OP_DRAW_ELLIPSE,
+  OP_DRAW_POLYGON,
+  OP_DRAW_POLYLINE,
+  OP_DRAW_PATH,
+  OP_DRAW_GRAPHIC_OBJECT,
+  OP_DRAW_CONNECTOR,
+  OP_START_TEXT_OBJECT,
+  OP_END_TEXT_OBJECT,
+  OP_START_TABLE_OBJECT,
+  OP_OPEN_TABLE_ROW,
+  OP_CLOSE_TABLE_ROW,
+  OP_OPEN_TABLE_CELL,
+  OP_CLOSE_TABLE_CELL,
+  OP_INSERT_COVERED_TABLE_CELL,
+  OP_END_TABLE_OBJECT,
+  OP_INSERT_TAB,
+  OP_INSERT_SPACE,
+  OP_INSERT_TEXT,
+  OP_INSERT_LINE_BREAK,
+  OP_INSERT_FIELD,
+  OP_OPEN_ORDERED_LIST_LEVEL,
+  OP_OPEN_UNORDERED_LIST_LEVEL,
+  OP_CLOSE_ORDERED_LIST_LEVEL,
+  OP_CLOSE_UNORDERED_LIST_LEVEL,
+  OP_OPEN_LIST_ELEMENT,
+  OP_CLOSE_LIST_ELEMENT,
+  OP_DEFINE_PARAGRAPH_STYLE,
+  OP_OPEN_PARAGRAPH,
+  OP_CLOSE_PARAGRAPH,
+  OP_DEFINE_CHARACTER_STYLE,
+  OP_OPEN_SPAN,
+  OP_CLOSE_SPAN,
+  OP_OPEN_LINK,
+  OP_CLOSE_LINK
+};
+
+enum ModelCachePropertyType
+{
+  PROPERTY_VALUE = 0,
+  PROPERTY_VECTOR
+};
+
+/* A property that gives back what each accessor of a recorded property
+ * returned. Properties do not tell whether they hold a string, a number
+ * or a boolean, so the cache keeps all their faces instead of one type.
+ */
+class CachedProperty : public librevenge::RVNGProperty
+{
+public:
+  CachedProperty(int intValue, double doubleValue, librevenge::RVNGUnit unit, const char *str)
+    : m_int(intValue), m_double(doubleValue), m_unit(unit), m_str(str) {}
+
+  int getInt() const override
+  {
+    return m_int;
+  }
+  double getDouble() const override
+  {
+    return m_double;
+  }
+  librevenge::RVNGUnit getUnit() const override
+  {
+    return m_unit;
+  }
+  librevenge::RVNGString getStr() const override
+  {
+    return m_str;
+  }
+  librevenge::RVNGProperty *clone() const override
+  {
+    return new CachedProperty(*this);
+  }
+
+private:
+  int m_int;
+  double m_double;
+  librevenge::RVNGUnit m_unit;
+  librevenge::RVNGString m_str;
+};
+
+typedef void (librevenge::RVNGDrawingInterface::*PropertyListCall)(const librevenge::RVNGPropertyList &);
+typedef void (librevenge::RVNGDrawingInterface::*PlainCall)();
+
+PropertyListCall getPropertyListCall(unsigned opcode)
+{
+  switch (opcode)
+  {
+  case OP_START_DOCUMENT:
+    return &librevenge::RVNGDrawingInterface::startDocument;
+  case OP_SET_DOCUMENT_META_DATA:
+    return &librevenge::RVNGDrawingInterface::setDocumentMetaData;
+  case OP_DEFINE_EMBEDDED_FONT:
+    return &librevenge::RVNGDrawingInterface::defineEmbeddedFont;
+  case OP_START_PAGE:
+    return &librevenge::RVNGDrawingInterface::startPage;
+  case OP_START_MASTER_PAGE:
+    return &librevenge::RVNGDrawingInterface::startMasterPage;
+  case OP_SET_STYLE:
+    return &librevenge::RVNGDrawingInterface::setStyle;
+  case OP_START_LAYER:
+    return &librevenge::RVNGDrawingInterface::startLayer;
+  case OP_START_EMBEDDED_GRAPHICS:
+    return &librevenge::RVNGDrawingInterface::startEmbeddedGraphics;
+  case OP_OPEN_GROUP:
+    return &librevenge::RVNGDrawingInterface::openGroup;
+  case OP_DRAW_RECTANGLE:
+    return &librevenge::RVNGDrawingInterface::drawRectangle;
+  case OP_DRAW_ELLIPSE:
+    return &librevenge::RVNGDrawingInterface::drawEllipse;
+  case OP_DRAW_POLYGON:
+    return &librevenge::RVNGDrawingInterface::drawPolygon;
+  case OP_DRAW_POLYLINE:
+    return &librevenge::RVNGDrawingInterface::drawPolyline;
+  case OP_DRAW_PATH:
+    return &librevenge::RVNGDrawingInterface::drawPath;
+  case OP_DRAW_GRAPHIC_OBJECT:
+    return &librevenge::RVNGDrawingInterface::drawGraphicObject;
+  case OP_DRAW_CONNECTOR:
+    return &librevenge::RVNGDrawingInterface::drawConnector;
+  case OP_START_TEXT_OBJECT:
+    return &librevenge::RVNGDrawingInterface::startTextObject;
+  case OP_START_TABLE_OBJECT:
+    return &librevenge::RVNGDrawingInterface::startTableObject;
+  case OP_OPEN_TABLE_ROW:
+    return &librevenge::RVNGDrawingInterface::openTableRow;
+  case OP_OPEN_TABLE_CELL:
+    return &librevenge::RVNGDrawingInterface::openTableCell;
+  case OP_INSERT_COVERED_TABLE_CELL:
+    return &librevenge::RVNGDrawingInterface::insertCoveredTableCell;
+  case OP_INSERT_FIELD:
+    return &librevenge::RVNGDrawingInterface::insertField;
+  case OP_OPEN_ORDERED_LIST_LEVEL:
+    return &librevenge::RVNGDrawingInterface::openOrderedListLevel;
+  case OP_OPEN_UNORDERED_LIST_LEVEL:
+    return &librevenge::RVNGDrawingInterface::openUnorderedListLevel;
+  case OP_OPEN_LIST_ELEMENT:
+    return &librevenge::RVNGDrawingInterface::openListElement;
+  case OP_DEFINE_PARAGRAPH_STYLE:
+    return &librevenge::RVNGDrawingInterface::defineParagraphStyle;
+  case OP_OPEN_PARAGRAPH:
+    return &librevenge::RVNGDrawingInterface::openParagraph;
+  case OP_DEFINE_CHARACTER_STYLE:
+    return &librevenge::RVNGDrawingInterface::defineCharacterStyle;
+  case OP_OPEN_SPAN:
+    return &librevenge::RVNGDrawingInterface::openSpan;
+  case OP_OPEN_LINK:
+    return &librevenge::RVNGDrawingInterface::openLink;
+  default:
+    return nullptr;
+  }
+}
+
+PlainCall getPlainCall(unsigned opcode)
+{
+  switch (opcode)
+  {
+  case OP_END_DOCUMENT:
+    return &librevenge::RVNGDrawingInterface::endDocument;
+  case OP_END_PAGE:
+    return &librevenge::RVNGDrawingInterface::endPage;
+  case OP_END_MASTER_PAGE:
+    return &librevenge::RVNGDrawingInterface::endMasterPage;
+  case OP_END_LAYER:
+    return &librevenge::RVNGDrawingInterface::endLayer;
+  case OP_END_EMBEDDED_GRAPHICS:
+    return &librevenge::RVNGDrawingInterface::endEmbeddedGraphics;
+  case OP_CLOSE_GROUP:
+    return &librevenge::RVNGDrawingInterface::closeGroup;
+  case OP_END_TEXT_OBJECT:
+    return &librevenge::RVNGDrawingInterface::endTextObject;
+  case OP_CLOSE_TABLE_ROW:
+    return &librevenge::RVNGDrawingInterface::closeTableRow;
+  case OP_CLOSE_TABLE_CELL:
+    return &librevenge::RVNGDrawingInterface::closeTableCell;
+  case OP_END_TABLE_OBJECT:
+    return &librevenge::RVNGDrawingInterface::endTableObject;
+  case OP_INSERT_TAB:
+    return &librevenge::RVNGDrawingInterface::insertTab;
+  case OP_INSERT_SPACE:
+    return &librevenge::RVNGDrawingInterface::insertSpace;
+  case OP_INSERT_LINE_BREAK:
+    return &librevenge::RVNGDrawingInterface::insertLineBreak;
+  case OP_CLOSE_ORDERED_LIST_LEVEL:
+    return &librevenge::RVNGDrawingInterface::closeOrderedListLevel;
+  case OP_CLOSE_UNORDERED_LIST_LEVEL:
+    return &librevenge::RVNGDrawingInterface::closeUnorderedListLevel;
+  case OP_CLOSE_LIST_ELEMENT:
+    return &librevenge::RVNGDrawingInterface::closeListElement;
+  case OP_CLOSE_PARAGRAPH:
+    return &librevenge::RVNGDrawingInterface::closeParagraph;
+  case OP_CLOSE_SPAN:
+    return &librevenge::RVNGDrawingInterface::closeSpan;
+  case OP_CLOSE_LINK:
+    return &librevenge::RVNGDrawingInterface::closeLink;
+  default:
+    return nullptr;
+  }
+}
+
+// 64-bit FNV-1a
+const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+uint64_t hashBytes(uint64_t hash, const unsigned char *data, unsigned long size)
+{
+  for (unsigned long i = 0; i < size; ++i)
+  {
+    hash ^= data[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+uint64_t getLibraryHash()
+{
+  return hashBytes(FNV_OFFSET_BASIS, reinterpret_cast<const unsigned char *>(LIBRARY_VERSION), sizeof(LIBRARY_VERSION) - 1);
+}
+
+bool readString(VSDCursor &cursor, const char *&str)
+{
+  const uint32_t length = cursor.readU32();
+  if (cursor.isTruncated() || length == 0 || length > cursor.getRemainingLength())
+    return false;
+  unsigned long numBytesRead = 0;
+  const unsigned char *const data = cursor.read(length, numBytesRead);
+  if (numBytesRead != length || data[length - 1] != 0)
+    return false;
+  str = reinterpret_cast<const char *>(data);
+  return true;
+}
+
+// With a null propList, only checks that a property list can be read
+bool readPropertyList(VSDCursor &cursor, librevenge::RVNGPropertyList *propList, unsigned depth)
+{
+  if (depth > MAX_VECTOR_DEPTH)
+    return false;
+  const uint32_t count = cursor.readU32();
+  // Each entry takes at least a key of one byte and a type
+  if (cursor.isTruncated() || count > cursor.getRemainingLength() / 6)
+    return false;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    const char *key = nullptr;
+    if (!readString(cursor, key))
+      return false;
+    switch (cursor.readU8())
+    {
+    case PROPERTY_VALUE:
+    {
+      const unsigned char unit = cursor.readU8();
+      const int intValue = int(int32_t(cursor.readU32()));
+      const double doubleValue = cursor.readDouble();
+      const char *str = nullptr;
+      if (unit > librevenge::RVNG_UNIT_ERROR || !readString(cursor, str))
+        return false;
+      if (propList)
+        propList->insert(key, new CachedProperty(intValue, doubleValue, librevenge::RVNGUnit(unit), str));
+      break;
+    }
+    case PROPERTY_VECTOR:
+    {
+      const uint32_t size = cursor.readU32();
+      if (cursor.isTruncated() || size > cursor.getRemainingLength() / 4)
+        return false;
+      librevenge::RVNGPropertyListVector vec;
+      for (uint32_t j = 0; j < size; ++j)
+      {
+        librevenge::RVNGPropertyList elem;
+        if (!readPropertyList(cursor, propList ? &elem : nullptr, depth + 1))
+          return false;
+        if (propList)
+          vec.append(elem);
+      }
+      if (propList)
+        propList->insert(key, vec);
+      break;
+    }
+    default:
+      return false;
+    }
+    if (cursor.isTruncated())
+      return false;
+  }
+  return true;
+}
+
+// With a null painter, only checks that the calls can be read
+bool replayCalls(VSDCursor &cursor, librevenge::RVNGDrawingInterface *painter)
+{
+  while (!cursor.isEnd())
+  {
+    const unsigned opcode = cursor.readU8();
+    if (const PropertyListCall listCall = getPropertyListCall(opcode))
+    {
+      librevenge::RVNGPropertyList propList;
+      if (!readPropertyList(cursor, painter ? &propList : nullptr, 0))
+        return false;
+      if (painter)
+        (painter->*listCall)(propList);
+    }
+    else if (const PlainCall plainCall = getPlainCall(opcode))
+    {
+      if (painter)
+        (painter->*plainCall)();
+    }
+    else if (opcode == OP_INSERT_TEXT)
+    {
+      const char *text = nullptr;
+      if (!readString(cursor, text))
+        return false;
+      if (painter)
+        painter->insertText(librevenge::RVNGString(text));
+    }
+    else
+      return false;
+  }
+  return !cursor.isTruncated();
+}
+
+} // anonymous namespace
+
+} // namespace libvisio
+
+libvisio::VSDModelCacheWriter::VSDModelCacheWriter(uint64_t inputHash, uint64_t inputSize)
+  : m_data()
+{
+  m_data.reserve(MODEL_CACHE_HEADER_SIZE);
+  // Byte by byte: a range insert into the empty vector makes GCC warn about an overflow that cannot happen
+  for (unsigned char c : MODEL_CACHE_MAGIC)
+    _writeU8(c);
+  _writeU32(MODEL_CACHE_VERSION);
+  _writeU32(0);
+  _writeU64(getLibraryHash());
+  _writeU64(inputHash);
+  _writeU64(inputSize);
+  _writeU64(0);
+}
+
+libvisio::VSDModelCacheWriter::~VSDModelCacheWriter()
+{
+}
+
+const std::vector<unsigned char> &libvisio::VSDModelCacheWriter::getData()
+{
+  uint64_t payloadSize = m_data.size() - MODEL_CACHE_HEADER_SIZE;
+  for (unsigned i = 0; i < 8; ++i, payloadSize >>= 8)
+    m_data[MODEL_CACHE_PAYLOAD_SIZE_OFFSET + i] = (unsigned char)(payloadSize & 0xff);
+  return m_data;
+}
+
+void libvisio::VSDModelCacheWriter::_writeU8(unsigned char value)
+{
+  m_data.push_back(value);
+}
+
+void libvisio::VSDModelCacheWriter::_writeU32(uint32_t value)
+{
+  for (unsigned i = 0; i < 4; ++i, value >>= 8)
+    m_data.push_back((unsigned char)(value & 0xff));
+}
+
+void libvisio::VSDModelCacheWriter::_writeU64(uint64_t value)
+{
+  for (unsigned i = 0; i < 8; ++i, value >>= 8)
+    m_data.push_back((unsigned char)(value & 0xff));
+}
+
+void libvisio::VSDModelCacheWriter::_writeString(const char *str)
+{
+  const uint32_t length = uint32_t(std::strlen(str) + 1);
+  _writeU32(length);
+  m_data.insert(m_data.end(), str, str + length);
+}
+
+void libvisio::VSDModelCacheWriter::_writeCall(unsigned char opcode)
+{
+  _writeU8(opcode);
+}
+
+void libvisio::VSDModelCacheWriter::_writeCall(unsigned char opcode, const librevenge::RVNGPropertyList &propList)
+{
+  _writeU8(opcode);
+  _writePropertyList(propList);
+}
+
+void libvisio::VSDModelCacheWriter::_writePropertyList(const librevenge::RVNGPropertyList &propList)
+{
+  const std::size_t countOffset = m_data.size();
+  _writeU32(0);
+  uint32_t count = 0;
+  librevenge::RVNGPropertyList::Iter i(propList);
+  for (i.rewind(); i.next();)
+  {
+    if (const librevenge::RVNGPropertyListVector *vec = i.child())
+    {
+      _writeString(i.key());
+      _writeU8(PROPERTY_VECTOR);
+      _writeU32(uint32_t(vec->count()));
+      for (unsigned long j = 0; j < vec->count(); ++j)
+        _writePropertyList((*vec)[j]);
+    }
+    else if (i())
+    {
+      _writeString(i.key());
+      _writeProperty(*i());
+    }
+    else
+      continue;
+    ++count;
+  }
+  for (unsigned j = 0; j < 4; ++j, count >>= 8)
+    m_data[countOffset + j] = (unsigned char)(count & 0xff);
+}
+
+void libvisio::VSDModelCacheWriter::_writeProperty(const librevenge::RVNGProperty &prop)
+{
+  _writeU8(PROPERTY_VALUE);
+  _writeU8((unsigned char)prop.getUnit());
+  _writeU32(uint32_t(int32_t(prop.getInt())));
+  const double value = prop.getDouble();
+  uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  _writeU64(bits);
+  _writeString(prop.getStr().cstr());
+}
+
+void libvisio::VSDModelCacheWriter::startDocument(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_START_DOCUMENT, propList);
+}
+
+void libvisio::VSDModelCacheWriter::endDocument()
+{
+  _writeCall(OP_END_DOCUMENT);
+}
+
+void libvisio::VSDModelCacheWriter::setDocumentMetaData(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_SET_DOCUMENT_META_DATA, propList);
+}
+
+void libvisio::VSDModelCacheWriter::defineEmbeddedFont(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_DEFINE_EMBEDDED_FONT, propList);
+}
+
+void libvisio::VSDModelCacheWriter::startPage(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_START_PAGE, propList);
+}
+
+void libvisio::VSDModelCacheWriter::endPage()
+{
+  _writeCall(OP_END_PAGE);
+}
+
+void libvisio::VSDModelCacheWriter::startMasterPage(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_START_MASTER_PAGE, propList);
+}
+
+void libvisio::VSDModelCacheWriter::endMasterPage()
+{
+  _writeCall(OP_END_MASTER_PAGE);
+}
+
+void libvisio::VSDModelCacheWriter::setStyle(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_SET_STYLE, propList);
+}
+
+void libvisio::VSDModelCacheWriter::startLayer(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_START_LAYER, propList);
+}
+
+void libvisio::VSDModelCacheWriter::endLayer()
+{
+  _writeCall(OP_END_LAYER);
+}
+
+void libvisio::VSDModelCacheWriter::startEmbeddedGraphics(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_START_EMBEDDED_GRAPHICS, propList);
+}
+
+void libvisio::VSDModelCacheWriter::endEmbeddedGraphics()
+{
+  _writeCall(OP_END_EMBEDDED_GRAPHICS);
+}
+
+void libvisio::VSDModelCacheWriter::openGroup(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_OPEN_GROUP, propList);
+}
+
+void libvisio::VSDModelCacheWriter::closeGroup()
+{
+  _writeCall(OP_CLOSE_GROUP);
+}
+
+void libvisio::VSDModelCacheWriter::drawRectangle(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_DRAW_RECTANGLE, propList);
+}
+
+void libvisio::VSDModelCacheWriter::drawEllipse(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_DRAW_ELLIPSE, propList);
+}
+
+void libvisio::VSDModelCacheWriter::drawPolygon(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_DRAW_POLYGON, propList);
+}
+
+void libvisio::VSDModelCacheWriter::drawPolyline(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_DRAW_POLYLINE, propList);
+}
+
+void libvisio::VSDModelCacheWriter::drawPath(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_DRAW_PATH, propList);
+}
+
+void libvisio::VSDModelCacheWriter::drawGraphicObject(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_DRAW_GRAPHIC_OBJECT, propList);
+}
+
+void libvisio::VSDModelCacheWriter::drawConnector(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_DRAW_CONNECTOR, propList);
+}
+
+void libvisio::VSDModelCacheWriter::startTextObject(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_START_TEXT_OBJECT, propList);
+}
+
+void libvisio::VSDModelCacheWriter::endTextObject()
+{
+  _writeCall(OP_END_TEXT_OBJECT);
+}
+
+void libvisio::VSDModelCacheWriter::startTableObject(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_START_TABLE_OBJECT, propList);
+}
+
+void libvisio::VSDModelCacheWriter::openTableRow(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_OPEN_TABLE_ROW, propList);
+}
+
+void libvisio::VSDModelCacheWriter::closeTableRow()
+{
+  _writeCall(OP_CLOSE_TABLE_ROW);
+}
+
+void libvisio::VSDModelCacheWriter::openTableCell(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_OPEN_TABLE_CELL, propList);
+}
+
+void libvisio::VSDModelCacheWriter::closeTableCell()
+{
+  _writeCall(OP_CLOSE_TABLE_CELL);
+}
+
+void libvisio::VSDModelCacheWriter::insertCoveredTableCell(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_INSERT_COVERED_TABLE_CELL, propList);
+}
+
+void libvisio::VSDModelCacheWriter::endTableObject()
+{
+  _writeCall(OP_END_TABLE_OBJECT);
+}
+
+void libvisio::VSDModelCacheWriter::insertTab()
+{
+  _writeCall(OP_INSERT_TAB);
+}
+
+void libvisio::VSDModelCacheWriter::insertSpace()
+{
+  _writeCall(OP_INSERT_SPACE);
+}
+
+void libvisio::VSDModelCacheWriter::insertText(const librevenge::RVNGString &text)
+{
+  _writeCall(OP_INSERT_TEXT);
+  _writeString(text.cstr());
+}
+
+void libvisio::VSDModelCacheWriter::insertLineBreak()
+{
+  _writeCall(OP_INSERT_LINE_BREAK);
+}
+
+void libvisio::VSDModelCacheWriter::insertField(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_INSERT_FIELD, propList);
+}
+
+void libvisio::VSDModelCacheWriter::openOrderedListLevel(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_OPEN_ORDERED_LIST_LEVEL, propList);
+}
+
+void libvisio::VSDModelCacheWriter::openUnorderedListLevel(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_OPEN_UNORDERED_LIST_LEVEL, propList);
+}
+
+void libvisio::VSDModelCacheWriter::closeOrderedListLevel()
+{
+  _writeCall(OP_CLOSE_ORDERED_LIST_LEVEL);
+}
+
+void libvisio::VSDModelCacheWriter::closeUnorderedListLevel()
+{
+  _writeCall(OP_CLOSE_UNORDERED_LIST_LEVEL);
+}
+
+void libvisio::VSDModelCacheWriter::openListElement(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_OPEN_LIST_ELEMENT, propList);
+}
+
+void libvisio::VSDModelCacheWriter::closeListElement()
+{
+  _writeCall(OP_CLOSE_LIST_ELEMENT);
+}
+
+void libvisio::VSDModelCacheWriter::defineParagraphStyle(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_DEFINE_PARAGRAPH_STYLE, propList);
+}
+
+void libvisio::VSDModelCacheWriter::openParagraph(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_OPEN_PARAGRAPH, propList);
+}
+
+void libvisio::VSDModelCacheWriter::closeParagraph()
+{
+  _writeCall(OP_CLOSE_PARAGRAPH);
+}
+
+void libvisio::VSDModelCacheWriter::defineCharacterStyle(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_DEFINE_CHARACTER_STYLE, propList);
+}
+
+void libvisio::VSDModelCacheWriter::openSpan(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_OPEN_SPAN, propList);
+}
+
+void libvisio::VSDModelCacheWriter::closeSpan()
+{
+  _writeCall(OP_CLOSE_SPAN);
+}
+
+void libvisio::VSDModelCacheWriter::openLink(const librevenge::RVNGPropertyList &propList)
+{
+  _writeCall(OP_OPEN_LINK, propList);
+}
+
+void libvisio::VSDModelCacheWriter::closeLink()
+{
+  _writeCall(OP_CLOSE_LINK);
+}
+
+uint64_t libvisio::hashModelCacheOptions(const VisioParseOptions &options)
+{
+  uint64_t hash = FNV_OFFSET_BASIS;
+  for (unsigned page : options.pages)
+  {
+    const unsigned char bytes[] =
+    {
+      (unsigned char)(page & 0xff), (unsigned char)((page >> 8) & 0xff), (unsigned char)((page >> 16) & 0xff), (unsigned char)(page >> 24)
+    };
+    hash = hashBytes(hash, bytes, sizeof(bytes));
+  }
+  // The terminating NULs keep the pages apart from the names, and the names from each other
+  const unsigned char separator = 0;
+  hash = hashBytes(hash, &separator, 1);
+  for (const std::string &name : options.pageNames)
+    hash = hashBytes(hash, reinterpret_cast<const unsigned char *>(name.c_str()), name.size() + 1);
+  const unsigned char textOnly = options.textOnly ? 1 : 0;
+  return hashBytes(hash, &textOnly, 1);
+}
+
+bool libvisio::hashModelCacheInput(librevenge::RVNGInputStream *input, uint64_t optionsHash, uint64_t &hash, uint64_t &size)
+{
+  hash = FNV_OFFSET_BASIS;
+  for (unsigned i = 0; i < 8; ++i, optionsHash >>= 8)
+  {
+    const unsigned char byte = (unsigned char)(optionsHash & 0xff);
+    hash = hashBytes(hash, &byte, 1);
+  }
+  size = 0;
+  if (!input || input->seek(0, librevenge::RVNG_SEEK_SET))
+    return false;
+  while (!input->isEnd())
+  {
+    unsigned long numBytesRead = 0;
+    const unsigned char *const data = input->read(0x10000, numBytesRead);
+    if (!data || !numBytesRead)
+      break;
+    hash = hashBytes(hash, data, numBytesRead);
+    size += numBytesRead;
+  }
+  input->seek(0, librevenge::RVNG_SEEK_SET);
+  return true;
+}
+
+bool libvisio::drawModelCache(const unsigned char *data, unsigned long size, uint64_t inputHash, uint64_t inputSize,
+                              librevenge::RVNGDrawingInterface *painter)
+{
+  if (!data || size < MODEL_CACHE_HEADER_SIZE)
+    return false;
+  if (std::memcmp(data, MODEL_CACHE_MAGIC, VSD_NUM_ELEMENTS(MODEL_CACHE_MAGIC)) != 0)
+    return false;
+
+  VSDCursor header(data, MODEL_CACHE_HEADER_SIZE);
+  header.seek(VSD_NUM_ELEMENTS(MODEL_CACHE_MAGIC), librevenge::RVNG_SEEK_SET);
+  if (header.readU32() != MODEL_CACHE_VERSION)
+    return false;
+  header.readU32();
+  if (header.readU64() != getLibraryHash())
+    return false;
+  if (header.readU64() != inputHash || header.readU64() != inputSize)
+    return false;
+  if (header.readU64() != size - MODEL_CACHE_HEADER_SIZE)
+    return false;
+
+  // Check the whole cache first, so the painter never gets half a document
+  VSDCursor calls(data + MODEL_CACHE_HEADER_SIZE, size - MODEL_CACHE_HEADER_SIZE);
+  if (!replayCalls(calls, nullptr))
+    return false;
+  if (!painter)
+    return true;
+  calls.seek(0, librevenge::RVNG_SEEK_SET);
+  return replayCalls(calls, painter);
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,134 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDMODELCACHE_H__
+#define __VSDMODELCACHE_H__
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <librevenge/librevenge.h>
+#include <libvisio/VisioParseOptions.h>
+
+namespace libvisio
+{
+
+/* Records the painter calls of a drawn document model, so they can be
+ * replayed later without parsing the document again.
+ *
+ * A model cache starts with a fixed header of little-endian numbers:
+ *
+ *   0  "VSDMODEL"
+ *   8  u32 format version
+ *  12  u32 reserved, 0
+ *  16  u64 hash of the library version
+ *  24  u64 hash of the input document and of the options that select
+ *      what was parsed of it
+ *  32  u64 size of the input document
+ *  40  u64 size of the calls that follow
+ *
+ * Each call is a u8 opcode followed by its arguments. Strings are a u32
+ * length, including a terminating NUL, and the characters, so they can
+ * be used in place. A property list is a u32 count of entries, each of
+ * them a key string, a u8 type and the value. A value is what each
+ * accessor of the property returned: a u8 unit, an i32, an f64 and a
+ * string. Nothing needs alignment, so the cache can be replayed straight
+ * from a mapped file.
+ */
+class VSDModelCacheWriter : public librevenge::RVNGDrawingInterface
+{
+public:
+  VSDModelCacheWriter(uint64_t inputHash, uint64_t inputSize);
+  ~VSDModelCacheWriter() override;
+
+  const std::vector<unsigned char> &getData();
+
+  void startDocument(const librevenge::RVNGPropertyList &propList) override;
+  void endDocument() override;
+  void setDocumentMetaData(const librevenge::RVNGPropertyList &propList) override;
+  void defineEmbeddedFont(const librevenge::RVNGPropertyList &propList) override;
+  void startPage(const librevenge::RVNGPropertyList &propList) override;
+  void endPage() override;
+  void startMasterPage(const librevenge::RVNGPropertyList &propList) override;
+  void endMasterPage() override;
+  void setStyle(const librevenge::RVNGPropertyList &propList) override;
+  void startLayer(const librevenge::RVNGPropertyList &propList) override;
+  void endLayer() override;
+  void startEmbeddedGraphics(const librevenge::RVNGPropertyList &propList) override;
+  void endEmbeddedGraphics() override;
+  void openGroup(const librevenge::RVNGPropertyList &propList) override;
+  void closeGroup() override;
+  void drawRectangle(const librevenge::RVNGPropertyList &propList) override;
+  void drawEllipse(const librevenge::RVNGPropertyList &propList) override;
+  void drawPolygon(const librevenge::RVNGPropertyList &propList) override;
+  void drawPolyline(const librevenge::RVNGPropertyList &propList) override;
+  void drawPath(const librevenge::RVNGPropertyList &propList) override;
+  void drawGraphicObject(const librevenge::RVNGPropertyList &propList) override;
+  void drawConnector(const librevenge::RVNGPropertyList &propList) override;
+  void startTextObject(const librevenge::RVNGPropertyList &propList) override;
+  void endTextObject() override;
+  void startTableObject(const librevenge::RVNGPropertyList &propList) override;
+  void openTableRow(const librevenge::RVNGPropertyList &propList) override;
+  void closeTableRow() override;
+  void openTableCell(const librevenge::RVNGPropertyList &propList) override;
+  void closeTableCell() override;
+  void insertCoveredTableCell(const librevenge::RVNGPropertyList &propList) override;
+  void endTableObject() override;
+  void insertTab() override;
+  void insertSpace() override;
+  void insertText(const librevenge::RVNGString &text) override;
+  void insertLineBreak() override;
+  void insertField(const librevenge::RVNGPropertyList &propList) override;
+  void openOrderedListLevel(const librevenge::RVNGPropertyList &propList) override;
+  void openUnorderedListLevel(const librevenge::RVNGPropertyList &propList) override;
+  void closeOrderedListLevel() override;
+  void closeUnorderedListLevel() override;
+  void openListElement(const librevenge::RVNGPropertyList &propList) override;
+  void closeListElement() override;
+  void defineParagraphStyle(const librevenge::RVNGPropertyList &propList) override;
+  void openParagraph(const librevenge::RVNGPropertyList &propList) override;
+  void closeParagraph() override;
+  void defineCharacterStyle(const librevenge::RVNGPropertyList &propList) override;
+  void openSpan(const librevenge::RVNGPropertyList &propList) override;
+  void closeSpan() override;
+  void openLink(const librevenge::RVNGPropertyList &propList) override;
+  void closeLink() override;
+
+private:
+  VSDModelCacheWriter(const VSDModelCacheWriter &);
+  VSDModelCacheWriter &operator=(const VSDModelCacheWriter &);
+
+  void _writeCall(unsigned char opcode);
+  void _writeCall(unsigned char opcode, const librevenge::RVNGPropertyList &propList);
+  void _writeU8(unsigned char value);
+  void _writeU32(uint32_t value);
+  void _writeU64(uint64_t value);
+  void _writeString(const char *str);
+  void _writePropertyList(const librevenge::RVNGPropertyList &propList);
+  void _writeProperty(const librevenge::RVNGProperty &prop);
+
+  std::vector<unsigned char> m_data;
+};
+
+// Hash of the options that select the pages and the content of a model
+uint64_t hashModelCacheOptions(const VisioParseOptions &options);
+
+// Hash and size of input that identify the document of a model cache, for a model parsed with options of optionsHash
+bool hashModelCacheInput(librevenge::RVNGInputStream *input, uint64_t optionsHash, uint64_t &hash, uint64_t &size);
+
+/* Makes the calls recorded in the model cache data on painter. Returns
+ * false without calling painter if data is not a complete cache of this
+ * version of the library for the given input.
+ */
+bool drawModelCache(const unsigned char *data, unsigned long size, uint64_t inputHash, uint64_t inputSize,
+                    librevenge::RVNGDrawingInterface *painter);
+
+} // namespace libvisio
+
+#endif // __VSDMODELCACHE_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -52,6 +52,10 @@ public:
   {
     return m_elements.empty();
   }
+  std::size_t size() const
+  {
+    return m_elements.size();
+  }
 private:
   std::vector<std::unique_ptr<VSDOutputElement>> m_elements;
 };
@@ -0,0 +1,68 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDPAGESELECTION_H__
+#define __VSDPAGESELECTION_H__
+
+#include <set>
+#include <string>
+
+namespace libvisio
+{
+
+/* Decides which foreground pages a parser goes into. Background pages
+ * are always parsed, since a selected page may be drawn on top of any of
+ * them. The parsers call reset() when they enter the list of pages and
+ * nextPage() for each foreground page, in document order.
+ */
+class VSDPageSelection
+{
+public:
+  VSDPageSelection() : m_indices(), m_names(), m_index(0) {}
+
+  void select(const std::set<unsigned> &indices, const std::set<std::string> &names)
+  {
+    m_indices = indices;
+    m_names = names;
+    m_index = 0;
+  }
+
+  bool selectsAll() const
+  {
+    return m_indices.empty() && m_names.empty();
+  }
+
+  bool needsNames() const
+  {
+    return !m_names.empty();
+  }
+
+  void reset()
+  {
+    m_index = 0;
+  }
+
+  bool nextPage(const char *name)
+  {
+    const unsigned index = m_index++;
+    if (selectsAll() || m_indices.count(index))
+      return true;
+    return name && m_names.count(name);
+  }
+
+private:
+  std::set<unsigned> m_indices;
+  std::set<std::string> m_names;
+  unsigned m_index;
+};
+
+} // namespace libvisio
+
+#endif // __VSDPAGESELECTION_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
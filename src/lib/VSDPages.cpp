@@ -9,6 +9,8 @@
 
 #include "VSDPages.h"
 
+#include <algorithm>
+
 #include "libvisio_utils.h"
 
 libvisio::VSDPage::VSDPage()
@@ -55,18 +57,43 @@ void libvisio::VSDPage::draw(librevenge::RVNGDrawingInterface *painter) const
 }
 
 libvisio::VSDPages::VSDPages()
-  : m_pages(), m_backgroundPages(), m_metaData()
+  : m_pages(), m_backgroundPages(), m_metaData(), m_painter(nullptr), m_isDocumentStarted(false),
+    m_elements(0), m_peakPages(0), m_peakElements(0)
 {
 }
 
 void libvisio::VSDPages::addPage(const libvisio::VSDPage &page)
 {
-  m_pages.push_back(page);
+  // Pages keep their order, so a page waits for those before it
+  if (m_painter && m_pages.empty() && _hasBackground(page))
+  {
+    if (!m_isDocumentStarted)
+    {
+      _startDocument(m_painter);
+      m_isDocumentStarted = true;
+    }
+    _drawPage(m_painter, page);
+  }
+  else
+  {
+    m_pages.push_back(page);
+    _keep(page);
+  }
 }
 
 void libvisio::VSDPages::addBackgroundPage(const libvisio::VSDPage &page)
 {
-  m_backgroundPages[page.m_currentPageID] = page;
+  auto iter = m_backgroundPages.find(page.m_currentPageID);
+  if (iter != m_backgroundPages.end())
+  {
+    _release(iter->second);
+    iter->second = page;
+  }
+  else
+    m_backgroundPages[page.m_currentPageID] = page;
+  _keep(page);
+  if (m_painter)
+    _drawPendingPages();
 }
 
 void libvisio::VSDPages::setMetaData(const librevenge::RVNGPropertyList &metaData)
@@ -74,45 +101,100 @@ void libvisio::VSDPages::setMetaData(const librevenge::RVNGPropertyList &metaDat
   m_metaData = metaData;
 }
 
-void libvisio::VSDPages::draw(librevenge::RVNGDrawingInterface *painter)
+void libvisio::VSDPages::swap(libvisio::VSDPages &other)
+{
+  m_pages.swap(other.m_pages);
+  m_backgroundPages.swap(other.m_backgroundPages);
+  const librevenge::RVNGPropertyList metaData(m_metaData);
+  m_metaData = other.m_metaData;
+  other.m_metaData = metaData;
+  std::swap(m_isDocumentStarted, other.m_isDocumentStarted);
+  std::swap(m_elements, other.m_elements);
+  std::swap(m_peakPages, other.m_peakPages);
+  std::swap(m_peakElements, other.m_peakElements);
+}
+
+void libvisio::VSDPages::draw(librevenge::RVNGDrawingInterface *painter) const
 {
   if (!painter)
     return;
-  if (m_pages.empty())
+  if (m_pages.empty() && !m_isDocumentStarted)
     return;
 
-  painter->startDocument(librevenge::RVNGPropertyList());
-  painter->setDocumentMetaData(m_metaData);
+  if (!m_isDocumentStarted)
+    _startDocument(painter);
 
-  for (auto &page : m_pages)
-  {
-    librevenge::RVNGPropertyList pageProps;
-    pageProps.insert("svg:width", page.m_pageWidth);
-    pageProps.insert("svg:height", page.m_pageHeight);
-    if (page.m_pageName.len())
-      pageProps.insert("draw:name", page.m_pageName);
-    painter->startPage(pageProps);
-    _drawWithBackground(painter, page);
-    painter->endPage();
-  }
+  for (const auto &page : m_pages)
+    _drawPage(painter, page);
   // Visio shows background pages in tabs after the normal pages
   for (std::map<unsigned, libvisio::VSDPage>::const_iterator iter = m_backgroundPages.begin();
        iter != m_backgroundPages.end(); ++iter)
+    _drawPage(painter, iter->second);
+
+  painter->endDocument();
+}
+
+bool libvisio::VSDPages::_hasBackground(const libvisio::VSDPage &page) const
+{
+  unsigned backgroundPageID = page.m_backgroundPageID;
+  // A cycle of background pages is as complete as it is ever going to be
+  for (std::size_t i = 0; backgroundPageID != MINUS_ONE && i <= m_backgroundPages.size(); ++i)
   {
-    librevenge::RVNGPropertyList pageProps;
-    pageProps.insert("svg:width", iter->second.m_pageWidth);
-    pageProps.insert("svg:height", iter->second.m_pageHeight);
-    if (iter->second.m_pageName.len())
-      pageProps.insert("draw:name", iter->second.m_pageName);
-    painter->startPage(pageProps);
-    _drawWithBackground(painter, iter->second);
-    painter->endPage();
+    auto iter = m_backgroundPages.find(backgroundPageID);
+    if (iter == m_backgroundPages.end())
+      return false;
+    backgroundPageID = iter->second.m_backgroundPageID;
   }
+  return true;
+}
 
-  painter->endDocument();
+void libvisio::VSDPages::_drawPendingPages()
+{
+  std::vector<VSDPage>::iterator iter = m_pages.begin();
+  for (; iter != m_pages.end() && _hasBackground(*iter); ++iter)
+  {
+    if (!m_isDocumentStarted)
+    {
+      _startDocument(m_painter);
+      m_isDocumentStarted = true;
+    }
+    _drawPage(m_painter, *iter);
+    _release(*iter);
+  }
+  m_pages.erase(m_pages.begin(), iter);
+}
+
+void libvisio::VSDPages::_keep(const libvisio::VSDPage &page)
+{
+  m_elements += page.m_pageElements.size();
+  m_peakPages = std::max(m_peakPages, m_pages.size() + m_backgroundPages.size());
+  m_peakElements = std::max(m_peakElements, m_elements);
+}
+
+void libvisio::VSDPages::_release(const libvisio::VSDPage &page)
+{
+  m_elements -= page.m_pageElements.size();
+}
+
+void libvisio::VSDPages::_startDocument(librevenge::RVNGDrawingInterface *painter) const
+{
+  painter->startDocument(librevenge::RVNGPropertyList());
+  painter->setDocumentMetaData(m_metaData);
+}
+
+void libvisio::VSDPages::_drawPage(librevenge::RVNGDrawingInterface *painter, const libvisio::VSDPage &page) const
+{
+  librevenge::RVNGPropertyList pageProps;
+  pageProps.insert("svg:width", page.m_pageWidth);
+  pageProps.insert("svg:height", page.m_pageHeight);
+  if (page.m_pageName.len())
+    pageProps.insert("draw:name", page.m_pageName);
+  painter->startPage(pageProps);
+  _drawWithBackground(painter, page);
+  painter->endPage();
 }
 
-void libvisio::VSDPages::_drawWithBackground(librevenge::RVNGDrawingInterface *painter, const libvisio::VSDPage &page)
+void libvisio::VSDPages::_drawWithBackground(librevenge::RVNGDrawingInterface *painter, const libvisio::VSDPage &page) const
 {
   if (!painter)
     return;
@@ -38,13 +38,47 @@ public:
   ~VSDPages();
   void addPage(const VSDPage &page);
   void addBackgroundPage(const VSDPage &page);
-  void draw(librevenge::RVNGDrawingInterface *painter);
+  void draw(librevenge::RVNGDrawingInterface *painter) const;
   void setMetaData(const librevenge::RVNGPropertyList &metaData);
+  // Draw each page to painter as soon as its background pages are known,
+  // instead of keeping it until draw()
+  void setPainter(librevenge::RVNGDrawingInterface *painter)
+  {
+    m_painter = painter;
+  }
+  bool empty() const
+  {
+    return m_pages.empty();
+  }
+  void swap(VSDPages &other);
+  // Largest number of pages, and of elements in them, kept at a time
+  std::size_t getPeakPages() const
+  {
+    return m_peakPages;
+  }
+  std::size_t getPeakElements() const
+  {
+    return m_peakElements;
+  }
 private:
-  void _drawWithBackground(librevenge::RVNGDrawingInterface *painter, const VSDPage &page);
+  VSDPages(const VSDPages &);
+  VSDPages &operator=(const VSDPages &);
+
+  void _keep(const VSDPage &page);
+  void _release(const VSDPage &page);
+  bool _hasBackground(const VSDPage &page) const;
+  void _drawPendingPages();
+  void _startDocument(librevenge::RVNGDrawingInterface *painter) const;
+  void _drawPage(librevenge::RVNGDrawingInterface *painter, const VSDPage &page) const;
+  void _drawWithBackground(librevenge::RVNGDrawingInterface *painter, const VSDPage &page) const;
   std::vector<VSDPage> m_pages;
   std::map<unsigned, VSDPage> m_backgroundPages;
   librevenge::RVNGPropertyList m_metaData;
+  librevenge::RVNGDrawingInterface *m_painter;
+  bool m_isDocumentStarted;
+  std::size_t m_elements;
+  std::size_t m_peakPages;
+  std::size_t m_peakElements;
 };
 
 
@@ -0,0 +1,83 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDParseControl.h"
+#include "libvisio_utils.h"
+
+libvisio::VSDParseControl::VSDParseControl()
+  : m_deadline(std::chrono::steady_clock::time_point::max()), m_hasDeadline(false), m_cancel(nullptr),
+    m_checks(0), m_status(VISIO_PARSE_OK), m_limits(), m_decompressedBytes(0), m_pageShapes(0),
+    m_pathPoints(0), m_isTimed(false), m_stats(), m_parent(nullptr), m_workerMutex()
+{
+}
+
+libvisio::VSDParseControl::VSDParseControl(const VisioParseOptions &options, bool isTimed)
+  : m_deadline(options.deadline), m_hasDeadline(options.deadline != std::chrono::steady_clock::time_point::max()),
+    m_cancel(options.cancel), m_checks(0), m_status(VISIO_PARSE_OK), m_limits(options.limits),
+    m_decompressedBytes(0), m_pageShapes(0), m_pathPoints(0), m_isTimed(isTimed), m_stats(), m_parent(nullptr),
+    m_workerMutex()
+{
+  // An expired deadline stops the parse at the first check
+  if (m_hasDeadline)
+    m_checks = VSD_CHECKS_PER_CLOCK_READ - 1;
+}
+
+libvisio::VSDParseControl::VSDParseControl(VSDParseControl *parent)
+  : m_deadline(parent ? parent->m_deadline : std::chrono::steady_clock::time_point::max()),
+    m_hasDeadline(parent && parent->m_hasDeadline), m_cancel(parent ? parent->m_cancel : nullptr), m_checks(0),
+    m_status(VISIO_PARSE_OK), m_limits(parent ? parent->m_limits : VisioParseLimits()), m_decompressedBytes(0),
+    m_pageShapes(0), m_pathPoints(0), m_isTimed(false), m_stats(), m_parent(parent), m_workerMutex()
+{
+  if (m_hasDeadline)
+    m_checks = VSD_CHECKS_PER_CLOCK_READ - 1;
+}
+
+void libvisio::VSDParseControl::_checkSlow()
+{
+  if (m_status == VISIO_PARSE_OK)
+  {
+    if (m_cancel && m_cancel->load(std::memory_order_relaxed))
+      _setStatus(VISIO_PARSE_CANCELLED);
+    else if (m_hasDeadline && std::chrono::steady_clock::now() >= m_deadline)
+      _setStatus(VISIO_PARSE_TIMED_OUT);
+    else
+      return;
+  }
+  VSD_DEBUG_MSG(("Throwing ParseInterruptedException\n"));
+  throw ParseInterruptedException();
+}
+
+void libvisio::VSDParseControl::_exceedLimit()
+{
+  // A cancellation or timeout that came first is kept
+  if (m_status == VISIO_PARSE_OK)
+    _setStatus(VISIO_PARSE_LIMIT_EXCEEDED);
+  VSD_DEBUG_MSG(("Throwing ParseInterruptedException\n"));
+  throw ParseInterruptedException();
+}
+
+void libvisio::VSDParseControl::_setStatus(VisioParseStatus status)
+{
+  m_status = status;
+  // The whole parse stops with the first worker that stops
+  if (m_parent)
+  {
+    std::lock_guard<std::mutex> lock(m_parent->m_workerMutex);
+    if (m_parent->m_status == VISIO_PARSE_OK)
+      m_parent->m_status = status;
+  }
+}
+
+void libvisio::VSDParseControl::_addToParent(void (VSDParseControl::*add)(unsigned long), unsigned long amount)
+{
+  std::lock_guard<std::mutex> lock(m_parent->m_workerMutex);
+  (m_parent->*add)(amount);
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
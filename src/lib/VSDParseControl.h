@@ -0,0 +1,233 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDPARSECONTROL_H__
+#define __VSDPARSECONTROL_H__
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include <libvisio/VisioParseOptions.h>
+#include <libvisio/VisioParseStats.h>
+
+namespace libvisio
+{
+
+/* Decides whether a parse has to stop early. The parsers and collectors
+ * call check() in their loops; once the parse is cancelled or past its
+ * deadline, check() throws ParseInterruptedException, and keeps throwing
+ * it, so an exception that is swallowed on the way up does not let the
+ * parse go on for long. The clock is only read on every few checks.
+ *
+ * The add functions account for the resources of the parse, and throw
+ * the same exception as soon as one of the limits is exceeded. They also
+ * keep the statistics of the parse.
+ *
+ * A worker thread of the parse gets a control of its own, which stops at
+ * the same cancel flag and deadline as its parent, and adds the resources
+ * it uses to the parent under a lock that the workers share. The parent
+ * itself must not be used while the workers run. When a worker stops, the
+ * parent gets its status; the statistics stay with the worker.
+ */
+class VSDParseControl
+{
+public:
+  VSDParseControl();
+  explicit VSDParseControl(const VisioParseOptions &options, bool isTimed = false);
+  // A control for a worker of the parse of parent, or of a parse without control if parent is null
+  explicit VSDParseControl(VSDParseControl *parent);
+
+  void check()
+  {
+    if (m_status != VISIO_PARSE_OK || (m_cancel && m_cancel->load(std::memory_order_relaxed)) || (m_hasDeadline && ++m_checks % VSD_CHECKS_PER_CLOCK_READ == 0))
+      _checkSlow();
+  }
+
+  VisioParseStatus getStatus() const
+  {
+    return m_status;
+  }
+
+  const VisioParseStats &getStats() const
+  {
+    return m_stats;
+  }
+
+  // The statistics to add times to, or null if the parse is not timed
+  VisioParseStats *getTimedStats()
+  {
+    return m_isTimed ? &m_stats : nullptr;
+  }
+
+  void addPass()
+  {
+    ++m_stats.passes;
+  }
+
+  void addStream()
+  {
+    ++m_stats.streams;
+    check();
+  }
+
+  void addChunk()
+  {
+    ++m_stats.chunks;
+    check();
+  }
+
+  void addChunks(unsigned long chunks)
+  {
+    m_stats.chunks += chunks;
+    check();
+  }
+
+  void addDecompressedBytes(unsigned long bytes)
+  {
+    if (m_parent)
+      _addToParent(&VSDParseControl::addDecompressedBytes, bytes);
+    else
+      _add(m_decompressedBytes, bytes, m_limits.maxDecompressedBytes);
+  }
+
+  void startPage()
+  {
+    m_pageShapes = 0;
+  }
+
+  void addShape()
+  {
+    _add(m_pageShapes, 1, m_limits.maxShapesPerPage);
+    ++m_stats.shapes;
+  }
+
+  void addPathPoints(unsigned long points)
+  {
+    if (m_parent)
+      _addToParent(&VSDParseControl::addPathPoints, points);
+    else
+      _add(m_pathPoints, points, m_limits.maxPathPoints);
+  }
+
+  void addEmbeddedBytes(unsigned long bytes)
+  {
+    if (m_parent)
+      _addToParent(&VSDParseControl::addEmbeddedBytes, bytes);
+    else
+      _add(m_stats.embeddedBytes, bytes, m_limits.maxEmbeddedBytes);
+  }
+
+  void addPathNodes(unsigned long nodes)
+  {
+    m_stats.pathNodes += nodes;
+  }
+
+  void addTextSpan()
+  {
+    ++m_stats.textSpans;
+  }
+
+  void addStreamCacheHit(unsigned long savedBytes)
+  {
+    ++m_stats.streamCacheHits;
+    m_stats.streamCacheSavedBytes += savedBytes;
+  }
+
+  void addStreamCacheMiss()
+  {
+    ++m_stats.streamCacheMisses;
+  }
+
+  void addParallelPart()
+  {
+    ++m_stats.parallelParts;
+  }
+
+  void setPeakBuffers(unsigned long pages, unsigned long elements)
+  {
+    if (pages > m_stats.peakBufferedPages)
+      m_stats.peakBufferedPages = pages;
+    if (elements > m_stats.peakBufferedElements)
+      m_stats.peakBufferedElements = elements;
+  }
+
+  void checkStreamDepth(unsigned depth)
+  {
+    if (m_limits.maxStreamDepth && depth > m_limits.maxStreamDepth)
+      _exceedLimit();
+  }
+
+private:
+  VSDParseControl(const VSDParseControl &);
+  VSDParseControl &operator=(const VSDParseControl &);
+
+  void _checkSlow();
+  void _exceedLimit();
+  void _setStatus(VisioParseStatus status);
+  void _addToParent(void (VSDParseControl::*add)(unsigned long), unsigned long amount);
+
+  template<typename T>
+  void _add(T &used, unsigned long amount, unsigned long limit)
+  {
+    if (limit && (amount > limit || used > limit - amount))
+      _exceedLimit();
+    used += (T)amount;
+  }
+
+  static const unsigned VSD_CHECKS_PER_CLOCK_READ = 16;
+
+  std::chrono::steady_clock::time_point m_deadline;
+  bool m_hasDeadline;
+  const std::atomic<bool> *m_cancel;
+  unsigned m_checks;
+  VisioParseStatus m_status;
+  VisioParseLimits m_limits;
+  unsigned long m_decompressedBytes;
+  unsigned m_pageShapes;
+  unsigned long m_pathPoints;
+  bool m_isTimed;
+  VisioParseStats m_stats;
+  VSDParseControl *m_parent;
+  // Taken by the workers of this control
+  std::mutex m_workerMutex;
+};
+
+/* Adds the time from its construction to its destruction to a phase in
+ * the statistics of control, if the parse is timed.
+ */
+class VSDParseTimer
+{
+public:
+  VSDParseTimer(VSDParseControl *control, double VisioParseStats::*phase)
+    : m_stats(control ? control->getTimedStats() : nullptr), m_phase(phase), m_start()
+  {
+    if (m_stats)
+      m_start = std::chrono::steady_clock::now();
+  }
+
+  ~VSDParseTimer()
+  {
+    if (m_stats)
+      m_stats->*m_phase += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+  }
+
+private:
+  VSDParseTimer(const VSDParseTimer &);
+  VSDParseTimer &operator=(const VSDParseTimer &);
+
+  VisioParseStats *m_stats;
+  double VisioParseStats::*m_phase;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace libvisio
+
+#endif // __VSDPARSECONTROL_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -11,17 +11,119 @@
 
 #include <librevenge-stream/librevenge-stream.h>
 #include <locale.h>
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 #include <string>
 #include <cmath>
 #include <set>
 #include "libvisio_utils.h"
+#include "VSDCompoundFile.h"
 #include "VSDInternalStream.h"
 #include "VSDDocumentStructure.h"
 #include "VSDContentCollector.h"
+#include "VSDDeferredCollector.h"
 #include "VSDStylesCollector.h"
+#include "VSDTextCollector.h"
 #include "VSDMetaData.h"
+#include "VSDParseControl.h"
+#include "VSDWorkerPool.h"
+
+namespace
+{
+
+/* Chunks whose content the styles pass does not need: it only looks at
+ * style sheets, shape transforms, group membership and shape order.
+ */
+bool isSkippedInStylesPass(unsigned chunkType)
+{
+  switch (chunkType)
+  {
+  case VSD_GEOM_LIST:
+  case VSD_GEOMETRY:
+  case VSD_MOVE_TO:
+  case VSD_LINE_TO:
+  case VSD_ARC_TO:
+  case VSD_ELLIPSE:
+  case VSD_ELLIPTICAL_ARC_TO:
+  case VSD_NURBS_TO:
+  case VSD_POLYLINE_TO:
+  case VSD_INFINITE_LINE:
+  case VSD_SHAPE_DATA:
+  case VSD_SPLINE_START:
+  case VSD_SPLINE_KNOT:
+  case VSD_TEXT:
+  case VSD_TEXT_XFORM:
+  case VSD_CHAR_LIST:
+  case VSD_CHAR_IX:
+  case VSD_PARA_LIST:
+  case VSD_PARA_IX:
+  case VSD_TABS_DATA_LIST:
+  case VSD_TABS_DATA_1:
+  case VSD_TABS_DATA_2:
+  case VSD_TABS_DATA_3:
+  case VSD_FIELD_LIST:
+  case VSD_TEXT_FIELD:
+  case VSD_FOREIGN_DATA_TYPE:
+  case VSD_FOREIGN_DATA:
+  case VSD_OLE_LIST:
+  case VSD_OLE_DATA:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/* Rank of the streams whose content is used while parsing the streams
+ * of a higher rank: colours and fonts are looked up by style sheets,
+ * stencils and pages, style sheets and stencils by the shapes on pages.
+ */
+int getSinglePassRank(unsigned streamType)
+{
+  switch (streamType)
+  {
+  case VSD_COLORS:
+  case VSD_FONT_LIST:
+  case VSD_FONTFACES:
+    return 0;
+  case VSD_STYLES:
+  case VSD_STENCILS:
+    return 1;
+  case VSD_PAGE:
+    return 2;
+  default:
+    return -1;
+  }
+}
+
+bool isRankOrdered(const libvisio::VSDStreamIndex &index, unsigned entry, int &maxRank)
+{
+  for (const auto &child : index.getEntry(entry).children)
+  {
+    const int rank = getSinglePassRank(index.getEntry(child.entry).pointer.Type);
+    if (rank >= 0)
+    {
+      if (rank < maxRank)
+        return false;
+      maxRank = rank;
+    }
+    if (!isRankOrdered(index, child.entry, maxRank))
+      return false;
+  }
+  return true;
+}
+
+/* Stores a value read from a chunk in field, unless the read ran past the
+ * end of the chunk: the readers commit nothing past the truncation point.
+ */
+template<typename T>
+void setField(const libvisio::VSDCursor *input, T &field, const T &value)
+{
+  if (!input->isTruncated())
+    field = value;
+}
+
+} // anonymous namespace
 
 libvisio::VSDParser::VSDParser(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, librevenge::RVNGInputStream *container)
   : m_input(input), m_painter(painter), m_container(container), m_header(), m_collector(nullptr), m_shapeList(), m_currentLevel(0),
@@ -29,7 +131,11 @@ libvisio::VSDParser::VSDParser(librevenge::RVNGInputStream *input, librevenge::R
     m_currentShapeLevel(0), m_currentShapeID(MINUS_ONE), m_currentLayerListLevel(0), m_extractStencils(false), m_colours(),
     m_isBackgroundPage(false), m_isShapeStarted(false), m_shadowOffsetX(0.0), m_shadowOffsetY(0.0),
     m_currentGeometryList(nullptr), m_currentGeomListCount(0), m_fonts(), m_names(), m_namesMapMap(),
-    m_currentPageName(), m_currentTabSet()
+    m_currentPageName(), m_currentTabSet(), m_streamCache(), m_streamIndex(),
+    m_inputSize(0), m_inputBuffer(getContiguousBuffer(input, m_inputSize)),
+    m_decompressionThreads(0), m_decompressionPool(), m_isStylesPass(false), m_singlePass(false), m_shortIntegers(false), m_deferredCollector(nullptr),
+    m_pagesOutput(nullptr), m_progressive(false), m_pageSelection(), m_parseControl(nullptr),
+    m_textOnly(false)
 {}
 
 libvisio::VSDParser::~VSDParser()
@@ -48,60 +154,140 @@ void libvisio::VSDParser::_nameFromId(VSDName &name, unsigned id, unsigned level
   }
 }
 
-bool libvisio::VSDParser::getChunkHeader(librevenge::RVNGInputStream *input)
+std::unique_ptr<VSDInternalStream> libvisio::VSDParser::_openStream(unsigned offset, unsigned length, bool compressed)
 {
-  unsigned char tmpChar = 0;
-  while (!input->isEnd() && !tmpChar)
-    tmpChar = readU8(input);
-
-  if (input->isEnd())
-    return false;
-  else
-    input->seek(-1, librevenge::RVNG_SEEK_CUR);
-
-  m_header.chunkType = readU32(input);
-  m_header.id = readU32(input);
-  m_header.list = readU32(input);
+  m_input->seek(offset, librevenge::RVNG_SEEK_SET);
+  if (!compressed)
+  {
+    if (!m_inputBuffer)
+      return make_unique<VSDInternalStream>(m_input, length, false);
+
+    // The input keeps its whole content in one buffer, so just point into it
+    unsigned long numBytes = offset < m_inputSize ? std::min<unsigned long>(length, m_inputSize - offset) : 0;
+    if (numBytes < 2)
+      numBytes = 0;
+    return make_unique<VSDInternalStream>(m_inputBuffer + (numBytes ? offset : 0), numBytes);
+  }
 
-  // Certain chunk types seem to always have a trailer
-  m_header.trailer = 0;
-  if (m_header.list != 0 || m_header.chunkType == 0x71 || m_header.chunkType == 0x70 ||
-      m_header.chunkType == 0x6b || m_header.chunkType == 0x6a || m_header.chunkType == 0x69 ||
-      m_header.chunkType == 0x66 || m_header.chunkType == 0x65 || m_header.chunkType == 0x2c)
-    m_header.trailer += 8; // 8 byte trailer
+  // Both passes visit the same compressed streams, so decompress each of them only once
+  const std::vector<unsigned char> *cached = m_streamCache.find(offset, length);
+  if (cached)
+  {
+    if (m_parseControl)
+      m_parseControl->addStreamCacheHit(cached->size());
+    return make_unique<VSDInternalStream>(cached->data(), cached->size());
+  }
+  if (m_parseControl)
+    m_parseControl->addStreamCacheMiss();
 
-  m_header.dataLength = readU32(input);
-  m_header.level = readU16(input);
-  m_header.unknown = readU8(input);
+  unsigned long numBytesRead = 0;
+  const unsigned char *buffer = m_input->read(length, numBytesRead);
+  std::vector<unsigned char> data;
+  if (numBytesRead >= 2)
+  {
+    // Counted before the output is allocated, so that a stream over the limit is never expanded
+    if (m_parseControl)
+      m_parseControl->addDecompressedBytes(VSDInternalStream::getDecompressedSize(buffer, numBytesRead));
+    VSDParseTimer timer(m_parseControl, &VisioParseStats::decompressionSeconds);
+    VSDInternalStream::decompress(buffer, numBytesRead, data);
+  }
+  cached = m_streamCache.insert(offset, length, data);
+  if (cached)
+    return make_unique<VSDInternalStream>(cached->data(), cached->size());
+  return make_unique<VSDInternalStream>(std::move(data));
+}
 
-  unsigned trailerChunks [14] = {0x64, 0x65, 0x66, 0x69, 0x6a, 0x6b, 0x6f, 0x71,
-                                 0x92, 0xa9, 0xb4, 0xb6, 0xb9, 0xc7
-                                };
-  // Add word separator under certain circumstances for v11
-  // Below are known conditions, may be more or a simpler pattern
-  if (m_header.list != 0 || (m_header.level == 2 && m_header.unknown == 0x55) ||
-      (m_header.level == 2 && m_header.unknown == 0x54 && m_header.chunkType == 0xaa)
-      || (m_header.level == 3 && m_header.unknown != 0x50 && m_header.unknown != 0x54))
+void libvisio::VSDParser::_prefetchStreams(const std::vector<Pointer> &pointers)
+{
+  struct Job
+  {
+    Job() : offset(0), length(0), raw(), data() {}
+    unsigned offset;
+    unsigned length;
+    std::vector<unsigned char> raw;
+    std::vector<unsigned char> data;
+  };
+
+  std::vector<Job> jobs;
+  for (const auto &ptr : pointers)
   {
-    m_header.trailer += 4;
+    if ((ptr.Format & 2) != 2 || m_streamCache.contains(ptr.Offset, ptr.Length))
+      continue;
+    // The input is not thread-safe, so read the raw bytes here and only decompress them in the workers
+    m_input->seek(ptr.Offset, librevenge::RVNG_SEEK_SET);
+    unsigned long numBytesRead = 0;
+    const unsigned char *buffer = m_input->read(ptr.Length, numBytesRead);
+    if (numBytesRead < 2)
+      continue;
+    jobs.push_back(Job());
+    jobs.back().offset = ptr.Offset;
+    jobs.back().length = ptr.Length;
+    jobs.back().raw.assign(buffer, buffer + numBytesRead);
   }
+  if (jobs.size() < 2)
+    return;
 
-  for (unsigned int trailerChunk : trailerChunks)
+  // Counted before any output is allocated, so that streams over the limit are never expanded
+  if (m_parseControl)
   {
-    if (m_header.chunkType == trailerChunk && m_header.trailer != 12 && m_header.trailer != 4)
-    {
-      m_header.trailer += 4;
-      break;
-    }
+    for (const auto &job : jobs)
+      m_parseControl->addDecompressedBytes(VSDInternalStream::getDecompressedSize(job.raw.data(), job.raw.size()));
   }
 
-  // Some chunks never have a trailer
-  if (m_header.chunkType == 0x1f || m_header.chunkType == 0xc9 ||
-      m_header.chunkType == 0x2d || m_header.chunkType == 0xd1)
+  // One pool serves all the sibling groups of the document
+  if (!m_decompressionPool)
+    m_decompressionPool = make_unique<VSDWorkerPool>(m_decompressionThreads);
   {
-    m_header.trailer = 0;
+    VSDParseTimer timer(m_parseControl, &VisioParseStats::decompressionSeconds);
+    m_decompressionPool->run(jobs.size(), [&jobs](std::size_t i)
+    {
+      VSDInternalStream::decompress(jobs[i].raw.data(), jobs[i].raw.size(), jobs[i].data);
+      std::vector<unsigned char>().swap(jobs[i].raw);
+    });
   }
-  return true;
+
+  for (auto &job : jobs)
+    m_streamCache.insert(job.offset, job.length, job.data);
+}
+
+void libvisio::VSDParser::setStreamCacheLimit(unsigned long maxBytes)
+{
+  m_streamCache.setMaxBytes(maxBytes);
+}
+
+void libvisio::VSDParser::setDecompressionThreads(unsigned threads)
+{
+  m_decompressionThreads = threads;
+}
+
+void libvisio::VSDParser::setSinglePass(bool singlePass)
+{
+  m_singlePass = singlePass;
+}
+
+void libvisio::VSDParser::setPagesOutput(VSDPages *pages)
+{
+  m_pagesOutput = pages;
+}
+
+void libvisio::VSDParser::setProgressive(bool progressive)
+{
+  m_progressive = progressive;
+}
+
+void libvisio::VSDParser::setPageSelection(const std::set<unsigned> &pages, const std::set<std::string> &pageNames)
+{
+  m_pageSelection.select(pages, pageNames);
+}
+
+void libvisio::VSDParser::setParseControl(VSDParseControl *control)
+{
+  m_parseControl = control;
+}
+
+void libvisio::VSDParser::setTextOnly(bool textOnly)
+{
+  m_textOnly = textOnly;
 }
 
 bool libvisio::VSDParser::parseMain()
@@ -110,18 +296,21 @@ bool libvisio::VSDParser::parseMain()
   {
     return false;
   }
-  // Seek to trailer stream pointer
-  m_input->seek(0x24, librevenge::RVNG_SEEK_SET);
-
-  Pointer trailerPointer;
-  readPointer(m_input, trailerPointer);
-  bool compressed = ((trailerPointer.Format & 2) == 2);
-  unsigned shift = 0;
-  if (compressed)
-    shift = 4;
+  if (!buildStreamIndex())
+    return false;
 
-  m_input->seek(trailerPointer.Offset, librevenge::RVNG_SEEK_SET);
-  VSDInternalStream trailerStream(m_input, trailerPointer.Length, compressed);
+  if (m_singlePass && !m_extractStencils && _canParseInSinglePass())
+  {
+    VSD_DEBUG_MSG(("VSDParser::parseMain single pass\n"));
+    if (m_parseControl)
+      m_parseControl->addPass();
+    VSDParseTimer timer(m_parseControl, &VisioParseStats::secondPassSeconds);
+    if (!parseSinglePass())
+      return false;
+
+    m_streamCache.clear();
+    return true;
+  }
 
   std::vector<std::map<unsigned, XForm> > groupXFormsSequence;
   std::vector<std::map<unsigned, unsigned> > groupMembershipsSequence;
@@ -130,96 +319,176 @@ bool libvisio::VSDParser::parseMain()
   VSDStylesCollector stylesCollector(groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders);
   m_collector = &stylesCollector;
   VSD_DEBUG_MSG(("VSDParser::parseMain 1st pass\n"));
-  if (!parseDocument(&trailerStream, shift))
+  m_isStylesPass = true;
+  bool stylesParsed = false;
+  {
+    if (m_parseControl)
+      m_parseControl->addPass();
+    VSDParseTimer timer(m_parseControl, &VisioParseStats::firstPassSeconds);
+    stylesParsed = parseDocument();
+  }
+  m_isStylesPass = false;
+  if (!stylesParsed)
     return false;
 
   _handleLevelChange(0);
 
   VSDStyles styles = stylesCollector.getStyleSheets();
 
-  VSDContentCollector contentCollector(m_painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, m_stencils);
-  m_collector = &contentCollector;
+  const std::unique_ptr<VSDContentCollector> contentCollector =
+    makeContentCollector(m_textOnly, m_painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, m_stencils);
+  contentCollector->setPagesOutput(m_pagesOutput);
+  contentCollector->setProgressive(m_progressive);
+  contentCollector->setParseControl(m_parseControl);
+  m_collector = contentCollector.get();
   if (m_container)
     parseMetaData();
 
   VSD_DEBUG_MSG(("VSDParser::parseMain 2nd pass\n"));
-  if (!parseDocument(&trailerStream, shift))
-    return false;
+  {
+    if (m_parseControl)
+      m_parseControl->addPass();
+    VSDParseTimer timer(m_parseControl, &VisioParseStats::secondPassSeconds);
+    if (!parseDocument())
+      return false;
+  }
+
+  m_streamCache.clear();
 
   return true;
 }
 
-void libvisio::VSDParser::parseMetaData() try
+bool libvisio::VSDParser::parseSinglePass()
 {
-  if (!m_container)
-    return;
-  m_container->seek(0, librevenge::RVNG_SEEK_SET);
-  if (!m_container->isStructured())
-    return;
-  VSDMetaData metaData;
+  std::vector<std::map<unsigned, XForm> > groupXFormsSequence;
+  std::vector<std::map<unsigned, unsigned> > groupMembershipsSequence;
+  std::vector<std::list<unsigned> > documentPageShapeOrders;
+
+  VSDStylesCollector stylesCollector(groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders);
 
-  const RVNGInputStreamPtr_t sumaryInfo(m_container->getSubStreamByName("\x05SummaryInformation"));
-  if (bool(sumaryInfo))
-    metaData.parse(sumaryInfo.get());
+  // The content collector holds iterators into the sequences, while the styles collector keeps appending pages
+  const std::size_t pageCount = m_streamIndex.getPageCount();
+  groupXFormsSequence.reserve(pageCount);
+  groupMembershipsSequence.reserve(pageCount);
+  documentPageShapeOrders.reserve(pageCount);
+
+  // Created at the end of the first page, when style sheets and stencils are complete
+  VSDStyles styles;
+  std::unique_ptr<VSDContentCollector> contentCollector;
+  const auto getContentCollector = [&]() -> VSDCollector &
+  {
+    if (!contentCollector)
+    {
+      styles = stylesCollector.getStyleSheets();
+      contentCollector = makeContentCollector(m_textOnly, m_painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, m_stencils);
+      contentCollector->setPagesOutput(m_pagesOutput);
+      contentCollector->setProgressive(m_progressive);
+      contentCollector->setParseControl(m_parseControl);
+      if (m_container)
+      {
+        VSDCollector *const collector = m_collector;
+        m_collector = contentCollector.get();
+        parseMetaData();
+        m_collector = collector;
+      }
+    }
+    return *contentCollector;
+  };
+
+  VSDDeferredCollector deferredCollector(stylesCollector, getContentCollector);
+  m_collector = &deferredCollector;
+  m_deferredCollector = &deferredCollector;
+  const bool parsed = parseDocument();
+  m_deferredCollector = nullptr;
+  if (!parsed)
+    return false;
 
-  const RVNGInputStreamPtr_t docSumaryInfo(m_container->getSubStreamByName("\005DocumentSummaryInformation"));
-  if (bool(docSumaryInfo))
-    metaData.parse(docSumaryInfo.get());
+  // Only the styles pass ends with a level change
+  m_collector = &stylesCollector;
+  _handleLevelChange(0);
+  deferredCollector.flush();
+  return true;
+}
 
-  m_container->seek(0, librevenge::RVNG_SEEK_SET);
-  metaData.parseTimes(m_container);
-  m_collector->collectMetaData(metaData.getMetaData());
+bool libvisio::VSDParser::_canParseInSinglePass() const
+{
+  // A shared page stream would be walked, and its page collected, more than once
+  if (m_streamIndex.empty() || !m_streamIndex.isTree())
+    return false;
+  int maxRank = 0;
+  return isRankOrdered(m_streamIndex, 0, maxRank);
+}
+
+void libvisio::VSDParser::parseMetaData() try
+{
+  VSDMetaData metaData;
+  if (metaData.parseStorage(m_container))
+    m_collector->collectMetaData(metaData.getMetaData());
 }
 catch (...)
 {
   // Ignore any exceptions in metadata. They are not important enough to stop parsing.
 }
 
-bool libvisio::VSDParser::parseDocument(librevenge::RVNGInputStream *input, unsigned shift)
+bool libvisio::VSDParser::parseDocument()
 {
-  std::set<unsigned> visited;
   try
   {
-    handleStreams(input, VSD_TRAILER_STREAM, shift, 0, visited);
-    assert(visited.empty());
+    if (!m_streamIndex.empty())
+      handleStreams(0, 0);
     return true;
   }
   catch (...)
   {
-    assert(visited.empty());
     return false;
   }
 }
 
-bool libvisio::VSDParser::extractStencils()
+bool libvisio::VSDParser::buildStreamIndex()
 {
-  m_extractStencils = true;
-  return parseMain();
+  return _buildStreamIndex<VSD11Traits>();
 }
 
-void libvisio::VSDParser::readPointer(librevenge::RVNGInputStream *input, Pointer &ptr)
+template<typename Traits>
+bool libvisio::VSDParser::_buildStreamIndex()
 {
-  ptr.Type = readU32(input);
-  input->seek(4, librevenge::RVNG_SEEK_CUR); // Skip dword
-  ptr.Offset = readU32(input);
-  ptr.Length = readU32(input);
-  ptr.Format = readU16(input);
+  m_streamIndex.clear();
+
+  // Seek to trailer stream pointer
+  m_input->seek(0x24, librevenge::RVNG_SEEK_SET);
+  Pointer trailer;
+  Traits::readPointer(m_input, trailer);
+  trailer.Type = VSD_TRAILER_STREAM;
+  m_streamIndex.addEntry(trailer);
+
+  const bool compressed = ((trailer.Format & 2) == 2);
+  std::set<unsigned> visited;
+  try
+  {
+    const std::unique_ptr<VSDInternalStream> trailerStream(_openStream(trailer.Offset, trailer.Length, compressed));
+    _indexStreams<Traits>(trailerStream.get(), 0, compressed ? 4 : 0, visited);
+    assert(visited.empty());
+    return true;
+  }
+  catch (...)
+  {
+    assert(visited.empty());
+    m_streamIndex.clear();
+    return false;
+  }
 }
 
-void libvisio::VSDParser::readPointerInfo(librevenge::RVNGInputStream *input, unsigned /* ptrType */, unsigned shift, unsigned &listSize, int &pointerCount)
+bool libvisio::VSDParser::extractStencils()
 {
-  VSD_DEBUG_MSG(("VSDParser::readPointerInfo\n"));
-  input->seek(shift, librevenge::RVNG_SEEK_SET);
-  unsigned offset = readU32(input);
-  input->seek(offset+shift-4, librevenge::RVNG_SEEK_SET);
-  listSize = readU32(input);
-  pointerCount = readS32(input);
-  input->seek(4, librevenge::RVNG_SEEK_CUR);
+  m_extractStencils = true;
+  return parseMain();
 }
 
-void libvisio::VSDParser::handleStreams(librevenge::RVNGInputStream *input, unsigned ptrType, unsigned shift, unsigned level, std::set<unsigned> &visited)
+template<typename Traits>
+void libvisio::VSDParser::_indexStreams(librevenge::RVNGInputStream *input, unsigned entry, unsigned shift, std::set<unsigned> &visited)
 {
-  VSD_DEBUG_MSG(("VSDParser::HandleStreams\n"));
+  VSD_DEBUG_MSG(("VSDParser::_indexStreams\n"));
+  const unsigned ptrType = m_streamIndex.getEntry(entry).pointer.Type;
   std::vector<unsigned> pointerOrder;
   std::map<unsigned, libvisio::Pointer> PtrList;
   std::map<unsigned, libvisio::Pointer> FontFaces;
@@ -231,11 +500,11 @@ void libvisio::VSDParser::handleStreams(librevenge::RVNGInputStream *input, unsi
     // Parse out pointers to streams
     unsigned listSize = 0;
     int pointerCount = 0;
-    readPointerInfo(input, ptrType, shift, listSize, pointerCount);
+    Traits::readPointerInfo(input, ptrType, shift, listSize, pointerCount);
     for (int i = 0; i < pointerCount; i++)
     {
       Pointer ptr;
-      readPointer(input, ptr);
+      Traits::readPointer(input, ptr);
       if (ptr.Type == 0)
         continue;
 
@@ -261,15 +530,17 @@ void libvisio::VSDParser::handleStreams(librevenge::RVNGInputStream *input, unsi
     NameList.clear();
   }
 
+  // The children in the order in which handleStreams is going to visit them
+  std::vector<std::pair<unsigned, Pointer> > children;
   std::map<unsigned, libvisio::Pointer>::iterator iter;
   for (iter = NameList.begin(); iter != NameList.end(); ++iter)
-    handleStream(iter->second, iter->first, level+1, visited);
+    children.push_back(*iter);
 
   for (iter = NameIDX.begin(); iter != NameIDX.end(); ++iter)
-    handleStream(iter->second, iter->first, level+1, visited);
+    children.push_back(*iter);
 
   for (iter = FontFaces.begin(); iter != FontFaces.end(); ++iter)
-    handleStream(iter->second, iter->first, level+1, visited);
+    children.push_back(*iter);
 
   if (!pointerOrder.empty())
   {
@@ -278,27 +549,92 @@ void libvisio::VSDParser::handleStreams(librevenge::RVNGInputStream *input, unsi
       iter = PtrList.find(j);
       if (iter != PtrList.end())
       {
-        handleStream(iter->second, iter->first, level+1, visited);
+        children.push_back(*iter);
         PtrList.erase(iter);
       }
     }
   }
   for (iter = PtrList.begin(); iter != PtrList.end(); ++iter)
-    handleStream(iter->second, iter->first, level+1, visited);
+    children.push_back(*iter);
+
+  if (m_decompressionThreads > 1)
+  {
+    std::vector<Pointer> siblings;
+    for (const auto &child : children)
+      siblings.push_back(child.second);
+    _prefetchStreams(siblings);
+  }
 
+  unsigned height = 0;
+  for (const auto &child : children)
+  {
+    const Pointer &ptr = child.second;
+    unsigned childEntry = MINUS_ONE;
+    if ((ptr.Format >> 4) != 0x5 || ptr.Type == VSD_COLORS)
+      childEntry = m_streamIndex.addEntry(ptr);
+    else if (visited.count(ptr.Offset))
+    {
+      // Already on the path to this stream; without children, the walk ends there
+      childEntry = m_streamIndex.addEntry(ptr);
+    }
+    else if ((childEntry = m_streamIndex.findEntry(ptr)) != MINUS_ONE)
+    {
+      // Indexed from another pointer list; its streams are as deep below this one as below that
+      if (m_parseControl)
+        m_parseControl->checkStreamDepth((unsigned)visited.size() + m_streamIndex.getEntry(childEntry).height);
+    }
+    else
+    {
+      childEntry = m_streamIndex.addEntry(ptr);
+      visited.insert(ptr.Offset);
+      try
+      {
+        // handleStreams walks this index, so this bounds its recursion too
+        if (m_parseControl)
+          m_parseControl->checkStreamDepth((unsigned)visited.size());
+        const bool compressed = ((ptr.Format & 2) == 2);
+        const std::unique_ptr<VSDInternalStream> tmpInput(_openStream(ptr.Offset, ptr.Length, compressed));
+        _indexStreams<Traits>(tmpInput.get(), childEntry, compressed ? 4 : 0, visited);
+      }
+      catch (...)
+      {
+        visited.erase(ptr.Offset);
+        throw;
+      }
+      visited.erase(ptr.Offset);
+    }
+    m_streamIndex.addChild(entry, child.first, childEntry);
+    height = std::max(height, m_streamIndex.getEntry(childEntry).height);
+  }
+  m_streamIndex.setComplete(entry, height + 1);
 }
 
-void libvisio::VSDParser::handleStream(const Pointer &ptr, unsigned idx, unsigned level, std::set<unsigned> &visited)
+void libvisio::VSDParser::handleStreams(unsigned entry, unsigned level)
 {
+  VSD_DEBUG_MSG(("VSDParser::HandleStreams\n"));
+  for (const auto &child : m_streamIndex.getEntry(entry).children)
+  {
+    if (m_parseControl)
+      m_parseControl->addStream();
+    handleStream(child.entry, child.id, level+1);
+  }
+}
+
+void libvisio::VSDParser::handleStream(unsigned entry, unsigned idx, unsigned level)
+{
+  const Pointer &ptr = m_streamIndex.getEntry(entry).pointer;
   VSD_DEBUG_MSG(("VSDParser::HandleStream %u type 0x%x\n", idx, ptr.Type));
   m_header.level = level;
   m_header.id = idx;
   m_header.chunkType = ptr.Type;
   _handleLevelChange(level);
+  // Pages that are not selected are not even decompressed
+  if (ptr.Type == VSD_PAGE && (ptr.Format & 0x1) && !m_extractStencils && !_isPageSelected(idx, level))
+    return;
   VSDStencil tmpStencil;
   bool compressed = ((ptr.Format & 2) == 2);
-  m_input->seek(ptr.Offset, librevenge::RVNG_SEEK_SET);
-  VSDInternalStream tmpInput(m_input, ptr.Length, compressed);
+  const std::unique_ptr<VSDInternalStream> stream(_openStream(ptr.Offset, ptr.Length, compressed));
+  VSDCursor tmpInput(stream->getDataBuffer(), stream->getSize());
   m_header.dataLength = tmpInput.getSize();
   unsigned shift = compressed ? 4 : 0;
   switch (ptr.Type)
@@ -309,6 +645,7 @@ void libvisio::VSDParser::handleStream(const Pointer &ptr, unsigned idx, unsigne
   case VSD_PAGES:
     if (m_extractStencils)
       return;
+    m_pageSelection.reset();
     break;
   case VSD_PAGE:
     if (m_extractStencils)
@@ -326,6 +663,8 @@ void libvisio::VSDParser::handleStream(const Pointer &ptr, unsigned idx, unsigne
     if (m_stencils.count())
       return;
     m_isStencilStarted = true;
+    if (m_deferredCollector)
+      m_deferredCollector->setMark();
     break;
   case VSD_STENCIL_PAGE:
     if (m_extractStencils)
@@ -355,22 +694,7 @@ void libvisio::VSDParser::handleStream(const Pointer &ptr, unsigned idx, unsigne
   {
     handleBlob(&tmpInput, shift, level+1);
     if ((ptr.Format >> 4) == 0x5 && ptr.Type != VSD_COLORS)
-    {
-      const auto it = visited.insert(ptr.Offset);
-      if (it.second)
-      {
-        try
-        {
-          handleStreams(&tmpInput, ptr.Type, shift, level+1, visited);
-        }
-        catch (...)
-        {
-          visited.erase(it.first);
-          throw;
-        }
-        visited.erase(it.first);
-      }
-    }
+      handleStreams(entry, level+1);
   }
   else if ((ptr.Format >> 4) == 0xd || (ptr.Format >> 4) == 0xc || (ptr.Format >> 4) == 0x8)
     handleChunks(&tmpInput, level+1);
@@ -394,7 +718,15 @@ void libvisio::VSDParser::handleStream(const Pointer &ptr, unsigned idx, unsigne
     if (m_extractStencils)
       m_collector->endPages();
     else
+    {
       m_isStencilStarted = false;
+      // A second pass returns before the stencils once there are some
+      if (m_deferredCollector && m_stencils.count())
+      {
+        m_deferredCollector->rewindToMark();
+        m_currentLevel = level;
+      }
+    }
     break;
   case VSD_STENCIL_PAGE:
     _handleLevelChange(0);
@@ -422,29 +754,48 @@ void libvisio::VSDParser::handleStream(const Pointer &ptr, unsigned idx, unsigne
 
 }
 
-void libvisio::VSDParser::handleBlob(librevenge::RVNGInputStream *input, unsigned shift, unsigned level)
+bool libvisio::VSDParser::_isPageSelected(unsigned id, unsigned level)
 {
-  try
+  if (m_pageSelection.selectsAll())
+    return true;
+  librevenge::RVNGString name;
+  if (m_pageSelection.needsNames())
   {
-    m_header.level = level;
-    input->seek(shift, librevenge::RVNG_SEEK_SET);
-    m_header.dataLength -= shift;
-    _handleLevelChange(m_header.level);
-    handleChunk(input);
+    VSDName pageName;
+    _nameFromId(pageName, id, level+1);
+    name = VSDContentCollector::nameToString(pageName);
   }
-  catch (EndOfStreamException &)
+  return m_pageSelection.nextPage(name.cstr());
+}
+
+void libvisio::VSDParser::handleBlob(VSDCursor *input, unsigned shift, unsigned level)
+{
+  m_header.level = level;
+  input->seek(shift, librevenge::RVNG_SEEK_SET);
+  m_header.dataLength -= shift;
+  _handleLevelChange(m_header.level);
+  handleChunk(input);
+  if (input->isTruncated())
   {
-    VSD_DEBUG_MSG(("VSDParser::handleBlob - catching EndOfStreamException\n"));
+    VSD_DEBUG_MSG(("VSDParser::handleBlob - truncated blob of type 0x%x\n", m_header.chunkType));
   }
 }
 
-void libvisio::VSDParser::handleChunks(librevenge::RVNGInputStream *input, unsigned level)
+void libvisio::VSDParser::handleChunks(VSDCursor *input, unsigned level)
+{
+  _handleChunks<VSD11Traits>(input, level);
+}
+
+template<typename Traits>
+void libvisio::VSDParser::_handleChunks(VSDCursor *input, unsigned level)
 {
   long endPos = 0;
 
   while (!input->isEnd())
   {
-    if (!getChunkHeader(input))
+    if (m_parseControl)
+      m_parseControl->addChunk();
+    if (!Traits::getChunkHeader(input, m_header) || input->isTruncated())
       return;
     m_header.level += level;
     endPos = m_header.dataLength+m_header.trailer+input->tell();
@@ -452,12 +803,28 @@ void libvisio::VSDParser::handleChunks(librevenge::RVNGInputStream *input, unsig
     _handleLevelChange(m_header.level);
     VSD_DEBUG_MSG(("VSDParser::handleChunks - parsing chunk type 0x%x\n", m_header.chunkType));
     handleChunk(input);
+    if (input->isTruncated())
+    {
+      // The chunk ran past the end of the stream, so there is nothing left to read
+      VSD_DEBUG_MSG(("VSDParser::handleChunks - truncated chunk of type 0x%x\n", m_header.chunkType));
+      return;
+    }
     input->seek(endPos, librevenge::RVNG_SEEK_SET);
   }
 }
 
-void libvisio::VSDParser::handleChunk(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::handleChunk(VSDCursor *input)
 {
+  // Stencils are only read in the styles pass, so they are never skipped
+  if (m_isStylesPass && !m_isStencilStarted && !m_isInStyles && isSkippedInStylesPass(m_header.chunkType))
+  {
+    // Lists still report their level, as their readers would; the caller skips the chunk by its length
+    if (m_header.chunkType == VSD_GEOM_LIST || m_header.chunkType == VSD_CHAR_LIST ||
+        m_header.chunkType == VSD_PARA_LIST || m_header.chunkType == VSD_TABS_DATA_LIST)
+      m_collector->collectUnhandledChunk(m_header.id, m_header.level);
+    return;
+  }
+
   switch (m_header.chunkType)
   {
   case VSD_SHAPE_GROUP:
@@ -742,7 +1109,7 @@ void libvisio::VSDParser::_handleLevelChange(unsigned level)
 
 // --- READERS ---
 
-void libvisio::VSDParser::readEllipticalArcTo(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readEllipticalArcTo(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double x3 = readDouble(input); // End x
@@ -756,14 +1123,18 @@ void libvisio::VSDParser::readEllipticalArcTo(librevenge::RVNGInputStream *input
   double angle = readDouble(input); // Angle
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double ecc = readDouble(input); // Eccentricity
+  if (input->isTruncated())
+    return;
 
   if (m_currentGeometryList)
     m_currentGeometryList->addEllipticalArcTo(m_header.id, m_header.level, x3, y3, x2, y2, angle, ecc);
 }
 
 
-void libvisio::VSDParser::readForeignData(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readForeignData(VSDCursor *input)
 {
+  if (m_textOnly)
+    return;
   unsigned long tmpBytesRead = 0;
   const unsigned char *buffer = input->read(m_header.dataLength, tmpBytesRead);
   if (m_header.dataLength != tmpBytesRead)
@@ -776,12 +1147,14 @@ void libvisio::VSDParser::readForeignData(librevenge::RVNGInputStream *input)
   m_shape.m_foreign->data = binaryData;
 }
 
-void libvisio::VSDParser::readOLEList(librevenge::RVNGInputStream * /* input */)
+void libvisio::VSDParser::readOLEList(VSDCursor * /* input */)
 {
 }
 
-void libvisio::VSDParser::readOLEData(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readOLEData(VSDCursor *input)
 {
+  if (m_textOnly)
+    return;
   unsigned long tmpBytesRead = 0;
   const unsigned char *buffer = input->read(m_header.dataLength, tmpBytesRead);
   if (m_header.dataLength != tmpBytesRead)
@@ -795,21 +1168,30 @@ void libvisio::VSDParser::readOLEData(librevenge::RVNGInputStream *input)
 
 }
 
-void libvisio::VSDParser::readTabsData(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readTabsData(VSDCursor *input)
 {
-  m_shape.m_tabSets[m_header.id].m_numChars = getUInt(input);
+  const unsigned numChars = getUInt(input);
   unsigned char numStops = readU8(input);
-  m_shape.m_tabSets[m_header.id].m_tabStops.clear();
+  if (input->isTruncated())
+    return;
+  VSDTabSet &tabSet = m_shape.m_tabSets[m_header.id];
+  tabSet.m_numChars = numChars;
+  tabSet.m_tabStops.clear();
   for (unsigned char i = 0; i < numStops; ++i)
   {
     input->seek(1, librevenge::RVNG_SEEK_CUR);
-    m_shape.m_tabSets[m_header.id].m_tabStops[i].m_position = readDouble(input);
-    m_shape.m_tabSets[m_header.id].m_tabStops[i].m_alignment = readU8(input);
-    m_shape.m_tabSets[m_header.id].m_tabStops[i].m_leader = readU8(input);
+    const double position = readDouble(input);
+    const unsigned char alignment = readU8(input);
+    const unsigned char leader = readU8(input);
+    if (input->isTruncated())
+      return;
+    tabSet.m_tabStops[i].m_position = position;
+    tabSet.m_tabStops[i].m_alignment = alignment;
+    tabSet.m_tabStops[i].m_leader = leader;
   }
 }
 
-void libvisio::VSDParser::readNameIDX(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readNameIDX(VSDCursor *input)
 {
   std::map<unsigned, VSDName> names;
   unsigned recordCount = readU32(input);
@@ -828,10 +1210,12 @@ void libvisio::VSDParser::readNameIDX(librevenge::RVNGInputStream *input)
     if (iter != m_names.end())
       names[elementId] = iter->second;
   }
+  if (input->isTruncated())
+    return;
   m_namesMapMap[m_header.level] = names;
 }
 
-void libvisio::VSDParser::readNameIDX123(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readNameIDX123(VSDCursor *input)
 {
   std::map<unsigned, VSDName> names;
   long endPosition = input->tell() + m_header.dataLength;
@@ -843,11 +1227,13 @@ void libvisio::VSDParser::readNameIDX123(librevenge::RVNGInputStream *input)
     if (iter != m_names.end())
       names[elementId] = iter->second;
   }
+  if (input->isTruncated())
+    return;
   m_namesMapMap[m_header.level] = names;
 
 }
 
-void libvisio::VSDParser::readEllipse(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readEllipse(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double cx = readDouble(input);
@@ -861,12 +1247,14 @@ void libvisio::VSDParser::readEllipse(librevenge::RVNGInputStream *input)
   double xtop = readDouble(input);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double ytop = readDouble(input);
+  if (input->isTruncated())
+    return;
 
   if (m_currentGeometryList)
     m_currentGeometryList->addEllipse(m_header.id, m_header.level, cx, cy, xleft, yleft, xtop, ytop);
 }
 
-void libvisio::VSDParser::readLine(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readLine(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double strokeWidth = readDouble(input);
@@ -883,6 +1271,8 @@ void libvisio::VSDParser::readLine(librevenge::RVNGInputStream *input)
   unsigned char startMarker = readU8(input);
   unsigned char endMarker = readU8(input);
   unsigned char lineCap = readU8(input);
+  if (input->isTruncated())
+    return;
 
   if (m_isInStyles)
     m_collector->collectLineStyle(m_header.level, strokeWidth, c, linePattern, startMarker, endMarker, lineCap, rounding, -1, -1);
@@ -890,7 +1280,7 @@ void libvisio::VSDParser::readLine(librevenge::RVNGInputStream *input)
     m_shape.m_lineStyle.override(VSDOptionalLineStyle(strokeWidth, c, linePattern, startMarker, endMarker, lineCap, rounding, -1, -1));
 }
 
-void libvisio::VSDParser::readTextBlock(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readTextBlock(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double leftMargin = readDouble(input);
@@ -912,6 +1302,8 @@ void libvisio::VSDParser::readTextBlock(librevenge::RVNGInputStream *input)
   double defaultTabStop = readDouble(input);
   input->seek(12, librevenge::RVNG_SEEK_CUR);
   unsigned char textDirection = readU8(input);
+  if (input->isTruncated())
+    return;
 
   if (m_isInStyles)
     m_collector->collectTextBlockStyle(m_header.level, leftMargin, rightMargin, topMargin, bottomMargin,
@@ -921,7 +1313,7 @@ void libvisio::VSDParser::readTextBlock(librevenge::RVNGInputStream *input)
                                                                 verticalAlign, isBgFilled, c, defaultTabStop, textDirection));
 }
 
-void libvisio::VSDParser::readGeomList(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readGeomList(VSDCursor *input)
 {
   if (!m_shape.m_geometries.empty() && m_currentGeometryList && m_currentGeometryList->empty())
     m_shape.m_geometries.erase(--m_currentGeomListCount);
@@ -942,6 +1334,8 @@ void libvisio::VSDParser::readGeomList(librevenge::RVNGInputStream *input)
     for (size_t i = 0; i < (childrenListLength / sizeof(uint32_t)); i++)
       geometryOrder.push_back(readU32(input));
 
+    if (input->isTruncated())
+      return;
     if (m_currentGeometryList)
       m_currentGeometryList->setElementsOrder(geometryOrder);
   }
@@ -951,7 +1345,7 @@ void libvisio::VSDParser::readGeomList(librevenge::RVNGInputStream *input)
     m_collector->collectUnhandledChunk(m_header.id, m_header.level);
 }
 
-void libvisio::VSDParser::readCharList(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readCharList(VSDCursor *input)
 {
   // We want the collectors to still get the level information
   if (!m_isStencilStarted)
@@ -969,11 +1363,13 @@ void libvisio::VSDParser::readCharList(librevenge::RVNGInputStream *input)
     for (size_t i = 0; i < (childrenListLength / sizeof(uint32_t)); i++)
       characterOrder.push_back(readU32(input));
 
+    if (input->isTruncated())
+      return;
     m_shape.m_charList.setElementsOrder(characterOrder);
   }
 }
 
-void libvisio::VSDParser::readParaList(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readParaList(VSDCursor *input)
 {
   // We want the collectors to still get the level information
   if (!m_isStencilStarted)
@@ -991,15 +1387,17 @@ void libvisio::VSDParser::readParaList(librevenge::RVNGInputStream *input)
     for (size_t i = 0; i < (childrenListLength / sizeof(uint32_t)); i++)
       paragraphOrder.push_back(readU32(input));
 
+    if (input->isTruncated())
+      return;
     m_shape.m_paraList.setElementsOrder(paragraphOrder);
   }
 }
 
-void libvisio::VSDParser::readPropList(librevenge::RVNGInputStream * /* input */)
+void libvisio::VSDParser::readPropList(VSDCursor * /* input */)
 {
 }
 
-void libvisio::VSDParser::readTabsDataList(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readTabsDataList(VSDCursor *input)
 {
   // We want the collectors to still get the level information
   if (!m_isStencilStarted)
@@ -1019,7 +1417,7 @@ void libvisio::VSDParser::readTabsDataList(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSDParser::readLayerList(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readLayerList(VSDCursor *input)
 {
   // We want the collectors to still get the level information
   if (!m_isStencilStarted)
@@ -1039,7 +1437,7 @@ void libvisio::VSDParser::readLayerList(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSDParser::readLayer(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readLayer(VSDCursor *input)
 {
   libvisio::VSDLayer layer;
   input->seek(8, librevenge::RVNG_SEEK_CUR);
@@ -1058,11 +1456,13 @@ void libvisio::VSDParser::readLayer(librevenge::RVNGInputStream *input)
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   layer.m_visible = !!readU8(input);
   layer.m_printable = !!readU8(input);
+  if (input->isTruncated())
+    return;
 
   m_collector->collectLayer(m_header.id, m_header.level, layer);
 }
 
-void libvisio::VSDParser::readLayerMem(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readLayerMem(VSDCursor *input)
 {
   input->seek(13, librevenge::RVNG_SEEK_CUR);
   unsigned textLength = readU8(input);
@@ -1079,47 +1479,55 @@ void libvisio::VSDParser::readLayerMem(librevenge::RVNGInputStream *input)
 
 }
 
-void libvisio::VSDParser::readPage(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readPage(VSDCursor *input)
 {
   input->seek(8, librevenge::RVNG_SEEK_CUR); //sub header length and children list length
   unsigned backgroundPageID = readU32(input);
+  if (input->isTruncated())
+    return;
   m_collector->collectPage(m_header.id, m_header.level, backgroundPageID, m_isBackgroundPage, m_currentPageName);
 }
 
-void libvisio::VSDParser::readGeometry(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readGeometry(VSDCursor *input)
 {
   unsigned char geomFlags = readU8(input);
   bool noFill = (!!(geomFlags & 1));
   bool noLine = (!!(geomFlags & 2));
   bool noShow = (!!(geomFlags & 4));
+  if (input->isTruncated())
+    return;
 
   if (m_currentGeometryList)
     m_currentGeometryList->addGeometry(m_header.id, m_header.level, noFill, noLine, noShow);
 }
 
-void libvisio::VSDParser::readMoveTo(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readMoveTo(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double x = readDouble(input);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double y = readDouble(input);
+  if (input->isTruncated())
+    return;
 
   if (m_currentGeometryList)
     m_currentGeometryList->addMoveTo(m_header.id, m_header.level, x, y);
 }
 
-void libvisio::VSDParser::readLineTo(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readLineTo(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double x = readDouble(input);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double y = readDouble(input);
+  if (input->isTruncated())
+    return;
 
   if (m_currentGeometryList)
     m_currentGeometryList->addLineTo(m_header.id, m_header.level, x, y);
 }
 
-void libvisio::VSDParser::readArcTo(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readArcTo(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double x2 = readDouble(input);
@@ -1127,73 +1535,78 @@ void libvisio::VSDParser::readArcTo(librevenge::RVNGInputStream *input)
   double y2 = readDouble(input);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double bow = readDouble(input);
+  if (input->isTruncated())
+    return;
 
   if (m_currentGeometryList)
     m_currentGeometryList->addArcTo(m_header.id, m_header.level, x2, y2, bow);
 }
 
-void libvisio::VSDParser::readXFormData(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readXFormData(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform.pinX = readDouble(input);
+  setField(input, m_shape.m_xform.pinX, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform.pinY = readDouble(input);
+  setField(input, m_shape.m_xform.pinY, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform.width = readDouble(input);
+  setField(input, m_shape.m_xform.width, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform.height = readDouble(input);
+  setField(input, m_shape.m_xform.height, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform.pinLocX = readDouble(input);
+  setField(input, m_shape.m_xform.pinLocX, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform.pinLocY = readDouble(input);
+  setField(input, m_shape.m_xform.pinLocY, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform.angle = readDouble(input);
-  m_shape.m_xform.flipX = !!readU8(input);
-  m_shape.m_xform.flipY = !!readU8(input);
+  setField(input, m_shape.m_xform.angle, readDouble(input));
+  setField(input, m_shape.m_xform.flipX, !!readU8(input));
+  setField(input, m_shape.m_xform.flipY, !!readU8(input));
 }
 
-void libvisio::VSDParser::readXForm1D(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readXForm1D(VSDCursor *input)
 {
   if (!m_shape.m_xform1d)
     m_shape.m_xform1d = make_unique<XForm1D>();
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform1d->beginX = readDouble(input);
+  setField(input, m_shape.m_xform1d->beginX, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform1d->beginY = readDouble(input);
+  setField(input, m_shape.m_xform1d->beginY, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform1d->endX = readDouble(input);
+  setField(input, m_shape.m_xform1d->endX, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_xform1d->endY = readDouble(input);
+  setField(input, m_shape.m_xform1d->endY, readDouble(input));
 }
 
-void libvisio::VSDParser::readTxtXForm(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readTxtXForm(VSDCursor *input)
 {
   m_shape.m_txtxform = make_unique<XForm>();
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_txtxform->pinX = readDouble(input);
+  setField(input, m_shape.m_txtxform->pinX, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_txtxform->pinY = readDouble(input);
+  setField(input, m_shape.m_txtxform->pinY, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_txtxform->width = readDouble(input);
+  setField(input, m_shape.m_txtxform->width, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_txtxform->height = readDouble(input);
+  setField(input, m_shape.m_txtxform->height, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_txtxform->pinLocX = readDouble(input);
+  setField(input, m_shape.m_txtxform->pinLocX, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_txtxform->pinLocY = readDouble(input);
+  setField(input, m_shape.m_txtxform->pinLocY, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shape.m_txtxform->angle = readDouble(input);
+  setField(input, m_shape.m_txtxform->angle, readDouble(input));
 }
 
-void libvisio::VSDParser::readShapeId(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readShapeId(VSDCursor *input)
 {
+  const unsigned shapeId = getUInt(input);
+  if (input->isTruncated())
+    return;
   if (!m_isShapeStarted)
-    m_shapeList.addShapeId(m_header.id, getUInt(input));
+    m_shapeList.addShapeId(m_header.id, shapeId);
   else
-    m_shape.m_shapeList.addShapeId(m_header.id, getUInt(input));
+    m_shape.m_shapeList.addShapeId(m_header.id, shapeId);
 }
 
-void libvisio::VSDParser::readShapeList(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readShapeList(VSDCursor *input)
 {
   // We want the collectors to still get the level information
   m_collector->collectUnhandledChunk(m_header.id, m_header.level);
@@ -1210,6 +1623,8 @@ void libvisio::VSDParser::readShapeList(librevenge::RVNGInputStream *input)
     for (size_t i = 0; i < (childrenListLength / sizeof(uint32_t)); i++)
       shapeOrder.push_back(readU32(input));
 
+    if (input->isTruncated())
+      return;
     if (!m_isShapeStarted)
       m_shapeList.setElementsOrder(shapeOrder);
     else
@@ -1217,7 +1632,7 @@ void libvisio::VSDParser::readShapeList(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSDParser::readForeignDataType(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readForeignDataType(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double imgOffsetX = readDouble(input);
@@ -1233,6 +1648,8 @@ void libvisio::VSDParser::readForeignDataType(librevenge::RVNGInputStream *input
     foreignType = 0x4;
   input->seek(0x9, librevenge::RVNG_SEEK_CUR);
   unsigned foreignFormat = readU32(input);
+  if (input->isTruncated())
+    return;
 
   if (!m_shape.m_foreign)
     m_shape.m_foreign = make_unique<ForeignData>();
@@ -1245,7 +1662,7 @@ void libvisio::VSDParser::readForeignDataType(librevenge::RVNGInputStream *input
   m_shape.m_foreign->height = imgHeight;
 }
 
-void libvisio::VSDParser::readPageProps(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readPageProps(VSDCursor *input)
 {
   // Skip bytes representing unit to *display* (value is always inches)
   input->seek(1, librevenge::RVNG_SEEK_CUR);
@@ -1253,15 +1670,17 @@ void libvisio::VSDParser::readPageProps(librevenge::RVNGInputStream *input)
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   const double pageHeight = std::max<double>(readDouble(input), 0);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shadowOffsetX = readDouble(input);
+  setField(input, m_shadowOffsetX, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
-  m_shadowOffsetY = readDouble(input);
+  setField(input, m_shadowOffsetY, readDouble(input));
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   const double numerator = readDouble(input);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double denominator = readDouble(input);
   if (VSD_ALMOST_ZERO(denominator))
     denominator = 1;
+  if (input->isTruncated())
+    return;
 
   const double scale = std::abs(numerator / denominator);
 
@@ -1273,7 +1692,7 @@ void libvisio::VSDParser::readPageProps(librevenge::RVNGInputStream *input)
   m_collector->collectPageProps(m_header.id, m_header.level, pageWidth, pageHeight, m_shadowOffsetX, m_shadowOffsetY, scale);
 }
 
-void libvisio::VSDParser::readShape(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readShape(VSDCursor *input)
 {
   m_currentGeomListCount = 0;
   m_isShapeStarted = true;
@@ -1288,24 +1707,25 @@ void libvisio::VSDParser::readShape(librevenge::RVNGInputStream *input)
   auto fillStyle = MINUS_ONE;
   auto textStyle = MINUS_ONE;
 
-  try
+  // Fields past the end of a truncated chunk keep their defaults
+  const auto readField = [input](unsigned &field)
   {
-    input->seek(10, librevenge::RVNG_SEEK_CUR);
-    parent = readU32(input);
-    input->seek(4, librevenge::RVNG_SEEK_CUR);
-    masterPage = readU32(input);
-    input->seek(4, librevenge::RVNG_SEEK_CUR);
-    masterShape = readU32(input);
-    input->seek(0x4, librevenge::RVNG_SEEK_CUR);
-    fillStyle = readU32(input);
-    input->seek(4, librevenge::RVNG_SEEK_CUR);
-    lineStyle = readU32(input);
-    input->seek(4, librevenge::RVNG_SEEK_CUR);
-    textStyle = readU32(input);
-  }
-  catch (const EndOfStreamException &)
-  {
-  }
+    const unsigned value = readU32(input);
+    if (!input->isTruncated())
+      field = value;
+  };
+  input->seek(10, librevenge::RVNG_SEEK_CUR);
+  readField(parent);
+  input->seek(4, librevenge::RVNG_SEEK_CUR);
+  readField(masterPage);
+  input->seek(4, librevenge::RVNG_SEEK_CUR);
+  readField(masterShape);
+  input->seek(0x4, librevenge::RVNG_SEEK_CUR);
+  readField(fillStyle);
+  input->seek(4, librevenge::RVNG_SEEK_CUR);
+  readField(lineStyle);
+  input->seek(4, librevenge::RVNG_SEEK_CUR);
+  readField(textStyle);
 
   m_shape.clear();
   m_currentGeometryList = nullptr;
@@ -1333,7 +1753,7 @@ void libvisio::VSDParser::readShape(librevenge::RVNGInputStream *input)
   m_currentShapeID = MINUS_ONE;
 }
 
-void libvisio::VSDParser::readNURBSTo(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readNURBSTo(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double x = readDouble(input);
@@ -1351,6 +1771,8 @@ void libvisio::VSDParser::readNURBSTo(librevenge::RVNGInputStream *input)
   {
     input->seek(3, librevenge::RVNG_SEEK_CUR);
     unsigned dataId = readU32(input);
+    if (input->isTruncated())
+      return;
 
     if (m_currentGeometryList)
       m_currentGeometryList->addNURBSTo(m_header.id, m_header.level, x, y, knot, knotPrev, weight, weightPrev, dataId);
@@ -1428,7 +1850,7 @@ void libvisio::VSDParser::readNURBSTo(librevenge::RVNGInputStream *input)
     unsigned long bytesRead = input->tell() - inputPos;
     unsigned char flag = 0;
     if (paramType != 0x8a) flag = readU8(input);
-    while ((paramType == 0x8a ? repetitions > 0 : flag != 0x81) && bytesRead < length)
+    while ((paramType == 0x8a ? repetitions > 0 : flag != 0x81) && bytesRead < length && !input->isTruncated())
     {
       inputPos = input->tell();
       double knot_ = 0;
@@ -1480,6 +1902,8 @@ void libvisio::VSDParser::readNURBSTo(librevenge::RVNGInputStream *input)
     knotVector.push_back(knot);
     knotVector.push_back(lastKnot);
     weights.push_back(weight);
+    if (input->isTruncated())
+      return;
 
     if (m_currentGeometryList)
       m_currentGeometryList->addNURBSTo(m_header.id, m_header.level, x, y, xType,
@@ -1492,7 +1916,7 @@ void libvisio::VSDParser::readNURBSTo(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSDParser::readPolylineTo(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readPolylineTo(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double x = readDouble(input);
@@ -1506,6 +1930,8 @@ void libvisio::VSDParser::readPolylineTo(librevenge::RVNGInputStream *input)
   {
     input->seek(3, librevenge::RVNG_SEEK_CUR);
     unsigned dataId = readU32(input);
+    if (input->isTruncated())
+      return;
 
     if (m_currentGeometryList)
       m_currentGeometryList->addPolylineTo(m_header.id, m_header.level, x, y, dataId);
@@ -1557,7 +1983,7 @@ void libvisio::VSDParser::readPolylineTo(librevenge::RVNGInputStream *input)
     unsigned flag = readU8(input);
     unsigned valueType = 0; // Holds parameter type indicator
     blockBytesRead += input->tell() - inputPos;
-    while (flag != 0x81 && blockBytesRead < length)
+    while (flag != 0x81 && blockBytesRead < length && !input->isTruncated())
     {
       inputPos = input->tell();
       double x2 = 0;
@@ -1579,6 +2005,8 @@ void libvisio::VSDParser::readPolylineTo(librevenge::RVNGInputStream *input)
       flag = readU8(input);
       blockBytesRead += input->tell() - inputPos;
     }
+    if (input->isTruncated())
+      return;
 
     if (m_currentGeometryList)
       m_currentGeometryList->addPolylineTo(m_header.id, m_header.level, x, y, xType,
@@ -1591,7 +2019,7 @@ void libvisio::VSDParser::readPolylineTo(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSDParser::readInfiniteLine(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readInfiniteLine(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double x1 = readDouble(input);
@@ -1601,11 +2029,13 @@ void libvisio::VSDParser::readInfiniteLine(librevenge::RVNGInputStream *input)
   double x2 = readDouble(input);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double y2 = readDouble(input);
+  if (input->isTruncated())
+    return;
   if (m_currentGeometryList)
     m_currentGeometryList->addInfiniteLine(m_header.id, m_header.level, x1, y1, x2, y2);
 }
 
-void libvisio::VSDParser::readShapeData(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readShapeData(VSDCursor *input)
 {
   unsigned char dataType = readU8(input);
 
@@ -1626,6 +2056,8 @@ void libvisio::VSDParser::readShapeData(librevenge::RVNGInputStream *input)
       double y = readDouble(input);
       points.push_back(std::pair<double, double>(x, y));
     }
+    if (input->isTruncated())
+      return;
 
     PolylineData data;
     data.xType = xType;
@@ -1661,6 +2093,8 @@ void libvisio::VSDParser::readShapeData(librevenge::RVNGInputStream *input)
       weights.push_back(weight);
       controlPoints.push_back(std::pair<double, double>(controlX, controlY));
     }
+    if (input->isTruncated())
+      return;
 
     NURBSData data;
     data.lastKnot = lastKnot;
@@ -1674,7 +2108,7 @@ void libvisio::VSDParser::readShapeData(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSDParser::readSplineStart(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readSplineStart(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double x = readDouble(input);
@@ -1684,34 +2118,38 @@ void libvisio::VSDParser::readSplineStart(librevenge::RVNGInputStream *input)
   double firstKnot = readDouble(input);
   double lastKnot = readDouble(input);
   unsigned degree = readU8(input);
+  if (input->isTruncated())
+    return;
 
   if (m_currentGeometryList)
     m_currentGeometryList->addSplineStart(m_header.id, m_header.level, x, y, secondKnot, firstKnot, lastKnot, degree);
 }
 
-void libvisio::VSDParser::readSplineKnot(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readSplineKnot(VSDCursor *input)
 {
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double x = readDouble(input);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
   double y = readDouble(input);
   double knot = readDouble(input);
+  if (input->isTruncated())
+    return;
 
   if (m_currentGeometryList)
     m_currentGeometryList->addSplineKnot(m_header.id, m_header.level, x, y, knot);
 }
 
-void libvisio::VSDParser::readNameList(librevenge::RVNGInputStream * /* input */)
+void libvisio::VSDParser::readNameList(VSDCursor * /* input */)
 {
   m_shape.m_names.clear();
 }
 
-void libvisio::VSDParser::readNameList2(librevenge::RVNGInputStream * /* input */)
+void libvisio::VSDParser::readNameList2(VSDCursor * /* input */)
 {
   m_names.clear();
 }
 
-void libvisio::VSDParser::readFieldList(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readFieldList(VSDCursor *input)
 {
   if (m_header.trailer)
   {
@@ -1725,16 +2163,20 @@ void libvisio::VSDParser::readFieldList(librevenge::RVNGInputStream *input)
     for (size_t i = 0; i < (childrenListLength / sizeof(uint32_t)); i++)
       fieldOrder.push_back(readU32(input));
 
+    if (input->isTruncated())
+      return;
     m_shape.m_fields.setElementsOrder(fieldOrder);
     m_shape.m_fields.addFieldList(m_header.id, m_header.level);
   }
 }
 
-void libvisio::VSDParser::readColours(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readColours(VSDCursor *input)
 {
   input->seek(2, librevenge::RVNG_SEEK_CUR);
   unsigned numColours = readU8(input);
   input->seek(1, librevenge::RVNG_SEEK_CUR);
+  if (input->isTruncated())
+    return;
   m_colours.clear();
 
   for (unsigned i = 0; i < numColours; i++)
@@ -1744,12 +2186,14 @@ void libvisio::VSDParser::readColours(librevenge::RVNGInputStream *input)
     tmpColour.g = readU8(input);
     tmpColour.b = readU8(input);
     tmpColour.a = readU8(input);
+    if (input->isTruncated())
+      return;
 
     m_colours.push_back(tmpColour);
   }
 }
 
-void libvisio::VSDParser::readFont(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readFont(VSDCursor *input)
 {
   input->seek(4, librevenge::RVNG_SEEK_CUR);
   librevenge::RVNGBinaryData textStream;
@@ -1763,10 +2207,12 @@ void libvisio::VSDParser::readFont(librevenge::RVNGInputStream *input)
     textStream.append(curchar);
     textStream.append(nextchar);
   }
+  if (input->isTruncated())
+    return;
   m_fonts[m_header.id] = VSDName(textStream, libvisio::VSD_TEXT_UTF16);
 }
 
-void libvisio::VSDParser::readFontIX(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readFontIX(VSDCursor *input)
 {
   long tmpAdjust = input->tell();
   input->seek(2, librevenge::RVNG_SEEK_CUR);
@@ -1782,6 +2228,8 @@ void libvisio::VSDParser::readFontIX(librevenge::RVNGInputStream *input)
       break;
     fontName.append(1, curchar);
   }
+  if (input->isTruncated())
+    return;
 
   if (!codePage)
   {
@@ -1881,7 +2329,7 @@ void libvisio::VSDParser::readFontIX(librevenge::RVNGInputStream *input)
 
 /* StyleSheet readers */
 
-void libvisio::VSDParser::readStyleSheet(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readStyleSheet(VSDCursor *input)
 {
   input->seek(0x22, librevenge::RVNG_SEEK_CUR);
   unsigned lineStyle = readU32(input);
@@ -1889,17 +2337,19 @@ void libvisio::VSDParser::readStyleSheet(librevenge::RVNGInputStream *input)
   unsigned fillStyle = readU32(input);
   input->seek(4, librevenge::RVNG_SEEK_CUR);
   unsigned textStyle = readU32(input);
+  if (input->isTruncated())
+    return;
 
   m_collector->collectStyleSheet(m_header.id, m_header.level, lineStyle, fillStyle, textStyle);
 }
 
-void libvisio::VSDParser::readPageSheet(librevenge::RVNGInputStream * /* input */)
+void libvisio::VSDParser::readPageSheet(VSDCursor * /* input */)
 {
   m_currentShapeLevel = m_header.level;
   m_collector->collectPageSheet(m_header.id, m_header.level);
 }
 
-void libvisio::VSDParser::readText(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readText(VSDCursor *input)
 {
   input->seek(8, librevenge::RVNG_SEEK_CUR);
   librevenge::RVNGBinaryData textStream;
@@ -1921,7 +2371,7 @@ void libvisio::VSDParser::readText(librevenge::RVNGInputStream *input)
   m_shape.m_textFormat = libvisio::VSD_TEXT_UTF16;
 }
 
-void libvisio::VSDParser::readCharIX(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readCharIX(VSDCursor *input)
 {
   VSDFont fontFace;
   unsigned charCount = readU32(input);
@@ -1968,6 +2418,8 @@ void libvisio::VSDParser::readCharIX(librevenge::RVNGInputStream *input)
   if (fontMod & 1) doubleunderline = true;
   if (fontMod & 4) strikeout = true;
   if (fontMod & 0x20) doublestrikeout = true;
+  if (input->isTruncated())
+    return;
 
   if (m_isInStyles)
     m_collector->collectCharIXStyle(m_header.id, m_header.level, charCount, font, fontColour, fontSize,
@@ -1989,7 +2441,7 @@ void libvisio::VSDParser::readCharIX(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSDParser::readParaIX(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readParaIX(VSDCursor *input)
 {
   long startPosition = input->tell();
   unsigned charCount = readU32(input);
@@ -2050,6 +2502,8 @@ void libvisio::VSDParser::readParaIX(librevenge::RVNGInputStream *input)
     remainingData -= blockLength;
   }
 
+  if (input->isTruncated())
+    return;
 
   if (m_isInStyles)
     m_collector->collectParaIXStyle(m_header.id, m_header.level, charCount, indFirst, indLeft, indRight,
@@ -2074,7 +2528,7 @@ void libvisio::VSDParser::readParaIX(librevenge::RVNGInputStream *input)
 }
 
 
-void libvisio::VSDParser::readFillAndShadow(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readFillAndShadow(VSDCursor *input)
 {
   unsigned char colourFGIndex = readU8(input);
   Colour colourFG;
@@ -2125,6 +2579,8 @@ void libvisio::VSDParser::readFillAndShadow(librevenge::RVNGInputStream *input)
   double shadowOffsetY = readDouble(input);
 
 
+  if (input->isTruncated())
+    return;
 
   if (m_isInStyles)
     m_collector->collectFillStyle(m_header.level, colourFG, colourBG, fillPattern,
@@ -2142,7 +2598,7 @@ void libvisio::VSDParser::readFillAndShadow(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSDParser::readName(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readName(VSDCursor *input)
 {
   unsigned long numBytesRead = 0;
   const unsigned char *tmpBuffer = input->read(m_header.dataLength, numBytesRead);
@@ -2153,7 +2609,7 @@ void libvisio::VSDParser::readName(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSDParser::readName2(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readName2(VSDCursor *input)
 {
   unsigned short unicharacter = 0;
   librevenge::RVNGBinaryData name;
@@ -2165,10 +2621,12 @@ void libvisio::VSDParser::readName2(librevenge::RVNGInputStream *input)
   }
   name.append(unicharacter & 0xff);
   name.append((unicharacter & 0xff00) >> 8);
+  if (input->isTruncated())
+    return;
   m_names[m_header.id] = VSDName(name, libvisio::VSD_TEXT_UTF16);
 }
 
-void libvisio::VSDParser::readTextField(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readTextField(VSDCursor *input)
 {
   unsigned long initialPosition = input->tell();
   input->seek(7, librevenge::RVNG_SEEK_CUR);
@@ -2178,6 +2636,8 @@ void libvisio::VSDParser::readTextField(librevenge::RVNGInputStream *input)
     int nameId = readS32(input);
     input->seek(6, librevenge::RVNG_SEEK_CUR);
     int formatStringId = readS32(input);
+    if (input->isTruncated())
+      return;
     m_shape.m_fields.addTextField(m_header.id, m_header.level, nameId, formatStringId);
   }
   else
@@ -2237,10 +2697,12 @@ void libvisio::VSDParser::readTextField(librevenge::RVNGInputStream *input)
   }
 }
 
-void libvisio::VSDParser::readMisc(librevenge::RVNGInputStream *input)
+void libvisio::VSDParser::readMisc(VSDCursor *input)
 {
   unsigned long initialPosition = input->tell();
   unsigned char flags = readU8(input);
+  if (input->isTruncated())
+    return;
   if (flags & 0x20)
     m_shape.m_misc.m_hideText = true;
   else
@@ -2288,14 +2750,10 @@ libvisio::Colour libvisio::VSDParser::_colourFromIndex(unsigned idx)
   return libvisio::Colour();
 }
 
-unsigned libvisio::VSDParser::getUInt(librevenge::RVNGInputStream *input)
-{
-  return readU32(input);
-}
-
-int libvisio::VSDParser::getInt(librevenge::RVNGInputStream *input)
-{
-  return readS32(input);
-}
+// The version specific parsers instantiate the chunk and pointer loops with their own traits
+template bool libvisio::VSDParser::_buildStreamIndex<libvisio::VSD5Traits>();
+template bool libvisio::VSDParser::_buildStreamIndex<libvisio::VSD6Traits>();
+template void libvisio::VSDParser::_handleChunks<libvisio::VSD5Traits>(VSDCursor *input, unsigned level);
+template void libvisio::VSDParser::_handleChunks<libvisio::VSD6Traits>(VSDCursor *input, unsigned level);
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -18,31 +18,29 @@
 #include <set>
 #include <librevenge/librevenge.h>
 #include "VSDTypes.h"
+#include "VSDCursor.h"
+#include "VSDFormatTraits.h"
 #include "VSDGeometryList.h"
 #include "VSDFieldList.h"
 #include "VSDCharacterList.h"
 #include "VSDParagraphList.h"
 #include "VSDShapeList.h"
 #include "VSDLayerList.h"
+#include "VSDPageSelection.h"
 #include "VSDStencils.h"
+#include "VSDStreamCache.h"
+#include "VSDStreamIndex.h"
+
+class VSDInternalStream;
 
 namespace libvisio
 {
 
 class VSDCollector;
-
-struct Pointer
-{
-  Pointer()
-    : Type(0), Offset(0), Length(0), Format(0), ListSize(0) {}
-  Pointer(const Pointer &ptr) = default;
-  Pointer &operator=(const Pointer &ptr) = default;
-  unsigned Type;
-  unsigned Offset;
-  unsigned Length;
-  unsigned short Format;
-  unsigned ListSize;
-};
+class VSDDeferredCollector;
+class VSDPages;
+class VSDParseControl;
+class VSDWorkerPool;
 
 class VSDParser
 {
@@ -51,96 +49,119 @@ public:
   virtual ~VSDParser();
   bool parseMain();
   bool extractStencils();
+  void setStreamCacheLimit(unsigned long maxBytes);
+  void setDecompressionThreads(unsigned threads);
+  void setSinglePass(bool singlePass);
+  void setPagesOutput(VSDPages *pages);
+  void setProgressive(bool progressive);
+  void setPageSelection(const std::set<unsigned> &pages, const std::set<std::string> &pageNames);
+  void setParseControl(VSDParseControl *control);
+  void setTextOnly(bool textOnly);
 
 protected:
   // reader functions
-  void readEllipticalArcTo(librevenge::RVNGInputStream *input);
-  void readForeignData(librevenge::RVNGInputStream *input);
-  void readEllipse(librevenge::RVNGInputStream *input);
-  virtual void readLine(librevenge::RVNGInputStream *input);
-  virtual void readFillAndShadow(librevenge::RVNGInputStream *input);
-  virtual void readGeomList(librevenge::RVNGInputStream *input);
-  void readGeometry(librevenge::RVNGInputStream *input);
-  void readMoveTo(librevenge::RVNGInputStream *input);
-  void readLineTo(librevenge::RVNGInputStream *input);
-  void readArcTo(librevenge::RVNGInputStream *input);
-  void readNURBSTo(librevenge::RVNGInputStream *input);
-  void readPolylineTo(librevenge::RVNGInputStream *input);
-  void readInfiniteLine(librevenge::RVNGInputStream *input);
-  void readShapeData(librevenge::RVNGInputStream *input);
-  void readXFormData(librevenge::RVNGInputStream *input);
-  virtual void readXForm1D(librevenge::RVNGInputStream *input);
-  void readTxtXForm(librevenge::RVNGInputStream *input);
-  void readShapeId(librevenge::RVNGInputStream *input);
-  virtual void readShapeList(librevenge::RVNGInputStream *input);
-  void readForeignDataType(librevenge::RVNGInputStream *input);
-  void readPageProps(librevenge::RVNGInputStream *input);
-  virtual void readShape(librevenge::RVNGInputStream *input);
-  void readColours(librevenge::RVNGInputStream *input);
-  void readFont(librevenge::RVNGInputStream *input);
-  void readFontIX(librevenge::RVNGInputStream *input);
-  virtual void readCharList(librevenge::RVNGInputStream *input);
-  virtual void readParaList(librevenge::RVNGInputStream *input);
-  virtual void readPropList(librevenge::RVNGInputStream *input);
-  virtual void readPage(librevenge::RVNGInputStream *input);
-  virtual void readText(librevenge::RVNGInputStream *input);
-  virtual void readCharIX(librevenge::RVNGInputStream *input);
-  virtual void readParaIX(librevenge::RVNGInputStream *input);
-  virtual void readTextBlock(librevenge::RVNGInputStream *input);
-  virtual void readTabsDataList(librevenge::RVNGInputStream *input);
-  virtual void readTabsData(librevenge::RVNGInputStream *input);
-
-  void readNameList(librevenge::RVNGInputStream *input);
-  virtual void readName(librevenge::RVNGInputStream *input);
-
-  virtual void readNameList2(librevenge::RVNGInputStream *input);
-  virtual void readName2(librevenge::RVNGInputStream *input);
-
-  virtual void readFieldList(librevenge::RVNGInputStream *input);
-  virtual void readTextField(librevenge::RVNGInputStream *input);
-
-  virtual void readStyleSheet(librevenge::RVNGInputStream *input);
-  void readPageSheet(librevenge::RVNGInputStream *input);
-
-  void readSplineStart(librevenge::RVNGInputStream *input);
-  void readSplineKnot(librevenge::RVNGInputStream *input);
-
-  void readStencilShape(librevenge::RVNGInputStream *input);
-
-  void readOLEList(librevenge::RVNGInputStream *input);
-  void readOLEData(librevenge::RVNGInputStream *input);
-
-  virtual void readNameIDX(librevenge::RVNGInputStream *input);
-  virtual void readNameIDX123(librevenge::RVNGInputStream *input);
-
-  virtual void readMisc(librevenge::RVNGInputStream *input);
-
-  virtual void readLayerList(librevenge::RVNGInputStream *input);
-  virtual void readLayer(librevenge::RVNGInputStream *input);
-  virtual void readLayerMem(librevenge::RVNGInputStream *input);
+  void readEllipticalArcTo(VSDCursor *input);
+  void readForeignData(VSDCursor *input);
+  void readEllipse(VSDCursor *input);
+  virtual void readLine(VSDCursor *input);
+  virtual void readFillAndShadow(VSDCursor *input);
+  virtual void readGeomList(VSDCursor *input);
+  void readGeometry(VSDCursor *input);
+  void readMoveTo(VSDCursor *input);
+  void readLineTo(VSDCursor *input);
+  void readArcTo(VSDCursor *input);
+  void readNURBSTo(VSDCursor *input);
+  void readPolylineTo(VSDCursor *input);
+  void readInfiniteLine(VSDCursor *input);
+  void readShapeData(VSDCursor *input);
+  void readXFormData(VSDCursor *input);
+  virtual void readXForm1D(VSDCursor *input);
+  void readTxtXForm(VSDCursor *input);
+  void readShapeId(VSDCursor *input);
+  virtual void readShapeList(VSDCursor *input);
+  void readForeignDataType(VSDCursor *input);
+  void readPageProps(VSDCursor *input);
+  virtual void readShape(VSDCursor *input);
+  void readColours(VSDCursor *input);
+  void readFont(VSDCursor *input);
+  void readFontIX(VSDCursor *input);
+  virtual void readCharList(VSDCursor *input);
+  virtual void readParaList(VSDCursor *input);
+  virtual void readPropList(VSDCursor *input);
+  virtual void readPage(VSDCursor *input);
+  virtual void readText(VSDCursor *input);
+  virtual void readCharIX(VSDCursor *input);
+  virtual void readParaIX(VSDCursor *input);
+  virtual void readTextBlock(VSDCursor *input);
+  virtual void readTabsDataList(VSDCursor *input);
+  virtual void readTabsData(VSDCursor *input);
+
+  void readNameList(VSDCursor *input);
+  virtual void readName(VSDCursor *input);
+
+  virtual void readNameList2(VSDCursor *input);
+  virtual void readName2(VSDCursor *input);
+
+  virtual void readFieldList(VSDCursor *input);
+  virtual void readTextField(VSDCursor *input);
+
+  virtual void readStyleSheet(VSDCursor *input);
+  void readPageSheet(VSDCursor *input);
+
+  void readSplineStart(VSDCursor *input);
+  void readSplineKnot(VSDCursor *input);
+
+  void readStencilShape(VSDCursor *input);
+
+  void readOLEList(VSDCursor *input);
+  void readOLEData(VSDCursor *input);
+
+  virtual void readNameIDX(VSDCursor *input);
+  virtual void readNameIDX123(VSDCursor *input);
+
+  virtual void readMisc(VSDCursor *input);
+
+  virtual void readLayerList(VSDCursor *input);
+  virtual void readLayer(VSDCursor *input);
+  virtual void readLayerMem(VSDCursor *input);
 
   // parser of one pass
-  bool parseDocument(librevenge::RVNGInputStream *input, unsigned shift);
+  bool parseDocument();
+  bool parseSinglePass();
 
   void parseMetaData();
 
   // Stream handlers
-  void handleStreams(librevenge::RVNGInputStream *input, unsigned ptrType, unsigned shift, unsigned level, std::set<unsigned> &visited);
-  void handleStream(const Pointer &ptr, unsigned idx, unsigned level, std::set<unsigned> &visited);
-  void handleChunks(librevenge::RVNGInputStream *input, unsigned level);
-  void handleChunk(librevenge::RVNGInputStream *input);
-  void handleBlob(librevenge::RVNGInputStream *input, unsigned shift, unsigned level);
-
-  virtual void readPointer(librevenge::RVNGInputStream *input, Pointer &ptr);
-  virtual void readPointerInfo(librevenge::RVNGInputStream *input, unsigned ptrType, unsigned shift, unsigned &listSize, int &pointerCount);
-  virtual bool getChunkHeader(librevenge::RVNGInputStream *input);
+  void handleStreams(unsigned entry, unsigned level);
+  void handleStream(unsigned entry, unsigned idx, unsigned level);
+  bool _isPageSelected(unsigned id, unsigned level);
+  virtual void handleChunks(VSDCursor *input, unsigned level);
+  void handleChunk(VSDCursor *input);
+  void handleBlob(VSDCursor *input, unsigned shift, unsigned level);
+
+  virtual bool buildStreamIndex();
+
+  template<typename Traits> void _handleChunks(VSDCursor *input, unsigned level);
+  template<typename Traits> bool _buildStreamIndex();
+  template<typename Traits> void _indexStreams(librevenge::RVNGInputStream *input, unsigned entry, unsigned shift, std::set<unsigned> &visited);
+
   void _handleLevelChange(unsigned level);
   Colour _colourFromIndex(unsigned idx);
   void _flushShape();
   void _nameFromId(VSDName &name, unsigned id, unsigned level);
-
-  virtual unsigned getUInt(librevenge::RVNGInputStream *input);
-  virtual int getInt(librevenge::RVNGInputStream *input);
+  std::unique_ptr<VSDInternalStream> _openStream(unsigned offset, unsigned length, bool compressed);
+  void _prefetchStreams(const std::vector<Pointer> &pointers);
+  bool _canParseInSinglePass() const;
+
+  // Integers shared by the readers of all versions are 16-bit in Visio 5
+  unsigned getUInt(VSDCursor *input)
+  {
+    return m_shortIntegers ? VSD5Traits::getUInt(input) : VSD11Traits::getUInt(input);
+  }
+  int getInt(VSDCursor *input)
+  {
+    return m_shortIntegers ? VSD5Traits::getInt(input) : VSD11Traits::getInt(input);
+  }
 
   librevenge::RVNGInputStream *m_input;
   librevenge::RVNGDrawingInterface *m_painter;
@@ -179,6 +200,23 @@ protected:
 
   std::map<unsigned, VSDTabStop> *m_currentTabSet;
 
+  VSDStreamCache m_streamCache;
+  VSDStreamIndex m_streamIndex;
+  // The whole input, if it is in one buffer that pointers can be kept into
+  unsigned long m_inputSize;
+  const unsigned char *m_inputBuffer;
+  unsigned m_decompressionThreads;
+  std::unique_ptr<VSDWorkerPool> m_decompressionPool;
+  bool m_isStylesPass;
+  bool m_singlePass;
+  bool m_shortIntegers;
+  VSDDeferredCollector *m_deferredCollector;
+  VSDPages *m_pagesOutput;
+  bool m_progressive;
+  VSDPageSelection m_pageSelection;
+  VSDParseControl *m_parseControl;
+  bool m_textOnly;
+
 private:
   VSDParser();
   VSDParser(const VSDParser &);
@@ -154,14 +154,20 @@ libvisio::VSDStencils::~VSDStencils()
 
 void libvisio::VSDStencils::addStencil(unsigned idx, const libvisio::VSDStencil &stencil)
 {
-  m_stencils[idx] = stencil;
+  m_stencils[idx] = std::make_shared<const VSDStencil>(stencil);
+}
+
+void libvisio::VSDStencils::addStencil(unsigned idx, std::unique_ptr<libvisio::VSDStencil> stencil)
+{
+  if (stencil)
+    m_stencils[idx] = std::move(stencil);
 }
 
 const libvisio::VSDStencil *libvisio::VSDStencils::getStencil(unsigned idx) const
 {
   auto iter = m_stencils.find(idx);
   if (iter != m_stencils.end())
-    return &(iter->second);
+    return iter->second.get();
   else
     return nullptr;
 }
@@ -75,12 +75,18 @@ public:
   unsigned m_firstShapeId;
 };
 
+/* The stencils of a document. A stencil cannot change once it is added,
+ * so copies of the store share the stencils instead of copying them, and
+ * the parsers, their collectors and page workers can all read the same
+ * store.
+ */
 class VSDStencils
 {
 public:
   VSDStencils();
   ~VSDStencils();
   void addStencil(unsigned idx, const VSDStencil &stencil);
+  void addStencil(unsigned idx, std::unique_ptr<VSDStencil> stencil);
   const VSDStencil *getStencil(unsigned idx) const;
   const VSDShape *getStencilShape(unsigned pageId, unsigned shapeId) const;
   unsigned count() const
@@ -88,7 +94,7 @@ public:
     return m_stencils.size();
   }
 private:
-  std::map<unsigned, VSDStencil> m_stencils;
+  std::map<unsigned, std::shared_ptr<const VSDStencil> > m_stencils;
 };
 
 
@@ -0,0 +1,57 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDStreamCache.h"
+
+libvisio::VSDStreamCache::VSDStreamCache(unsigned long maxBytes)
+  : m_streams(), m_maxBytes(maxBytes), m_size(0)
+{
+}
+
+libvisio::VSDStreamCache::~VSDStreamCache()
+{
+}
+
+const std::vector<unsigned char> *libvisio::VSDStreamCache::find(unsigned offset, unsigned length) const
+{
+  std::map<std::pair<unsigned, unsigned>, std::vector<unsigned char> >::const_iterator iter = m_streams.find(std::make_pair(offset, length));
+  if (iter == m_streams.end())
+    return nullptr;
+  return &iter->second;
+}
+
+bool libvisio::VSDStreamCache::contains(unsigned offset, unsigned length) const
+{
+  return m_streams.find(std::make_pair(offset, length)) != m_streams.end();
+}
+
+const std::vector<unsigned char> *libvisio::VSDStreamCache::insert(unsigned offset, unsigned length, std::vector<unsigned char> &data)
+{
+  if (m_maxBytes && m_size + data.size() > m_maxBytes)
+    return nullptr;
+
+  std::vector<unsigned char> &cached = m_streams[std::make_pair(offset, length)];
+  m_size -= cached.size();
+  cached.swap(data);
+  m_size += cached.size();
+  return &cached;
+}
+
+void libvisio::VSDStreamCache::clear()
+{
+  m_streams.clear();
+  m_size = 0;
+}
+
+void libvisio::VSDStreamCache::setMaxBytes(unsigned long maxBytes)
+{
+  m_maxBytes = maxBytes;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
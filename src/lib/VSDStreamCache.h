@@ -0,0 +1,58 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDSTREAMCACHE_H__
+#define __VSDSTREAMCACHE_H__
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace libvisio
+{
+
+/* Per-document store of decompressed pointer streams, keyed by the
+ * offset and length of the pointer, so that the styles and content
+ * passes decompress every stream only once. A non-zero limit caps the
+ * total number of bytes kept; streams that do not fit are not cached.
+ */
+class VSDStreamCache
+{
+public:
+  explicit VSDStreamCache(unsigned long maxBytes = 0);
+  ~VSDStreamCache();
+
+  const std::vector<unsigned char> *find(unsigned offset, unsigned length) const;
+  bool contains(unsigned offset, unsigned length) const;
+  const std::vector<unsigned char> *insert(unsigned offset, unsigned length, std::vector<unsigned char> &data);
+  void clear();
+
+  void setMaxBytes(unsigned long maxBytes);
+  unsigned long getMaxBytes() const
+  {
+    return m_maxBytes;
+  }
+  unsigned long getSize() const
+  {
+    return m_size;
+  }
+
+private:
+  VSDStreamCache(const VSDStreamCache &);
+  VSDStreamCache &operator=(const VSDStreamCache &);
+
+  std::map<std::pair<unsigned, unsigned>, std::vector<unsigned char> > m_streams;
+  unsigned long m_maxBytes;
+  unsigned long m_size;
+};
+
+} // namespace libvisio
+
+#endif // __VSDSTREAMCACHE_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,76 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDStreamIndex.h"
+#include "VSDDocumentStructure.h"
+
+libvisio::VSDStreamIndex::VSDStreamIndex()
+  : m_entries(), m_completeEntries(), m_hasParent(), m_isShared(false)
+{
+}
+
+libvisio::VSDStreamIndex::~VSDStreamIndex()
+{
+}
+
+unsigned libvisio::VSDStreamIndex::addEntry(const Pointer &pointer)
+{
+  const unsigned entry = m_entries.size();
+  m_entries.push_back(VSDStreamIndexEntry());
+  m_entries.back().pointer = pointer;
+  m_hasParent.push_back(false);
+  return entry;
+}
+
+void libvisio::VSDStreamIndex::addChild(unsigned parent, unsigned id, unsigned entry)
+{
+  m_entries[parent].children.push_back(VSDStreamIndexChild(id, entry));
+  if (m_hasParent[entry])
+    m_isShared = true;
+  m_hasParent[entry] = true;
+}
+
+void libvisio::VSDStreamIndex::setComplete(unsigned entry, unsigned height)
+{
+  m_entries[entry].height = height;
+  m_completeEntries.insert(std::make_pair(_getKey(m_entries[entry].pointer), entry));
+}
+
+unsigned libvisio::VSDStreamIndex::findEntry(const Pointer &pointer) const
+{
+  const std::map<StreamKey, unsigned>::const_iterator iter = m_completeEntries.find(_getKey(pointer));
+  return iter == m_completeEntries.end() ? MINUS_ONE : iter->second;
+}
+
+void libvisio::VSDStreamIndex::clear()
+{
+  m_entries.clear();
+  m_completeEntries.clear();
+  m_hasParent.clear();
+  m_isShared = false;
+}
+
+unsigned libvisio::VSDStreamIndex::getPageCount() const
+{
+  unsigned pages = 0;
+  for (const auto &entry : m_entries)
+  {
+    if (entry.pointer.Type == VSD_PAGE)
+      ++pages;
+  }
+  return pages;
+}
+
+libvisio::VSDStreamIndex::StreamKey libvisio::VSDStreamIndex::_getKey(const Pointer &pointer)
+{
+  // The pointer list of a stream depends on where it is, how it is stored and what it is
+  return StreamKey(pointer.Offset, pointer.Length, pointer.Format, pointer.Type);
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,93 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDSTREAMINDEX_H__
+#define __VSDSTREAMINDEX_H__
+
+#include <map>
+#include <tuple>
+#include <vector>
+#include "VSDTypes.h"
+
+namespace libvisio
+{
+
+struct VSDStreamIndexChild
+{
+  VSDStreamIndexChild(unsigned i, unsigned e)
+    : id(i), entry(e) {}
+  unsigned id;    // position of the pointer in the pointer list of the parent
+  unsigned entry; // entry of the stream that the pointer points to
+};
+
+struct VSDStreamIndexEntry
+{
+  VSDStreamIndexEntry()
+    : pointer(), height(0), children() {}
+  Pointer pointer;
+  unsigned height; // number of nested pointer lists from this stream down, 0 if it has none
+  std::vector<VSDStreamIndexChild> children; // in the order in which the parser visits them
+};
+
+/* Flat table of the pointer tree of a binary document, starting with the
+ * trailer stream as entry 0. It is built once per document, so the parser
+ * passes do not have to read the pointer lists again.
+ *
+ * A stream with a pointer list of its own that several pointer lists
+ * point to is indexed once and its entry is shared, so the table grows
+ * with the number of streams and not with the number of paths to them.
+ * Only complete entries are shared, so the table never has a cycle.
+ */
+class VSDStreamIndex
+{
+public:
+  VSDStreamIndex();
+  ~VSDStreamIndex();
+
+  unsigned addEntry(const Pointer &pointer);
+  void addChild(unsigned parent, unsigned id, unsigned entry);
+  // Marks entry as indexed with all its children, so that findEntry can share it
+  void setComplete(unsigned entry, unsigned height);
+  // The complete entry of the stream that pointer points to, or MINUS_ONE
+  unsigned findEntry(const Pointer &pointer) const;
+  const VSDStreamIndexEntry &getEntry(unsigned entry) const
+  {
+    return m_entries[entry];
+  }
+  unsigned size() const
+  {
+    return m_entries.size();
+  }
+  bool empty() const
+  {
+    return m_entries.empty();
+  }
+  // Whether no entry is shared, so that a walk visits every entry once
+  bool isTree() const
+  {
+    return !m_isShared;
+  }
+  void clear();
+  unsigned getPageCount() const;
+
+private:
+  typedef std::tuple<unsigned, unsigned, unsigned, unsigned> StreamKey;
+
+  static StreamKey _getKey(const Pointer &pointer);
+
+  std::vector<VSDStreamIndexEntry> m_entries;
+  std::map<StreamKey, unsigned> m_completeEntries;
+  std::vector<bool> m_hasParent;
+  bool m_isShared;
+};
+
+} // namespace libvisio
+
+#endif // __VSDSTREAMINDEX_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
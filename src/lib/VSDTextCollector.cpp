@@ -0,0 +1,214 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDTextCollector.h"
+
+libvisio::VSDTextCollector::VSDTextCollector(
+  librevenge::RVNGDrawingInterface *painter,
+  std::vector<std::map<unsigned, XForm> > &groupXFormsSequence,
+  std::vector<std::map<unsigned, unsigned> > &groupMembershipsSequence,
+  std::vector<std::list<unsigned> > &documentPageShapeOrders,
+  VSDStyles &styles, VSDStencils &stencils
+) : VSDContentCollector(painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, stencils)
+{
+}
+
+void libvisio::VSDTextCollector::collectEllipticalArcTo(unsigned /* id */, unsigned level, double /* x3 */, double /* y3 */,
+                                                        double /* x2 */, double /* y2 */, double /* angle */, double /* ecc */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectForeignData(unsigned level, const librevenge::RVNGBinaryData & /* binaryData */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectOLEList(unsigned /* id */, unsigned level)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectOLEData(unsigned /* id */, unsigned level, const librevenge::RVNGBinaryData & /* oleData */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectEllipse(unsigned /* id */, unsigned level, double /* cx */, double /* cy */,
+                                                double /* xleft */, double /* yleft */, double /* xtop */, double /* ytop */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectLine(unsigned level, const boost::optional<double> & /* strokeWidth */, const boost::optional<Colour> & /* c */,
+                                             const boost::optional<unsigned char> & /* linePattern */, const boost::optional<unsigned char> & /* startMarker */,
+                                             const boost::optional<unsigned char> & /* endMarker */, const boost::optional<unsigned char> & /* lineCap */,
+                                             const boost::optional<double> & /* rounding */, const boost::optional<long> & /* qsLineColour */,
+                                             const boost::optional<long> & /* qsLineMatrix */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectFillAndShadow(unsigned level, const boost::optional<Colour> & /* colourFG */, const boost::optional<Colour> & /* colourBG */,
+                                                      const boost::optional<unsigned char> & /* fillPattern */, const boost::optional<double> & /* fillFGTransparency */,
+                                                      const boost::optional<double> & /* fillBGTransparency */, const boost::optional<unsigned char> & /* shadowPattern */,
+                                                      const boost::optional<Colour> & /* shfgc */, const boost::optional<double> & /* shadowOffsetX */,
+                                                      const boost::optional<double> & /* shadowOffsetY */, const boost::optional<long> & /* qsFc */,
+                                                      const boost::optional<long> & /* qsSc */, const boost::optional<long> & /* qsLm */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectFillAndShadow(unsigned level, const boost::optional<Colour> & /* colourFG */, const boost::optional<Colour> & /* colourBG */,
+                                                      const boost::optional<unsigned char> & /* fillPattern */, const boost::optional<double> & /* fillFGTransparency */,
+                                                      const boost::optional<double> & /* fillBGTransparency */, const boost::optional<unsigned char> & /* shadowPattern */,
+                                                      const boost::optional<Colour> & /* shfgc */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectGeometry(unsigned /* id */, unsigned level, bool /* noFill */, bool /* noLine */, bool /* noShow */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectMoveTo(unsigned /* id */, unsigned level, double /* x */, double /* y */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectLineTo(unsigned /* id */, unsigned level, double /* x */, double /* y */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectArcTo(unsigned /* id */, unsigned level, double /* x2 */, double /* y2 */, double /* bow */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectNURBSTo(unsigned /* id */, unsigned level, double /* x2 */, double /* y2 */, unsigned char /* xType */,
+                                                unsigned char /* yType */, unsigned /* degree */, const std::vector<std::pair<double, double> > & /* ctrlPnts */,
+                                                const std::vector<double> & /* kntVec */, const std::vector<double> & /* weights */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectNURBSTo(unsigned /* id */, unsigned level, double /* x2 */, double /* y2 */, double /* knot */,
+                                                double /* knotPrev */, double /* weight */, double /* weightPrev */, unsigned /* dataID */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectNURBSTo(unsigned /* id */, unsigned level, double /* x2 */, double /* y2 */, double /* knot */,
+                                                double /* knotPrev */, double /* weight */, double /* weightPrev */, const NURBSData & /* data */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectPolylineTo(unsigned /* id */, unsigned level, double /* x */, double /* y */, unsigned char /* xType */,
+                                                   unsigned char /* yType */, const std::vector<std::pair<double, double> > & /* points */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectPolylineTo(unsigned /* id */, unsigned level, double /* x */, double /* y */, unsigned /* dataID */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectPolylineTo(unsigned /* id */, unsigned level, double /* x */, double /* y */, const PolylineData & /* data */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectShapeData(unsigned /* id */, unsigned level, unsigned char /* xType */, unsigned char /* yType */,
+                                                  unsigned /* degree */, double /* lastKnot */, std::vector<std::pair<double, double> > /* controlPoints */,
+                                                  std::vector<double> /* knotVector */, std::vector<double> /* weights */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectShapeData(unsigned /* id */, unsigned level, unsigned char /* xType */, unsigned char /* yType */,
+                                                  std::vector<std::pair<double, double> > /* points */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectForeignDataType(unsigned level, unsigned /* foreignType */, unsigned /* foreignFormat */,
+                                                        double /* offsetX */, double /* offsetY */, double /* width */, double /* height */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectSplineStart(unsigned /* id */, unsigned level, double /* x */, double /* y */, double /* secondKnot */,
+                                                    double /* firstKnot */, double /* lastKnot */, unsigned /* degree */)
+{
+  // The spline would be drawn at this level by collectSplineEnd
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectSplineKnot(unsigned /* id */, unsigned /* level */, double /* x */, double /* y */, double /* knot */)
+{
+}
+
+void libvisio::VSDTextCollector::collectSplineEnd()
+{
+}
+
+void libvisio::VSDTextCollector::collectInfiniteLine(unsigned /* id */, unsigned level, double /* x1 */, double /* y1 */, double /* x2 */, double /* y2 */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectRelCubBezTo(unsigned /* id */, unsigned level, double /* x */, double /* y */,
+                                                    double /* a */, double /* b */, double /* c */, double /* d */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectRelEllipticalArcTo(unsigned /* id */, unsigned level, double /* x */, double /* y */,
+                                                           double /* a */, double /* b */, double /* c */, double /* d */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectRelLineTo(unsigned /* id */, unsigned level, double /* x */, double /* y */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectRelMoveTo(unsigned /* id */, unsigned level, double /* x */, double /* y */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectRelQuadBezTo(unsigned /* id */, unsigned level, double /* x */, double /* y */, double /* a */, double /* b */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::_handleForeignData(const librevenge::RVNGBinaryData & /* data */)
+{
+}
+
+std::unique_ptr<libvisio::VSDContentCollector> libvisio::makeContentCollector(
+  bool textOnly,
+  librevenge::RVNGDrawingInterface *painter,
+  std::vector<std::map<unsigned, XForm> > &groupXFormsSequence,
+  std::vector<std::map<unsigned, unsigned> > &groupMembershipsSequence,
+  std::vector<std::list<unsigned> > &documentPageShapeOrders,
+  VSDStyles &styles, VSDStencils &stencils)
+{
+  if (textOnly)
+    return std::unique_ptr<VSDContentCollector>(new VSDTextCollector(painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, stencils));
+  return std::unique_ptr<VSDContentCollector>(new VSDContentCollector(painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, stencils));
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,100 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef VSDTEXTCOLLECTOR_H
+#define VSDTEXTCOLLECTOR_H
+
+#include <memory>
+#include "VSDContentCollector.h"
+
+namespace libvisio
+{
+
+/* Content collector of the text-only mode. Pages, shapes and their text,
+ * fields included, come out as from VSDContentCollector, but geometry,
+ * line and fill properties and embedded images and objects are dropped
+ * as soon as they arrive, so no paths are built for them.
+ */
+class VSDTextCollector : public VSDContentCollector
+{
+public:
+  VSDTextCollector(
+    librevenge::RVNGDrawingInterface *painter,
+    std::vector<std::map<unsigned, XForm> > &groupXFormsSequence,
+    std::vector<std::map<unsigned, unsigned> > &groupMembershipsSequence,
+    std::vector<std::list<unsigned> > &documentPageShapeOrders,
+    VSDStyles &styles, VSDStencils &stencils
+  );
+  ~VSDTextCollector() override {}
+
+  void collectEllipticalArcTo(unsigned id, unsigned level, double x3, double y3, double x2, double y2, double angle, double ecc) override;
+  void collectForeignData(unsigned level, const librevenge::RVNGBinaryData &binaryData) override;
+  void collectOLEList(unsigned id, unsigned level) override;
+  void collectOLEData(unsigned id, unsigned level, const librevenge::RVNGBinaryData &oleData) override;
+  void collectEllipse(unsigned id, unsigned level, double cx, double cy, double xleft, double yleft, double xtop, double ytop) override;
+  void collectLine(unsigned level, const boost::optional<double> &strokeWidth, const boost::optional<Colour> &c, const boost::optional<unsigned char> &linePattern,
+                   const boost::optional<unsigned char> &startMarker, const boost::optional<unsigned char> &endMarker,
+                   const boost::optional<unsigned char> &lineCap, const boost::optional<double> &rounding,
+                   const boost::optional<long> &qsLineColour, const boost::optional<long> &qsLineMatrix) override;
+  void collectFillAndShadow(unsigned level, const boost::optional<Colour> &colourFG, const boost::optional<Colour> &colourBG,
+                            const boost::optional<unsigned char> &fillPattern, const boost::optional<double> &fillFGTransparency,
+                            const boost::optional<double> &fillBGTransparency, const boost::optional<unsigned char> &shadowPattern,
+                            const boost::optional<Colour> &shfgc, const boost::optional<double> &shadowOffsetX, const boost::optional<double> &shadowOffsetY,
+                            const boost::optional<long> &qsFc, const boost::optional<long> &qsSc, const boost::optional<long> &qsLm) override;
+  void collectFillAndShadow(unsigned level, const boost::optional<Colour> &colourFG, const boost::optional<Colour> &colourBG,
+                            const boost::optional<unsigned char> &fillPattern, const boost::optional<double> &fillFGTransparency,
+                            const boost::optional<double> &fillBGTransparency, const boost::optional<unsigned char> &shadowPattern,
+                            const boost::optional<Colour> &shfgc) override;
+  void collectGeometry(unsigned id, unsigned level, bool noFill, bool noLine, bool noShow) override;
+  void collectMoveTo(unsigned id, unsigned level, double x, double y) override;
+  void collectLineTo(unsigned id, unsigned level, double x, double y) override;
+  void collectArcTo(unsigned id, unsigned level, double x2, double y2, double bow) override;
+  void collectNURBSTo(unsigned id, unsigned level, double x2, double y2, unsigned char xType, unsigned char yType, unsigned degree,
+                      const std::vector<std::pair<double, double> > &ctrlPnts, const std::vector<double> &kntVec, const std::vector<double> &weights) override;
+  void collectNURBSTo(unsigned id, unsigned level, double x2, double y2, double knot, double knotPrev, double weight, double weightPrev, unsigned dataID) override;
+  void collectNURBSTo(unsigned id, unsigned level, double x2, double y2, double knot, double knotPrev, double weight, double weightPrev, const NURBSData &data) override;
+  void collectPolylineTo(unsigned id, unsigned level, double x, double y, unsigned char xType, unsigned char yType, const std::vector<std::pair<double, double> > &points) override;
+  void collectPolylineTo(unsigned id, unsigned level, double x, double y, unsigned dataID) override;
+  void collectPolylineTo(unsigned id, unsigned level, double x, double y, const PolylineData &data) override;
+  void collectShapeData(unsigned id, unsigned level, unsigned char xType, unsigned char yType, unsigned degree, double lastKnot,
+                        std::vector<std::pair<double, double> > controlPoints, std::vector<double> knotVector, std::vector<double> weights) override;
+  void collectShapeData(unsigned id, unsigned level, unsigned char xType, unsigned char yType, std::vector<std::pair<double, double> > points) override;
+  void collectForeignDataType(unsigned level, unsigned foreignType, unsigned foreignFormat, double offsetX, double offsetY, double width, double height) override;
+  void collectSplineStart(unsigned id, unsigned level, double x, double y, double secondKnot, double firstKnot, double lastKnot, unsigned degree) override;
+  void collectSplineKnot(unsigned id, unsigned level, double x, double y, double knot) override;
+  void collectSplineEnd() override;
+  void collectInfiniteLine(unsigned id, unsigned level, double x1, double y1, double x2, double y2) override;
+  void collectRelCubBezTo(unsigned id, unsigned level, double x, double y, double a, double b, double c, double d) override;
+  void collectRelEllipticalArcTo(unsigned id, unsigned level, double x, double y, double a, double b, double c, double d) override;
+  void collectRelLineTo(unsigned id, unsigned level, double x, double y) override;
+  void collectRelMoveTo(unsigned id, unsigned level, double x, double y) override;
+  void collectRelQuadBezTo(unsigned id, unsigned level, double x, double y, double a, double b) override;
+
+protected:
+  void _handleForeignData(const librevenge::RVNGBinaryData &data) override;
+
+private:
+  VSDTextCollector(const VSDTextCollector &);
+  VSDTextCollector &operator=(const VSDTextCollector &);
+};
+
+// A VSDTextCollector if textOnly is set, else a VSDContentCollector
+std::unique_ptr<VSDContentCollector> makeContentCollector(
+  bool textOnly,
+  librevenge::RVNGDrawingInterface *painter,
+  std::vector<std::map<unsigned, XForm> > &groupXFormsSequence,
+  std::vector<std::map<unsigned, unsigned> > &groupMembershipsSequence,
+  std::vector<std::list<unsigned> > &documentPageShapeOrders,
+  VSDStyles &styles, VSDStencils &stencils
+);
+
+} // namespace libvisio
+
+#endif /* VSDTEXTCOLLECTOR_H */
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
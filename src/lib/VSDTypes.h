@@ -67,6 +67,19 @@ struct ChunkHeader
   unsigned trailer; // Derived
 };
 
+struct Pointer
+{
+  Pointer()
+    : Type(0), Offset(0), Length(0), Format(0), ListSize(0) {}
+  Pointer(const Pointer &ptr) = default;
+  Pointer &operator=(const Pointer &ptr) = default;
+  unsigned Type;
+  unsigned Offset;
+  unsigned Length;
+  unsigned short Format;
+  unsigned ListSize;
+};
+
 struct Colour
 {
   Colour(unsigned char red, unsigned char green, unsigned char blue, unsigned char alpha)
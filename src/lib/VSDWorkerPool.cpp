@@ -0,0 +1,123 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDWorkerPool.h"
+
+#include <system_error>
+
+libvisio::VSDWorkerPool::VSDWorkerPool(unsigned threadCount)
+  : m_threadCount(threadCount), m_threads(), m_mutex(), m_batchStarted(), m_batchDone(),
+    m_job(nullptr), m_jobCount(0), m_nextJob(0), m_batch(0), m_finishedThreads(0), m_stopping(false), m_error()
+{
+}
+
+libvisio::VSDWorkerPool::~VSDWorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_batchStarted.notify_all();
+  for (auto &thread : m_threads)
+    thread.join();
+}
+
+void libvisio::VSDWorkerPool::run(std::size_t jobCount, const std::function<void(std::size_t)> &job)
+{
+  if (!jobCount)
+    return;
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    _startThreads(jobCount);
+    m_job = &job;
+    m_jobCount = jobCount;
+    m_nextJob = 0;
+    m_finishedThreads = 0;
+    ++m_batch;
+  }
+  m_batchStarted.notify_all();
+
+  _work(job, jobCount);
+
+  {
+    // Every thread takes part in every batch, so none of them can still see this one when the next starts
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_batchDone.wait(lock, [this]()
+    {
+      return m_finishedThreads == m_threads.size();
+    });
+    m_job = nullptr;
+    error = m_error;
+    m_error = nullptr;
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void libvisio::VSDWorkerPool::_startThreads(std::size_t jobCount)
+{
+  // Called with the mutex held, before the batch is published
+  while (m_threads.size() + 1 < m_threadCount && m_threads.size() + 1 < jobCount)
+  {
+    try
+    {
+      m_threads.push_back(std::thread(&VSDWorkerPool::_waitForBatches, this, m_batch));
+    }
+    catch (const std::system_error &)
+    {
+      // Could not start more threads; the ones we have will do the work
+      break;
+    }
+  }
+}
+
+void libvisio::VSDWorkerPool::_waitForBatches(unsigned long batch)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true)
+  {
+    m_batchStarted.wait(lock, [this, batch]()
+    {
+      return m_stopping || m_batch != batch;
+    });
+    if (m_stopping)
+      return;
+    batch = m_batch;
+    const std::function<void(std::size_t)> &job = *m_job;
+    const std::size_t jobCount = m_jobCount;
+    lock.unlock();
+    _work(job, jobCount);
+    lock.lock();
+    if (++m_finishedThreads == m_threads.size())
+      m_batchDone.notify_one();
+  }
+}
+
+void libvisio::VSDWorkerPool::_work(const std::function<void(std::size_t)> &job, std::size_t jobCount)
+{
+  for (std::size_t i = m_nextJob++; i < jobCount; i = m_nextJob++)
+  {
+    try
+    {
+      job(i);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_error)
+        m_error = std::current_exception();
+      m_nextJob = jobCount;
+    }
+  }
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,68 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDWORKERPOOL_H__
+#define __VSDWORKERPOOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libvisio
+{
+
+/* Runs batches of jobs on up to threadCount threads, the calling thread
+ * included. The threads are started by the first batch that can use
+ * them and are kept until the pool is destroyed, so a parse that runs
+ * many small batches starts them only once.
+ *
+ * run() calls job(0) ... job(jobCount - 1) and returns once all of them
+ * are done. Jobs must not touch shared state without their own
+ * synchronization. The first exception thrown by a job is rethrown to
+ * the caller.
+ */
+class VSDWorkerPool
+{
+public:
+  explicit VSDWorkerPool(unsigned threadCount);
+  ~VSDWorkerPool();
+
+  void run(std::size_t jobCount, const std::function<void(std::size_t)> &job);
+
+private:
+  VSDWorkerPool(const VSDWorkerPool &);
+  VSDWorkerPool &operator=(const VSDWorkerPool &);
+
+  void _startThreads(std::size_t jobCount);
+  void _waitForBatches(unsigned long batch);
+  void _work(const std::function<void(std::size_t)> &job, std::size_t jobCount);
+
+  const unsigned m_threadCount;
+  std::vector<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_batchStarted;
+  std::condition_variable m_batchDone;
+  const std::function<void(std::size_t)> *m_job;
+  std::size_t m_jobCount;
+  std::atomic<std::size_t> m_nextJob;
+  unsigned long m_batch;
+  std::size_t m_finishedThreads;
+  bool m_stopping;
+  std::exception_ptr m_error;
+};
+
+} // namespace libvisio
+
+#endif // __VSDWORKERPOOL_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
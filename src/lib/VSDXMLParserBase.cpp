@@ -24,8 +24,6 @@
 #include "VSDXMLHelper.h"
 #include "VSDXMLTokenMap.h"
 
-using std::shared_ptr;
-
 libvisio::VSDXMLParserBase::VSDXMLParserBase()
   : m_collector(), m_stencils(), m_currentStencil(), m_shape(),
     m_isStencilStarted(false), m_currentStencilID(MINUS_ONE),
@@ -34,7 +32,8 @@ libvisio::VSDXMLParserBase::VSDXMLParserBase()
     m_currentBinaryData(), m_shapeStack(), m_shapeLevelStack(),
     m_isShapeStarted(false), m_isPageStarted(false), m_currentGeometryList(nullptr),
     m_currentGeometryListIndex(MINUS_ONE), m_fonts(), m_currentTabSet(nullptr),
-    m_watcher(nullptr)
+    m_watcher(nullptr), m_pagesOutput(nullptr), m_progressive(false), m_pageSelection(), m_parseControl(nullptr),
+    m_textOnly(false)
 {
   initColours();
 }
@@ -45,7 +44,7 @@ libvisio::VSDXMLParserBase::~VSDXMLParserBase()
 
 // Common functions
 
-void libvisio::VSDXMLParserBase::readGeometry(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readGeometry(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -56,9 +55,9 @@ void libvisio::VSDXMLParserBase::readGeometry(xmlTextReaderPtr reader)
 
   m_currentGeometryList = &m_shape.m_geometries[ix];
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -77,13 +76,13 @@ void libvisio::VSDXMLParserBase::readGeometry(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readGeometry: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readGeometry: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -168,7 +167,7 @@ void libvisio::VSDXMLParserBase::readGeometry(xmlTextReaderPtr reader)
     m_currentGeometryList->addGeometry(0, level+1, noFill, noLine, noShow);
 }
 
-void libvisio::VSDXMLParserBase::readMoveTo(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readMoveTo(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -177,9 +176,9 @@ void libvisio::VSDXMLParserBase::readMoveTo(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -193,13 +192,13 @@ void libvisio::VSDXMLParserBase::readMoveTo(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readMoveTo: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readMoveTo: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -218,7 +217,7 @@ void libvisio::VSDXMLParserBase::readMoveTo(xmlTextReaderPtr reader)
     m_currentGeometryList->addMoveTo(ix, level, x, y);
 }
 
-void libvisio::VSDXMLParserBase::readLineTo(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readLineTo(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -227,9 +226,9 @@ void libvisio::VSDXMLParserBase::readLineTo(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -243,13 +242,13 @@ void libvisio::VSDXMLParserBase::readLineTo(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readLineTo: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readLineTo: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -268,7 +267,7 @@ void libvisio::VSDXMLParserBase::readLineTo(xmlTextReaderPtr reader)
     m_currentGeometryList->addLineTo(ix, level, x, y);
 }
 
-void libvisio::VSDXMLParserBase::readArcTo(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readArcTo(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -277,9 +276,9 @@ void libvisio::VSDXMLParserBase::readArcTo(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -294,13 +293,13 @@ void libvisio::VSDXMLParserBase::readArcTo(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readArcTo: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readArcTo: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -322,7 +321,7 @@ void libvisio::VSDXMLParserBase::readArcTo(xmlTextReaderPtr reader)
     m_currentGeometryList->addArcTo(ix, level, x, y, a);
 }
 
-void libvisio::VSDXMLParserBase::readEllipticalArcTo(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readEllipticalArcTo(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -331,9 +330,9 @@ void libvisio::VSDXMLParserBase::readEllipticalArcTo(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -351,13 +350,13 @@ void libvisio::VSDXMLParserBase::readEllipticalArcTo(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readEllipticalArcTo: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readEllipticalArcTo: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -388,7 +387,7 @@ void libvisio::VSDXMLParserBase::readEllipticalArcTo(xmlTextReaderPtr reader)
     m_currentGeometryList->addEllipticalArcTo(ix, level, x, y, a, b, c, d);
 }
 
-void libvisio::VSDXMLParserBase::readEllipse(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readEllipse(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -397,9 +396,9 @@ void libvisio::VSDXMLParserBase::readEllipse(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -417,13 +416,13 @@ void libvisio::VSDXMLParserBase::readEllipse(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readEllipse: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readEllipse: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -454,7 +453,7 @@ void libvisio::VSDXMLParserBase::readEllipse(xmlTextReaderPtr reader)
     m_currentGeometryList->addEllipse(ix, level, x, y, a, b, c, d);
 }
 
-void libvisio::VSDXMLParserBase::readNURBSTo(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readNURBSTo(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -463,9 +462,9 @@ void libvisio::VSDXMLParserBase::readNURBSTo(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -484,13 +483,13 @@ void libvisio::VSDXMLParserBase::readNURBSTo(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readNURBSTo: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readNURBSTo: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -525,7 +524,7 @@ void libvisio::VSDXMLParserBase::readNURBSTo(xmlTextReaderPtr reader)
     m_currentGeometryList->addNURBSTo(ix, level, x, y, knot, knotPrev, weight, weightPrev, nurbsData);
 }
 
-void libvisio::VSDXMLParserBase::readPolylineTo(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readPolylineTo(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -534,9 +533,9 @@ void libvisio::VSDXMLParserBase::readPolylineTo(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -551,13 +550,13 @@ void libvisio::VSDXMLParserBase::readPolylineTo(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readPolylineTo: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readPolylineTo: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -579,7 +578,7 @@ void libvisio::VSDXMLParserBase::readPolylineTo(xmlTextReaderPtr reader)
     m_currentGeometryList->addPolylineTo(ix, level, x, y, polyLineData);
 }
 
-void libvisio::VSDXMLParserBase::readInfiniteLine(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readInfiniteLine(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -588,9 +587,9 @@ void libvisio::VSDXMLParserBase::readInfiniteLine(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -606,13 +605,13 @@ void libvisio::VSDXMLParserBase::readInfiniteLine(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readInfiniteLine: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readInfiniteLine: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -637,7 +636,7 @@ void libvisio::VSDXMLParserBase::readInfiniteLine(xmlTextReaderPtr reader)
     m_currentGeometryList->addInfiniteLine(ix, level, x, y, a, b);
 }
 
-void libvisio::VSDXMLParserBase::readRelEllipticalArcTo(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readRelEllipticalArcTo(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -646,9 +645,9 @@ void libvisio::VSDXMLParserBase::readRelEllipticalArcTo(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -666,13 +665,13 @@ void libvisio::VSDXMLParserBase::readRelEllipticalArcTo(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readRelEllipticalArcTo: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readRelEllipticalArcTo: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -703,7 +702,7 @@ void libvisio::VSDXMLParserBase::readRelEllipticalArcTo(xmlTextReaderPtr reader)
     m_currentGeometryList->addRelEllipticalArcTo(ix, level, x, y, a, b, c, d);
 }
 
-void libvisio::VSDXMLParserBase::readRelCubBezTo(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readRelCubBezTo(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -712,9 +711,9 @@ void libvisio::VSDXMLParserBase::readRelCubBezTo(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -732,13 +731,13 @@ void libvisio::VSDXMLParserBase::readRelCubBezTo(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readRelCubBezTo: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readRelCubBezTo: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -769,7 +768,7 @@ void libvisio::VSDXMLParserBase::readRelCubBezTo(xmlTextReaderPtr reader)
     m_currentGeometryList->addRelCubBezTo(ix, level, x, y, a, b, c, d);
 }
 
-void libvisio::VSDXMLParserBase::readRelLineTo(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readRelLineTo(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -778,9 +777,9 @@ void libvisio::VSDXMLParserBase::readRelLineTo(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -794,13 +793,13 @@ void libvisio::VSDXMLParserBase::readRelLineTo(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readRelLineTo: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readRelLineTo: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -819,7 +818,7 @@ void libvisio::VSDXMLParserBase::readRelLineTo(xmlTextReaderPtr reader)
     m_currentGeometryList->addRelLineTo(ix, level, x, y);
 }
 
-void libvisio::VSDXMLParserBase::readRelMoveTo(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readRelMoveTo(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -828,9 +827,9 @@ void libvisio::VSDXMLParserBase::readRelMoveTo(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -844,13 +843,13 @@ void libvisio::VSDXMLParserBase::readRelMoveTo(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readRelMoveTo: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readRelMoveTo: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -869,7 +868,7 @@ void libvisio::VSDXMLParserBase::readRelMoveTo(xmlTextReaderPtr reader)
     m_currentGeometryList->addRelMoveTo(ix, level, x, y);
 }
 
-void libvisio::VSDXMLParserBase::readRelQuadBezTo(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readRelQuadBezTo(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -878,9 +877,9 @@ void libvisio::VSDXMLParserBase::readRelQuadBezTo(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -896,13 +895,13 @@ void libvisio::VSDXMLParserBase::readRelQuadBezTo(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readRelQuadBezTo: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readRelQuadBezTo: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -927,17 +926,17 @@ void libvisio::VSDXMLParserBase::readRelQuadBezTo(xmlTextReaderPtr reader)
     m_currentGeometryList->addRelQuadBezTo(ix, level, x, y, a, b);
 }
 
-void libvisio::VSDXMLParserBase::readShape(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readShape(VSDXMLReader *reader)
 {
   m_isShapeStarted = true;
   m_currentShapeLevel = getElementDepth(reader);
 
-  const shared_ptr<xmlChar> idString(xmlTextReaderGetAttribute(reader, BAD_CAST("ID")), xmlFree);
-  const shared_ptr<xmlChar> masterPageString(xmlTextReaderGetAttribute(reader, BAD_CAST("Master")), xmlFree);
-  const shared_ptr<xmlChar> masterShapeString(xmlTextReaderGetAttribute(reader, BAD_CAST("MasterShape")), xmlFree);
-  const shared_ptr<xmlChar> lineStyleString(xmlTextReaderGetAttribute(reader, BAD_CAST("LineStyle")), xmlFree);
-  const shared_ptr<xmlChar> fillStyleString(xmlTextReaderGetAttribute(reader, BAD_CAST("FillStyle")), xmlFree);
-  const shared_ptr<xmlChar> textStyleString(xmlTextReaderGetAttribute(reader, BAD_CAST("TextStyle")), xmlFree);
+  const xmlChar *const idString = reader->getConstAttribute(BAD_CAST("ID"));
+  const xmlChar *const masterPageString = reader->getConstAttribute(BAD_CAST("Master"));
+  const xmlChar *const masterShapeString = reader->getConstAttribute(BAD_CAST("MasterShape"));
+  const xmlChar *const lineStyleString = reader->getConstAttribute(BAD_CAST("LineStyle"));
+  const xmlChar *const fillStyleString = reader->getConstAttribute(BAD_CAST("FillStyle"));
+  const xmlChar *const textStyleString = reader->getConstAttribute(BAD_CAST("TextStyle"));
 
   unsigned id = idString ? (unsigned)xmlStringToLong(idString) : MINUS_ONE;
   unsigned masterPage = masterPageString ? (unsigned)xmlStringToLong(masterPageString) : MINUS_ONE;
@@ -1025,7 +1024,7 @@ void libvisio::VSDXMLParserBase::initColours()
   m_colours[23] = Colour(0x1A, 0x1A, 0x1A, 0);
 }
 
-void libvisio::VSDXMLParserBase::readColours(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readColours(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -1035,18 +1034,18 @@ void libvisio::VSDXMLParserBase::readColours(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readColours: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readColours: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     if (XML_COLORENTRY == tokenId)
     {
       unsigned idx = getIX(reader);
-      const shared_ptr<xmlChar> rgb(xmlTextReaderGetAttribute(reader, BAD_CAST("RGB")), xmlFree);
+      const xmlChar *const rgb = reader->getConstAttribute(BAD_CAST("RGB"));
       if (MINUS_ONE != idx && rgb)
       {
         Colour rgbColour = xmlStringToColour(rgb);
@@ -1057,15 +1056,15 @@ void libvisio::VSDXMLParserBase::readColours(xmlTextReaderPtr reader)
   while ((XML_COLORS != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VSDXMLParserBase::readPage(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readPage(VSDXMLReader *reader)
 {
   m_shapeList.clear();
-  const shared_ptr<xmlChar> id(xmlTextReaderGetAttribute(reader, BAD_CAST("ID")), xmlFree);
-  const shared_ptr<xmlChar> bgndPage(xmlTextReaderGetAttribute(reader, BAD_CAST("BackPage")), xmlFree);
-  const shared_ptr<xmlChar> background(xmlTextReaderGetAttribute(reader, BAD_CAST("Background")), xmlFree);
-  shared_ptr<xmlChar> pageName(xmlTextReaderGetAttribute(reader, BAD_CAST("Name")), xmlFree);
-  if (!pageName.get())
-    pageName.reset(xmlTextReaderGetAttribute(reader, BAD_CAST("NameU")), xmlFree);
+  const xmlChar *const id = reader->getConstAttribute(BAD_CAST("ID"));
+  const xmlChar *const bgndPage = reader->getConstAttribute(BAD_CAST("BackPage"));
+  const xmlChar *const background = reader->getConstAttribute(BAD_CAST("Background"));
+  const xmlChar *pageName = reader->getConstAttribute(BAD_CAST("Name"));
+  if (!pageName)
+    pageName = reader->getConstAttribute(BAD_CAST("NameU"));
   if (id)
   {
     auto nId = (unsigned)xmlStringToLong(id);
@@ -1073,13 +1072,13 @@ void libvisio::VSDXMLParserBase::readPage(xmlTextReaderPtr reader)
     bool isBackgroundPage = background ? xmlStringToBool(background) : false;
     m_isPageStarted = true;
     m_collector->startPage(nId);
-    m_collector->collectPage(nId, (unsigned)getElementDepth(reader), backgroundPageID, isBackgroundPage, pageName ? VSDName(librevenge::RVNGBinaryData(pageName.get(), xmlStrlen(pageName.get())), VSD_TEXT_UTF8) : VSDName());
+    m_collector->collectPage(nId, (unsigned)getElementDepth(reader), backgroundPageID, isBackgroundPage, pageName ? VSDName(librevenge::RVNGBinaryData(pageName, xmlStrlen(pageName)), VSD_TEXT_UTF8) : VSDName());
   }
 }
 
-void libvisio::VSDXMLParserBase::readText(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readText(VSDXMLReader *reader)
 {
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
     return;
 
   unsigned cp = 0;
@@ -1095,13 +1094,13 @@ void libvisio::VSDXMLParserBase::readText(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readText: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readText: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_CP:
@@ -1120,7 +1119,7 @@ void libvisio::VSDXMLParserBase::readText(xmlTextReaderPtr reader)
       if (XML_READER_TYPE_TEXT == tokenType || XML_READER_TYPE_SIGNIFICANT_WHITESPACE == tokenType)
       {
         librevenge::RVNGBinaryData tmpText;
-        const unsigned char *tmpBuffer = xmlTextReaderConstValue(reader);
+        const unsigned char *tmpBuffer = reader->getValue();
         int tmpLength = xmlStrlen(tmpBuffer);
         for (int i = 0; i < tmpLength && tmpBuffer[i]; ++i)
         {
@@ -1170,9 +1169,9 @@ void libvisio::VSDXMLParserBase::readText(xmlTextReaderPtr reader)
   while ((XML_TEXT != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VSDXMLParserBase::readCharIX(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readCharIX(VSDXMLReader *reader)
 {
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
     return;
 
   unsigned ix = getIX(reader);
@@ -1202,20 +1201,20 @@ void libvisio::VSDXMLParserBase::readCharIX(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readCharIX: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readCharIX: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_FONT:
       if (XML_READER_TYPE_ELEMENT == tokenType)
       {
-        const shared_ptr<xmlChar> stringValue(readStringData(reader), xmlFree);
-        if (stringValue && !xmlStrEqual(stringValue.get(), BAD_CAST("Themed")))
+        const xmlChar *const stringValue = readStringData(reader);
+        if (stringValue && !xmlStrEqual(stringValue, BAD_CAST("Themed")))
         {
           try
           {
@@ -1224,11 +1223,11 @@ void libvisio::VSDXMLParserBase::readCharIX(xmlTextReaderPtr reader)
             if (iter != m_fonts.end())
               font = iter->second;
             else
-              font = VSDName(librevenge::RVNGBinaryData(stringValue.get(), xmlStrlen(stringValue.get())), VSD_TEXT_UTF8);
+              font = VSDName(librevenge::RVNGBinaryData(stringValue, xmlStrlen(stringValue)), VSD_TEXT_UTF8);
           }
           catch (const XmlParserException &)
           {
-            font = VSDName(librevenge::RVNGBinaryData(stringValue.get(), xmlStrlen(stringValue.get())), VSD_TEXT_UTF8);
+            font = VSDName(librevenge::RVNGBinaryData(stringValue, xmlStrlen(stringValue)), VSD_TEXT_UTF8);
           }
         }
       }
@@ -1352,9 +1351,9 @@ void libvisio::VSDXMLParserBase::readCharIX(xmlTextReaderPtr reader)
   }
 }
 
-void libvisio::VSDXMLParserBase::readLayerIX(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readLayerIX(VSDXMLReader *reader)
 {
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
     return;
 
   unsigned ix = getIX(reader);
@@ -1368,13 +1367,13 @@ void libvisio::VSDXMLParserBase::readLayerIX(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readLayerIX: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readLayerIX: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -1403,9 +1402,9 @@ void libvisio::VSDXMLParserBase::readLayerIX(xmlTextReaderPtr reader)
   m_collector->collectLayer(ix, level, layer);
 }
 
-void libvisio::VSDXMLParserBase::readParaIX(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readParaIX(VSDXMLReader *reader)
 {
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
     return;
 
   unsigned ix = getIX(reader);
@@ -1432,13 +1431,13 @@ void libvisio::VSDXMLParserBase::readParaIX(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readParaIX: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readParaIX: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -1479,24 +1478,24 @@ void libvisio::VSDXMLParserBase::readParaIX(xmlTextReaderPtr reader)
         ret = readByteData(bullet, reader);
       break;
     case XML_BULLETSTR:
-      if (XML_READER_TYPE_ELEMENT == tokenType && !xmlTextReaderIsEmptyElement(reader))
+      if (XML_READER_TYPE_ELEMENT == tokenType && !reader->isEmptyElement())
       {
-        const shared_ptr<xmlChar> stringValue(readStringData(reader), xmlFree);
-        if (stringValue && !xmlStrEqual(stringValue.get(), BAD_CAST("Themed")))
+        const xmlChar *const stringValue = readStringData(reader);
+        if (stringValue && !xmlStrEqual(stringValue, BAD_CAST("Themed")))
         {
-          unsigned length = xmlStrlen(stringValue.get());
-          const xmlChar *strV = stringValue.get();
+          unsigned length = xmlStrlen(stringValue);
+          const xmlChar *strV = stringValue;
           // The character U+E000 is considered as empty string in VDX produced by Visio 2002
           if (3 != length || 0xee != strV[0] || 0x80 != strV[1] || 0x80 != strV[2])
-            bulletStr = VSDName(librevenge::RVNGBinaryData(stringValue.get(), xmlStrlen(stringValue.get())), VSD_TEXT_UTF8);
+            bulletStr = VSDName(librevenge::RVNGBinaryData(stringValue, xmlStrlen(stringValue)), VSD_TEXT_UTF8);
         }
       }
       break;
     case XML_BULLETFONT:
       if (XML_READER_TYPE_ELEMENT == tokenType)
       {
-        const shared_ptr<xmlChar> stringValue(readStringData(reader), xmlFree);
-        if (stringValue && !xmlStrEqual(stringValue.get(), BAD_CAST("Themed")))
+        const xmlChar *const stringValue = readStringData(reader);
+        if (stringValue && !xmlStrEqual(stringValue, BAD_CAST("Themed")))
         {
           try
           {
@@ -1507,12 +1506,12 @@ void libvisio::VSDXMLParserBase::readParaIX(xmlTextReaderPtr reader)
               if (iter != m_fonts.end())
                 bulletFont = iter->second;
               else
-                bulletFont = VSDName(librevenge::RVNGBinaryData(stringValue.get(), xmlStrlen(stringValue.get())), VSD_TEXT_UTF8);
+                bulletFont = VSDName(librevenge::RVNGBinaryData(stringValue, xmlStrlen(stringValue)), VSD_TEXT_UTF8);
             }
           }
           catch (const XmlParserException &)
           {
-            bulletFont = VSDName(librevenge::RVNGBinaryData(stringValue.get(), xmlStrlen(stringValue.get())), VSD_TEXT_UTF8);
+            bulletFont = VSDName(librevenge::RVNGBinaryData(stringValue, xmlStrlen(stringValue)), VSD_TEXT_UTF8);
           }
         }
       }
@@ -1549,12 +1548,12 @@ void libvisio::VSDXMLParserBase::readParaIX(xmlTextReaderPtr reader)
   }
 }
 
-void libvisio::VSDXMLParserBase::readStyleSheet(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readStyleSheet(VSDXMLReader *reader)
 {
-  const shared_ptr<xmlChar> id(xmlTextReaderGetAttribute(reader, BAD_CAST("ID")), xmlFree);
-  const shared_ptr<xmlChar> lineStyle(xmlTextReaderGetAttribute(reader, BAD_CAST("LineStyle")), xmlFree);
-  const shared_ptr<xmlChar> fillStyle(xmlTextReaderGetAttribute(reader, BAD_CAST("FillStyle")), xmlFree);
-  const shared_ptr<xmlChar> textStyle(xmlTextReaderGetAttribute(reader, BAD_CAST("TextStyle")), xmlFree);
+  const xmlChar *const id = reader->getConstAttribute(BAD_CAST("ID"));
+  const xmlChar *const lineStyle = reader->getConstAttribute(BAD_CAST("LineStyle"));
+  const xmlChar *const fillStyle = reader->getConstAttribute(BAD_CAST("FillStyle"));
+  const xmlChar *const textStyle = reader->getConstAttribute(BAD_CAST("TextStyle"));
   if (id)
   {
     auto nId = (unsigned)xmlStringToLong(id);
@@ -1565,13 +1564,13 @@ void libvisio::VSDXMLParserBase::readStyleSheet(xmlTextReaderPtr reader)
   }
 }
 
-void libvisio::VSDXMLParserBase::readPageSheet(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readPageSheet(VSDXMLReader *reader)
 {
   m_currentShapeLevel = (unsigned)getElementDepth(reader);
   m_collector->collectPageSheet(0, m_currentShapeLevel);
 }
 
-void libvisio::VSDXMLParserBase::readSplineStart(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readSplineStart(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -1580,9 +1579,9 @@ void libvisio::VSDXMLParserBase::readSplineStart(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -1600,13 +1599,13 @@ void libvisio::VSDXMLParserBase::readSplineStart(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readSplineStart: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readSplineStart: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -1637,7 +1636,7 @@ void libvisio::VSDXMLParserBase::readSplineStart(xmlTextReaderPtr reader)
     m_currentGeometryList->addSplineStart(ix, level, x, y, a, b, c, d);
 }
 
-void libvisio::VSDXMLParserBase::readSplineKnot(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readSplineKnot(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -1646,9 +1645,9 @@ void libvisio::VSDXMLParserBase::readSplineKnot(xmlTextReaderPtr reader)
 
   unsigned ix = getIX(reader);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
-    const shared_ptr<xmlChar> delString(xmlTextReaderGetAttribute(reader, BAD_CAST("Del")), xmlFree);
+    const xmlChar *const delString = reader->getConstAttribute(BAD_CAST("Del"));
     if (delString)
     {
       if (xmlStringToBool(delString))
@@ -1663,13 +1662,13 @@ void libvisio::VSDXMLParserBase::readSplineKnot(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXMLParserBase::readSplineKnot: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXMLParserBase::readSplineKnot: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     switch (tokenId)
     {
@@ -1691,9 +1690,9 @@ void libvisio::VSDXMLParserBase::readSplineKnot(xmlTextReaderPtr reader)
     m_currentGeometryList->addSplineKnot(ix, level, x, y, a);
 }
 
-void libvisio::VSDXMLParserBase::readStencil(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readStencil(VSDXMLReader *reader)
 {
-  const shared_ptr<xmlChar> id(xmlTextReaderGetAttribute(reader, BAD_CAST("ID")), xmlFree);
+  const xmlChar *const id = reader->getConstAttribute(BAD_CAST("ID"));
   if (id)
   {
     auto nId = (unsigned)xmlStringToLong(id);
@@ -1704,34 +1703,34 @@ void libvisio::VSDXMLParserBase::readStencil(xmlTextReaderPtr reader)
   m_currentStencil.reset(new VSDStencil());
 }
 
-void libvisio::VSDXMLParserBase::readForeignData(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readForeignData(VSDXMLReader *reader)
 {
   VSD_DEBUG_MSG(("VSDXMLParser::readForeignData\n"));
   if (!m_shape.m_foreign)
     m_shape.m_foreign = make_unique<ForeignData>();
 
-  const shared_ptr<xmlChar> foreignTypeString(xmlTextReaderGetAttribute(reader, BAD_CAST("ForeignType")), xmlFree);
+  const xmlChar *const foreignTypeString = reader->getConstAttribute(BAD_CAST("ForeignType"));
   if (foreignTypeString)
   {
-    if (xmlStrEqual(foreignTypeString.get(), BAD_CAST("Bitmap")))
+    if (xmlStrEqual(foreignTypeString, BAD_CAST("Bitmap")))
       m_shape.m_foreign->type = 1;
-    else if (xmlStrEqual(foreignTypeString.get(), BAD_CAST("Object")))
+    else if (xmlStrEqual(foreignTypeString, BAD_CAST("Object")))
       m_shape.m_foreign->type = 2;
-    else if (xmlStrEqual(foreignTypeString.get(), BAD_CAST("EnhMetaFile")))
+    else if (xmlStrEqual(foreignTypeString, BAD_CAST("EnhMetaFile")))
       m_shape.m_foreign->type = 4;
-    else if (xmlStrEqual(foreignTypeString.get(), BAD_CAST("MetaFile")))
+    else if (xmlStrEqual(foreignTypeString, BAD_CAST("MetaFile")))
       m_shape.m_foreign->type = 0;
   }
-  const shared_ptr<xmlChar> foreignFormatString(xmlTextReaderGetAttribute(reader, BAD_CAST("CompressionType")), xmlFree);
+  const xmlChar *const foreignFormatString = reader->getConstAttribute(BAD_CAST("CompressionType"));
   if (foreignFormatString)
   {
-    if (xmlStrEqual(foreignFormatString.get(), BAD_CAST("JPEG")))
+    if (xmlStrEqual(foreignFormatString, BAD_CAST("JPEG")))
       m_shape.m_foreign->format = 1;
-    else if (xmlStrEqual(foreignFormatString.get(), BAD_CAST("GIF")))
+    else if (xmlStrEqual(foreignFormatString, BAD_CAST("GIF")))
       m_shape.m_foreign->format = 2;
-    else if (xmlStrEqual(foreignFormatString.get(), BAD_CAST("TIFF")))
+    else if (xmlStrEqual(foreignFormatString, BAD_CAST("TIFF")))
       m_shape.m_foreign->format = 3;
-    else if (xmlStrEqual(foreignFormatString.get(), BAD_CAST("PNG")))
+    else if (xmlStrEqual(foreignFormatString, BAD_CAST("PNG")))
       m_shape.m_foreign->format = 4;
     else
       m_shape.m_foreign->format = 0;
@@ -1845,29 +1844,52 @@ void libvisio::VSDXMLParserBase::_handleLevelChange(unsigned level)
   m_collector->collectUnhandledChunk(0, m_currentLevel);
 }
 
-void libvisio::VSDXMLParserBase::handlePagesStart(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::handlePagesStart(VSDXMLReader *reader)
 {
   m_isShapeStarted = false;
   m_isStencilStarted = false;
   if (m_extractStencils)
     skipPages(reader);
+  else
+    m_pageSelection.reset();
 }
 
-void libvisio::VSDXMLParserBase::handlePagesEnd(xmlTextReaderPtr /* reader */)
+void libvisio::VSDXMLParserBase::handlePagesEnd(VSDXMLReader * /* reader */)
 {
   m_isShapeStarted = false;
   if (!m_extractStencils)
     m_collector->endPages();
 }
 
-void libvisio::VSDXMLParserBase::handlePageStart(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::handlePageStart(VSDXMLReader *reader)
 {
   m_isShapeStarted = false;
-  if (!m_extractStencils)
+  if (m_extractStencils)
+    return;
+  if (isPageSelected(reader))
     readPage(reader);
+  else
+    skipPage(reader);
 }
 
-void libvisio::VSDXMLParserBase::handlePageEnd(xmlTextReaderPtr /* reader */)
+bool libvisio::VSDXMLParserBase::isPageSelected(VSDXMLReader *reader)
+{
+  if (m_pageSelection.selectsAll())
+    return true;
+  const xmlChar *const background = reader->getConstAttribute(BAD_CAST("Background"));
+  if (background && xmlStringToBool(background))
+    return true;
+  const xmlChar *pageName = nullptr;
+  if (m_pageSelection.needsNames())
+  {
+    pageName = reader->getConstAttribute(BAD_CAST("Name"));
+    if (!pageName)
+      pageName = reader->getConstAttribute(BAD_CAST("NameU"));
+  }
+  return m_pageSelection.nextPage((const char *)pageName);
+}
+
+void libvisio::VSDXMLParserBase::handlePageEnd(VSDXMLReader * /* reader */)
 {
   m_isShapeStarted = false;
   if (!m_extractStencils)
@@ -1880,7 +1902,7 @@ void libvisio::VSDXMLParserBase::handlePageEnd(xmlTextReaderPtr /* reader */)
   }
 }
 
-void libvisio::VSDXMLParserBase::handleMastersStart(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::handleMastersStart(VSDXMLReader *reader)
 {
   m_isShapeStarted = false;
   if (m_stencils.count())
@@ -1894,7 +1916,7 @@ void libvisio::VSDXMLParserBase::handleMastersStart(xmlTextReaderPtr reader)
   }
 }
 
-void libvisio::VSDXMLParserBase::handleMastersEnd(xmlTextReaderPtr /* reader */)
+void libvisio::VSDXMLParserBase::handleMastersEnd(VSDXMLReader * /* reader */)
 {
   m_isShapeStarted = false;
   if (m_extractStencils)
@@ -1903,7 +1925,7 @@ void libvisio::VSDXMLParserBase::handleMastersEnd(xmlTextReaderPtr /* reader */)
     m_isStencilStarted = false;
 }
 
-void libvisio::VSDXMLParserBase::handleMasterStart(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::handleMasterStart(VSDXMLReader *reader)
 {
   m_isShapeStarted = false;
   if (m_extractStencils)
@@ -1912,7 +1934,7 @@ void libvisio::VSDXMLParserBase::handleMasterStart(xmlTextReaderPtr reader)
     readStencil(reader);
 }
 
-void libvisio::VSDXMLParserBase::handleMasterEnd(xmlTextReaderPtr /* reader */)
+void libvisio::VSDXMLParserBase::handleMasterEnd(VSDXMLReader * /* reader */)
 {
   m_isShapeStarted = false;
   m_isPageStarted = false;
@@ -1927,46 +1949,62 @@ void libvisio::VSDXMLParserBase::handleMasterEnd(xmlTextReaderPtr /* reader */)
   else
   {
     if (m_currentStencil)
-      m_stencils.addStencil(m_currentStencilID, *m_currentStencil);
+      m_stencils.addStencil(m_currentStencilID, std::move(m_currentStencil));
     m_currentStencil.reset();
     m_currentStencilID = MINUS_ONE;
   }
 }
 
-void libvisio::VSDXMLParserBase::skipMasters(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::skipMasters(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
   }
   while ((XML_MASTERS != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret);
 }
 
-void libvisio::VSDXMLParserBase::skipPages(xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::skipPages(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
   }
   while ((XML_PAGES != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret);
 }
 
-int libvisio::VSDXMLParserBase::readNURBSData(boost::optional<NURBSData> &data, xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::skipPage(VSDXMLReader *reader)
+{
+  if (reader->isEmptyElement())
+    return;
+  int ret = 1;
+  int tokenId = XML_TOKEN_INVALID;
+  int tokenType = -1;
+  do
+  {
+    ret = reader->read();
+    tokenId = getElementToken(reader);
+    tokenType = reader->getNodeType();
+  }
+  while ((XML_PAGE != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret);
+}
+
+int libvisio::VSDXMLParserBase::readNURBSData(boost::optional<NURBSData> &data, VSDXMLReader *reader)
 {
   NURBSData tmpData;
 
   bool bRes = false;
-  const shared_ptr<xmlChar> formula(readStringData(reader), xmlFree);
+  const xmlChar *const formula = readStringData(reader);
 
   if (formula)
   {
@@ -1977,7 +2015,7 @@ int libvisio::VSDXMLParserBase::readNURBSData(boost::optional<NURBSData> &data,
     using phx::push_back;
     using phx::ref;
 
-    auto first = reinterpret_cast<const char *>(formula.get());
+    auto first = reinterpret_cast<const char *>(formula);
     const auto last = first + strlen(first);
     bRes = phrase_parse(first, last,
                         //  Begin grammar
@@ -2014,12 +2052,12 @@ int libvisio::VSDXMLParserBase::readNURBSData(boost::optional<NURBSData> &data,
   return 1;
 }
 
-int libvisio::VSDXMLParserBase::readPolylineData(boost::optional<PolylineData> &data, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readPolylineData(boost::optional<PolylineData> &data, VSDXMLReader *reader)
 {
   PolylineData tmpData;
 
   bool bRes = false;
-  const shared_ptr<xmlChar> formula(readStringData(reader), xmlFree);
+  const xmlChar *const formula = readStringData(reader);
 
   if (formula)
   {
@@ -2030,7 +2068,7 @@ int libvisio::VSDXMLParserBase::readPolylineData(boost::optional<PolylineData> &
     using phx::push_back;
     using phx::ref;
 
-    auto first = reinterpret_cast<const char *>(formula.get());
+    auto first = reinterpret_cast<const char *>(formula);
     const auto last = first + strlen(first);
     bRes = phrase_parse(first, last,
                         (
@@ -2058,28 +2096,28 @@ int libvisio::VSDXMLParserBase::readPolylineData(boost::optional<PolylineData> &
 }
 
 
-int libvisio::VSDXMLParserBase::readDoubleData(double &value, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readDoubleData(double &value, VSDXMLReader *reader)
 {
-  const shared_ptr<xmlChar> stringValue(readStringData(reader), xmlFree);
+  const xmlChar *const stringValue = readStringData(reader);
   if (stringValue)
   {
-    VSD_DEBUG_MSG(("VSDXMLParserBase::readDoubleData stringValue %s\n", (const char *)stringValue.get()));
-    if (!xmlStrEqual(stringValue.get(), BAD_CAST("Themed")))
+    VSD_DEBUG_MSG(("VSDXMLParserBase::readDoubleData stringValue %s\n", (const char *)stringValue));
+    if (!xmlStrEqual(stringValue, BAD_CAST("Themed")))
       value = xmlStringToDouble(stringValue);
     return 1;
   }
   return -1;
 }
 
-int libvisio::VSDXMLParserBase::readStringData(libvisio::VSDName &text, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readStringData(libvisio::VSDName &text, VSDXMLReader *reader)
 {
-  const shared_ptr<xmlChar> stringValue(readStringData(reader), xmlFree);
+  const xmlChar *const stringValue = readStringData(reader);
   if (stringValue)
   {
-    VSD_DEBUG_MSG(("VSDXMLParserBase::readStringData stringValue %s\n", (const char *)stringValue.get()));
-    if (!xmlStrEqual(stringValue.get(), BAD_CAST("Themed")))
+    VSD_DEBUG_MSG(("VSDXMLParserBase::readStringData stringValue %s\n", (const char *)stringValue));
+    if (!xmlStrEqual(stringValue, BAD_CAST("Themed")))
     {
-      text.m_data = librevenge::RVNGBinaryData(stringValue.get(), xmlStrlen(stringValue.get()));
+      text.m_data = librevenge::RVNGBinaryData(stringValue, xmlStrlen(stringValue));
       text.m_format = VSD_TEXT_UTF8;
     }
     return 1;
@@ -2087,72 +2125,72 @@ int libvisio::VSDXMLParserBase::readStringData(libvisio::VSDName &text, xmlTextR
   return -1;
 }
 
-int libvisio::VSDXMLParserBase::readDoubleData(boost::optional<double> &value, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readDoubleData(boost::optional<double> &value, VSDXMLReader *reader)
 {
-  const shared_ptr<xmlChar> stringValue(readStringData(reader), xmlFree);
+  const xmlChar *const stringValue = readStringData(reader);
   if (stringValue)
   {
-    VSD_DEBUG_MSG(("VSDXMLParserBase::readDoubleData stringValue %s\n", (const char *)stringValue.get()));
-    if (!xmlStrEqual(stringValue.get(), BAD_CAST("Themed")))
+    VSD_DEBUG_MSG(("VSDXMLParserBase::readDoubleData stringValue %s\n", (const char *)stringValue));
+    if (!xmlStrEqual(stringValue, BAD_CAST("Themed")))
       value = xmlStringToDouble(stringValue);
     return 1;
   }
   return -1;
 }
 
-int libvisio::VSDXMLParserBase::readLongData(long &value, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readLongData(long &value, VSDXMLReader *reader)
 {
-  const shared_ptr<xmlChar> stringValue(readStringData(reader), xmlFree);
+  const xmlChar *const stringValue = readStringData(reader);
   if (stringValue)
   {
-    VSD_DEBUG_MSG(("VSDXMLParserBase::readLongData stringValue %s\n", (const char *)stringValue.get()));
-    if (!xmlStrEqual(stringValue.get(), BAD_CAST("Themed")))
+    VSD_DEBUG_MSG(("VSDXMLParserBase::readLongData stringValue %s\n", (const char *)stringValue));
+    if (!xmlStrEqual(stringValue, BAD_CAST("Themed")))
       value = xmlStringToLong(stringValue);
     return 1;
   }
   return -1;
 }
 
-int libvisio::VSDXMLParserBase::readLongData(boost::optional<long> &value, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readLongData(boost::optional<long> &value, VSDXMLReader *reader)
 {
-  const shared_ptr<xmlChar> stringValue(readStringData(reader), xmlFree);
+  const xmlChar *const stringValue = readStringData(reader);
   if (stringValue)
   {
-    VSD_DEBUG_MSG(("VSDXMLParserBase::readLongData stringValue %s\n", (const char *)stringValue.get()));
-    if (!xmlStrEqual(stringValue.get(), BAD_CAST("Themed")))
+    VSD_DEBUG_MSG(("VSDXMLParserBase::readLongData stringValue %s\n", (const char *)stringValue));
+    if (!xmlStrEqual(stringValue, BAD_CAST("Themed")))
       value = xmlStringToLong(stringValue);
     return 1;
   }
   return -1;
 }
 
-int libvisio::VSDXMLParserBase::readBoolData(bool &value, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readBoolData(bool &value, VSDXMLReader *reader)
 {
-  const shared_ptr<xmlChar> stringValue(readStringData(reader), xmlFree);
+  const xmlChar *const stringValue = readStringData(reader);
   if (stringValue)
   {
-    VSD_DEBUG_MSG(("VSDXMLParserBase::readBoolData stringValue %s\n", (const char *)stringValue.get()));
-    if (!xmlStrEqual(stringValue.get(), BAD_CAST("Themed")))
+    VSD_DEBUG_MSG(("VSDXMLParserBase::readBoolData stringValue %s\n", (const char *)stringValue));
+    if (!xmlStrEqual(stringValue, BAD_CAST("Themed")))
       value = xmlStringToBool(stringValue);
     return 1;
   }
   return -1;
 }
 
-int libvisio::VSDXMLParserBase::readBoolData(boost::optional<bool> &value, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readBoolData(boost::optional<bool> &value, VSDXMLReader *reader)
 {
-  const shared_ptr<xmlChar> stringValue(readStringData(reader), xmlFree);
+  const xmlChar *const stringValue = readStringData(reader);
   if (stringValue)
   {
-    VSD_DEBUG_MSG(("VSDXMLParserBase::readBoolData stringValue %s\n", (const char *)stringValue.get()));
-    if (!xmlStrEqual(stringValue.get(), BAD_CAST("Themed")))
+    VSD_DEBUG_MSG(("VSDXMLParserBase::readBoolData stringValue %s\n", (const char *)stringValue));
+    if (!xmlStrEqual(stringValue, BAD_CAST("Themed")))
       value = xmlStringToBool(stringValue);
     return 1;
   }
   return -1;
 }
 
-int libvisio::VSDXMLParserBase::readUnsignedData(boost::optional<unsigned> &value, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readUnsignedData(boost::optional<unsigned> &value, VSDXMLReader *reader)
 {
   boost::optional<long> tmpValue;
   int ret = readLongData(tmpValue, reader);
@@ -2161,7 +2199,7 @@ int libvisio::VSDXMLParserBase::readUnsignedData(boost::optional<unsigned> &valu
   return ret;
 }
 
-int libvisio::VSDXMLParserBase::readByteData(unsigned char &value, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readByteData(unsigned char &value, VSDXMLReader *reader)
 {
   long longValue = 0;
   int ret = readLongData(longValue, reader);
@@ -2169,7 +2207,7 @@ int libvisio::VSDXMLParserBase::readByteData(unsigned char &value, xmlTextReader
   return ret;
 }
 
-int libvisio::VSDXMLParserBase::readByteData(boost::optional<unsigned char> &value, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readByteData(boost::optional<unsigned char> &value, VSDXMLReader *reader)
 {
   boost::optional<long> tmpValue;
   int ret = readLongData(tmpValue, reader);
@@ -2178,13 +2216,13 @@ int libvisio::VSDXMLParserBase::readByteData(boost::optional<unsigned char> &val
   return ret;
 }
 
-int libvisio::VSDXMLParserBase::readExtendedColourData(Colour &value, long &idx, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readExtendedColourData(Colour &value, long &idx, VSDXMLReader *reader)
 {
-  const shared_ptr<xmlChar> stringValue(readStringData(reader), xmlFree);
+  const xmlChar *const stringValue = readStringData(reader);
   if (stringValue)
   {
-    VSD_DEBUG_MSG(("VSDXMLParserBase::readColourData stringValue %s\n", (const char *)stringValue.get()));
-    if (!xmlStrEqual(stringValue.get(), BAD_CAST("Themed")))
+    VSD_DEBUG_MSG(("VSDXMLParserBase::readColourData stringValue %s\n", (const char *)stringValue));
+    if (!xmlStrEqual(stringValue, BAD_CAST("Themed")))
     {
       try
       {
@@ -2210,7 +2248,7 @@ int libvisio::VSDXMLParserBase::readExtendedColourData(Colour &value, long &idx,
   return -1;
 }
 
-int libvisio::VSDXMLParserBase::readExtendedColourData(boost::optional<Colour> &value, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readExtendedColourData(boost::optional<Colour> &value, VSDXMLReader *reader)
 {
   Colour tmpValue;
   int ret = readExtendedColourData(tmpValue, reader);
@@ -2221,30 +2259,30 @@ int libvisio::VSDXMLParserBase::readExtendedColourData(boost::optional<Colour> &
   return ret;
 }
 
-int libvisio::VSDXMLParserBase::readExtendedColourData(Colour &value, xmlTextReaderPtr reader)
+int libvisio::VSDXMLParserBase::readExtendedColourData(Colour &value, VSDXMLReader *reader)
 {
   long idx = -1;
   return readExtendedColourData(value, idx, reader);
 }
 
-unsigned libvisio::VSDXMLParserBase::getIX(xmlTextReaderPtr reader)
+unsigned libvisio::VSDXMLParserBase::getIX(VSDXMLReader *reader)
 {
   auto ix = MINUS_ONE;
-  const std::shared_ptr<xmlChar> ixString(xmlTextReaderGetAttribute(reader, BAD_CAST("IX")), xmlFree);
+  const xmlChar *const ixString = reader->getConstAttribute(BAD_CAST("IX"));
   if (ixString)
-    ix = (unsigned)xmlStringToLong(ixString.get());
+    ix = (unsigned)xmlStringToLong(ixString);
   return ix;
 }
 
-void libvisio::VSDXMLParserBase::readTriggerId(unsigned &id, xmlTextReaderPtr reader)
+void libvisio::VSDXMLParserBase::readTriggerId(unsigned &id, VSDXMLReader *reader)
 {
   using namespace boost::spirit::qi;
 
   auto triggerId = MINUS_ONE;
-  const std::shared_ptr<xmlChar> triggerString(xmlTextReaderGetAttribute(reader, BAD_CAST("F")), xmlFree);
+  const xmlChar *const triggerString = reader->getConstAttribute(BAD_CAST("F"));
   if (triggerString)
   {
-    auto first = reinterpret_cast<const char *>(triggerString.get());
+    auto first = reinterpret_cast<const char *>(triggerString);
     const auto last = first + strlen(first);
     if (phrase_parse(first, last,
                      (
@@ -12,11 +12,14 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <stack>
 #include <string>
 #include <boost/optional.hpp>
 #include "VSDXMLHelper.h"
+#include "VSDXMLReader.h"
 #include "VSDCharacterList.h"
+#include "VSDPageSelection.h"
 #include "VSDParagraphList.h"
 #include "VSDShapeList.h"
 #include "VSDStencils.h"
@@ -25,6 +28,8 @@ namespace libvisio
 {
 
 class VSDCollector;
+class VSDPages;
+class VSDParseControl;
 class XMLErrorWatcher;
 
 class VSDXMLParserBase
@@ -34,6 +39,26 @@ public:
   virtual ~VSDXMLParserBase();
   virtual bool parseMain() = 0;
   virtual bool extractStencils() = 0;
+  void setPagesOutput(VSDPages *pages)
+  {
+    m_pagesOutput = pages;
+  }
+  void setProgressive(bool progressive)
+  {
+    m_progressive = progressive;
+  }
+  void setPageSelection(const std::set<unsigned> &pages, const std::set<std::string> &pageNames)
+  {
+    m_pageSelection.select(pages, pageNames);
+  }
+  void setParseControl(VSDParseControl *control)
+  {
+    m_parseControl = control;
+  }
+  void setTextOnly(bool textOnly)
+  {
+    m_textOnly = textOnly;
+  }
 
 protected:
   // Protected data
@@ -65,78 +90,87 @@ protected:
 
   XMLErrorWatcher *m_watcher;
 
+  VSDPages *m_pagesOutput;
+  bool m_progressive;
+  VSDPageSelection m_pageSelection;
+  VSDParseControl *m_parseControl;
+  bool m_textOnly;
+
   // Helper functions
 
-  int readByteData(unsigned char &value, xmlTextReaderPtr reader);
-  int readByteData(boost::optional<unsigned char> &value, xmlTextReaderPtr reader);
-  int readUnsignedData(boost::optional<unsigned> &value, xmlTextReaderPtr reader);
-  int readLongData(boost::optional<long> &value, xmlTextReaderPtr reader);
-  int readLongData(long &value, xmlTextReaderPtr reader);
-  int readDoubleData(boost::optional<double> &value, xmlTextReaderPtr reader);
-  int readDoubleData(double &value, xmlTextReaderPtr reader);
-  int readBoolData(boost::optional<bool> &value, xmlTextReaderPtr reader);
-  int readBoolData(bool &value, xmlTextReaderPtr reader);
-  int readExtendedColourData(Colour &value, long &idx, xmlTextReaderPtr reader);
-  int readExtendedColourData(Colour &value, xmlTextReaderPtr reader);
-  int readExtendedColourData(boost::optional<Colour> &value, xmlTextReaderPtr reader);
-  int readNURBSData(boost::optional<NURBSData> &data, xmlTextReaderPtr reader);
-  int readPolylineData(boost::optional<PolylineData> &data, xmlTextReaderPtr reader);
-  int readStringData(VSDName &text, xmlTextReaderPtr reader);
-  void readTriggerId(unsigned &id, xmlTextReaderPtr reader);
-
-  virtual xmlChar *readStringData(xmlTextReaderPtr reader) = 0;
-  unsigned getIX(xmlTextReaderPtr reader);
+  int readByteData(unsigned char &value, VSDXMLReader *reader);
+  int readByteData(boost::optional<unsigned char> &value, VSDXMLReader *reader);
+  int readUnsignedData(boost::optional<unsigned> &value, VSDXMLReader *reader);
+  int readLongData(boost::optional<long> &value, VSDXMLReader *reader);
+  int readLongData(long &value, VSDXMLReader *reader);
+  int readDoubleData(boost::optional<double> &value, VSDXMLReader *reader);
+  int readDoubleData(double &value, VSDXMLReader *reader);
+  int readBoolData(boost::optional<bool> &value, VSDXMLReader *reader);
+  int readBoolData(bool &value, VSDXMLReader *reader);
+  int readExtendedColourData(Colour &value, long &idx, VSDXMLReader *reader);
+  int readExtendedColourData(Colour &value, VSDXMLReader *reader);
+  int readExtendedColourData(boost::optional<Colour> &value, VSDXMLReader *reader);
+  int readNURBSData(boost::optional<NURBSData> &data, VSDXMLReader *reader);
+  int readPolylineData(boost::optional<PolylineData> &data, VSDXMLReader *reader);
+  int readStringData(VSDName &text, VSDXMLReader *reader);
+  void readTriggerId(unsigned &id, VSDXMLReader *reader);
+
+  // The value of the current cell, valid until the next read of reader, or null
+  virtual const xmlChar *readStringData(VSDXMLReader *reader) = 0;
+  unsigned getIX(VSDXMLReader *reader);
   virtual void _handleLevelChange(unsigned level);
   void _flushShape();
 
-  virtual int getElementToken(xmlTextReaderPtr reader) = 0;
-  virtual int getElementDepth(xmlTextReaderPtr reader) = 0;
+  virtual int getElementToken(VSDXMLReader *reader) = 0;
+  virtual int getElementDepth(VSDXMLReader *reader) = 0;
 
   // Functions reading the DiagramML document content
 
-  void readEllipticalArcTo(xmlTextReaderPtr reader);
-  void readEllipse(xmlTextReaderPtr reader);
-  void readGeometry(xmlTextReaderPtr reader);
-  void readMoveTo(xmlTextReaderPtr reader);
-  void readLineTo(xmlTextReaderPtr reader);
-  void readArcTo(xmlTextReaderPtr reader);
-  void readNURBSTo(xmlTextReaderPtr reader);
-  void readPolylineTo(xmlTextReaderPtr reader);
-  void readInfiniteLine(xmlTextReaderPtr reader);
-  void readRelCubBezTo(xmlTextReaderPtr reader);
-  void readRelEllipticalArcTo(xmlTextReaderPtr reader);
-  void readRelLineTo(xmlTextReaderPtr reader);
-  void readRelMoveTo(xmlTextReaderPtr reader);
-  void readRelQuadBezTo(xmlTextReaderPtr reader);
-  void readForeignData(xmlTextReaderPtr reader);
-  virtual void getBinaryData(xmlTextReaderPtr reader) = 0;
-  void readShape(xmlTextReaderPtr reader);
-  void readColours(xmlTextReaderPtr reader);
-  void readPage(xmlTextReaderPtr reader);
-  void readText(xmlTextReaderPtr reader);
-  void readCharIX(xmlTextReaderPtr reader);
-  void readParaIX(xmlTextReaderPtr reader);
-  void readLayerIX(xmlTextReaderPtr reader);
-  void readLayerMember(xmlTextReaderPtr reader);
-
-  void readStyleSheet(xmlTextReaderPtr reader);
-  void readPageSheet(xmlTextReaderPtr reader);
-
-  void readSplineStart(xmlTextReaderPtr reader);
-  void readSplineKnot(xmlTextReaderPtr reader);
-
-  void readStencil(xmlTextReaderPtr reader);
-
-  void handlePagesStart(xmlTextReaderPtr reader);
-  void handlePagesEnd(xmlTextReaderPtr reader);
-  void handlePageStart(xmlTextReaderPtr reader);
-  void handlePageEnd(xmlTextReaderPtr reader);
-  void handleMastersStart(xmlTextReaderPtr reader);
-  void handleMastersEnd(xmlTextReaderPtr reader);
-  void handleMasterStart(xmlTextReaderPtr reader);
-  void handleMasterEnd(xmlTextReaderPtr reader);
-  void skipPages(xmlTextReaderPtr reader);
-  void skipMasters(xmlTextReaderPtr reader);
+  void readEllipticalArcTo(VSDXMLReader *reader);
+  void readEllipse(VSDXMLReader *reader);
+  void readGeometry(VSDXMLReader *reader);
+  void readMoveTo(VSDXMLReader *reader);
+  void readLineTo(VSDXMLReader *reader);
+  void readArcTo(VSDXMLReader *reader);
+  void readNURBSTo(VSDXMLReader *reader);
+  void readPolylineTo(VSDXMLReader *reader);
+  void readInfiniteLine(VSDXMLReader *reader);
+  void readRelCubBezTo(VSDXMLReader *reader);
+  void readRelEllipticalArcTo(VSDXMLReader *reader);
+  void readRelLineTo(VSDXMLReader *reader);
+  void readRelMoveTo(VSDXMLReader *reader);
+  void readRelQuadBezTo(VSDXMLReader *reader);
+  void readForeignData(VSDXMLReader *reader);
+  virtual void getBinaryData(VSDXMLReader *reader) = 0;
+  void readShape(VSDXMLReader *reader);
+  void readColours(VSDXMLReader *reader);
+  void readPage(VSDXMLReader *reader);
+  void readText(VSDXMLReader *reader);
+  void readCharIX(VSDXMLReader *reader);
+  void readParaIX(VSDXMLReader *reader);
+  void readLayerIX(VSDXMLReader *reader);
+  void readLayerMember(VSDXMLReader *reader);
+
+  void readStyleSheet(VSDXMLReader *reader);
+  void readPageSheet(VSDXMLReader *reader);
+
+  void readSplineStart(VSDXMLReader *reader);
+  void readSplineKnot(VSDXMLReader *reader);
+
+  void readStencil(VSDXMLReader *reader);
+
+  void handlePagesStart(VSDXMLReader *reader);
+  void handlePagesEnd(VSDXMLReader *reader);
+  void handlePageStart(VSDXMLReader *reader);
+  void handlePageEnd(VSDXMLReader *reader);
+  void handleMastersStart(VSDXMLReader *reader);
+  void handleMastersEnd(VSDXMLReader *reader);
+  void handleMasterStart(VSDXMLReader *reader);
+  void handleMasterEnd(VSDXMLReader *reader);
+  void skipPages(VSDXMLReader *reader);
+  void skipPage(VSDXMLReader *reader);
+  bool isPageSelected(VSDXMLReader *reader);
+  void skipMasters(VSDXMLReader *reader);
 
 private:
   VSDXMLParserBase(const VSDXMLParserBase &);
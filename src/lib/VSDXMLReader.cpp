@@ -0,0 +1,230 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDXMLReader.h"
+
+#include "VSDParseControl.h"
+#include "VSDXMLTokenMap.h"
+
+namespace
+{
+
+const unsigned NO_STRING = unsigned(-1);
+
+} // anonymous namespace
+
+libvisio::VSDXMLTape::VSDXMLTape()
+  : m_nodes(), m_attributes(), m_values(), m_names(), m_nameTokens(), m_nameIndex(), m_nameBytes(0), m_complete(false)
+{
+}
+
+void libvisio::VSDXMLTape::clear()
+{
+  // clear() would keep the capacity of the containers
+  *this = VSDXMLTape();
+}
+
+unsigned long libvisio::VSDXMLTape::getSize() const
+{
+  return m_nodes.size() * sizeof(Node) + m_attributes.size() * sizeof(Attribute) + m_values.size() + m_nameBytes;
+}
+
+unsigned libvisio::VSDXMLTape::addName(const xmlChar *name)
+{
+  if (!name)
+    return NO_STRING;
+  const auto it = m_nameIndex.find((const char *)name);
+  if (it != m_nameIndex.end())
+    return it->second;
+  const auto index = unsigned(m_names.size());
+  m_names.push_back((const char *)name);
+  m_nameBytes += m_names.back().size() + 1;
+  m_nameTokens.push_back(VSDXMLTokenMap::getTokenId(name));
+  m_nameIndex[m_names.back()] = index;
+  return index;
+}
+
+unsigned libvisio::VSDXMLTape::addValue(const xmlChar *value)
+{
+  if (!value)
+    return NO_STRING;
+  const auto offset = unsigned(m_values.size());
+  m_values.insert(m_values.end(), value, value + xmlStrlen(value) + 1);
+  return offset;
+}
+
+libvisio::VSDXMLReader::VSDXMLReader(xmlTextReaderPtr reader, VSDXMLTape &tape, VSDParseControl *control)
+  : m_reader(reader), m_recording(&tape), m_control(control), m_tape(tape), m_next(0), m_attribute(0), m_openElements()
+{
+  tape.clear();
+}
+
+libvisio::VSDXMLReader::VSDXMLReader(const VSDXMLTape &tape)
+  : m_reader(nullptr), m_recording(nullptr), m_control(nullptr), m_tape(tape), m_next(0), m_attribute(0), m_openElements()
+{
+}
+
+int libvisio::VSDXMLReader::read()
+{
+  m_attribute = 0;
+  if (m_recording)
+  {
+    const int ret = xmlTextReaderRead(m_reader);
+    if (1 == ret)
+    {
+      const unsigned long size = m_tape.getSize();
+      record();
+      if (m_control)
+        m_control->addDecompressedBytes(m_tape.getSize() - size);
+    }
+    else if (0 == ret)
+      m_recording->m_complete = true;
+    m_next = 1 == ret ? m_tape.m_nodes.size() : m_tape.m_nodes.size() + 1;
+    return ret;
+  }
+
+  if (m_next < m_tape.m_nodes.size())
+  {
+    ++m_next;
+    return 1;
+  }
+  m_next = m_tape.m_nodes.size() + 1;
+  return 0;
+}
+
+void libvisio::VSDXMLReader::record()
+{
+  VSDXMLTape &tape = *m_recording;
+
+  VSDXMLTape::Node node;
+  node.type = xmlTextReaderNodeType(m_reader);
+  node.depth = xmlTextReaderDepth(m_reader);
+  node.isEmpty = 1 == xmlTextReaderIsEmptyElement(m_reader);
+  node.name = tape.addName(xmlTextReaderConstName(m_reader));
+  node.value = tape.addValue(xmlTextReaderConstValue(m_reader));
+  node.firstAttribute = unsigned(tape.m_attributes.size());
+  node.attributeCount = 0;
+  // libxml2 still gives the attributes of an element at its end
+  if (XML_READER_TYPE_END_ELEMENT == node.type && !m_openElements.empty())
+  {
+    const VSDXMLTape::Node &start = tape.m_nodes[m_openElements.back()];
+    node.firstAttribute = start.firstAttribute;
+    node.attributeCount = start.attributeCount;
+    m_openElements.pop_back();
+  }
+  // Not xmlTextReaderHasAttributes, which does not see namespace declarations
+  else if (XML_READER_TYPE_ELEMENT == node.type)
+  {
+    while (1 == xmlTextReaderMoveToNextAttribute(m_reader))
+    {
+      VSDXMLTape::Attribute attribute;
+      attribute.name = tape.addName(xmlTextReaderConstName(m_reader));
+      attribute.value = tape.addValue(xmlTextReaderConstValue(m_reader));
+      tape.m_attributes.push_back(attribute);
+      ++node.attributeCount;
+    }
+    xmlTextReaderMoveToElement(m_reader);
+    if (!node.isEmpty)
+      m_openElements.push_back(tape.m_nodes.size());
+  }
+  tape.m_nodes.push_back(node);
+}
+
+const libvisio::VSDXMLTape::Node *libvisio::VSDXMLReader::getNode() const
+{
+  if (!m_next || m_next > m_tape.m_nodes.size())
+    return nullptr;
+  return &m_tape.m_nodes[m_next - 1];
+}
+
+int libvisio::VSDXMLReader::getNodeType() const
+{
+  const VSDXMLTape::Node *node = getNode();
+  if (!node)
+    return -1;
+  return m_attribute ? XML_READER_TYPE_ATTRIBUTE : node->type;
+}
+
+int libvisio::VSDXMLReader::getDepth() const
+{
+  const VSDXMLTape::Node *node = getNode();
+  if (!node)
+    return -1;
+  return m_attribute ? node->depth + 1 : node->depth;
+}
+
+bool libvisio::VSDXMLReader::isEmptyElement() const
+{
+  const VSDXMLTape::Node *node = getNode();
+  return node && !m_attribute && node->isEmpty;
+}
+
+const xmlChar *libvisio::VSDXMLReader::getName() const
+{
+  const VSDXMLTape::Node *node = getNode();
+  if (!node)
+    return nullptr;
+  const unsigned name = m_attribute ? m_tape.m_attributes[node->firstAttribute + m_attribute - 1].name : node->name;
+  if (NO_STRING == name)
+    return nullptr;
+  return (const xmlChar *)m_tape.m_names[name].c_str();
+}
+
+int libvisio::VSDXMLReader::getToken() const
+{
+  const VSDXMLTape::Node *node = getNode();
+  if (!node)
+    return XML_TOKEN_INVALID;
+  const unsigned name = m_attribute ? m_tape.m_attributes[node->firstAttribute + m_attribute - 1].name : node->name;
+  if (NO_STRING == name)
+    return XML_TOKEN_INVALID;
+  return m_tape.m_nameTokens[name];
+}
+
+const xmlChar *libvisio::VSDXMLReader::getValue() const
+{
+  const VSDXMLTape::Node *node = getNode();
+  if (!node)
+    return nullptr;
+  const unsigned value = m_attribute ? m_tape.m_attributes[node->firstAttribute + m_attribute - 1].value : node->value;
+  if (NO_STRING == value)
+    return nullptr;
+  return &m_tape.m_values[value];
+}
+
+const xmlChar *libvisio::VSDXMLReader::getConstAttribute(const xmlChar *name) const
+{
+  const VSDXMLTape::Node *node = getNode();
+  if (!node || !name)
+    return nullptr;
+  for (unsigned i = node->firstAttribute; i != node->firstAttribute + node->attributeCount; ++i)
+  {
+    const VSDXMLTape::Attribute &attribute = m_tape.m_attributes[i];
+    if (NO_STRING != attribute.name && xmlStrEqual(name, (const xmlChar *)m_tape.m_names[attribute.name].c_str()))
+      return NO_STRING == attribute.value ? nullptr : &m_tape.m_values[attribute.value];
+  }
+  return nullptr;
+}
+
+xmlChar *libvisio::VSDXMLReader::getAttribute(const xmlChar *name) const
+{
+  const xmlChar *const value = getConstAttribute(name);
+  return value ? xmlStrdup(value) : nullptr;
+}
+
+bool libvisio::VSDXMLReader::moveToNextAttribute()
+{
+  const VSDXMLTape::Node *node = getNode();
+  if (!node || m_attribute == node->attributeCount)
+    return false;
+  ++m_attribute;
+  return true;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
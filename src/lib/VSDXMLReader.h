@@ -0,0 +1,135 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDXMLREADER_H__
+#define __VSDXMLREADER_H__
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <libxml/xmlreader.h>
+
+namespace libvisio
+{
+
+class VSDParseControl;
+
+/* The nodes of an XML document as the XML parsers read them, so that the
+ * second pass of a parse can read them again without inflating and
+ * tokenising the XML a second time. Names are stored once, together with
+ * their VSDXMLTokenMap id; values are kept in one NUL-separated buffer.
+ * That buffer grows while the tape is recorded, so the values only stay
+ * where they are once the tape is complete.
+ */
+class VSDXMLTape
+{
+public:
+  VSDXMLTape();
+
+  // Empties the tape and frees its memory
+  void clear();
+  // Whether the whole document was read into the tape without errors
+  bool isComplete() const
+  {
+    return m_complete;
+  }
+  // The bytes the nodes, attributes and strings of the tape take
+  unsigned long getSize() const;
+
+private:
+  friend class VSDXMLReader;
+
+  struct Node
+  {
+    int type;
+    int depth;
+    bool isEmpty;
+    unsigned name;
+    unsigned value;
+    unsigned firstAttribute;
+    unsigned attributeCount;
+  };
+
+  struct Attribute
+  {
+    unsigned name;
+    unsigned value;
+  };
+
+  unsigned addName(const xmlChar *name);
+  unsigned addValue(const xmlChar *value);
+
+  std::vector<Node> m_nodes;
+  std::vector<Attribute> m_attributes;
+  std::vector<xmlChar> m_values;
+  // A deque, so that the strings do not move when more names are added
+  std::deque<std::string> m_names;
+  std::vector<int> m_nameTokens;
+  std::unordered_map<std::string, unsigned> m_nameIndex;
+  unsigned long m_nameBytes;
+  bool m_complete;
+};
+
+/* Reads an XML document for the XML parsers, either from libxml2 while
+ * recording every node read into a tape, or by replaying a complete tape.
+ * The interface follows the xmlTextReader functions the parsers use; as
+ * with those, the strings returned stay valid until the next read(). When
+ * recording, the next read() can move the values of the tape; a replayed
+ * tape keeps them in place for as long as the tape is not changed.
+ */
+class VSDXMLReader
+{
+public:
+  /* Reads from reader and records into tape, which is cleared first. The
+   * bytes of the tape count as decompressed bytes of control, if any.
+   */
+  VSDXMLReader(xmlTextReaderPtr reader, VSDXMLTape &tape, VSDParseControl *control = nullptr);
+  // Replays tape, which has to be complete
+  explicit VSDXMLReader(const VSDXMLTape &tape);
+
+  int read();
+
+  int getNodeType() const;
+  int getDepth() const;
+  bool isEmptyElement() const;
+  const xmlChar *getName() const;
+  // The VSDXMLTokenMap id of getName()
+  int getToken() const;
+  const xmlChar *getValue() const;
+  // Returns the value of the attribute name, or null
+  const xmlChar *getConstAttribute(const xmlChar *name) const;
+  // Returns a copy of the value of the attribute name, to be freed by xmlFree, or null
+  xmlChar *getAttribute(const xmlChar *name) const;
+  bool moveToNextAttribute();
+
+private:
+  VSDXMLReader(const VSDXMLReader &);
+  VSDXMLReader &operator=(const VSDXMLReader &);
+
+  void record();
+  const VSDXMLTape::Node *getNode() const;
+
+  xmlTextReaderPtr m_reader;
+  VSDXMLTape *m_recording;
+  VSDParseControl *m_control;
+  const VSDXMLTape &m_tape;
+  // Index of the node after the current one
+  std::size_t m_next;
+  // 1 + index of the current attribute of the current node, or 0 if on the node itself
+  unsigned m_attribute;
+  // The elements being recorded that have not ended yet
+  std::vector<std::size_t> m_openElements;
+};
+
+} // namespace libvisio
+
+#endif // __VSDXMLREADER_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -151,6 +151,36 @@ bool libvisio::VSDXMetaData::parse(librevenge::RVNGInputStream *input)
   return !watcher.isError();
 }
 
+bool libvisio::VSDXMetaData::parsePackage(librevenge::RVNGInputStream *input, VSDXRelationships &rels)
+{
+  if (!input)
+    return false;
+  input->seek(0, librevenge::RVNG_SEEK_SET);
+  if (!input->isStructured())
+    return false;
+
+  const VSDXRelationship *coreProp = rels.getRelationshipByType("http://schemas.openxmlformats.org/package/2006/relationships/metadata/core-properties");
+  if (coreProp)
+  {
+    const RVNGInputStreamPtr_t stream(input->getSubStreamByName(coreProp->getTarget().c_str()));
+    if (stream)
+    {
+      parse(stream.get());
+    }
+  }
+
+  const VSDXRelationship *extendedProp = rels.getRelationshipByType("http://schemas.openxmlformats.org/officeDocument/2006/relationships/extended-properties");
+  if (extendedProp)
+  {
+    const RVNGInputStreamPtr_t stream(input->getSubStreamByName(extendedProp->getTarget().c_str()));
+    if (stream)
+    {
+      parse(stream.get());
+    }
+  }
+  return true;
+}
+
 int libvisio::VSDXMetaData::getElementToken(xmlTextReaderPtr reader)
 {
   return VSDXMLTokenMap::getTokenId(xmlTextReaderConstName(reader));
@@ -16,13 +16,15 @@
 namespace libvisio
 {
 
-/// Parses docProps/core.xml stream of a VSDX file.
+/// Parses docProps/core.xml and docProps/app.xml streams of a VSDX file.
 class VSDXMetaData
 {
 public:
   VSDXMetaData();
   ~VSDXMetaData();
   bool parse(librevenge::RVNGInputStream *input);
+  /// Parses the property parts that rels of the package input refer to.
+  bool parsePackage(librevenge::RVNGInputStream *input, VSDXRelationships &rels);
   const librevenge::RVNGPropertyList &getMetaData();
 
 private:
@@ -17,11 +17,17 @@
 #include "libvisio_utils.h"
 #include "libvisio_xml.h"
 #include "VSDContentCollector.h"
+#include "VSDDeferredCollector.h"
+#include "VSDParseControl.h"
 #include "VSDStylesCollector.h"
+#include "VSDTextCollector.h"
+#include "VSDWorkerPool.h"
 #include "VSDXMLHelper.h"
 #include "VSDXMLTokenMap.h"
 #include "VSDXMetaData.h"
 
+#define VSDX_DATA_READ_SIZE 4096UL
+
 namespace
 {
 static std::string getTargetBaseDirectory(const char *target)
@@ -45,8 +51,52 @@ std::string getRelationshipsForTarget(const char *target)
   return relStr;
 }
 
+void readAll(librevenge::RVNGInputStream *stream, librevenge::RVNGBinaryData &data)
+{
+  while (true)
+  {
+    unsigned long numBytesRead;
+    const unsigned char *buffer = stream->read(VSDX_DATA_READ_SIZE, numBytesRead);
+    if (numBytesRead)
+      data.append(buffer, numBytesRead);
+    if (stream->isEnd())
+      break;
+  }
+}
+
+// Whether a shape of stencil takes its properties from one of stencils
+bool refersToStencils(const libvisio::VSDStencil &stencil, const libvisio::VSDStencils &stencils)
+{
+  for (const auto &shape : stencil.m_shapes)
+  {
+    if (stencils.getStencil(shape.second.m_masterPage))
+      return true;
+  }
+  return false;
+}
+
 } // anonymous namespace
 
+// A page or master part that a worker parsed, waiting for the part that refers to it to get there
+struct libvisio::VSDXParser::ParsedPart
+{
+  ParsedPart(VSDXMLTape &tape_, const VSDXRelationships &rels_, int depth_, const std::function<VSDCollector &()> &getTarget)
+    : tape(tape_), stream(), rels(rels_), depth(depth_), calls(getTarget), shapeList(), stencil(), chunks(0), isComplete(false)
+  {
+  }
+
+  // The worker records the tape from stream if the first pass has not
+  VSDXMLTape &tape;
+  std::unique_ptr<librevenge::RVNGInputStream> stream;
+  const VSDXRelationships &rels;
+  int depth;
+  VSDDeferredCollector calls;
+  VSDShapeList shapeList;
+  // The master that a master part fills, null for a page part
+  std::unique_ptr<VSDStencil> stencil;
+  unsigned long chunks;
+  bool isComplete;
+};
 
 libvisio::VSDXParser::VSDXParser(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter)
   : VSDXMLParserBase(),
@@ -54,8 +104,49 @@ libvisio::VSDXParser::VSDXParser(librevenge::RVNGInputStream *input, librevenge:
     m_painter(painter),
     m_currentDepth(0),
     m_rels(nullptr),
-    m_currentTheme()
+    m_currentTheme(),
+    m_isStylesPass(false),
+    m_tapes(),
+    m_openParts(),
+    m_relationships(),
+    m_binaryParts(),
+    m_currentThemeName(),
+    m_isCurrentThemeParsed(false),
+    m_pageThreads(0),
+    m_parsedParts(),
+    m_packageOwner(nullptr),
+    m_packageMutex(),
+    m_needsDocumentOrder(false)
+{
+}
+
+libvisio::VSDXParser::VSDXParser(VSDXParser &owner, VSDCollector &collector)
+  : VSDXMLParserBase(),
+    m_input(nullptr),
+    m_painter(nullptr),
+    m_currentDepth(0),
+    m_rels(nullptr),
+    m_currentTheme(),
+    m_isStylesPass(false),
+    m_tapes(),
+    m_openParts(),
+    m_relationships(),
+    m_binaryParts(),
+    m_currentThemeName(),
+    m_isCurrentThemeParsed(false),
+    m_pageThreads(0),
+    m_parsedParts(),
+    m_packageOwner(&owner),
+    m_packageMutex(),
+    m_needsDocumentOrder(false)
 {
+  // What the parts are parsed with: the document and the masters read so far
+  m_collector = &collector;
+  m_stencils = owner.m_stencils;
+  m_colours = owner.m_colours;
+  m_fonts = owner.m_fonts;
+  m_textOnly = owner.m_textOnly;
+  m_isStylesPass = owner.m_isStylesPass;
 }
 
 libvisio::VSDXParser::~VSDXParser()
@@ -85,17 +176,35 @@ bool libvisio::VSDXParser::parseMain() try
 
   VSDStylesCollector stylesCollector(groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders);
   m_collector = &stylesCollector;
-  if (!parseDocument(m_input, rel->getTarget().c_str()))
-    return false;
+  clearPackageCache();
+  m_isStylesPass = true;
+  {
+    if (m_parseControl)
+      m_parseControl->addPass();
+    VSDParseTimer timer(m_parseControl, &VisioParseStats::firstPassSeconds);
+    if (!parseDocument(m_input, rel->getTarget().c_str()))
+      return false;
+  }
 
   VSDStyles styles = stylesCollector.getStyleSheets();
 
-  VSDContentCollector contentCollector(m_painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, m_stencils);
-  m_collector = &contentCollector;
+  const std::unique_ptr<VSDContentCollector> contentCollector =
+    makeContentCollector(m_textOnly, m_painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, m_stencils);
+  contentCollector->setPagesOutput(m_pagesOutput);
+  contentCollector->setProgressive(m_progressive);
+  contentCollector->setParseControl(m_parseControl);
+  m_collector = contentCollector.get();
+  m_isStylesPass = false;
   parseMetaData(m_input, rootRels);
 
-  if (!parseDocument(m_input, rel->getTarget().c_str()))
-    return false;
+  {
+    if (m_parseControl)
+      m_parseControl->addPass();
+    VSDParseTimer timer(m_parseControl, &VisioParseStats::secondPassSeconds);
+    if (!parseDocument(m_input, rel->getTarget().c_str()))
+      return false;
+  }
+  clearPackageCache();
 
   return true;
 }
@@ -117,14 +226,15 @@ bool libvisio::VSDXParser::parseDocument(librevenge::RVNGInputStream *input, con
   input->seek(0, librevenge::RVNG_SEEK_SET);
   if (!input->isStructured())
     return false;
-  const RVNGInputStreamPtr_t stream(input->getSubStreamByName(name));
-  input->seek(0, librevenge::RVNG_SEEK_SET);
-  if (!stream)
-    return false;
-  const RVNGInputStreamPtr_t relStream(input->getSubStreamByName(getRelationshipsForTarget(name).c_str()));
-  input->seek(0, librevenge::RVNG_SEEK_SET);
-  VSDXRelationships rels(relStream.get());
-  rels.rebaseTargets(getTargetBaseDirectory(name).c_str());
+  RVNGInputStreamPtr_t stream;
+  if (!hasCompleteTape(name))
+  {
+    stream.reset(input->getSubStreamByName(name));
+    input->seek(0, librevenge::RVNG_SEEK_SET);
+    if (!stream)
+      return false;
+  }
+  const VSDXRelationships &rels = getRelationships(input, name);
 
   const VSDXRelationship *rel = rels.getRelationshipByType("http://schemas.openxmlformats.org/officeDocument/2006/relationships/theme");
   if (rel)
@@ -139,7 +249,7 @@ bool libvisio::VSDXParser::parseDocument(librevenge::RVNGInputStream *input, con
     input->seek(0, librevenge::RVNG_SEEK_SET);
   }
 
-  processXmlDocument(stream.get(), rels);
+  processXmlDocument(stream.get(), name, rels);
 
   rel = rels.getRelationshipByType("http://schemas.microsoft.com/visio/2010/relationships/masters");
   if (rel)
@@ -166,86 +276,268 @@ bool libvisio::VSDXParser::parseDocument(librevenge::RVNGInputStream *input, con
 
 bool libvisio::VSDXParser::parseMasters(librevenge::RVNGInputStream *input, const char *name)
 {
-  if (!input)
-    return false;
-  input->seek(0, librevenge::RVNG_SEEK_SET);
-  if (!input->isStructured())
-    return false;
-  const RVNGInputStreamPtr_t stream(input->getSubStreamByName(name));
-  if (!stream)
-    return false;
-  const RVNGInputStreamPtr_t relStream(input->getSubStreamByName(getRelationshipsForTarget(name).c_str()));
-  input->seek(0, librevenge::RVNG_SEEK_SET);
-  VSDXRelationships rels(relStream.get());
-  rels.rebaseTargets(getTargetBaseDirectory(name).c_str());
+  // The masters are read once, into the stencils that both passes share
+  if (m_pageThreads > 1 && !m_extractStencils && !m_stencils.count() && tapePart(input, name))
+  {
+    const std::vector<ParsedPart *> parts = prepareParts(input, name, "http://schemas.microsoft.com/visio/2010/relationships/master");
+    for (ParsedPart *part : parts)
+      part->stencil = make_unique<VSDStencil>();
+    parseParts(parts);
+  }
+  const bool parsed = parsePart(input, name);
+  m_parsedParts.clear();
+  return parsed;
+}
 
-  processXmlDocument(stream.get(), rels);
+bool libvisio::VSDXParser::parseMaster(librevenge::RVNGInputStream *input, const char *name)
+{
+  const std::unique_ptr<ParsedPart> part(takeParsedPart(name));
+  // The worker started from an empty master, and did not see the masters before this one
+  if (part && part->stencil && canReplay(*part) && m_isStencilStarted && m_currentStencil && !m_isPageStarted
+      && m_currentStencil->m_shapes.empty() && MINUS_ONE == m_currentStencil->m_firstShapeId
+      && !refersToStencils(*part->stencil, m_stencils))
+  {
+    replayParsedPart(*part);
+    m_currentStencil->m_shapes.swap(part->stencil->m_shapes);
+    m_currentStencil->m_firstShapeId = part->stencil->m_firstShapeId;
+    releaseTape(name);
+    return true;
+  }
+  return parsePart(input, name);
+}
 
-  return true;
+bool libvisio::VSDXParser::parsePages(librevenge::RVNGInputStream *input, const char *name)
+{
+  // Only the content pass is worth it, and only when all pages are drawn
+  if (m_pageThreads > 1 && !m_isStylesPass && !m_extractStencils && m_pageSelection.selectsAll())
+    parseParts(prepareParts(input, name, "http://schemas.microsoft.com/visio/2010/relationships/page"));
+  const bool parsed = parsePart(input, name);
+  m_parsedParts.clear();
+  return parsed;
 }
 
-bool libvisio::VSDXParser::parseMaster(librevenge::RVNGInputStream *input, const char *name)
+bool libvisio::VSDXParser::parsePage(librevenge::RVNGInputStream *input, const char *name)
 {
-  if (!input)
-    return false;
+  const std::unique_ptr<ParsedPart> part(takeParsedPart(name));
+  // The worker started from the state in which the pages part normally gets to its page parts
+  if (part && !part->stencil && canReplay(*part) && m_isPageStarted && !m_isStencilStarted)
+  {
+    replayParsedPart(*part);
+    releaseTape(name);
+    return true;
+  }
+  return parsePart(input, name);
+}
+
+/* Records the tape of the part name without parsing it, so that
+ * prepareParts can find the parts it refers to before it is parsed.
+ */
+bool libvisio::VSDXParser::tapePart(librevenge::RVNGInputStream *input, const char *name)
+{
+  if (hasCompleteTape(name))
+    return true;
   input->seek(0, librevenge::RVNG_SEEK_SET);
-  if (!input->isStructured())
-    return false;
   const RVNGInputStreamPtr_t stream(input->getSubStreamByName(name));
+  input->seek(0, librevenge::RVNG_SEEK_SET);
   if (!stream)
     return false;
-  const RVNGInputStreamPtr_t relStream(input->getSubStreamByName(getRelationshipsForTarget(name).c_str()));
+  XMLErrorWatcher watcher;
+  const auto xmlReader = xmlReaderForStream(stream.get(), &watcher, false);
+  if (!xmlReader)
+    return false;
+  VSDXMLTape &tape = m_tapes[name];
+  VSDXMLReader reader(xmlReader.get(), tape, m_parseControl);
+  while (1 == reader.read() && !watcher.isError())
+    ;
+  if (watcher.isError())
+    tape.clear();
+  return tape.isComplete();
+}
+
+/* Finds the parts of the given type that the Rel elements of the taped
+ * part name refer to, and prepares each of them for a worker. The workers
+ * cannot share the input stream, so a part that is not taped yet is read
+ * into memory here.
+ */
+std::vector<libvisio::VSDXParser::ParsedPart *> libvisio::VSDXParser::prepareParts(librevenge::RVNGInputStream *input, const char *name, const char *type)
+{
+  std::vector<ParsedPart *> parts;
+  const auto tape = m_tapes.find(name);
+  if (tape == m_tapes.end() || !tape->second.isComplete())
+    return parts;
+  const VSDXRelationships &rels = getRelationships(input, name);
+
+  const std::function<VSDCollector &()> getCollector = [this]() -> VSDCollector &
+  {
+    return *m_collector;
+  };
+  VSDXMLReader reader(tape->second);
+  while (1 == reader.read())
+  {
+    if (XML_REL != reader.getToken() || XML_READER_TYPE_ELEMENT != reader.getNodeType())
+      continue;
+    const xmlChar *const id = reader.getConstAttribute(BAD_CAST("r:id"));
+    const VSDXRelationship *rel = id ? rels.getRelationshipById((const char *)id) : nullptr;
+    if (!rel || rel->getType() != type)
+      continue;
+    const std::string &target = rel->getTarget();
+    if (m_parsedParts.count(target))
+      continue;
+    auto part = make_unique<ParsedPart>(m_tapes[target], getRelationships(input, target.c_str()), m_currentDepth + reader.getDepth(), getCollector);
+    if (!part->tape.isComplete())
+    {
+      input->seek(0, librevenge::RVNG_SEEK_SET);
+      const RVNGInputStreamPtr_t stream(input->getSubStreamByName(target.c_str()));
+      librevenge::RVNGBinaryData data;
+      if (stream)
+        readAll(stream.get(), data);
+      if (data.empty())
+        continue;
+      part->stream = make_unique<librevenge::RVNGStringStream>(data.getDataBuffer(), (unsigned)data.size());
+    }
+    parts.push_back(part.get());
+    m_parsedParts[target] = std::move(part);
+  }
   input->seek(0, librevenge::RVNG_SEEK_SET);
-  VSDXRelationships rels(relStream.get());
-  rels.rebaseTargets(getTargetBaseDirectory(name).c_str());
+  return parts;
+}
 
-  processXmlDocument(stream.get(), rels);
+/* Parses parts on m_pageThreads threads, each into a recording collector,
+ * before the part that refers to them is read. parsePage and parseMaster
+ * then replay the calls of each part in document order, so the collector
+ * gets the same calls as without the workers. The workers stop at the
+ * cancel flag, deadline and limits of the parse, and then the parse stops.
+ */
+void libvisio::VSDXParser::parseParts(const std::vector<ParsedPart *> &parts)
+{
+  if (parts.size() < 2)
+  {
+    m_parsedParts.clear();
+    return;
+  }
 
-  return true;
+  VSDWorkerPool(m_pageThreads).run(parts.size(), [this, &parts](std::size_t i)
+  {
+    ParsedPart &part = *parts[i];
+    try
+    {
+      VSDParseControl control(m_parseControl);
+      VSDXParser worker(*this, part.calls);
+      worker.setParseControl(&control);
+      worker.m_currentDepth = part.depth;
+      if (part.stencil)
+      {
+        worker.m_isStencilStarted = true;
+        worker.m_currentStencil = std::move(part.stencil);
+      }
+      else
+        worker.m_isPageStarted = true;
+      worker.processXmlDocument(part.stream.get(), part.tape, part.rels);
+      part.shapeList = worker.m_shapeList;
+      part.stencil = std::move(worker.m_currentStencil);
+      part.chunks = control.getStats().chunks;
+      part.isComplete = part.tape.isComplete() && !worker.m_needsDocumentOrder;
+    }
+    catch (const ParseInterruptedException &)
+    {
+      // The parse is cancelled, out of time or over a limit, so it stops
+      throw;
+    }
+    catch (...)
+    {
+      // The part is parsed again in document order, which handles the error as usual
+    }
+  });
 }
 
-bool libvisio::VSDXParser::parsePages(librevenge::RVNGInputStream *input, const char *name)
+std::unique_ptr<libvisio::VSDXParser::ParsedPart> libvisio::VSDXParser::takeParsedPart(const char *name)
 {
-  if (!input)
-    return false;
-  input->seek(0, librevenge::RVNG_SEEK_SET);
-  if (!input->isStructured())
-    return false;
-  const RVNGInputStreamPtr_t stream(input->getSubStreamByName(name));
-  if (!stream)
-    return false;
-  const RVNGInputStreamPtr_t relStream(input->getSubStreamByName(getRelationshipsForTarget(name).c_str()));
-  input->seek(0, librevenge::RVNG_SEEK_SET);
-  VSDXRelationships rels(relStream.get());
-  rels.rebaseTargets(getTargetBaseDirectory(name).c_str());
+  std::unique_ptr<ParsedPart> part;
+  const auto it = m_parsedParts.find(name);
+  if (it != m_parsedParts.end())
+  {
+    part = std::move(it->second);
+    m_parsedParts.erase(it);
+  }
+  return part;
+}
 
-  processXmlDocument(stream.get(), rels);
+bool libvisio::VSDXParser::canReplay(const ParsedPart &part) const
+{
+  return part.isComplete && part.depth == m_currentDepth && !m_isShapeStarted && !m_isInStyles && m_shapeStack.empty();
+}
 
-  return true;
+void libvisio::VSDXParser::replayParsedPart(ParsedPart &part)
+{
+  if (m_parseControl)
+  {
+    m_parseControl->addStream();
+    m_parseControl->addChunks(part.chunks);
+    m_parseControl->addParallelPart();
+  }
+  part.calls.flush();
+  for (unsigned shapeId : part.shapeList.getShapesOrder())
+    m_shapeList.addShapeId(shapeId);
 }
 
-bool libvisio::VSDXParser::parsePage(librevenge::RVNGInputStream *input, const char *name)
+bool libvisio::VSDXParser::parsePart(librevenge::RVNGInputStream *input, const char *name)
 {
+  // A worker has only the part it was given
+  if (m_packageOwner)
+  {
+    m_needsDocumentOrder = true;
+    return false;
+  }
   if (!input)
     return false;
   input->seek(0, librevenge::RVNG_SEEK_SET);
   if (!input->isStructured())
     return false;
-  const RVNGInputStreamPtr_t stream(input->getSubStreamByName(name));
-  if (!stream)
-    return false;
-  const RVNGInputStreamPtr_t relStream(input->getSubStreamByName(getRelationshipsForTarget(name).c_str()));
-  input->seek(0, librevenge::RVNG_SEEK_SET);
-  VSDXRelationships rels(relStream.get());
-  rels.rebaseTargets(getTargetBaseDirectory(name).c_str());
+  // A part that the first pass read is replayed from its tape, without inflating it again
+  RVNGInputStreamPtr_t stream;
+  if (!hasCompleteTape(name))
+  {
+    stream.reset(input->getSubStreamByName(name));
+    if (!stream)
+      return false;
+  }
+  const VSDXRelationships &rels = getRelationships(input, name);
 
-  processXmlDocument(stream.get(), rels);
+  processXmlDocument(stream.get(), name, rels);
 
   return true;
 }
 
+const libvisio::VSDXRelationships &libvisio::VSDXParser::getRelationships(librevenge::RVNGInputStream *input, const char *name)
+{
+  auto it = m_relationships.find(name);
+  if (it == m_relationships.end())
+  {
+    input->seek(0, librevenge::RVNG_SEEK_SET);
+    const RVNGInputStreamPtr_t relStream(input->getSubStreamByName(getRelationshipsForTarget(name).c_str()));
+    input->seek(0, librevenge::RVNG_SEEK_SET);
+    VSDXRelationships rels(relStream.get());
+    rels.rebaseTargets(getTargetBaseDirectory(name).c_str());
+    it = m_relationships.insert(std::make_pair(std::string(name), rels)).first;
+  }
+  return it->second;
+}
+
+void libvisio::VSDXParser::clearPackageCache()
+{
+  m_tapes.clear();
+  m_relationships.clear();
+  m_binaryParts.clear();
+  m_currentThemeName.clear();
+  m_isCurrentThemeParsed = false;
+  m_parsedParts.clear();
+}
+
 bool libvisio::VSDXParser::parseTheme(librevenge::RVNGInputStream *input, const char *name)
 {
+  // Both passes use the same theme
+  if (m_currentThemeName == name)
+    return m_isCurrentThemeParsed;
   if (!input)
     return false;
   input->seek(0, librevenge::RVNG_SEEK_SET);
@@ -256,96 +548,118 @@ bool libvisio::VSDXParser::parseTheme(librevenge::RVNGInputStream *input, const
     return false;
 
   m_currentTheme.parse(stream.get());
+  m_currentThemeName = name;
+  m_isCurrentThemeParsed = true;
 
   return true;
 }
 
 void libvisio::VSDXParser::parseMetaData(librevenge::RVNGInputStream *input, libvisio::VSDXRelationships &rels) try
 {
-  if (!input)
-    return;
-  input->seek(0, librevenge::RVNG_SEEK_SET);
-  if (!input->isStructured())
-    return;
-
   VSDXMetaData metaData;
-  const libvisio::VSDXRelationship *coreProp = rels.getRelationshipByType("http://schemas.openxmlformats.org/package/2006/relationships/metadata/core-properties");
-  if (coreProp)
-  {
-    const RVNGInputStreamPtr_t stream(input->getSubStreamByName(coreProp->getTarget().c_str()));
-    if (stream)
-    {
-      metaData.parse(stream.get());
-    }
-  }
-
-  const libvisio::VSDXRelationship *extendedProp = rels.getRelationshipByType("http://schemas.openxmlformats.org/officeDocument/2006/relationships/extended-properties");
-  if (extendedProp)
-  {
-    const RVNGInputStreamPtr_t stream(input->getSubStreamByName(extendedProp->getTarget().c_str()));
-    if (stream)
-    {
-      metaData.parse(stream.get());
-    }
-  }
-  m_collector->collectMetaData(metaData.getMetaData());
+  if (metaData.parsePackage(input, rels))
+    m_collector->collectMetaData(metaData.getMetaData());
 }
 catch (...)
 {
   // Ignore any exceptions in metadata. They are not important enough to stop parsing.
 }
 
-void libvisio::VSDXParser::processXmlDocument(librevenge::RVNGInputStream *input, VSDXRelationships &rels)
+void libvisio::VSDXParser::releaseTape(const char *name)
 {
-  if (!input)
+  // Nothing reads a part after the content pass
+  if (!m_isStylesPass)
+    m_tapes.erase(name);
+}
+
+bool libvisio::VSDXParser::hasCompleteTape(const char *name) const
+{
+  const auto it = m_tapes.find(name);
+  return it != m_tapes.end() && it->second.isComplete();
+}
+
+void libvisio::VSDXParser::processXmlDocument(librevenge::RVNGInputStream *input, const char *name, const VSDXRelationships &rels)
+{
+  // A part that refers to itself would be read again without end, from the tape that is being read
+  if (!m_openParts.insert(name).second)
     return;
+  try
+  {
+    processXmlDocument(input, m_tapes[name], rels);
+  }
+  catch (...)
+  {
+    m_openParts.erase(name);
+    throw;
+  }
+  m_openParts.erase(name);
+  releaseTape(name);
+}
 
+void libvisio::VSDXParser::processXmlDocument(librevenge::RVNGInputStream *input, VSDXMLTape &tape, const VSDXRelationships &rels)
+{
   m_rels = &rels;
 
   XMLErrorWatcher watcher;
 
-  auto reader = xmlReaderForStream(input, &watcher, false);
-  if (!reader)
-    return;
+  // Record the part the first time it is read, replay it afterwards
+  std::unique_ptr<xmlTextReader, void (*)(xmlTextReaderPtr)> xmlReader(nullptr, xmlFreeTextReader);
+  std::unique_ptr<VSDXMLReader> reader;
+  if (tape.isComplete())
+    reader.reset(new VSDXMLReader(tape));
+  else
+  {
+    if (!input)
+      return;
+    xmlReader = xmlReaderForStream(input, &watcher, false);
+    if (!xmlReader)
+      return;
+    reader.reset(new VSDXMLReader(xmlReader.get(), tape, m_parseControl));
+  }
+  if (m_parseControl)
+    m_parseControl->addStream();
 
   XMLErrorWatcher *oldWatcher = m_watcher;
   try
   {
     m_watcher = &watcher;
 
-    int ret = xmlTextReaderRead(reader.get());
+    int ret = reader->read();
     while (1 == ret && !watcher.isError())
     {
-      int tokenId = VSDXMLTokenMap::getTokenId(xmlTextReaderConstName(reader.get()));
-      int tokenType = xmlTextReaderNodeType(reader.get());
+      if (m_parseControl)
+        m_parseControl->addChunk();
+      int tokenId = reader->getToken();
+      int tokenType = reader->getNodeType();
 
       switch (tokenId)
       {
       case XML_REL:
         if (XML_READER_TYPE_ELEMENT == tokenType)
         {
-          std::shared_ptr<xmlChar> id(xmlTextReaderGetAttribute(reader.get(), BAD_CAST("r:id")), xmlFree);
+          const xmlChar *const id = reader->getConstAttribute(BAD_CAST("r:id"));
           if (id)
           {
-            const VSDXRelationship *rel = rels.getRelationshipById((char *)id.get());
+            const VSDXRelationship *rel = rels.getRelationshipById((const char *)id);
             if (rel)
             {
               std::string type = rel->getType();
               if (type == "http://schemas.microsoft.com/visio/2010/relationships/master")
               {
-                m_currentDepth += xmlTextReaderDepth(reader.get());
+                m_currentDepth += reader->getDepth();
                 parseMaster(m_input, rel->getTarget().c_str());
-                m_currentDepth -= xmlTextReaderDepth(reader.get());
+                m_currentDepth -= reader->getDepth();
               }
               else if (type == "http://schemas.microsoft.com/visio/2010/relationships/page")
               {
-                m_currentDepth += xmlTextReaderDepth(reader.get());
+                m_currentDepth += reader->getDepth();
                 parsePage(m_input, rel->getTarget().c_str());
-                m_currentDepth -= xmlTextReaderDepth(reader.get());
+                m_currentDepth -= reader->getDepth();
               }
               else if (type == "http://schemas.openxmlformats.org/officeDocument/2006/relationships/image")
               {
-                extractBinaryData(m_input, rel->getTarget().c_str());
+                if (!m_textOnly)
+                  extractBinaryData(m_input, rel->getTarget().c_str());
               }
               else
                 processXmlNode(reader.get());
@@ -357,8 +671,11 @@ void libvisio::VSDXParser::processXmlDocument(librevenge::RVNGInputStream *input
         processXmlNode(reader.get());
         break;
       }
-      ret = xmlTextReaderRead(reader.get());
+      ret = reader->read();
     }
+    // A part that failed to parse has to fail the same way in the next pass
+    if (watcher.isError())
+      tape.clear();
 
     m_watcher = oldWatcher;
   }
@@ -369,12 +686,12 @@ void libvisio::VSDXParser::processXmlDocument(librevenge::RVNGInputStream *input
   }
 }
 
-void libvisio::VSDXParser::processXmlNode(xmlTextReaderPtr reader)
+void libvisio::VSDXParser::processXmlNode(VSDXMLReader *reader)
 {
   if (!reader)
     return;
   int tokenId = getElementToken(reader);
-  int tokenType = xmlTextReaderNodeType(reader);
+  int tokenType = reader->getNodeType();
   _handleLevelChange((unsigned)getElementDepth(reader));
   switch (tokenId)
   {
@@ -437,7 +754,7 @@ void libvisio::VSDXParser::processXmlNode(xmlTextReaderPtr reader)
     if (XML_READER_TYPE_ELEMENT == tokenType)
     {
       readShape(reader);
-      if (!xmlTextReaderIsEmptyElement(reader))
+      if (!reader->isEmptyElement())
         readShapeProperties(reader);
       else
       {
@@ -497,22 +814,22 @@ void libvisio::VSDXParser::processXmlNode(xmlTextReaderPtr reader)
   }
 
 #ifdef DEBUG
-  const xmlChar *name = xmlTextReaderConstName(reader);
-  const xmlChar *value = xmlTextReaderConstValue(reader);
-  int type = xmlTextReaderNodeType(reader);
-  int isEmptyElement = xmlTextReaderIsEmptyElement(reader);
+  const xmlChar *name = reader->getName();
+  const xmlChar *value = reader->getValue();
+  int type = reader->getNodeType();
+  int isEmptyElement = reader->isEmptyElement();
 
   for (int i=0; i<getElementDepth(reader); ++i)
   {
     VSD_DEBUG_MSG((" "));
   }
   VSD_DEBUG_MSG(("%i %i %s", isEmptyElement, type, name ? (const char *)name : ""));
-  if (xmlTextReaderNodeType(reader) == 1)
+  if (reader->getNodeType() == 1)
   {
-    while (xmlTextReaderMoveToNextAttribute(reader))
+    while (reader->moveToNextAttribute())
     {
-      const xmlChar *name1 = xmlTextReaderConstName(reader);
-      const xmlChar *value1 = xmlTextReaderConstValue(reader);
+      const xmlChar *name1 = reader->getName();
+      const xmlChar *value1 = reader->getValue();
       fprintf(stderr, " %s=\"%s\"", name1, value1);
     }
   }
@@ -526,75 +843,86 @@ void libvisio::VSDXParser::processXmlNode(xmlTextReaderPtr reader)
 #endif
 }
 
-#define VSDX_DATA_READ_SIZE 4096UL
-
 void libvisio::VSDXParser::extractBinaryData(librevenge::RVNGInputStream *input, const char *name)
 {
   m_currentBinaryData.clear();
+  // The styles pass only keeps the data of the shapes of stencils
+  if (m_isStylesPass && !m_isStencilStarted)
+    return;
+  // A worker reads through the parser that owns the package, one worker at a time
+  if (m_packageOwner)
+  {
+    std::lock_guard<std::mutex> lock(m_packageOwner->m_packageMutex);
+    m_packageOwner->readBinaryPart(m_packageOwner->m_input, name, m_currentBinaryData);
+    return;
+  }
+  readBinaryPart(input, name, m_currentBinaryData);
+}
+
+void libvisio::VSDXParser::readBinaryPart(librevenge::RVNGInputStream *input, const char *name, librevenge::RVNGBinaryData &data)
+{
+  const auto it = m_binaryParts.find(name);
+  if (it != m_binaryParts.end())
+  {
+    data = it->second;
+    return;
+  }
   if (!input || !input->isStructured())
     return;
   input->seek(0, librevenge::RVNG_SEEK_SET);
   const RVNGInputStreamPtr_t stream(input->getSubStreamByName(name));
   if (!stream)
     return;
-  while (true)
-  {
-    unsigned long numBytesRead;
-    const unsigned char *buffer = stream->read(VSDX_DATA_READ_SIZE, numBytesRead);
-    if (numBytesRead)
-      m_currentBinaryData.append(buffer, numBytesRead);
-    if (stream->isEnd())
-      break;
-  }
-  VSD_DEBUG_MSG(("%s\n", m_currentBinaryData.getBase64Data().cstr()));
+  readAll(stream.get(), data);
+  m_binaryParts[name] = data;
+  VSD_DEBUG_MSG(("%s\n", data.getBase64Data().cstr()));
 }
 
-xmlChar *libvisio::VSDXParser::readStringData(xmlTextReaderPtr reader)
+const xmlChar *libvisio::VSDXParser::readStringData(VSDXMLReader *reader)
 {
-  std::unique_ptr<xmlChar, void (*)(void *)> stringValue(xmlTextReaderGetAttribute(reader, BAD_CAST("V")), xmlFree);
+  const xmlChar *const stringValue = reader->getConstAttribute(BAD_CAST("V"));
   if (stringValue)
   {
-    VSD_DEBUG_MSG(("VSDXParser::readStringData stringValue %s\n", (const char *)stringValue.get()));
-    return stringValue.release();
+    VSD_DEBUG_MSG(("VSDXParser::readStringData stringValue %s\n", (const char *)stringValue));
   }
-  return nullptr;
+  return stringValue;
 }
 
-int libvisio::VSDXParser::getElementToken(xmlTextReaderPtr reader)
+int libvisio::VSDXParser::getElementToken(VSDXMLReader *reader)
 {
-  int tokenId = VSDXMLTokenMap::getTokenId(xmlTextReaderConstName(reader));
-  if (XML_READER_TYPE_END_ELEMENT == xmlTextReaderNodeType(reader))
+  int tokenId = reader->getToken();
+  if (XML_READER_TYPE_END_ELEMENT == reader->getNodeType())
     return tokenId;
 
-  std::unique_ptr<xmlChar, decltype(xmlFree)> stringValue(nullptr, xmlFree);
+  const xmlChar *stringValue = nullptr;
 
   switch (tokenId)
   {
   case XML_CELL:
-    stringValue.reset(xmlTextReaderGetAttribute(reader, BAD_CAST("N")));
+    stringValue = reader->getConstAttribute(BAD_CAST("N"));
     if (stringValue)
     {
-      tokenId = VSDXMLTokenMap::getTokenId(stringValue.get());
+      tokenId = VSDXMLTokenMap::getTokenId(stringValue);
       if (tokenId == XML_TOKEN_INVALID)
       {
-        if (*stringValue.get() == 'P' && !strncmp((char *)stringValue.get(), "Position", 8))
+        if (*stringValue == 'P' && !strncmp((const char *)stringValue, "Position", 8))
           tokenId = XML_POSITION;
-        else if (*stringValue.get() == 'A' && !strncmp((char *)stringValue.get(), "Alignment", 9))
+        else if (*stringValue == 'A' && !strncmp((const char *)stringValue, "Alignment", 9))
           tokenId = XML_ALIGNMENT;
       }
     }
     break;
   case XML_ROW:
-    stringValue.reset(xmlTextReaderGetAttribute(reader, BAD_CAST("N")));
+    stringValue = reader->getConstAttribute(BAD_CAST("N"));
     if (!stringValue)
-      stringValue.reset(xmlTextReaderGetAttribute(reader, BAD_CAST("T")));
+      stringValue = reader->getConstAttribute(BAD_CAST("T"));
     if (stringValue)
-      tokenId = VSDXMLTokenMap::getTokenId(stringValue.get());
+      tokenId = VSDXMLTokenMap::getTokenId(stringValue);
     break;
   case XML_SECTION:
-    stringValue.reset(xmlTextReaderGetAttribute(reader, BAD_CAST("N")));
+    stringValue = reader->getConstAttribute(BAD_CAST("N"));
     if (stringValue)
-      tokenId = VSDXMLTokenMap::getTokenId(stringValue.get());
+      tokenId = VSDXMLTokenMap::getTokenId(stringValue);
     break;
   default:
     break;
@@ -602,7 +930,7 @@ int libvisio::VSDXParser::getElementToken(xmlTextReaderPtr reader)
   return tokenId;
 }
 
-void libvisio::VSDXParser::readPageSheetProperties(xmlTextReaderPtr reader)
+void libvisio::VSDXParser::readPageSheetProperties(VSDXMLReader *reader)
 {
   double pageWidth = 0.0;
   double pageHeight = 0.0;
@@ -617,13 +945,13 @@ void libvisio::VSDXParser::readPageSheetProperties(xmlTextReaderPtr reader)
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXParser::readPageSheetProperties: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXParser::readPageSheetProperties: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_PAGEWIDTH:
@@ -664,6 +992,9 @@ void libvisio::VSDXParser::readPageSheetProperties(xmlTextReaderPtr reader)
   {
     m_currentStencil->m_shadowOffsetX = shadowOffsetX;
     m_currentStencil->m_shadowOffsetY = shadowOffsetY;
+    // A worker cannot tell whether these or the ones of the masters part come last
+    if (m_packageOwner)
+      m_needsDocumentOrder = true;
   }
   else if (m_isPageStarted)
   {
@@ -672,7 +1003,7 @@ void libvisio::VSDXParser::readPageSheetProperties(xmlTextReaderPtr reader)
   }
 }
 
-void libvisio::VSDXParser::readFonts(xmlTextReaderPtr reader)
+void libvisio::VSDXParser::readFonts(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -681,20 +1012,20 @@ void libvisio::VSDXParser::readFonts(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXParser::readFonts: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXParser::readFonts: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
 
     if (XML_FACENAME == tokenId && XML_READER_TYPE_ELEMENT == tokenType)
     {
-      std::unique_ptr<xmlChar, decltype(xmlFree)> name(xmlTextReaderGetAttribute(reader, BAD_CAST("NameU")), xmlFree);
+      const xmlChar *const name = reader->getConstAttribute(BAD_CAST("NameU"));
       if (name)
       {
-        librevenge::RVNGBinaryData textStream(name.get(), xmlStrlen(name.get()));
+        librevenge::RVNGBinaryData textStream(name, xmlStrlen(name));
         m_fonts[idx] = VSDName(textStream, libvisio::VSD_TEXT_UTF8);
       }
       ++idx;
@@ -703,7 +1034,7 @@ void libvisio::VSDXParser::readFonts(xmlTextReaderPtr reader)
   while ((XML_FACENAMES != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VSDXParser::readStyleProperties(xmlTextReaderPtr reader)
+void libvisio::VSDXParser::readStyleProperties(VSDXMLReader *reader)
 {
   // Line properties
   boost::optional<double> strokeWidth;
@@ -748,13 +1079,13 @@ void libvisio::VSDXParser::readStyleProperties(xmlTextReaderPtr reader)
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXParser::readLine: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXParser::readLine: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_LINEWEIGHT:
@@ -928,12 +1259,12 @@ void libvisio::VSDXParser::readStyleProperties(xmlTextReaderPtr reader)
   }
 }
 
-int libvisio::VSDXParser::getElementDepth(xmlTextReaderPtr reader)
+int libvisio::VSDXParser::getElementDepth(VSDXMLReader *reader)
 {
-  return xmlTextReaderDepth(reader)+m_currentDepth;
+  return reader->getDepth()+m_currentDepth;
 }
 
-void libvisio::VSDXParser::readShapeProperties(xmlTextReaderPtr reader)
+void libvisio::VSDXParser::readShapeProperties(VSDXMLReader *reader)
 {
   // Text block properties
   long bgClrId = -1;
@@ -943,14 +1274,14 @@ void libvisio::VSDXParser::readShapeProperties(xmlTextReaderPtr reader)
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
-    int tokenClass = VSDXMLTokenMap::getTokenId(xmlTextReaderConstName(reader));
+    int tokenClass = reader->getToken();
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXParser::readShapeProperties: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXParser::readShapeProperties: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     switch (tokenId)
     {
     case XML_PINX:
@@ -1298,7 +1629,7 @@ void libvisio::VSDXParser::readShapeProperties(xmlTextReaderPtr reader)
     processXmlNode(reader);
 }
 
-void libvisio::VSDXParser::readLayer(xmlTextReaderPtr reader)
+void libvisio::VSDXParser::readLayer(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -1306,20 +1637,20 @@ void libvisio::VSDXParser::readLayer(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXParser::readLayer: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXParser::readLayer: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     if (XML_ROW == tokenId && XML_READER_TYPE_ELEMENT == tokenType)
       readLayerIX(reader);
   }
   while ((XML_SECTION != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VSDXParser::readParagraph(xmlTextReaderPtr reader)
+void libvisio::VSDXParser::readParagraph(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -1327,26 +1658,26 @@ void libvisio::VSDXParser::readParagraph(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXParser::readParagraph: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXParser::readParagraph: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     if (XML_ROW == tokenId && XML_READER_TYPE_ELEMENT == tokenType)
       readParaIX(reader);
   }
   while ((XML_SECTION != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VSDXParser::readTabs(xmlTextReaderPtr reader)
+void libvisio::VSDXParser::readTabs(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
   int tokenType = -1;
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
     m_shape.m_tabSets.clear();
   }
@@ -1354,13 +1685,13 @@ void libvisio::VSDXParser::readTabs(xmlTextReaderPtr reader)
   {
     do
     {
-      ret = xmlTextReaderRead(reader);
+      ret = reader->read();
       tokenId = getElementToken(reader);
       if (XML_TOKEN_INVALID == tokenId)
       {
-        VSD_DEBUG_MSG(("VSDXParser::readTabs: unknown token %s\n", xmlTextReaderConstName(reader)));
+        VSD_DEBUG_MSG(("VSDXParser::readTabs: unknown token %s\n", reader->getName()));
       }
-      tokenType = xmlTextReaderNodeType(reader);
+      tokenType = reader->getNodeType();
       if (XML_ROW == tokenId && XML_READER_TYPE_ELEMENT == tokenType)
         readTabRow(reader);
     }
@@ -1368,7 +1699,7 @@ void libvisio::VSDXParser::readTabs(xmlTextReaderPtr reader)
   }
 }
 
-void libvisio::VSDXParser::readTabRow(xmlTextReaderPtr reader)
+void libvisio::VSDXParser::readTabRow(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -1377,7 +1708,7 @@ void libvisio::VSDXParser::readTabRow(xmlTextReaderPtr reader)
 
   m_currentTabSet = &(m_shape.m_tabSets[ix].m_tabStops);
 
-  if (xmlTextReaderIsEmptyElement(reader))
+  if (reader->isEmptyElement())
   {
     m_currentTabSet->clear();
   }
@@ -1385,22 +1716,22 @@ void libvisio::VSDXParser::readTabRow(xmlTextReaderPtr reader)
   {
     do
     {
-      ret = xmlTextReaderRead(reader);
+      ret = reader->read();
       tokenId = getElementToken(reader);
       if (XML_TOKEN_INVALID == tokenId)
       {
-        VSD_DEBUG_MSG(("VSDXParser::readTabs: unknown token %s\n", xmlTextReaderConstName(reader)));
+        VSD_DEBUG_MSG(("VSDXParser::readTabs: unknown token %s\n", reader->getName()));
       }
-      tokenType = xmlTextReaderNodeType(reader);
+      tokenType = reader->getNodeType();
       switch (tokenId)
       {
       case XML_POSITION:
         if (XML_READER_TYPE_ELEMENT == tokenType)
         {
-          const std::shared_ptr<xmlChar> stringValue(xmlTextReaderGetAttribute(reader, BAD_CAST("N")), xmlFree);
+          const xmlChar *const stringValue = reader->getConstAttribute(BAD_CAST("N"));
           if (stringValue)
           {
-            unsigned idx = xmlStringToLong(stringValue.get()+8);
+            unsigned idx = xmlStringToLong(stringValue+8);
             ret = readDoubleData((*m_currentTabSet)[idx].m_position, reader);
           }
         }
@@ -1408,10 +1739,10 @@ void libvisio::VSDXParser::readTabRow(xmlTextReaderPtr reader)
       case XML_ALIGNMENT:
         if (XML_READER_TYPE_ELEMENT == tokenType)
         {
-          const std::shared_ptr<xmlChar> stringValue(xmlTextReaderGetAttribute(reader, BAD_CAST("N")), xmlFree);
+          const xmlChar *const stringValue = reader->getConstAttribute(BAD_CAST("N"));
           if (stringValue)
           {
-            unsigned idx = xmlStringToLong(stringValue.get()+9);
+            unsigned idx = xmlStringToLong(stringValue+9);
             ret = readByteData((*m_currentTabSet)[idx].m_alignment, reader);
           }
         }
@@ -1425,7 +1756,7 @@ void libvisio::VSDXParser::readTabRow(xmlTextReaderPtr reader)
   m_currentTabSet = nullptr;
 }
 
-void libvisio::VSDXParser::readCharacter(xmlTextReaderPtr reader)
+void libvisio::VSDXParser::readCharacter(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
@@ -1433,33 +1764,33 @@ void libvisio::VSDXParser::readCharacter(xmlTextReaderPtr reader)
 
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
     if (XML_TOKEN_INVALID == tokenId)
     {
-      VSD_DEBUG_MSG(("VSDXParser::readCharacter: unknown token %s\n", xmlTextReaderConstName(reader)));
+      VSD_DEBUG_MSG(("VSDXParser::readCharacter: unknown token %s\n", reader->getName()));
     }
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
     if (XML_ROW == tokenId && XML_READER_TYPE_ELEMENT == tokenType)
       readCharIX(reader);
   }
   while ((XML_SECTION != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret && (!m_watcher || !m_watcher->isError()));
 }
 
-void libvisio::VSDXParser::getBinaryData(xmlTextReaderPtr reader)
+void libvisio::VSDXParser::getBinaryData(VSDXMLReader *reader)
 {
-  const int ret = xmlTextReaderRead(reader);
-  int tokenId = VSDXMLTokenMap::getTokenId(xmlTextReaderConstName(reader));
-  int tokenType = xmlTextReaderNodeType(reader);
+  const int ret = reader->read();
+  int tokenId = reader->getToken();
+  int tokenType = reader->getNodeType();
 
   m_currentBinaryData.clear();
   if (1 == ret && XML_REL == tokenId && XML_READER_TYPE_ELEMENT == tokenType)
   {
-    std::unique_ptr<xmlChar, decltype(xmlFree)> id(xmlTextReaderGetAttribute(reader, BAD_CAST("r:id")), xmlFree);
+    const xmlChar *const id = reader->getConstAttribute(BAD_CAST("r:id"));
     if (id)
     {
-      const VSDXRelationship *rel = m_rels->getRelationshipById((char *)id.get());
-      if (rel)
+      const VSDXRelationship *rel = m_rels->getRelationshipById((const char *)id);
+      if (rel && !m_textOnly)
       {
         if ("http://schemas.openxmlformats.org/officeDocument/2006/relationships/image" == rel->getType()
             || "http://schemas.openxmlformats.org/officeDocument/2006/relationships/oleObject" == rel->getType())
@@ -1472,16 +1803,16 @@ void libvisio::VSDXParser::getBinaryData(xmlTextReaderPtr reader)
   m_shape.m_foreign->data = m_currentBinaryData;
 }
 
-int libvisio::VSDXParser::skipSection(xmlTextReaderPtr reader)
+int libvisio::VSDXParser::skipSection(VSDXMLReader *reader)
 {
   int ret = 1;
   int tokenId = XML_TOKEN_INVALID;
   int tokenType = -1;
   do
   {
-    ret = xmlTextReaderRead(reader);
+    ret = reader->read();
     tokenId = getElementToken(reader);
-    tokenType = xmlTextReaderNodeType(reader);
+    tokenType = reader->getNodeType();
   }
   while ((XML_SECTION != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret);
   return ret;
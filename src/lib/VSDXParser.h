@@ -10,6 +10,12 @@
 #ifndef __VSDXPARSER_H__
 #define __VSDXPARSER_H__
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
 #include <librevenge/librevenge.h>
 #include "VSDXTheme.h"
 #include "VSDXMLParserBase.h"
@@ -33,20 +39,28 @@ public:
   ~VSDXParser() override;
   bool parseMain() override;
   bool extractStencils() override;
+  void setPageThreads(unsigned threads)
+  {
+    m_pageThreads = threads;
+  }
 
 private:
+  struct ParsedPart;
+
   VSDXParser();
   VSDXParser(const VSDXParser &);
   VSDXParser &operator=(const VSDXParser &);
+  // A worker, parsing a page or master part of owner into collector
+  VSDXParser(VSDXParser &owner, VSDCollector &collector);
 
   // Helper functions
 
-  xmlChar *readStringData(xmlTextReaderPtr reader) override;
+  const xmlChar *readStringData(VSDXMLReader *reader) override;
 
-  int getElementToken(xmlTextReaderPtr reader) override;
-  int getElementDepth(xmlTextReaderPtr reader) override;
+  int getElementToken(VSDXMLReader *reader) override;
+  int getElementDepth(VSDXMLReader *reader) override;
 
-  int skipSection(xmlTextReaderPtr reader);
+  int skipSection(VSDXMLReader *reader);
 
   // Functions parsing the Visio 2013 OPC document structure
 
@@ -55,37 +69,69 @@ private:
   bool parseMaster(librevenge::RVNGInputStream *input, const char *name);
   bool parsePages(librevenge::RVNGInputStream *input, const char *name);
   bool parsePage(librevenge::RVNGInputStream *input, const char *name);
+  bool parsePart(librevenge::RVNGInputStream *input, const char *name);
   bool parseTheme(librevenge::RVNGInputStream *input, const char *name);
   void parseMetaData(librevenge::RVNGInputStream *input, VSDXRelationships &rels);
-  void processXmlDocument(librevenge::RVNGInputStream *input, VSDXRelationships &rels);
-  void processXmlNode(xmlTextReaderPtr reader);
+  bool tapePart(librevenge::RVNGInputStream *input, const char *name);
+  std::vector<ParsedPart *> prepareParts(librevenge::RVNGInputStream *input, const char *name, const char *type);
+  void parseParts(const std::vector<ParsedPart *> &parts);
+  std::unique_ptr<ParsedPart> takeParsedPart(const char *name);
+  bool canReplay(const ParsedPart &part) const;
+  void replayParsedPart(ParsedPart &part);
+  void processXmlDocument(librevenge::RVNGInputStream *input, const char *name, const VSDXRelationships &rels);
+  void processXmlDocument(librevenge::RVNGInputStream *input, VSDXMLTape &tape, const VSDXRelationships &rels);
+  bool hasCompleteTape(const char *name) const;
+  void releaseTape(const char *name);
+  const VSDXRelationships &getRelationships(librevenge::RVNGInputStream *input, const char *name);
+  void processXmlNode(VSDXMLReader *reader);
 
   // Functions reading the Visio 2013 OPC document content
 
   void extractBinaryData(librevenge::RVNGInputStream *input, const char *name);
+  void readBinaryPart(librevenge::RVNGInputStream *input, const char *name, librevenge::RVNGBinaryData &data);
 
-  void readPageSheetProperties(xmlTextReaderPtr reader);
+  void readPageSheetProperties(VSDXMLReader *reader);
 
-  void readStyleProperties(xmlTextReaderPtr reader);
+  void readStyleProperties(VSDXMLReader *reader);
 
-  void readShapeProperties(xmlTextReaderPtr reader);
+  void readShapeProperties(VSDXMLReader *reader);
 
-  void getBinaryData(xmlTextReaderPtr reader) override;
+  void getBinaryData(VSDXMLReader *reader) override;
 
-  void readLayer(xmlTextReaderPtr reader);
-  void readParagraph(xmlTextReaderPtr reader);
-  void readCharacter(xmlTextReaderPtr reader);
-  void readFonts(xmlTextReaderPtr reader);
-  void readTabs(xmlTextReaderPtr reader);
-  void readTabRow(xmlTextReaderPtr reader);
+  void readLayer(VSDXMLReader *reader);
+  void readParagraph(VSDXMLReader *reader);
+  void readCharacter(VSDXMLReader *reader);
+  void readFonts(VSDXMLReader *reader);
+  void readTabs(VSDXMLReader *reader);
+  void readTabRow(VSDXMLReader *reader);
 
   // Private data
 
   librevenge::RVNGInputStream *m_input;
   librevenge::RVNGDrawingInterface *m_painter;
   int m_currentDepth;
-  VSDXRelationships *m_rels;
+  const VSDXRelationships *m_rels;
   VSDXTheme m_currentTheme;
+  bool m_isStylesPass;
+
+  // The parts of the package that are read once for both passes, by name
+  std::map<std::string, VSDXMLTape> m_tapes;
+  // The parts being read, which must not be read again inside themselves
+  std::set<std::string> m_openParts;
+  std::map<std::string, VSDXRelationships> m_relationships;
+  std::map<std::string, librevenge::RVNGBinaryData> m_binaryParts;
+  std::string m_currentThemeName;
+  bool m_isCurrentThemeParsed;
+
+  void clearPackageCache();
+
+  // How many workers parse page and master parts ahead, and the parts they parsed, until they are reached
+  unsigned m_pageThreads;
+  std::map<std::string, std::unique_ptr<ParsedPart> > m_parsedParts;
+  // In a worker, the parser whose package it reads, and whether its part has to be parsed in order after all
+  VSDXParser *m_packageOwner;
+  std::mutex m_packageMutex;
+  bool m_needsDocumentOrder;
 };
 
 } // namespace libvisio
@@ -10,14 +10,23 @@
 #include <libvisio/libvisio.h>
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <thread>
 
 #include <librevenge/librevenge.h>
 #include "libvisio_utils.h"
 #include "libvisio_xml.h"
 #include "VDXParser.h"
+#include "VSDCompoundFile.h"
+#include "VSDMetaData.h"
+#include "VSDModelCache.h"
+#include "VSDPages.h"
+#include "VSDParseControl.h"
 #include "VSDParser.h"
+#include "VSDWorkerPool.h"
+#include "VSDXMetaData.h"
 #include "VSDXParser.h"
 #include "VSD5Parser.h"
 #include "VSD6Parser.h"
@@ -43,17 +52,27 @@ static bool checkVisioMagic(librevenge::RVNGInputStream *input)
   return returnValue;
 }
 
-static bool isBinaryVisioDocument(librevenge::RVNGInputStream *input) try
+// Returns the main stream of a binary document; storage is the compound file opened from input, if any
+static std::shared_ptr<librevenge::RVNGInputStream> getDocumentStream(librevenge::RVNGInputStream *input, libvisio::VSDCompoundFile *storage)
 {
   std::shared_ptr<librevenge::RVNGInputStream> docStream;
   input->seek(0, librevenge::RVNG_SEEK_SET);
-  if (input->isStructured())
+  if (storage)
+    docStream.reset(storage->getSubStreamByName("VisioDocument"));
+  // librevenge still gets to try files the built-in reader does not understand
+  if (!docStream && input->isStructured())
   {
     input->seek(0, librevenge::RVNG_SEEK_SET);
     docStream.reset(input->getSubStreamByName("VisioDocument"));
   }
   if (!docStream)
     docStream.reset(input, libvisio::VSDDummyDeleter());
+  return docStream;
+}
+
+static bool isBinaryVisioDocument(librevenge::RVNGInputStream *input, libvisio::VSDCompoundFile *storage) try
+{
+  const std::shared_ptr<librevenge::RVNGInputStream> docStream = getDocumentStream(input, storage);
 
   docStream->seek(0, librevenge::RVNG_SEEK_SET);
   unsigned char version = 0;
@@ -74,15 +93,12 @@ catch (...)
   return false;
 }
 
-static bool parseBinaryVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, bool isStencilExtraction) try
+static bool parseBinaryVisioDocument(librevenge::RVNGInputStream *input, libvisio::VSDCompoundFile *storage, librevenge::RVNGDrawingInterface *painter,
+                                     libvisio::VSDPages *pages, bool isStencilExtraction, const libvisio::VisioParseOptions &options,
+                                     libvisio::VSDParseControl *control) try
 {
   VSD_DEBUG_MSG(("Parsing Binary Visio Document\n"));
-  input->seek(0, librevenge::RVNG_SEEK_SET);
-  std::shared_ptr<librevenge::RVNGInputStream> docStream;
-  if (input->isStructured())
-    docStream.reset(input->getSubStreamByName("VisioDocument"));
-  if (!docStream)
-    docStream.reset(input, libvisio::VSDDummyDeleter());
+  const std::shared_ptr<librevenge::RVNGInputStream> docStream = getDocumentStream(input, storage);
 
   docStream->seek(0x1A, librevenge::RVNG_SEEK_SET);
 
@@ -102,12 +118,21 @@ static bool parseBinaryVisioDocument(librevenge::RVNGInputStream *input, libreve
     parser.reset(new libvisio::VSD6Parser(docStream.get(), painter));
     break;
   case 11:
-    parser.reset(new libvisio::VSDParser(docStream.get(), painter, input));
+    parser.reset(new libvisio::VSDParser(docStream.get(), painter, storage ? storage : input));
     break;
   default:
     break;
   }
 
+  parser->setStreamCacheLimit(options.streamCacheLimit);
+  parser->setDecompressionThreads(options.decompressionThreads);
+  parser->setSinglePass(options.singlePass);
+  parser->setPagesOutput(pages);
+  parser->setProgressive(options.progressive);
+  parser->setPageSelection(options.pages, options.pageNames);
+  parser->setParseControl(control);
+  parser->setTextOnly(options.textOnly);
+
   if (isStencilExtraction)
     return parser->extractStencils();
   else
@@ -144,11 +169,19 @@ catch (...)
   return false;
 }
 
-static bool parseOpcVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, bool isStencilExtraction) try
+static bool parseOpcVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, libvisio::VSDPages *pages,
+                                  bool isStencilExtraction, const libvisio::VisioParseOptions &options,
+                                  libvisio::VSDParseControl *control) try
 {
   VSD_DEBUG_MSG(("Parsing Visio Document based on Open Packaging Convention\n"));
   input->seek(0, librevenge::RVNG_SEEK_SET);
   libvisio::VSDXParser parser(input, painter);
+  parser.setPagesOutput(pages);
+  parser.setProgressive(options.progressive);
+  parser.setPageSelection(options.pages, options.pageNames);
+  parser.setParseControl(control);
+  parser.setTextOnly(options.textOnly);
+  parser.setPageThreads(options.pageThreads);
   if (isStencilExtraction && parser.extractStencils())
     return true;
   else if (!isStencilExtraction && parser.parseMain())
@@ -189,11 +222,18 @@ catch (...)
   return false;
 }
 
-static bool parseXmlVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, bool isStencilExtraction) try
+static bool parseXmlVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, libvisio::VSDPages *pages,
+                                  bool isStencilExtraction, const libvisio::VisioParseOptions &options,
+                                  libvisio::VSDParseControl *control) try
 {
   VSD_DEBUG_MSG(("Parsing Visio DrawingML Document\n"));
   input->seek(0, librevenge::RVNG_SEEK_SET);
   libvisio::VDXParser parser(input, painter);
+  parser.setPagesOutput(pages);
+  parser.setProgressive(options.progressive);
+  parser.setPageSelection(options.pages, options.pageNames);
+  parser.setParseControl(control);
+  parser.setTextOnly(options.textOnly);
   if (isStencilExtraction && parser.extractStencils())
     return true;
   else if (!isStencilExtraction && parser.parseMain())
@@ -205,6 +245,79 @@ catch (...)
   return false;
 }
 
+// Only version 11 documents have property sets; older ones give no metadata, as in a full parse
+static bool readBinaryVisioMetaData(librevenge::RVNGInputStream *input, libvisio::VSDCompoundFile *storage,
+                                    librevenge::RVNGPropertyList &metaData) try
+{
+  const std::shared_ptr<librevenge::RVNGInputStream> docStream = getDocumentStream(input, storage);
+  docStream->seek(0x1A, librevenge::RVNG_SEEK_SET);
+  if (libvisio::readU8(docStream.get()) != 11)
+    return true;
+
+  libvisio::VSDMetaData reader;
+  if (reader.parseStorage(storage ? storage : input))
+    metaData = reader.getMetaData();
+  return true;
+}
+catch (...)
+{
+  metaData.clear();
+  return true;
+}
+
+static bool readOpcVisioMetaData(librevenge::RVNGInputStream *input, librevenge::RVNGPropertyList &metaData) try
+{
+  input->seek(0, librevenge::RVNG_SEEK_SET);
+  const std::unique_ptr<librevenge::RVNGInputStream> relsStream(input->getSubStreamByName("_rels/.rels"));
+  if (!relsStream)
+    return false;
+  libvisio::VSDXRelationships rootRels(relsStream.get());
+
+  libvisio::VSDXMetaData reader;
+  if (reader.parsePackage(input, rootRels))
+    metaData = reader.getMetaData();
+  return true;
+}
+catch (...)
+{
+  metaData.clear();
+  return true;
+}
+
+// Fills stats, if not null, even when the parse fails
+static libvisio::VisioParseStatus parseDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, libvisio::VSDPages *pages,
+                                               bool isStencilExtraction, const libvisio::VisioParseOptions &options,
+                                               libvisio::VisioParseStats *stats = nullptr)
+{
+  libvisio::VSDParseControl control(options, bool(stats));
+  std::unique_ptr<libvisio::VSDCompoundFile> storage;
+  bool isBinary = false;
+  bool isOpc = false;
+  bool isXml = false;
+  {
+    libvisio::VSDParseTimer timer(&control, &libvisio::VisioParseStats::detectionSeconds);
+    storage = libvisio::VSDCompoundFile::open(input);
+    isBinary = isBinaryVisioDocument(input, storage.get());
+    isOpc = !isBinary && isOpcVisioDocument(input);
+    isXml = !isBinary && !isOpc && isXmlVisioDocument(input);
+  }
+
+  bool parsed = false;
+  if (isBinary)
+    parsed = parseBinaryVisioDocument(input, storage.get(), painter, pages, isStencilExtraction, options, &control);
+  else if (isOpc)
+    parsed = parseOpcVisioDocument(input, painter, pages, isStencilExtraction, options, &control);
+  else if (isXml)
+    parsed = parseXmlVisioDocument(input, painter, pages, isStencilExtraction, options, &control);
+  if (stats)
+    *stats = control.getStats();
+
+  // An interruption wins even if the parser swallowed it, as the output is incomplete
+  if (control.getStatus() != libvisio::VISIO_PARSE_OK)
+    return control.getStatus();
+  return parsed ? libvisio::VISIO_PARSE_OK : libvisio::VISIO_PARSE_ERROR;
+}
+
 } // anonymous namespace
 
 
@@ -219,7 +332,8 @@ VSDAPI bool libvisio::VisioDocument::isSupported(librevenge::RVNGInputStream *in
   if (!input)
     return false;
 
-  if (isBinaryVisioDocument(input))
+  const std::unique_ptr<VSDCompoundFile> storage(VSDCompoundFile::open(input));
+  if (isBinaryVisioDocument(input, storage.get()))
     return true;
   if (isOpcVisioDocument(input))
     return true;
@@ -238,30 +352,186 @@ librevenge::RVNGDrawingInterface class implementation when needed. This is often
 */
 VSDAPI bool libvisio::VisioDocument::parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter)
 {
+  return parse(input, painter, VisioParseOptions());
+}
+
+/**
+Parses the input stream content like parse(input, painter), with the
+behaviour of the parser tuned by options.
+\param input The input stream
+\param painter A WPGPainterInterface implementation
+\param options Settings for this parse
+\return A value that indicates whether the parsing was successful
+*/
+VSDAPI bool libvisio::VisioDocument::parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const VisioParseOptions &options)
+{
+  VisioParseStatus status = VISIO_PARSE_OK;
+  return parse(input, painter, options, status);
+}
+
+/**
+Parses the input stream content like parse(input, painter, options), and
+tells why the parse failed.
+\param input The input stream
+\param painter A WPGPainterInterface implementation
+\param options Settings for this parse
+\param status Receives the outcome of the parse
+\return A value that indicates whether the parsing was successful
+*/
+VSDAPI bool libvisio::VisioDocument::parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const VisioParseOptions &options,
+                                           VisioParseStatus &status)
+{
+  status = VISIO_PARSE_ERROR;
   if (!input || !painter)
     return false;
 
-  if (isBinaryVisioDocument(input))
-  {
-    if (parseBinaryVisioDocument(input, painter, false))
-      return true;
+  status = parseDocument(input, painter, nullptr, false, options);
+  return status == VISIO_PARSE_OK;
+}
+
+/**
+Parses the input stream content like parse(input, painter, options,
+status), and reports where the parse spent its time.
+\param input The input stream
+\param painter A WPGPainterInterface implementation
+\param options Settings for this parse
+\param status Receives the outcome of the parse
+\param stats Receives the statistics of the parse
+\return A value that indicates whether the parsing was successful
+*/
+VSDAPI bool libvisio::VisioDocument::parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const VisioParseOptions &options,
+                                           VisioParseStatus &status, VisioParseStats &stats)
+{
+  status = VISIO_PARSE_ERROR;
+  stats = VisioParseStats();
+  if (!input || !painter)
     return false;
-  }
-  if (isOpcVisioDocument(input))
-  {
-    if (parseOpcVisioDocument(input, painter, false))
-      return true;
+
+  status = parseDocument(input, painter, nullptr, false, options, &stats);
+  return status == VISIO_PARSE_OK;
+}
+
+/**
+Parses the input stream content into model, without drawing it. The
+model can then be drawn to any number of painters, in the same way as
+parse(input, painter) would draw the document.
+\param input The input stream
+\param model The model to fill; its previous content is dropped
+\return A value that indicates whether the parsing was successful
+*/
+VSDAPI bool libvisio::VisioDocument::parse(librevenge::RVNGInputStream *input, VisioDocumentModel &model)
+{
+  return parse(input, model, VisioParseOptions());
+}
+
+/**
+Parses the input stream content into model like parse(input, model),
+with the behaviour of the parser tuned by options.
+\param input The input stream
+\param model The model to fill; its previous content is dropped
+\param options Settings for this parse
+\return A value that indicates whether the parsing was successful
+*/
+VSDAPI bool libvisio::VisioDocument::parse(librevenge::RVNGInputStream *input, VisioDocumentModel &model, const VisioParseOptions &options)
+{
+  VisioParseStatus status = VISIO_PARSE_OK;
+  return parse(input, model, options, status);
+}
+
+/**
+Parses the input stream content into model like parse(input, model,
+options), and tells why the parse failed.
+\param input The input stream
+\param model The model to fill; its previous content is dropped
+\param options Settings for this parse
+\param status Receives the outcome of the parse
+\return A value that indicates whether the parsing was successful
+*/
+VSDAPI bool libvisio::VisioDocument::parse(librevenge::RVNGInputStream *input, VisioDocumentModel &model, const VisioParseOptions &options,
+                                           VisioParseStatus &status)
+{
+  model.clear();
+  status = VISIO_PARSE_ERROR;
+  if (!input)
     return false;
-  }
-  if (isXmlVisioDocument(input))
+
+  status = parseDocument(input, nullptr, model.m_pages.get(), false, options);
+  if (status == VISIO_PARSE_OK)
   {
-    if (parseXmlVisioDocument(input, painter, false))
-      return true;
+    model.m_optionsHash = hashModelCacheOptions(options);
+    return true;
+  }
+  model.clear();
+  return false;
+}
+
+/**
+Parses the input stream content into model like parse(input, model,
+options, status), and reports where the parse spent its time.
+\param input The input stream
+\param model The model to fill; its previous content is dropped
+\param options Settings for this parse
+\param status Receives the outcome of the parse
+\param stats Receives the statistics of the parse
+\return A value that indicates whether the parsing was successful
+*/
+VSDAPI bool libvisio::VisioDocument::parse(librevenge::RVNGInputStream *input, VisioDocumentModel &model, const VisioParseOptions &options,
+                                           VisioParseStatus &status, VisioParseStats &stats)
+{
+  model.clear();
+  status = VISIO_PARSE_ERROR;
+  stats = VisioParseStats();
+  if (!input)
     return false;
+
+  status = parseDocument(input, nullptr, model.m_pages.get(), false, options, &stats);
+  if (status == VISIO_PARSE_OK)
+  {
+    model.m_optionsHash = hashModelCacheOptions(options);
+    return true;
   }
+  model.clear();
   return false;
 }
 
+/**
+Parses several documents at once, like parse(input, painter, options,
+status, stats) parses each of them, spreading them over threads. Each
+document is parsed by a single thread, so its input stream and painter
+need not be thread-safe; the thread count multiplies with the
+decompressionThreads and pageThreads of options.
+\param documents The documents; their status and stats receive the
+outcome of each parse
+\param threads Maximal number of threads, the calling thread included;
+0 means one per processor
+\param options Settings for the parse of every document
+\return A value that indicates whether all documents were parsed
+successfully
+*/
+VSDAPI bool libvisio::VisioDocument::parseBatch(std::vector<VisioBatchDocument> &documents, unsigned threads, const VisioParseOptions &options)
+{
+  if (!threads)
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  std::atomic<bool> parsedAll(true);
+  VSDWorkerPool(threads).run(documents.size(), [&documents, &options, &parsedAll](std::size_t i)
+  {
+    VisioBatchDocument &document = documents[i];
+    std::unique_ptr<librevenge::RVNGDrawingInterface> painter;
+    try
+    {
+      if (document.createPainter)
+        painter = document.createPainter();
+    }
+    catch (...)
+    {
+    }
+    if (!parse(document.input, painter.get(), options, document.status, document.stats))
+      parsedAll = false;
+  });
+  return parsedAll;
+}
+
 /**
 Parses the input stream content and extracts stencil pages, one stencil page per output page.
 It will make callbacks to the functions provided by a librevenge::RVNGDrawingInterface class implementation
@@ -271,28 +541,113 @@ when needed.
 \return A value that indicates whether the parsing was successful
 */
 VSDAPI bool libvisio::VisioDocument::parseStencils(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter)
+{
+  return parseStencils(input, painter, VisioParseOptions());
+}
+
+/**
+Extracts the stencil pages like parseStencils(input, painter), with the
+behaviour of the parser tuned by options.
+\param input The input stream
+\param painter A WPGPainterInterface implementation
+\param options Settings for this parse
+\return A value that indicates whether the parsing was successful
+*/
+VSDAPI bool libvisio::VisioDocument::parseStencils(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter,
+                                                   const VisioParseOptions &options)
 {
   if (!input || !painter)
     return false;
 
-  if (isBinaryVisioDocument(input))
-  {
-    if (parseBinaryVisioDocument(input, painter, true))
-      return true;
+  return parseDocument(input, painter, nullptr, true, options) == VISIO_PARSE_OK;
+}
+
+/**
+Reads the document metadata of the input stream, the same properties that
+parse passes to setDocumentMetaData, without parsing the pages. Only the
+document property streams are read, so this is much faster than a parse.
+\param input The input stream
+\param metaData Receives the metadata; it is left empty if the document has none
+\return A value that indicates whether the input is a supported Visio document
+*/
+VSDAPI bool libvisio::VisioDocument::parseMetaData(librevenge::RVNGInputStream *input, librevenge::RVNGPropertyList &metaData)
+{
+  metaData.clear();
+  if (!input)
     return false;
-  }
+
+  const std::unique_ptr<VSDCompoundFile> storage(VSDCompoundFile::open(input));
+  if (isBinaryVisioDocument(input, storage.get()))
+    return readBinaryVisioMetaData(input, storage.get(), metaData);
   if (isOpcVisioDocument(input))
-  {
-    if (parseOpcVisioDocument(input, painter, true))
-      return true;
+    return readOpcVisioMetaData(input, metaData);
+  // DrawingML documents carry no metadata that the parser reads
+  return isXmlVisioDocument(input);
+}
+
+/**
+Writes a cache of model, which was parsed from input, to cache. The cache
+can be stored, for example in a file, and later drawn by drawCache without
+parsing input again.
+\param input The input stream the model was parsed from
+\param model The parsed document
+\param cache Receives the cache
+\return A value that indicates whether the cache was written
+*/
+VSDAPI bool libvisio::VisioDocument::writeCache(librevenge::RVNGInputStream *input, const VisioDocumentModel &model, librevenge::RVNGBinaryData &cache)
+{
+  cache.clear();
+  uint64_t inputHash = 0;
+  uint64_t inputSize = 0;
+  if (!hashModelCacheInput(input, model.m_optionsHash, inputHash, inputSize))
     return false;
-  }
-  if (isXmlVisioDocument(input))
-  {
-    if (parseXmlVisioDocument(input, painter, true))
-      return true;
+
+  VSDModelCacheWriter writer(inputHash, inputSize);
+  model.m_pages->draw(&writer);
+  const std::vector<unsigned char> &data = writer.getData();
+  cache.append(data.data(), data.size());
+  return true;
+}
+
+/**
+Makes the same calls on painter that parsing input would make, using a
+cache written by writeCache. The cache is read in place, so it can be a
+mapped file. Nothing is drawn if the cache was written for another input
+or by another version of the library; the caller then parses input.
+\param input The input stream
+\param cache The cache
+\param cacheSize The size of the cache in bytes
+\param painter A WPGPainterInterface implementation
+\return A value that indicates whether the document was drawn from the cache
+*/
+VSDAPI bool libvisio::VisioDocument::drawCache(librevenge::RVNGInputStream *input, const unsigned char *cache, unsigned long cacheSize,
+                                               librevenge::RVNGDrawingInterface *painter)
+{
+  return drawCache(input, cache, cacheSize, VisioParseOptions(), painter);
+}
+
+/**
+Makes the same calls on painter that parsing input with options would
+make, using a cache written by writeCache. Nothing is drawn if the model
+of the cache was parsed with other pages, pageNames or textOnly than
+options; the other options do not change what is drawn.
+\param input The input stream
+\param cache The cache
+\param cacheSize The size of the cache in bytes
+\param options The settings the document would be parsed with
+\param painter A WPGPainterInterface implementation
+\return A value that indicates whether the document was drawn from the cache
+*/
+VSDAPI bool libvisio::VisioDocument::drawCache(librevenge::RVNGInputStream *input, const unsigned char *cache, unsigned long cacheSize,
+                                               const VisioParseOptions &options, librevenge::RVNGDrawingInterface *painter)
+{
+  if (!cache || !painter)
     return false;
-  }
-  return false;
+
+  uint64_t inputHash = 0;
+  uint64_t inputSize = 0;
+  if (!hashModelCacheInput(input, hashModelCacheOptions(options), inputHash, inputSize))
+    return false;
+  return drawModelCache(cache, cacheSize, inputHash, inputSize, painter);
 }
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
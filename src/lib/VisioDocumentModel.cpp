@@ -0,0 +1,40 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <libvisio/libvisio.h>
+
+#include "VSDModelCache.h"
+#include "VSDPages.h"
+
+VSDAPI libvisio::VisioDocumentModel::VisioDocumentModel()
+  : m_pages(new VSDPages()), m_optionsHash(hashModelCacheOptions(VisioParseOptions()))
+{
+}
+
+VSDAPI libvisio::VisioDocumentModel::~VisioDocumentModel()
+{
+}
+
+VSDAPI bool libvisio::VisioDocumentModel::empty() const
+{
+  return m_pages->empty();
+}
+
+VSDAPI void libvisio::VisioDocumentModel::draw(librevenge::RVNGDrawingInterface *painter) const
+{
+  m_pages->draw(painter);
+}
+
+VSDAPI void libvisio::VisioDocumentModel::clear()
+{
+  VSDPages().swap(*m_pages);
+  m_optionsHash = hashModelCacheOptions(VisioParseOptions());
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -11,6 +11,9 @@
 
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
 #include "VSDInternalStream.h"
 
 uint8_t libvisio::readU8(librevenge::RVNGInputStream *input)
@@ -143,6 +146,76 @@ void libvisio::appendUCS4(librevenge::RVNGString &text, UChar32 ucs4Character)
   text.append((char *)outbuf);
 }
 
+namespace
+{
+
+// The converters opened by one thread, closed when the thread ends
+class ThreadConverters
+{
+public:
+  ThreadConverters() : m_converters() {}
+  ~ThreadConverters()
+  {
+    for (auto &converter : m_converters)
+      ucnv_close(converter.second);
+  }
+
+  UConverter *get(const char *name)
+  {
+    for (auto &converter : m_converters)
+    {
+      if (!std::strcmp(converter.first, name))
+        return converter.second;
+    }
+    UErrorCode status = U_ZERO_ERROR;
+    UConverter *const conv = ucnv_open(name, &status);
+    if (U_FAILURE(status) || !conv)
+    {
+      if (conv)
+        ucnv_close(conv);
+      return nullptr;
+    }
+    m_converters.push_back(std::make_pair(name, conv));
+    return conv;
+  }
+
+private:
+  ThreadConverters(const ThreadConverters &);
+  ThreadConverters &operator=(const ThreadConverters &);
+
+  // The names are string literals of the callers, so they are not copied
+  std::vector<std::pair<const char *, UConverter *> > m_converters;
+};
+
+}
+
+UConverter *libvisio::getThreadConverter(const char *name)
+{
+  static thread_local ThreadConverters converters;
+  UConverter *const conv = converters.get(name);
+  if (conv)
+    ucnv_reset(conv);
+  return conv;
+}
+
+bool libvisio::getUTCTime(std::time_t time, std::tm &result)
+{
+#ifdef _WIN32
+  return !gmtime_s(&result, &time);
+#else
+  return gmtime_r(&time, &result);
+#endif
+}
+
+bool libvisio::getLocalTime(std::time_t time, std::tm &result)
+{
+#ifdef _WIN32
+  return !localtime_s(&result, &time);
+#else
+  return localtime_r(&time, &result);
+#endif
+}
+
 void libvisio::debugPrint(const char *format, ...)
 {
   va_list args;
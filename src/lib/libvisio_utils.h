@@ -14,6 +14,7 @@
 #include "config.h"
 #endif
 
+#include <ctime>
 #include <memory>
 
 #include <boost/cstdint.hpp>
@@ -26,6 +27,7 @@
 
 #include <librevenge/librevenge.h>
 #include <librevenge-stream/librevenge-stream.h>
+#include <unicode/ucnv.h>
 #include <unicode/utypes.h>
 
 #if defined(HAVE_FUNC_ATTRIBUTE_FORMAT)
@@ -82,6 +84,19 @@ unsigned long getRemainingLength(librevenge::RVNGInputStream *input);
 
 void appendUCS4(librevenge::RVNGString &text, UChar32 ucs4Character);
 
+/* Returns a reset converter for the ICU charset name, which has to be a
+ * string literal, or null if ICU has none. The converter belongs to the
+ * calling thread and is kept for its later calls, so it must not be
+ * closed by the caller.
+ */
+UConverter *getThreadConverter(const char *name);
+
+/* Like gmtime and localtime, but into result instead of a buffer that
+ * all threads share. Return false if time cannot be converted.
+ */
+bool getUTCTime(std::time_t time, std::tm &result);
+bool getLocalTime(std::time_t time, std::tm &result);
+
 void debugPrint(const char *format, ...) VSD_ATTRIBUTE_PRINTF(1, 2);
 
 class EndOfStreamException
@@ -96,6 +111,10 @@ class GenericException
 {
 };
 
+class ParseInterruptedException
+{
+};
+
 } // namespace libvisio
 
 #endif // __LIBVISIO_UTILS_H__
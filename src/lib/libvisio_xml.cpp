@@ -9,6 +9,8 @@
 
 #include "libvisio_xml.h"
 
+#include <mutex>
+
 #ifndef BOOST_LEXICAL_CAST_ASSUME_C_LOCALE
 #define BOOST_LEXICAL_CAST_ASSUME_C_LOCALE 1
 #endif
@@ -99,6 +101,11 @@ void XMLErrorWatcher::setError()
 std::unique_ptr<xmlTextReader, void (*)(xmlTextReaderPtr)>
 xmlReaderForStream(librevenge::RVNGInputStream *input, XMLErrorWatcher *const watcher, bool recover)
 {
+  // libxml2 sets up its globals lazily, which is not safe if the first
+  // readers are created on several threads at once
+  static std::once_flag xmlInitialized;
+  std::call_once(xmlInitialized, xmlInitParser);
+
   int options = XML_PARSE_NOBLANKS | XML_PARSE_NONET;
   if (recover)
     options |= XML_PARSE_RECOVER;
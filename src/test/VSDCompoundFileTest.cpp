@@ -0,0 +1,318 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include "VSDCompoundFile.h"
+
+namespace test
+{
+
+namespace
+{
+
+const unsigned SECTOR_SIZE = 512;
+const unsigned LARGE_STREAM_SIZE = 5000;
+const unsigned SMALL_STREAM_SIZE = 100;
+
+void putU16(std::vector<unsigned char> &data, unsigned long offset, unsigned value)
+{
+  data[offset] = (unsigned char)(value & 0xff);
+  data[offset + 1] = (unsigned char)((value >> 8) & 0xff);
+}
+
+void putU32(std::vector<unsigned char> &data, unsigned long offset, unsigned value)
+{
+  putU16(data, offset, value & 0xffff);
+  putU16(data, offset + 2, value >> 16);
+}
+
+unsigned long sectorOffset(unsigned sector)
+{
+  return (sector + 1) * SECTOR_SIZE;
+}
+
+void putEntry(std::vector<unsigned char> &data, unsigned id, const char *name, unsigned char type,
+              unsigned left, unsigned right, unsigned child, unsigned start, unsigned size)
+{
+  const unsigned long offset = sectorOffset(1) + id * 128;
+  unsigned i = 0;
+  for (; name[i]; ++i)
+    putU16(data, offset + 2 * i, (unsigned char)name[i]);
+  putU16(data, offset + 0x40, 2 * (i + 1));
+  data[offset + 0x42] = type;
+  putU32(data, offset + 0x44, left);
+  putU32(data, offset + 0x48, right);
+  putU32(data, offset + 0x4c, child);
+  putU32(data, offset + 0x74, start);
+  putU32(data, offset + 0x78, size);
+}
+
+unsigned char largeStreamByte(unsigned long i)
+{
+  return (unsigned char)((i * 7 + 3) & 0xff);
+}
+
+unsigned char smallStreamByte(unsigned long i)
+{
+  return (unsigned char)(0x80 + i);
+}
+
+/* A version 3 compound file with 512 byte sectors:
+ * 0: FAT, 1: directory, 2: MiniFAT, 3-7 and 9-13: "VisioDocument", 8: mini stream.
+ * "\x05SummaryInformation" is in the mini sectors 1 and 0, in that order.
+ */
+std::vector<unsigned char> makeCompoundFile()
+{
+  std::vector<unsigned char> data(sectorOffset(14), 0);
+
+  const unsigned char signature[] = { 0xd0, 0xcf, 0x11, 0xe0, 0xa1, 0xb1, 0x1a, 0xe1 };
+  std::copy(signature, signature + sizeof(signature), data.begin());
+  putU16(data, 0x18, 0x3e);
+  putU16(data, 0x1a, 3);
+  putU16(data, 0x1c, 0xfffe);
+  putU16(data, 0x1e, 9);
+  putU16(data, 0x20, 6);
+  putU32(data, 0x2c, 1);
+  putU32(data, 0x30, 1);
+  putU32(data, 0x38, 4096);
+  putU32(data, 0x3c, 2);
+  putU32(data, 0x40, 1);
+  putU32(data, 0x44, 0xfffffffe);
+  putU32(data, 0x4c, 0);
+  for (unsigned i = 1; i < 109; ++i)
+    putU32(data, 0x4c + 4 * i, 0xffffffff);
+
+  // FAT
+  for (unsigned i = 0; i < SECTOR_SIZE / 4; ++i)
+    putU32(data, sectorOffset(0) + 4 * i, 0xffffffff);
+  putU32(data, sectorOffset(0), 0xfffffffd);
+  putU32(data, sectorOffset(0) + 4 * 1, 0xfffffffe);
+  putU32(data, sectorOffset(0) + 4 * 2, 0xfffffffe);
+  for (unsigned i = 3; i < 7; ++i)
+    putU32(data, sectorOffset(0) + 4 * i, i + 1);
+  putU32(data, sectorOffset(0) + 4 * 7, 9);
+  putU32(data, sectorOffset(0) + 4 * 8, 0xfffffffe);
+  for (unsigned i = 9; i < 13; ++i)
+    putU32(data, sectorOffset(0) + 4 * i, i + 1);
+  putU32(data, sectorOffset(0) + 4 * 13, 0xfffffffe);
+
+  // MiniFAT
+  for (unsigned i = 0; i < SECTOR_SIZE / 4; ++i)
+    putU32(data, sectorOffset(2) + 4 * i, 0xffffffff);
+  putU32(data, sectorOffset(2) + 4 * 1, 0);
+  putU32(data, sectorOffset(2), 0xfffffffe);
+
+  // directory
+  putEntry(data, 0, "Root Entry", 5, 0xffffffff, 0xffffffff, 1, 8, SECTOR_SIZE);
+  putEntry(data, 1, "VisioDocument", 2, 0xffffffff, 2, 0xffffffff, 3, LARGE_STREAM_SIZE);
+  putEntry(data, 2, "\x05SummaryInformation", 2, 0xffffffff, 0xffffffff, 0xffffffff, 1, SMALL_STREAM_SIZE);
+  putEntry(data, 3, "", 0, 0xffffffff, 0xffffffff, 0xffffffff, 0, 0);
+
+  const unsigned largeSectors[] = { 3, 4, 5, 6, 7, 9, 10, 11, 12, 13 };
+  for (unsigned long i = 0; i < LARGE_STREAM_SIZE; ++i)
+    data[sectorOffset(largeSectors[i / SECTOR_SIZE]) + i % SECTOR_SIZE] = largeStreamByte(i);
+
+  const unsigned miniSectors[] = { 1, 0 };
+  for (unsigned long i = 0; i < SMALL_STREAM_SIZE; ++i)
+    data[sectorOffset(8) + miniSectors[i / 64] * 64 + i % 64] = smallStreamByte(i);
+
+  return data;
+}
+
+}
+
+class VSDCompoundFileTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDCompoundFileTest);
+  CPPUNIT_TEST(testDirectory);
+  CPPUNIT_TEST(testStream);
+  CPPUNIT_TEST(testMiniStream);
+  CPPUNIT_TEST(testInvalid);
+  CPPUNIT_TEST(testContiguousBuffer);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testDirectory();
+  void testStream();
+  void testMiniStream();
+  void testInvalid();
+  void testContiguousBuffer();
+};
+
+void VSDCompoundFileTest::setUp()
+{
+}
+
+void VSDCompoundFileTest::tearDown()
+{
+}
+
+void VSDCompoundFileTest::testDirectory()
+{
+  const std::vector<unsigned char> data = makeCompoundFile();
+  librevenge::RVNGStringStream input(data.data(), data.size());
+  const std::unique_ptr<libvisio::VSDCompoundFile> file(libvisio::VSDCompoundFile::open(&input));
+  CPPUNIT_ASSERT(bool(file));
+  CPPUNIT_ASSERT(file->isStructured());
+  CPPUNIT_ASSERT_EQUAL(2u, file->subStreamCount());
+  CPPUNIT_ASSERT(file->existsSubStream("VisioDocument"));
+  CPPUNIT_ASSERT_MESSAGE("names are compared case-insensitively", file->existsSubStream("visiodocument"));
+  CPPUNIT_ASSERT(file->existsSubStream("\x05SummaryInformation"));
+  CPPUNIT_ASSERT(!file->existsSubStream("VisioDocumen"));
+  CPPUNIT_ASSERT(!file->getSubStreamByName("Root Entry"));
+
+  // reads that are not on a sub-stream go to the container
+  CPPUNIT_ASSERT_EQUAL(0L, file->tell());
+  CPPUNIT_ASSERT_EQUAL(0, file->seek(0x1e, librevenge::RVNG_SEEK_SET));
+  unsigned long numBytesRead = 0;
+  const unsigned char *const sectorShift = file->read(1, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(1UL, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL((unsigned char)9, sectorShift[0]);
+}
+
+void VSDCompoundFileTest::testStream()
+{
+  const std::vector<unsigned char> data = makeCompoundFile();
+  librevenge::RVNGStringStream input(data.data(), data.size());
+  const std::unique_ptr<libvisio::VSDCompoundFile> file(libvisio::VSDCompoundFile::open(&input));
+  CPPUNIT_ASSERT(bool(file));
+  const std::unique_ptr<librevenge::RVNGInputStream> stream(file->getSubStreamByName("VisioDocument"));
+  CPPUNIT_ASSERT(bool(stream));
+
+  // the whole stream, across the gap in its sectors
+  unsigned long numBytesRead = 0;
+  const unsigned char *buffer = stream->read(LARGE_STREAM_SIZE + 10, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL((unsigned long)LARGE_STREAM_SIZE, numBytesRead);
+  for (unsigned long i = 0; i < numBytesRead; ++i)
+    CPPUNIT_ASSERT_EQUAL(largeStreamByte(i), buffer[i]);
+  CPPUNIT_ASSERT(stream->isEnd());
+  CPPUNIT_ASSERT(!stream->read(1, numBytesRead));
+
+  // a read inside the adjacent sectors 3 to 7
+  CPPUNIT_ASSERT_EQUAL(0, stream->seek(100, librevenge::RVNG_SEEK_SET));
+  buffer = stream->read(1000, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(1000UL, numBytesRead);
+  for (unsigned long i = 0; i < numBytesRead; ++i)
+    CPPUNIT_ASSERT_EQUAL(largeStreamByte(100 + i), buffer[i]);
+
+  // a read over the end of sector 7
+  CPPUNIT_ASSERT_EQUAL(0, stream->seek(5 * SECTOR_SIZE - 2, librevenge::RVNG_SEEK_SET));
+  buffer = stream->read(4, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(4UL, numBytesRead);
+  for (unsigned long i = 0; i < 4; ++i)
+    CPPUNIT_ASSERT_EQUAL(largeStreamByte(5 * SECTOR_SIZE - 2 + i), buffer[i]);
+  CPPUNIT_ASSERT_EQUAL(long(5 * SECTOR_SIZE + 2), stream->tell());
+
+  CPPUNIT_ASSERT(0 != stream->seek(-1, librevenge::RVNG_SEEK_SET));
+  CPPUNIT_ASSERT_EQUAL(0L, stream->tell());
+  CPPUNIT_ASSERT(0 != stream->seek(1, librevenge::RVNG_SEEK_END));
+  CPPUNIT_ASSERT_EQUAL(long(LARGE_STREAM_SIZE), stream->tell());
+}
+
+void VSDCompoundFileTest::testMiniStream()
+{
+  const std::vector<unsigned char> data = makeCompoundFile();
+  librevenge::RVNGStringStream input(data.data(), data.size());
+  const std::unique_ptr<libvisio::VSDCompoundFile> file(libvisio::VSDCompoundFile::open(&input));
+  CPPUNIT_ASSERT(bool(file));
+  const std::unique_ptr<librevenge::RVNGInputStream> stream(file->getSubStreamByName("\x05SummaryInformation"));
+  CPPUNIT_ASSERT(bool(stream));
+
+  unsigned long numBytesRead = 0;
+  const unsigned char *const buffer = stream->read(SMALL_STREAM_SIZE, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL((unsigned long)SMALL_STREAM_SIZE, numBytesRead);
+  for (unsigned long i = 0; i < numBytesRead; ++i)
+    CPPUNIT_ASSERT_EQUAL(smallStreamByte(i), buffer[i]);
+  CPPUNIT_ASSERT(stream->isEnd());
+}
+
+void VSDCompoundFileTest::testInvalid()
+{
+  std::vector<unsigned char> data = makeCompoundFile();
+  {
+    librevenge::RVNGStringStream input(data.data(), 300);
+    CPPUNIT_ASSERT_MESSAGE("truncated header", !libvisio::VSDCompoundFile::open(&input));
+  }
+  {
+    librevenge::RVNGStringStream input(data.data(), sectorOffset(1));
+    CPPUNIT_ASSERT_MESSAGE("missing directory", !libvisio::VSDCompoundFile::open(&input));
+  }
+  {
+    std::vector<unsigned char> broken(data);
+    broken[0] = 0;
+    librevenge::RVNGStringStream input(broken.data(), broken.size());
+    CPPUNIT_ASSERT_MESSAGE("no signature", !libvisio::VSDCompoundFile::open(&input));
+  }
+  {
+    // a FAT chain that loops
+    std::vector<unsigned char> broken(data);
+    putU32(broken, sectorOffset(0) + 4 * 13, 3);
+    librevenge::RVNGStringStream input(broken.data(), broken.size());
+    const std::unique_ptr<libvisio::VSDCompoundFile> file(libvisio::VSDCompoundFile::open(&input));
+    CPPUNIT_ASSERT(bool(file));
+    CPPUNIT_ASSERT(!file->getSubStreamByName("VisioDocument"));
+  }
+  {
+    // a stream that is longer than its chain
+    std::vector<unsigned char> broken(data);
+    putU32(broken, sectorOffset(1) + 128 + 0x78, 6000);
+    librevenge::RVNGStringStream input(broken.data(), broken.size());
+    const std::unique_ptr<libvisio::VSDCompoundFile> file(libvisio::VSDCompoundFile::open(&input));
+    CPPUNIT_ASSERT(bool(file));
+    CPPUNIT_ASSERT(!file->getSubStreamByName("VisioDocument"));
+  }
+}
+
+void VSDCompoundFileTest::testContiguousBuffer()
+{
+  std::vector<unsigned char> data = makeCompoundFile();
+  // only the second half of the mini stream, which is in one mini sector
+  putEntry(data, 2, "\x05SummaryInformation", 2, 0xffffffff, 0xffffffff, 0xffffffff, 1, 64);
+  librevenge::RVNGStringStream input(data.data(), data.size());
+
+  unsigned long size = 0;
+  CPPUNIT_ASSERT(bool(libvisio::getContiguousBuffer(&input, size)));
+  CPPUNIT_ASSERT_EQUAL((unsigned long)data.size(), size);
+
+  const std::unique_ptr<libvisio::VSDCompoundFile> file(libvisio::VSDCompoundFile::open(&input));
+  CPPUNIT_ASSERT(bool(file));
+  CPPUNIT_ASSERT_EQUAL(0, input.seek(10, librevenge::RVNG_SEEK_SET));
+  const std::unique_ptr<librevenge::RVNGInputStream> contiguous(file->getSubStreamByName("\x05SummaryInformation"));
+  CPPUNIT_ASSERT(bool(contiguous));
+  const unsigned char *const buffer = libvisio::getContiguousBuffer(contiguous.get(), size);
+  CPPUNIT_ASSERT(bool(buffer));
+  CPPUNIT_ASSERT_EQUAL(64UL, size);
+  for (unsigned long i = 0; i < size; ++i)
+    CPPUNIT_ASSERT_EQUAL(smallStreamByte(i), buffer[i]);
+  CPPUNIT_ASSERT_MESSAGE("the position of the container is kept", 10L == input.tell());
+
+  const std::unique_ptr<librevenge::RVNGInputStream> gapped(file->getSubStreamByName("VisioDocument"));
+  CPPUNIT_ASSERT(bool(gapped));
+  CPPUNIT_ASSERT(!libvisio::getContiguousBuffer(gapped.get(), size));
+  CPPUNIT_ASSERT_EQUAL(0UL, size);
+  CPPUNIT_ASSERT(!libvisio::getContiguousBuffer(file.get(), size));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDCompoundFileTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
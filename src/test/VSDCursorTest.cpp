@@ -0,0 +1,120 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "VSDCursor.h"
+
+namespace test
+{
+
+using libvisio::VSDCursor;
+
+class VSDCursorTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDCursorTest);
+  CPPUNIT_TEST(testRead);
+  CPPUNIT_TEST(testSeek);
+  CPPUNIT_TEST(testTruncated);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testRead();
+  void testSeek();
+  void testTruncated();
+};
+
+void VSDCursorTest::setUp()
+{
+}
+
+void VSDCursorTest::tearDown()
+{
+}
+
+void VSDCursorTest::testRead()
+{
+  const unsigned char data[] =
+  {
+    0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x3f
+  };
+  VSDCursor cursor(data, sizeof(data));
+
+  CPPUNIT_ASSERT(0x01 == libvisio::readU8(&cursor));
+  CPPUNIT_ASSERT(0x0302 == libvisio::readU16(&cursor));
+  CPPUNIT_ASSERT(0x07060504 == libvisio::readU32(&cursor));
+  CPPUNIT_ASSERT(sizeof(data) - 7 == cursor.getRemainingLength());
+  CPPUNIT_ASSERT_EQUAL(1.0, libvisio::readDouble(&cursor));
+  CPPUNIT_ASSERT(cursor.isEnd());
+  CPPUNIT_ASSERT(!cursor.isTruncated());
+
+  cursor.seek(0, librevenge::RVNG_SEEK_SET);
+  unsigned long readBytes = 0;
+  const unsigned char *s = cursor.read(sizeof(data) + 1, readBytes);
+  CPPUNIT_ASSERT(sizeof(data) == readBytes);
+  CPPUNIT_ASSERT(data == s);
+  CPPUNIT_ASSERT(!cursor.read(1, readBytes));
+  CPPUNIT_ASSERT(0 == readBytes);
+  CPPUNIT_ASSERT_MESSAGE("a short read must not mark the cursor as truncated", !cursor.isTruncated());
+}
+
+void VSDCursorTest::testSeek()
+{
+  const unsigned char data[] = "abc dee fgh";
+  VSDCursor cursor(data, sizeof(data));
+
+  CPPUNIT_ASSERT(0 == cursor.seek(2, librevenge::RVNG_SEEK_SET));
+  CPPUNIT_ASSERT(2 == cursor.tell());
+  CPPUNIT_ASSERT(0 == cursor.seek(-1, librevenge::RVNG_SEEK_CUR));
+  CPPUNIT_ASSERT(1 == cursor.tell());
+  CPPUNIT_ASSERT(0 != cursor.seek(-2, librevenge::RVNG_SEEK_CUR)); // cannot seek before the start
+  CPPUNIT_ASSERT(0 == cursor.tell());
+
+  CPPUNIT_ASSERT(0 == cursor.seek(0, librevenge::RVNG_SEEK_END));
+  CPPUNIT_ASSERT(cursor.isEnd());
+  CPPUNIT_ASSERT(0 != cursor.seek(1, librevenge::RVNG_SEEK_END)); // cannot seek after the end
+  CPPUNIT_ASSERT(sizeof(data) == cursor.tell());
+  CPPUNIT_ASSERT(0 == cursor.seek(-1, librevenge::RVNG_SEEK_END));
+  CPPUNIT_ASSERT((sizeof(data) - 1) == cursor.tell());
+  CPPUNIT_ASSERT(!cursor.isTruncated());
+}
+
+void VSDCursorTest::testTruncated()
+{
+  const unsigned char data[] = { 0x01, 0x02, 0x03 };
+  VSDCursor cursor(data, sizeof(data));
+
+  cursor.seek(1, librevenge::RVNG_SEEK_SET);
+  CPPUNIT_ASSERT(0 == libvisio::readU32(&cursor));
+  CPPUNIT_ASSERT(cursor.isTruncated());
+  CPPUNIT_ASSERT(cursor.isEnd());
+
+  // truncation is kept, even after seeking back
+  cursor.seek(0, librevenge::RVNG_SEEK_SET);
+  CPPUNIT_ASSERT(0x01 == libvisio::readU8(&cursor));
+  CPPUNIT_ASSERT(cursor.isTruncated());
+
+  VSDCursor empty(nullptr, 0);
+  CPPUNIT_ASSERT(empty.isEnd());
+  CPPUNIT_ASSERT(0.0 == libvisio::readDouble(&empty));
+  CPPUNIT_ASSERT(empty.isTruncated());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDCursorTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -8,6 +8,8 @@
  */
 
 #include <algorithm>
+#include <random>
+#include <vector>
 
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
@@ -15,6 +17,7 @@
 #include <librevenge/librevenge.h>
 
 #include "VSDInternalStream.h"
+#include "lzreference.h"
 
 namespace test
 {
@@ -29,11 +32,17 @@ private:
   CPPUNIT_TEST_SUITE(VSDInternalStreamTest);
   CPPUNIT_TEST(testRead);
   CPPUNIT_TEST(testSeek);
+  CPPUNIT_TEST(testView);
+  CPPUNIT_TEST(testDecompress);
+  CPPUNIT_TEST(testDecompressRandom);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   void testRead();
   void testSeek();
+  void testView();
+  void testDecompress();
+  void testDecompressRandom();
 };
 
 void VSDInternalStreamTest::setUp()
@@ -99,6 +108,77 @@ void VSDInternalStreamTest::testSeek()
   CPPUNIT_ASSERT((sizeof(data) - 1) == strm.tell());
 }
 
+void VSDInternalStreamTest::testView()
+{
+  const unsigned char data[] = "abc dee fgh";
+  VSDInternalStream strm(data, sizeof(data));
+
+  CPPUNIT_ASSERT(sizeof(data) == strm.getSize());
+  CPPUNIT_ASSERT_MESSAGE("view does not point to the original data", data == strm.getDataBuffer());
+
+  strm.seek(4, librevenge::RVNG_SEEK_SET);
+  unsigned long readBytes = 0;
+  const unsigned char *s = strm.read(3, readBytes);
+  CPPUNIT_ASSERT(3 == readBytes);
+  CPPUNIT_ASSERT(data + 4 == s);
+
+  s = strm.read(sizeof(data), readBytes);
+  CPPUNIT_ASSERT(sizeof(data) - 7 == readBytes);
+  CPPUNIT_ASSERT(strm.isEnd());
+
+  VSDInternalStream empty(static_cast<const unsigned char *>(nullptr), 10);
+  CPPUNIT_ASSERT(0 == empty.getSize());
+  CPPUNIT_ASSERT(empty.isEnd());
+}
+
+void VSDInternalStreamTest::testDecompress()
+{
+  // 8 literals, then a match overlapping its own output, then a match into the untouched (zeroed) window
+  const unsigned char data[] =
+  {
+    0xff, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h',
+    0x01, 'x', 0xf5, 0xf0, 0x10, 0x00
+  };
+  librevenge::RVNGBinaryData binData(data, sizeof(data));
+  VSDInternalStream strm(binData.getDataStream(), binData.size(), true);
+
+  std::vector<unsigned char> expected;
+  test::lzDecompressReference(data, sizeof(data), expected);
+  CPPUNIT_ASSERT_EQUAL(expected.size(), static_cast<size_t>(strm.getSize()));
+  CPPUNIT_ASSERT_EQUAL(size_t(9 + 3 + 3), expected.size());
+  CPPUNIT_ASSERT(std::equal(expected.begin(), expected.end(), strm.getDataBuffer()));
+
+  // truncated inputs must stop where the old decoder stopped
+  for (unsigned long len = 0; len <= sizeof(data); ++len)
+  {
+    std::vector<unsigned char> output;
+    VSDInternalStream::decompress(data, len, output);
+    test::lzDecompressReference(data, len, expected);
+    CPPUNIT_ASSERT(expected == output);
+  }
+}
+
+void VSDInternalStreamTest::testDecompressRandom()
+{
+  std::mt19937 gen(0x56534421);
+  std::vector<unsigned char> input;
+  std::vector<unsigned char> expected;
+  std::vector<unsigned char> output;
+
+  for (unsigned i = 0; i < 2000; ++i)
+  {
+    input.resize(gen() % (i < 200 ? 24 : 12000));
+    // mix of fully random data and data dominated by back references with short distances
+    const bool sparse = i % 2;
+    for (unsigned char &c : input)
+      c = static_cast<unsigned char>(sparse && gen() % 3 ? gen() % 16 : gen());
+
+    test::lzDecompressReference(input.data(), input.size(), expected);
+    VSDInternalStream::decompress(input.data(), input.size(), output);
+    CPPUNIT_ASSERT(expected == output);
+  }
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(VSDInternalStreamTest);
 
 }
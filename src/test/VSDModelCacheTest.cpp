@@ -0,0 +1,187 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge/librevenge.h>
+
+#include "VSDModelCache.h"
+
+namespace test
+{
+
+using libvisio::VSDModelCacheWriter;
+
+namespace
+{
+
+const uint64_t INPUT_HASH = 0x0123456789abcdefULL;
+const uint64_t INPUT_SIZE = 4242;
+
+void drawDocument(librevenge::RVNGDrawingInterface &painter)
+{
+  librevenge::RVNGPropertyList metaData;
+  metaData.insert("dc:title", "A title");
+  painter.startDocument(librevenge::RVNGPropertyList());
+  painter.setDocumentMetaData(metaData);
+
+  librevenge::RVNGPropertyList page;
+  page.insert("svg:width", 8.5);
+  page.insert("svg:height", 11.0);
+  page.insert("draw:name", "Page-1");
+  painter.startPage(page);
+
+  librevenge::RVNGPropertyList style;
+  style.insert("draw:stroke", "solid");
+  style.insert("svg:stroke-width", 0.01);
+  style.insert("svg:stroke-opacity", 0.5, librevenge::RVNG_PERCENT);
+  style.insert("fo:font-size", 12.0, librevenge::RVNG_POINT);
+  style.insert("draw:shadow-count", 3);
+  style.insert("draw:marker-start-center", true);
+  style.insert("draw:marker-end-center", false);
+  painter.setStyle(style);
+
+  librevenge::RVNGPropertyListVector path;
+  librevenge::RVNGPropertyList element;
+  element.insert("librevenge:path-action", "M");
+  element.insert("svg:x", 1.0);
+  element.insert("svg:y", 2.0);
+  path.append(element);
+  element.clear();
+  element.insert("librevenge:path-action", "L");
+  element.insert("svg:x", 3.25);
+  element.insert("svg:y", 4.0);
+  path.append(element);
+  librevenge::RVNGPropertyList pathProps;
+  pathProps.insert("svg:d", path);
+  painter.drawPath(pathProps);
+
+  painter.startTextObject(librevenge::RVNGPropertyList());
+  painter.openParagraph(librevenge::RVNGPropertyList());
+  painter.openSpan(librevenge::RVNGPropertyList());
+  painter.insertText("Hello");
+  painter.insertSpace();
+  painter.insertText("world");
+  painter.insertTab();
+  painter.insertLineBreak();
+  painter.closeSpan();
+  painter.closeParagraph();
+  painter.endTextObject();
+
+  painter.endPage();
+  painter.endDocument();
+}
+
+std::vector<unsigned char> writeCache()
+{
+  VSDModelCacheWriter writer(INPUT_HASH, INPUT_SIZE);
+  drawDocument(writer);
+  return writer.getData();
+}
+
+}
+
+class VSDModelCacheTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDModelCacheTest);
+  CPPUNIT_TEST(testReplay);
+  CPPUNIT_TEST(testStale);
+  CPPUNIT_TEST(testInvalid);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testReplay();
+  void testStale();
+  void testInvalid();
+};
+
+void VSDModelCacheTest::setUp()
+{
+}
+
+void VSDModelCacheTest::tearDown()
+{
+}
+
+void VSDModelCacheTest::testReplay()
+{
+  const std::vector<unsigned char> cache = writeCache();
+
+  // Replaying into another writer has to record the same calls again
+  VSDModelCacheWriter replayed(INPUT_HASH, INPUT_SIZE);
+  CPPUNIT_ASSERT(libvisio::drawModelCache(cache.data(), cache.size(), INPUT_HASH, INPUT_SIZE, &replayed));
+  CPPUNIT_ASSERT(cache == replayed.getData());
+
+  VSDModelCacheWriter empty(INPUT_HASH, INPUT_SIZE);
+  const std::vector<unsigned char> emptyCache = empty.getData();
+  CPPUNIT_ASSERT(libvisio::drawModelCache(emptyCache.data(), emptyCache.size(), INPUT_HASH, INPUT_SIZE, &replayed));
+}
+
+void VSDModelCacheTest::testStale()
+{
+  const std::vector<unsigned char> cache = writeCache();
+  VSDModelCacheWriter replayed(INPUT_HASH, INPUT_SIZE);
+  const std::vector<unsigned char> nothing = replayed.getData();
+
+  CPPUNIT_ASSERT(!libvisio::drawModelCache(cache.data(), cache.size(), INPUT_HASH + 1, INPUT_SIZE, &replayed));
+  CPPUNIT_ASSERT(!libvisio::drawModelCache(cache.data(), cache.size(), INPUT_HASH, INPUT_SIZE + 1, &replayed));
+
+  std::vector<unsigned char> otherVersion(cache);
+  ++otherVersion[8];
+  CPPUNIT_ASSERT(!libvisio::drawModelCache(otherVersion.data(), otherVersion.size(), INPUT_HASH, INPUT_SIZE, &replayed));
+
+  CPPUNIT_ASSERT(nothing == replayed.getData());
+}
+
+void VSDModelCacheTest::testInvalid()
+{
+  const std::vector<unsigned char> cache = writeCache();
+  VSDModelCacheWriter replayed(INPUT_HASH, INPUT_SIZE);
+  const std::vector<unsigned char> nothing = replayed.getData();
+
+  CPPUNIT_ASSERT(!libvisio::drawModelCache(nullptr, 0, INPUT_HASH, INPUT_SIZE, &replayed));
+  CPPUNIT_ASSERT(!libvisio::drawModelCache(cache.data(), 20, INPUT_HASH, INPUT_SIZE, &replayed));
+
+  std::vector<unsigned char> badMagic(cache);
+  badMagic[0] = 'X';
+  CPPUNIT_ASSERT(!libvisio::drawModelCache(badMagic.data(), badMagic.size(), INPUT_HASH, INPUT_SIZE, &replayed));
+
+  // A cache cut inside a call must not draw the calls before it
+  for (std::size_t size = 49; size < cache.size(); ++size)
+  {
+    std::vector<unsigned char> truncated(cache.begin(), cache.begin() + size);
+    // Make the header agree with the cut size, so only the calls are checked
+    uint64_t payloadSize = size - 48;
+    for (unsigned i = 0; i < 8; ++i, payloadSize >>= 8)
+      truncated[40 + i] = (unsigned char)(payloadSize & 0xff);
+    VSDModelCacheWriter cut(INPUT_HASH, INPUT_SIZE);
+    if (!libvisio::drawModelCache(truncated.data(), truncated.size(), INPUT_HASH, INPUT_SIZE, &cut))
+      CPPUNIT_ASSERT(nothing == cut.getData());
+  }
+  CPPUNIT_ASSERT(!libvisio::drawModelCache(cache.data(), cache.size() - 1, INPUT_HASH, INPUT_SIZE, &replayed));
+
+  std::vector<unsigned char> badOpcode(cache);
+  badOpcode[48] = 0xff;
+  CPPUNIT_ASSERT(!libvisio::drawModelCache(badOpcode.data(), badOpcode.size(), INPUT_HASH, INPUT_SIZE, &replayed));
+  CPPUNIT_ASSERT(nothing == replayed.getData());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDModelCacheTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,171 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <atomic>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "libvisio_utils.h"
+#include "VSDParseControl.h"
+#include "VSDWorkerPool.h"
+
+namespace test
+{
+
+using libvisio::VSDParseControl;
+using libvisio::VSDWorkerPool;
+
+class VSDParseControlTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDParseControlTest);
+  CPPUNIT_TEST(testLimits);
+  CPPUNIT_TEST(testWorkerLimits);
+  CPPUNIT_TEST(testWorkerCancel);
+  CPPUNIT_TEST(testWorkerWithoutParent);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testLimits();
+  void testWorkerLimits();
+  void testWorkerCancel();
+  void testWorkerWithoutParent();
+};
+
+void VSDParseControlTest::setUp()
+{
+}
+
+void VSDParseControlTest::tearDown()
+{
+}
+
+void VSDParseControlTest::testLimits()
+{
+  libvisio::VisioParseOptions options;
+  options.limits.maxDecompressedBytes = 10;
+  VSDParseControl control(options);
+  control.addDecompressedBytes(6);
+  control.addDecompressedBytes(4);
+  CPPUNIT_ASSERT_EQUAL(libvisio::VISIO_PARSE_OK, control.getStatus());
+
+  bool thrown = false;
+  try
+  {
+    control.addDecompressedBytes(1);
+  }
+  catch (const libvisio::ParseInterruptedException &)
+  {
+    thrown = true;
+  }
+  CPPUNIT_ASSERT(thrown);
+  CPPUNIT_ASSERT_EQUAL(libvisio::VISIO_PARSE_LIMIT_EXCEEDED, control.getStatus());
+}
+
+void VSDParseControlTest::testWorkerLimits()
+{
+  libvisio::VisioParseOptions options;
+  options.limits.maxDecompressedBytes = 100;
+  options.limits.maxEmbeddedBytes = 1000;
+  VSDParseControl parent(options);
+
+  // The workers share the limits of the parent, whose totals they add to
+  VSDWorkerPool pool(4);
+  pool.run(10, [&parent](std::size_t)
+  {
+    VSDParseControl control(&parent);
+    control.addDecompressedBytes(10);
+    control.addEmbeddedBytes(5);
+    control.addChunk();
+    CPPUNIT_ASSERT_EQUAL(1ul, control.getStats().chunks);
+  });
+  CPPUNIT_ASSERT_EQUAL(libvisio::VISIO_PARSE_OK, parent.getStatus());
+  CPPUNIT_ASSERT_EQUAL(50ul, parent.getStats().embeddedBytes);
+  CPPUNIT_ASSERT_EQUAL(0ul, parent.getStats().chunks);
+
+  // Together they are over the limit, though none of them is on its own
+  bool thrown = false;
+  try
+  {
+    pool.run(10, [&parent](std::size_t)
+    {
+      VSDParseControl control(&parent);
+      control.addDecompressedBytes(1);
+    });
+  }
+  catch (const libvisio::ParseInterruptedException &)
+  {
+    thrown = true;
+  }
+  CPPUNIT_ASSERT(thrown);
+  CPPUNIT_ASSERT_EQUAL(libvisio::VISIO_PARSE_LIMIT_EXCEEDED, parent.getStatus());
+}
+
+void VSDParseControlTest::testWorkerCancel()
+{
+  std::atomic<bool> cancel(false);
+  libvisio::VisioParseOptions options;
+  options.cancel = &cancel;
+  VSDParseControl parent(options);
+  VSDParseControl control(&parent);
+  control.check();
+
+  cancel = true;
+  bool thrown = false;
+  try
+  {
+    control.check();
+  }
+  catch (const libvisio::ParseInterruptedException &)
+  {
+    thrown = true;
+  }
+  CPPUNIT_ASSERT(thrown);
+  CPPUNIT_ASSERT_EQUAL(libvisio::VISIO_PARSE_CANCELLED, control.getStatus());
+  // The parent stops too, even once the flag is cleared
+  cancel = false;
+  CPPUNIT_ASSERT_EQUAL(libvisio::VISIO_PARSE_CANCELLED, parent.getStatus());
+
+  // So does a worker that is past the deadline
+  options.cancel = nullptr;
+  options.deadline = std::chrono::steady_clock::now();
+  VSDParseControl late(options);
+  VSDParseControl lateControl(&late);
+  thrown = false;
+  try
+  {
+    lateControl.check();
+  }
+  catch (const libvisio::ParseInterruptedException &)
+  {
+    thrown = true;
+  }
+  CPPUNIT_ASSERT(thrown);
+  CPPUNIT_ASSERT_EQUAL(libvisio::VISIO_PARSE_TIMED_OUT, late.getStatus());
+}
+
+void VSDParseControlTest::testWorkerWithoutParent()
+{
+  VSDParseControl control(nullptr);
+  control.addDecompressedBytes(1UL << 30);
+  control.addPathPoints(1UL << 30);
+  control.check();
+  CPPUNIT_ASSERT_EQUAL(libvisio::VISIO_PARSE_OK, control.getStatus());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDParseControlTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
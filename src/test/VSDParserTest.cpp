@@ -0,0 +1,135 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "VSDCursor.h"
+#include "VSDParser.h"
+
+namespace test
+{
+
+namespace
+{
+
+using libvisio::VSDCursor;
+
+// Runs single chunk readers and exposes what they stored
+class ReadingParser : public libvisio::VSDParser
+{
+public:
+  ReadingParser()
+    : VSDParser(nullptr, nullptr)
+  {
+    m_header.id = 3;
+  }
+
+  void name2(const unsigned char *data, unsigned long size)
+  {
+    VSDCursor cursor(data, size);
+    readName2(&cursor);
+  }
+
+  void tabsData(const unsigned char *data, unsigned long size)
+  {
+    VSDCursor cursor(data, size);
+    readTabsData(&cursor);
+  }
+
+  bool hasName() const
+  {
+    return m_names.find(m_header.id) != m_names.end();
+  }
+
+  bool hasTabSet() const
+  {
+    return m_shape.m_tabSets.find(m_header.id) != m_shape.m_tabSets.end();
+  }
+
+  const libvisio::VSDTabSet &getTabSet()
+  {
+    return m_shape.m_tabSets[m_header.id];
+  }
+};
+
+}
+
+class VSDParserTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDParserTest);
+  CPPUNIT_TEST(testTruncatedName);
+  CPPUNIT_TEST(testTruncatedTabs);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testTruncatedName();
+  void testTruncatedTabs();
+};
+
+void VSDParserTest::setUp()
+{
+}
+
+void VSDParserTest::tearDown()
+{
+}
+
+void VSDParserTest::testTruncatedName()
+{
+  const unsigned char name[] = { 0x01, 0x00, 0x00, 0x00, 'A', 0x00, 0x00, 0x00 };
+
+  ReadingParser truncated;
+  // the name ends before its terminating zero
+  truncated.name2(name, sizeof(name) - 2);
+  CPPUNIT_ASSERT(!truncated.hasName());
+  truncated.name2(name, 4);
+  CPPUNIT_ASSERT(!truncated.hasName());
+
+  ReadingParser complete;
+  complete.name2(name, sizeof(name));
+  CPPUNIT_ASSERT(complete.hasName());
+}
+
+void VSDParserTest::testTruncatedTabs()
+{
+  const unsigned char tabs[] =
+  {
+    0x07, 0x00, 0x00, 0x00, 0x02,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x3f, 0x01, 0x02,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x03, 0x04
+  };
+
+  ReadingParser parser;
+  parser.tabsData(tabs, 3);
+  CPPUNIT_ASSERT(!parser.hasTabSet());
+
+  // the second tab stop is cut off
+  parser.tabsData(tabs, sizeof(tabs) - 1);
+  CPPUNIT_ASSERT(parser.hasTabSet());
+  CPPUNIT_ASSERT_EQUAL(7u, parser.getTabSet().m_numChars);
+  CPPUNIT_ASSERT_EQUAL(std::size_t(1), parser.getTabSet().m_tabStops.size());
+  CPPUNIT_ASSERT_EQUAL(1.0, parser.getTabSet().m_tabStops.find(0)->second.m_position);
+
+  parser.tabsData(tabs, sizeof(tabs));
+  CPPUNIT_ASSERT_EQUAL(std::size_t(2), parser.getTabSet().m_tabStops.size());
+  CPPUNIT_ASSERT_EQUAL(2.0, parser.getTabSet().m_tabStops.find(1)->second.m_position);
+  CPPUNIT_ASSERT(4 == parser.getTabSet().m_tabStops.find(1)->second.m_leader);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDParserTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
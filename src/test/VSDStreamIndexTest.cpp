@@ -0,0 +1,312 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include "VSDDocumentStructure.h"
+#include "VSDParseControl.h"
+#include "VSDParser.h"
+#include "VSDStreamIndex.h"
+#include "VSDTypes.h"
+
+namespace test
+{
+
+namespace
+{
+
+using libvisio::Pointer;
+using libvisio::VSDStreamIndex;
+
+const unsigned STREAM_FORMAT = 0x50; // uncompressed, with a pointer list
+const unsigned POINTER_SIZE = 18;
+const unsigned LIST_START = 16;
+
+void putU16(std::vector<unsigned char> &data, unsigned long offset, unsigned value)
+{
+  data[offset] = (unsigned char)(value & 0xff);
+  data[offset + 1] = (unsigned char)((value >> 8) & 0xff);
+}
+
+void putU32(std::vector<unsigned char> &data, unsigned long offset, unsigned value)
+{
+  putU16(data, offset, value & 0xffff);
+  putU16(data, offset + 2, value >> 16);
+}
+
+void putPointer(std::vector<unsigned char> &data, unsigned long offset, unsigned type, unsigned streamOffset, unsigned length)
+{
+  putU32(data, offset, type);
+  putU32(data, offset + 8, streamOffset);
+  putU32(data, offset + 12, length);
+  putU16(data, offset + 16, STREAM_FORMAT);
+}
+
+/* The VisioDocument stream of a version 11 document whose streams hold
+ * nothing but pointer lists: children[i] lists the streams that stream
+ * i points to, and stream 0 is the trailer.
+ */
+std::vector<unsigned char> makeDocument(const std::vector<std::vector<unsigned> > &children)
+{
+  std::vector<unsigned long> offsets;
+  unsigned long size = 0x40;
+  for (const auto &list : children)
+  {
+    offsets.push_back(size);
+    size += LIST_START + POINTER_SIZE * list.size();
+  }
+  std::vector<unsigned char> data(size, 0);
+  const auto length = [&children](unsigned stream)
+  {
+    return LIST_START + POINTER_SIZE * (unsigned)children[stream].size();
+  };
+
+  putPointer(data, 0x24, VSD_TRAILER_STREAM, offsets[0], length(0));
+  for (unsigned stream = 0; stream < children.size(); ++stream)
+  {
+    const unsigned long offset = offsets[stream];
+    putU32(data, offset, 8);
+    putU32(data, offset + 8, (unsigned)children[stream].size());
+    for (unsigned i = 0; i < children[stream].size(); ++i)
+    {
+      const unsigned child = children[stream][i];
+      putPointer(data, offset + LIST_START + POINTER_SIZE * i, VSD_PAGES, offsets[child], length(child));
+    }
+  }
+  return data;
+}
+
+class IndexingParser : public libvisio::VSDParser
+{
+public:
+  explicit IndexingParser(librevenge::RVNGInputStream *input)
+    : VSDParser(input, nullptr)
+  {
+  }
+
+  bool index()
+  {
+    return buildStreamIndex();
+  }
+
+  const VSDStreamIndex &getIndex() const
+  {
+    return m_streamIndex;
+  }
+};
+
+// Builds the index of the document, with the given limit on the stream depth
+bool buildIndex(const std::vector<unsigned char> &document, unsigned maxStreamDepth, VSDStreamIndex &index)
+{
+  librevenge::RVNGStringStream input(document.data(), (unsigned)document.size());
+  libvisio::VisioParseOptions options;
+  options.limits.maxStreamDepth = maxStreamDepth;
+  libvisio::VSDParseControl control(options);
+  IndexingParser parser(&input);
+  parser.setParseControl(&control);
+  const bool indexed = parser.index();
+  index = VSDStreamIndex();
+  if (indexed)
+  {
+    // Copy the entries, as the parser is gone after this
+    const VSDStreamIndex &built = parser.getIndex();
+    for (unsigned entry = 0; entry < built.size(); ++entry)
+      index.addEntry(built.getEntry(entry).pointer);
+    for (unsigned entry = 0; entry < built.size(); ++entry)
+    {
+      for (const auto &child : built.getEntry(entry).children)
+        index.addChild(entry, child.id, child.entry);
+      index.setComplete(entry, built.getEntry(entry).height);
+    }
+  }
+  return indexed;
+}
+
+}
+
+class VSDStreamIndexTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDStreamIndexTest);
+  CPPUNIT_TEST(testEntries);
+  CPPUNIT_TEST(testTree);
+  CPPUNIT_TEST(testSharedStreams);
+  CPPUNIT_TEST(testSharedDepth);
+  CPPUNIT_TEST(testCycle);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testEntries();
+  void testTree();
+  void testSharedStreams();
+  void testSharedDepth();
+  void testCycle();
+};
+
+void VSDStreamIndexTest::setUp()
+{
+}
+
+void VSDStreamIndexTest::tearDown()
+{
+}
+
+void VSDStreamIndexTest::testEntries()
+{
+  VSDStreamIndex index;
+  CPPUNIT_ASSERT(index.empty());
+
+  Pointer trailer;
+  trailer.Type = VSD_TRAILER_STREAM;
+  Pointer page;
+  page.Type = VSD_PAGE;
+  page.Offset = 100;
+  page.Length = 20;
+  page.Format = 0x54;
+
+  CPPUNIT_ASSERT_EQUAL(0u, index.addEntry(trailer));
+  CPPUNIT_ASSERT_EQUAL(1u, index.addEntry(page));
+  // Only a complete entry can be shared
+  CPPUNIT_ASSERT_EQUAL(MINUS_ONE, index.findEntry(page));
+  index.setComplete(1, 1);
+  CPPUNIT_ASSERT_EQUAL(1u, index.findEntry(page));
+  Pointer other(page);
+  other.Format = 0x56;
+  CPPUNIT_ASSERT_EQUAL(MINUS_ONE, index.findEntry(other));
+
+  index.addChild(0, 7, 1);
+  CPPUNIT_ASSERT_EQUAL(2u, index.size());
+  CPPUNIT_ASSERT_EQUAL(std::size_t(1), index.getEntry(0).children.size());
+  CPPUNIT_ASSERT_EQUAL(7u, index.getEntry(0).children[0].id);
+  CPPUNIT_ASSERT_EQUAL(1u, index.getEntry(0).children[0].entry);
+  CPPUNIT_ASSERT_EQUAL(1u, index.getEntry(1).height);
+  CPPUNIT_ASSERT_EQUAL(1u, index.getPageCount());
+  CPPUNIT_ASSERT(index.isTree());
+
+  index.addChild(0, 8, 1);
+  CPPUNIT_ASSERT(!index.isTree());
+
+  index.clear();
+  CPPUNIT_ASSERT(index.empty());
+  CPPUNIT_ASSERT(index.isTree());
+  CPPUNIT_ASSERT_EQUAL(MINUS_ONE, index.findEntry(page));
+}
+
+void VSDStreamIndexTest::testTree()
+{
+  // 0 -> 1 -> (2, 3), 0 -> 4
+  std::vector<std::vector<unsigned> > children(5);
+  children[0].push_back(1);
+  children[0].push_back(4);
+  children[1].push_back(2);
+  children[1].push_back(3);
+
+  VSDStreamIndex tree;
+  CPPUNIT_ASSERT(buildIndex(makeDocument(children), 0, tree));
+  CPPUNIT_ASSERT_EQUAL(5u, tree.size());
+  CPPUNIT_ASSERT(tree.isTree());
+  CPPUNIT_ASSERT_EQUAL(std::size_t(2), tree.getEntry(0).children.size());
+  CPPUNIT_ASSERT_EQUAL(0u, tree.getEntry(0).children[0].id);
+  CPPUNIT_ASSERT_EQUAL(1u, tree.getEntry(0).children[1].id);
+  CPPUNIT_ASSERT_EQUAL(3u, tree.getEntry(0).height);
+  CPPUNIT_ASSERT_EQUAL(2u, tree.getEntry(tree.getEntry(0).children[0].entry).height);
+  CPPUNIT_ASSERT_EQUAL(1u, tree.getEntry(tree.getEntry(0).children[1].entry).height);
+
+  CPPUNIT_ASSERT(buildIndex(makeDocument(children), 2, tree));
+  CPPUNIT_ASSERT(!buildIndex(makeDocument(children), 1, tree));
+}
+
+void VSDStreamIndexTest::testSharedStreams()
+{
+  // Every stream points twice to the next one, so there are 2^32 paths to the last one
+  const unsigned depth = 32;
+  std::vector<std::vector<unsigned> > children(depth + 1);
+  for (unsigned stream = 0; stream < depth; ++stream)
+  {
+    children[stream].push_back(stream + 1);
+    children[stream].push_back(stream + 1);
+  }
+
+  VSDStreamIndex shared;
+  CPPUNIT_ASSERT(buildIndex(makeDocument(children), 0, shared));
+  CPPUNIT_ASSERT_EQUAL(depth + 1, shared.size());
+  CPPUNIT_ASSERT(!shared.isTree());
+  CPPUNIT_ASSERT_EQUAL(depth + 1, shared.getEntry(0).height);
+  for (unsigned entry = 0; entry < depth; ++entry)
+  {
+    const auto &entryChildren = shared.getEntry(entry).children;
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), entryChildren.size());
+    CPPUNIT_ASSERT_EQUAL(entryChildren[0].entry, entryChildren[1].entry);
+    CPPUNIT_ASSERT_EQUAL(0u, entryChildren[0].id);
+    CPPUNIT_ASSERT_EQUAL(1u, entryChildren[1].id);
+  }
+
+  CPPUNIT_ASSERT(buildIndex(makeDocument(children), depth, shared));
+  CPPUNIT_ASSERT(!buildIndex(makeDocument(children), depth - 1, shared));
+}
+
+void VSDStreamIndexTest::testSharedDepth()
+{
+  // 3 -> 4 is indexed below 1 first, and then shared two levels deeper below 2
+  std::vector<std::vector<unsigned> > children(6);
+  children[0].push_back(1);
+  children[0].push_back(2);
+  children[1].push_back(3);
+  children[2].push_back(5);
+  children[5].push_back(3);
+  children[3].push_back(4);
+
+  VSDStreamIndex shared;
+  CPPUNIT_ASSERT(buildIndex(makeDocument(children), 0, shared));
+  CPPUNIT_ASSERT_EQUAL(6u, shared.size());
+  CPPUNIT_ASSERT(!shared.isTree());
+  CPPUNIT_ASSERT_EQUAL(5u, shared.getEntry(0).height);
+
+  // The shared streams count at the depth of every path to them
+  CPPUNIT_ASSERT(buildIndex(makeDocument(children), 4, shared));
+  CPPUNIT_ASSERT(!buildIndex(makeDocument(children), 3, shared));
+}
+
+void VSDStreamIndexTest::testCycle()
+{
+  // 1 -> 2 -> 1, and 1 -> 1
+  std::vector<std::vector<unsigned> > children(3);
+  children[0].push_back(1);
+  children[1].push_back(2);
+  children[1].push_back(1);
+  children[2].push_back(1);
+
+  VSDStreamIndex cycle;
+  CPPUNIT_ASSERT(buildIndex(makeDocument(children), 0, cycle));
+  // The streams that point back get entries without children, so the walk ends there
+  CPPUNIT_ASSERT_EQUAL(5u, cycle.size());
+  CPPUNIT_ASSERT(cycle.isTree());
+  const unsigned first = cycle.getEntry(0).children[0].entry;
+  CPPUNIT_ASSERT_EQUAL(std::size_t(2), cycle.getEntry(first).children.size());
+  const unsigned second = cycle.getEntry(first).children[0].entry;
+  const unsigned back = cycle.getEntry(first).children[1].entry;
+  CPPUNIT_ASSERT(cycle.getEntry(back).children.empty());
+  CPPUNIT_ASSERT_EQUAL(std::size_t(1), cycle.getEntry(second).children.size());
+  CPPUNIT_ASSERT(cycle.getEntry(cycle.getEntry(second).children[0].entry).children.empty());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDStreamIndexTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,135 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "VSDWorkerPool.h"
+
+namespace test
+{
+
+using libvisio::VSDWorkerPool;
+
+class VSDWorkerPoolTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDWorkerPoolTest);
+  CPPUNIT_TEST(testRun);
+  CPPUNIT_TEST(testReuse);
+  CPPUNIT_TEST(testException);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testRun();
+  void testReuse();
+  void testException();
+};
+
+void VSDWorkerPoolTest::setUp()
+{
+}
+
+void VSDWorkerPoolTest::tearDown()
+{
+}
+
+void VSDWorkerPoolTest::testRun()
+{
+  for (unsigned threads = 0; threads < 5; ++threads)
+  {
+    std::vector<unsigned> runs(100, 0);
+    VSDWorkerPool pool(threads);
+    pool.run(runs.size(), [&runs](std::size_t i)
+    {
+      ++runs[i];
+    });
+    for (unsigned run : runs)
+      CPPUNIT_ASSERT_EQUAL(1u, run);
+  }
+
+  VSDWorkerPool pool(4);
+  pool.run(0, [](std::size_t)
+  {
+    CPPUNIT_FAIL("no job to run");
+  });
+}
+
+void VSDWorkerPoolTest::testReuse()
+{
+  VSDWorkerPool pool(4);
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  const auto record = [&mutex, &threads](std::size_t)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.insert(std::this_thread::get_id());
+  };
+
+  // Batches of every size, one after the other, run on the same threads
+  for (unsigned batch = 0; batch < 200; ++batch)
+  {
+    std::atomic<unsigned> done(0);
+    pool.run(batch % 7, [&done, &record](std::size_t i)
+    {
+      record(i);
+      ++done;
+    });
+    CPPUNIT_ASSERT_EQUAL(batch % 7, done.load());
+  }
+  CPPUNIT_ASSERT(threads.size() <= 4);
+  CPPUNIT_ASSERT(threads.count(std::this_thread::get_id()));
+}
+
+void VSDWorkerPoolTest::testException()
+{
+  VSDWorkerPool pool(3);
+  std::atomic<unsigned> done(0);
+  bool thrown = false;
+  try
+  {
+    pool.run(50, [&done](std::size_t i)
+    {
+      if (i == 10)
+        throw std::runtime_error("job failed");
+      ++done;
+    });
+  }
+  catch (const std::runtime_error &)
+  {
+    thrown = true;
+  }
+  CPPUNIT_ASSERT(thrown);
+  CPPUNIT_ASSERT(done < 50);
+
+  // The error does not outlive its batch
+  done = 0;
+  pool.run(50, [&done](std::size_t)
+  {
+    ++done;
+  });
+  CPPUNIT_ASSERT_EQUAL(50u, done.load());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDWorkerPoolTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,247 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include "libvisio_utils.h"
+#include "libvisio_xml.h"
+#include "VSDParseControl.h"
+#include "VSDXMLReader.h"
+#include "VSDXMLTokenMap.h"
+
+namespace test
+{
+
+using libvisio::VSDXMLReader;
+using libvisio::VSDXMLTape;
+
+namespace
+{
+
+const char DOCUMENT[] =
+  "<?xml version='1.0' encoding='utf-8'?>\n"
+  "<PageContents xmlns:r='http://schemas.openxmlformats.org/officeDocument/2006/relationships'>"
+  "<Shapes><Shape ID='1' Type='Shape' LineStyle='3'>"
+  "<Cell N='PinX' V='1.5'/><Cell N='PinY' V='2' U='IN'/>"
+  "<Text>Hello &amp; <cp IX='0'/>world</Text>"
+  "</Shape></Shapes>"
+  "<Rel r:id='rId1'/>"
+  "</PageContents>";
+
+std::string asString(const xmlChar *str)
+{
+  return str ? std::string((const char *)str) : std::string("(null)");
+}
+
+std::string getAttribute(VSDXMLReader &reader, const char *name)
+{
+  const std::unique_ptr<xmlChar, void (*)(void *)> value(reader.getAttribute(BAD_CAST(name)), xmlFree);
+  return asString(value.get());
+}
+
+void readToEnd(VSDXMLReader &reader)
+{
+  while (1 == reader.read())
+    ;
+}
+
+// Reads the whole of input with libxml2 alone and with reader, checking that both see the same
+void assertSameAsLibxml(const char *xml, VSDXMLReader &reader)
+{
+  librevenge::RVNGStringStream input(reinterpret_cast<const unsigned char *>(xml), (unsigned)std::strlen(xml));
+  const auto expected = libvisio::xmlReaderForStream(&input);
+  CPPUNIT_ASSERT(bool(expected));
+
+  int ret = xmlTextReaderRead(expected.get());
+  CPPUNIT_ASSERT_EQUAL(1, ret);
+  while (1 == ret)
+  {
+    CPPUNIT_ASSERT_EQUAL(ret, reader.read());
+    CPPUNIT_ASSERT_EQUAL(xmlTextReaderNodeType(expected.get()), reader.getNodeType());
+    CPPUNIT_ASSERT_EQUAL(xmlTextReaderDepth(expected.get()), reader.getDepth());
+    CPPUNIT_ASSERT_EQUAL(1 == xmlTextReaderIsEmptyElement(expected.get()), reader.isEmptyElement());
+    CPPUNIT_ASSERT_EQUAL(asString(xmlTextReaderConstName(expected.get())), asString(reader.getName()));
+    CPPUNIT_ASSERT_EQUAL(libvisio::VSDXMLTokenMap::getTokenId(xmlTextReaderConstName(expected.get())), reader.getToken());
+    CPPUNIT_ASSERT_EQUAL(asString(xmlTextReaderConstValue(expected.get())), asString(reader.getValue()));
+
+    while (1 == xmlTextReaderMoveToNextAttribute(expected.get()))
+    {
+      CPPUNIT_ASSERT(reader.moveToNextAttribute());
+      CPPUNIT_ASSERT_EQUAL(asString(xmlTextReaderConstName(expected.get())), asString(reader.getName()));
+      CPPUNIT_ASSERT_EQUAL(asString(xmlTextReaderConstValue(expected.get())), asString(reader.getValue()));
+    }
+    CPPUNIT_ASSERT(!reader.moveToNextAttribute());
+
+    ret = xmlTextReaderRead(expected.get());
+  }
+  CPPUNIT_ASSERT_EQUAL(0, reader.read());
+  CPPUNIT_ASSERT_EQUAL(-1, reader.getNodeType());
+  CPPUNIT_ASSERT(!reader.getName());
+}
+
+}
+
+class VSDXMLReaderTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDXMLReaderTest);
+  CPPUNIT_TEST(testRecord);
+  CPPUNIT_TEST(testReplay);
+  CPPUNIT_TEST(testAttributes);
+  CPPUNIT_TEST(testIncomplete);
+  CPPUNIT_TEST(testLimit);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testRecord();
+  void testReplay();
+  void testAttributes();
+  void testIncomplete();
+  void testLimit();
+};
+
+void VSDXMLReaderTest::setUp()
+{
+}
+
+void VSDXMLReaderTest::tearDown()
+{
+}
+
+void VSDXMLReaderTest::testRecord()
+{
+  librevenge::RVNGStringStream input(reinterpret_cast<const unsigned char *>(DOCUMENT), (unsigned)std::strlen(DOCUMENT));
+  const auto xmlReader = libvisio::xmlReaderForStream(&input);
+  CPPUNIT_ASSERT(bool(xmlReader));
+
+  VSDXMLTape tape;
+  VSDXMLReader reader(xmlReader.get(), tape);
+  assertSameAsLibxml(DOCUMENT, reader);
+  CPPUNIT_ASSERT(tape.isComplete());
+}
+
+void VSDXMLReaderTest::testReplay()
+{
+  librevenge::RVNGStringStream input(reinterpret_cast<const unsigned char *>(DOCUMENT), (unsigned)std::strlen(DOCUMENT));
+  const auto xmlReader = libvisio::xmlReaderForStream(&input);
+  VSDXMLTape tape;
+  {
+    VSDXMLReader recorder(xmlReader.get(), tape);
+    while (1 == recorder.read())
+      ;
+  }
+  CPPUNIT_ASSERT(tape.isComplete());
+
+  // A tape can be replayed as often as needed
+  VSDXMLReader reader(tape);
+  assertSameAsLibxml(DOCUMENT, reader);
+  VSDXMLReader again(tape);
+  assertSameAsLibxml(DOCUMENT, again);
+}
+
+void VSDXMLReaderTest::testAttributes()
+{
+  librevenge::RVNGStringStream input(reinterpret_cast<const unsigned char *>(DOCUMENT), (unsigned)std::strlen(DOCUMENT));
+  const auto xmlReader = libvisio::xmlReaderForStream(&input);
+  VSDXMLTape tape;
+  VSDXMLReader reader(xmlReader.get(), tape);
+
+  while (1 == reader.read() && XML_SHAPE != reader.getToken())
+    ;
+  CPPUNIT_ASSERT_EQUAL(std::string("1"), getAttribute(reader, "ID"));
+  CPPUNIT_ASSERT_EQUAL(std::string("3"), getAttribute(reader, "LineStyle"));
+  CPPUNIT_ASSERT_EQUAL(std::string("(null)"), getAttribute(reader, "FillStyle"));
+  // The values can be read in place too, as they are stored once for every read
+  CPPUNIT_ASSERT_EQUAL(std::string("3"), asString(reader.getConstAttribute(BAD_CAST("LineStyle"))));
+  CPPUNIT_ASSERT(!reader.getConstAttribute(BAD_CAST("FillStyle")));
+  CPPUNIT_ASSERT(reader.getConstAttribute(BAD_CAST("ID")) == reader.getConstAttribute(BAD_CAST("ID")));
+
+  // Attribute lookup does not depend on having moved over the attributes
+  CPPUNIT_ASSERT(reader.moveToNextAttribute());
+  CPPUNIT_ASSERT_EQUAL(XML_READER_TYPE_ATTRIBUTE, reader.getNodeType());
+  CPPUNIT_ASSERT_EQUAL(std::string("Shape"), getAttribute(reader, "Type"));
+
+  while (1 == reader.read() && XML_REL != reader.getToken())
+    ;
+  CPPUNIT_ASSERT_EQUAL(XML_READER_TYPE_ELEMENT, reader.getNodeType());
+  CPPUNIT_ASSERT_EQUAL(std::string("rId1"), getAttribute(reader, "r:id"));
+  CPPUNIT_ASSERT_EQUAL(std::string("rId1"), asString(reader.getConstAttribute(BAD_CAST("r:id"))));
+}
+
+void VSDXMLReaderTest::testIncomplete()
+{
+  const char broken[] = "<PageContents><Shapes><Shape ID='1'></Shapes></PageContents>";
+  librevenge::RVNGStringStream input(reinterpret_cast<const unsigned char *>(broken), (unsigned)std::strlen(broken));
+  libvisio::XMLErrorWatcher watcher;
+  const auto xmlReader = libvisio::xmlReaderForStream(&input, &watcher, false);
+  CPPUNIT_ASSERT(bool(xmlReader));
+
+  VSDXMLTape tape;
+  VSDXMLReader reader(xmlReader.get(), tape);
+  int ret = reader.read();
+  while (1 == ret)
+    ret = reader.read();
+  CPPUNIT_ASSERT(0 != ret || watcher.isError());
+  if (0 != ret)
+    CPPUNIT_ASSERT(!tape.isComplete());
+
+  // Recording into a tape starts it anew
+  librevenge::RVNGStringStream goodInput(reinterpret_cast<const unsigned char *>(DOCUMENT), (unsigned)std::strlen(DOCUMENT));
+  const auto goodReader = libvisio::xmlReaderForStream(&goodInput);
+  VSDXMLReader recorder(goodReader.get(), tape);
+  CPPUNIT_ASSERT(!tape.isComplete());
+  assertSameAsLibxml(DOCUMENT, recorder);
+  CPPUNIT_ASSERT(tape.isComplete());
+}
+
+void VSDXMLReaderTest::testLimit()
+{
+  librevenge::RVNGStringStream input(reinterpret_cast<const unsigned char *>(DOCUMENT), (unsigned)std::strlen(DOCUMENT));
+  const auto xmlReader = libvisio::xmlReaderForStream(&input);
+  VSDXMLTape tape;
+  libvisio::VSDParseControl control;
+  {
+    VSDXMLReader recorder(xmlReader.get(), tape, &control);
+    readToEnd(recorder);
+  }
+  CPPUNIT_ASSERT(tape.isComplete());
+  const unsigned long size = tape.getSize();
+  CPPUNIT_ASSERT(size > std::strlen("PageContentsShapesShapeCellTextcpRel"));
+
+  // The tape counts as decompressed data of the parse
+  libvisio::VisioParseOptions options;
+  options.limits.maxDecompressedBytes = size - 1;
+  libvisio::VSDParseControl limited(options);
+  librevenge::RVNGStringStream limitedInput(reinterpret_cast<const unsigned char *>(DOCUMENT), (unsigned)std::strlen(DOCUMENT));
+  const auto limitedReader = libvisio::xmlReaderForStream(&limitedInput);
+  VSDXMLReader recorder(limitedReader.get(), tape, &limited);
+  CPPUNIT_ASSERT_THROW(readToEnd(recorder), libvisio::ParseInterruptedException);
+  CPPUNIT_ASSERT_EQUAL(libvisio::VISIO_PARSE_LIMIT_EXCEEDED, limited.getStatus());
+  CPPUNIT_ASSERT(!tape.isComplete());
+
+  tape.clear();
+  CPPUNIT_ASSERT_EQUAL(0ul, tape.getSize());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDXMLReaderTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
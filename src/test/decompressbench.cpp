@@ -0,0 +1,188 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/* Measures the throughput of the LZ decoder used for compressed pointer
+ * streams, against the original byte-at-a-time decoder. Without arguments
+ * only synthetic streams are measured; every argument is taken as a
+ * Visio 2000/2003 binary document whose compressed streams are measured.
+ */
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdio.h>
+#include <vector>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include "VSDInternalStream.h"
+#include "lzreference.h"
+
+namespace
+{
+
+typedef std::vector<std::vector<unsigned char> > Streams_t;
+
+unsigned readU16(const std::vector<unsigned char> &buf, unsigned long pos)
+{
+  return pos + 2 <= buf.size() ? buf[pos] | (buf[pos+1] << 8) : 0;
+}
+
+unsigned readU32(const std::vector<unsigned char> &buf, unsigned long pos)
+{
+  return pos + 4 <= buf.size() ? readU16(buf, pos) | (readU16(buf, pos+2) << 16) : 0;
+}
+
+std::vector<unsigned char> readAll(librevenge::RVNGInputStream *input)
+{
+  std::vector<unsigned char> data;
+  input->seek(0, librevenge::RVNG_SEEK_SET);
+  while (!input->isEnd())
+  {
+    unsigned long numBytesRead = 0;
+    const unsigned char *buf = input->read(65536, numBytesRead);
+    if (!numBytesRead)
+      break;
+    data.insert(data.end(), buf, buf + numBytesRead);
+  }
+  return data;
+}
+
+// Walks the pointer tree of a version 6/11 document, collecting the raw bytes of compressed streams
+void collectStreams(const std::vector<unsigned char> &doc, const std::vector<unsigned char> &stream, unsigned shift,
+                    std::set<unsigned> &visited, Streams_t &streams)
+{
+  const unsigned offset = readU32(stream, shift);
+  const unsigned long infoPos = (unsigned long)offset + shift - 4;
+  const int pointerCount = (int)readU32(stream, infoPos + 4);
+  for (int i = 0; i < pointerCount && infoPos + 12 + 18 * (i + 1) <= stream.size(); ++i)
+  {
+    const unsigned long ptrPos = infoPos + 12 + 18 * i;
+    const unsigned ptrOffset = readU32(stream, ptrPos + 8);
+    const unsigned ptrLength = readU32(stream, ptrPos + 12);
+    const unsigned ptrFormat = readU16(stream, ptrPos + 16);
+    if (!readU32(stream, ptrPos) || ptrOffset >= doc.size() || !visited.insert(ptrOffset).second)
+      continue;
+    std::vector<unsigned char> raw(doc.begin() + ptrOffset, doc.begin() + std::min<unsigned long>(doc.size(), (unsigned long)ptrOffset + ptrLength));
+    const bool compressed = (ptrFormat & 2) == 2;
+    if ((ptrFormat >> 4) == 0x5)
+    {
+      std::vector<unsigned char> child;
+      if (compressed)
+        VSDInternalStream::decompress(raw.data(), raw.size(), child);
+      else
+        child = raw;
+      collectStreams(doc, child, compressed ? 4 : 0, visited, streams);
+    }
+    if (compressed)
+      streams.push_back(raw);
+  }
+}
+
+bool collectDocumentStreams(const char *path, Streams_t &streams)
+{
+  librevenge::RVNGFileStream input(path);
+  std::unique_ptr<librevenge::RVNGInputStream> docStream;
+  if (input.isStructured())
+    docStream.reset(input.getSubStreamByName("VisioDocument"));
+  const std::vector<unsigned char> doc = readAll(docStream ? docStream.get() : &input);
+  if (doc.size() < 0x36)
+    return false;
+
+  const unsigned trailerOffset = readU32(doc, 0x2c);
+  const unsigned trailerLength = readU32(doc, 0x30);
+  const bool compressed = (readU16(doc, 0x34) & 2) == 2;
+  if (trailerOffset >= doc.size())
+    return false;
+  const std::vector<unsigned char> raw(doc.begin() + trailerOffset, doc.begin() + std::min<unsigned long>(doc.size(), (unsigned long)trailerOffset + trailerLength));
+  std::vector<unsigned char> trailer;
+  if (compressed)
+  {
+    VSDInternalStream::decompress(raw.data(), raw.size(), trailer);
+    streams.push_back(raw);
+  }
+  else
+    trailer = raw;
+
+  std::set<unsigned> visited;
+  collectStreams(doc, trailer, compressed ? 4 : 0, visited, streams);
+  return true;
+}
+
+Streams_t makeSyntheticStreams()
+{
+  Streams_t streams;
+  std::mt19937 gen(11);
+  for (unsigned i = 0; i < 64; ++i)
+  {
+    std::vector<unsigned char> stream(64 * 1024);
+    // alternate between literal-heavy and match-heavy control bytes
+    for (unsigned long j = 0; j < stream.size(); ++j)
+      stream[j] = static_cast<unsigned char>((j % 17) ? gen() : (i % 2 ? 0x00 : 0xaa));
+    streams.push_back(stream);
+  }
+  return streams;
+}
+
+template<typename Decoder>
+double measure(const Streams_t &streams, Decoder decoder, unsigned long &outputSize)
+{
+  std::vector<unsigned char> output;
+  unsigned rounds = 0;
+  outputSize = 0;
+  const auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed(0);
+  do
+  {
+    for (const auto &stream : streams)
+    {
+      decoder(stream.data(), stream.size(), output);
+      outputSize += output.size();
+    }
+    ++rounds;
+    elapsed = std::chrono::steady_clock::now() - start;
+  }
+  while (elapsed.count() < 1.0 || rounds < 3);
+  return outputSize / elapsed.count() / (1024.0 * 1024.0);
+}
+
+void report(const char *name, const Streams_t &streams)
+{
+  unsigned long inputSize = 0;
+  for (const auto &stream : streams)
+    inputSize += stream.size();
+
+  unsigned long outputSize = 0;
+  const double reference = measure(streams, test::lzDecompressReference, outputSize);
+  const double current = measure(streams, VSDInternalStream::decompress, outputSize);
+  printf("%-40s %6lu streams %10lu bytes   reference %8.1f MB/s   current %8.1f MB/s   x%.2f\n",
+         name, (unsigned long)streams.size(), inputSize, reference, current, reference > 0 ? current / reference : 0.0);
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+  report("synthetic", makeSyntheticStreams());
+
+  for (int i = 1; i < argc; ++i)
+  {
+    Streams_t streams;
+    if (!collectDocumentStreams(argv[i], streams) || streams.empty())
+    {
+      printf("%-40s no compressed streams found\n", argv[i]);
+      continue;
+    }
+    report(argv[i], streams);
+  }
+  return 0;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
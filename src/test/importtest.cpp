@@ -7,8 +7,13 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <cppunit/extensions/HelperMacros.h>
 
@@ -169,8 +174,9 @@ void assertXPathContent(xmlDocPtr doc, const librevenge::RVNGString &xpath, cons
   CPPUNIT_ASSERT_EQUAL_MESSAGE(message.cstr(), content, getXPathContent(doc, xpath));
 }
 
-/// Paints an XML representation of filename into buffer, then returns the parsed buffer content.
-xmlDocPtr parse(const char *filename, xmlBufferPtr buffer)
+/// Paints an XML representation of filename into buffer, and stores the statistics of the parse in stats if given.
+void paint(const char *filename, xmlBufferPtr buffer, const libvisio::VisioParseOptions &options,
+           libvisio::VisioParseStats *stats = nullptr)
 {
   librevenge::RVNGString path(TDOC "/");
   path.append(filename);
@@ -182,15 +188,100 @@ xmlDocPtr parse(const char *filename, xmlBufferPtr buffer)
   xmlTextWriterStartDocument(writer, 0, 0, 0);
   libvisio::XmlDrawingGenerator painter(writer);
 
-  CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, &painter));
+  if (stats)
+  {
+    libvisio::VisioParseStatus status = libvisio::VISIO_PARSE_ERROR;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, &painter, options, status, *stats));
+  }
+  else
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, &painter, options));
 
   xmlTextWriterEndDocument(writer);
   xmlFreeTextWriter(writer);
+}
 
+/// Paints an XML representation of filename into buffer, then returns the parsed buffer content.
+xmlDocPtr parse(const char *filename, xmlBufferPtr buffer, const libvisio::VisioParseOptions &options = libvisio::VisioParseOptions())
+{
+  paint(filename, buffer, options);
   //std::cerr << "XML is '" << (const char *)xmlBufferContent(buffer) << "'" << std::endl;
   return xmlParseMemory((const char *)xmlBufferContent(buffer), xmlBufferLength(buffer));
 }
 
+/// Paints an XML representation of filename and returns it unparsed, for comparing whole outputs.
+std::string parseToString(const char *filename, const libvisio::VisioParseOptions &options = libvisio::VisioParseOptions(),
+                          libvisio::VisioParseStats *stats = nullptr)
+{
+  std::unique_ptr<xmlBuffer, void(*)(xmlBufferPtr)> buffer{xmlBufferCreate(), xmlBufferFree};
+  paint(filename, buffer.get(), options, stats);
+  return std::string((const char *)xmlBufferContent(buffer.get()), xmlBufferLength(buffer.get()));
+}
+
+/// Parses the XML that parseToString() returned.
+std::unique_ptr<xmlDoc, void(*)(xmlDocPtr)> readXml(const std::string &xml)
+{
+  return std::unique_ptr<xmlDoc, void(*)(xmlDocPtr)>(xmlParseMemory(xml.data(), int(xml.size())), xmlFreeDoc);
+}
+
+/// Serializes the single node that xpath selects in doc.
+std::string dumpXPathNode(xmlDocPtr doc, const librevenge::RVNGString &xpath)
+{
+  getXPath(doc, xpath, "");
+  std::unique_ptr<xmlXPathObject, void(*)(xmlXPathObjectPtr)> xpathobject{getXPathNode(doc, xpath), xmlXPathFreeObject};
+  std::unique_ptr<xmlBuffer, void(*)(xmlBufferPtr)> buffer{xmlBufferCreate(), xmlBufferFree};
+  xmlNodeDump(buffer.get(), doc, xpathobject->nodesetval->nodeTab[0], 0, 0);
+  return std::string((const char *)xmlBufferContent(buffer.get()), xmlBufferLength(buffer.get()));
+}
+
+/// Paints an XML representation of model and returns it as a string.
+std::string draw(const libvisio::VisioDocumentModel &model)
+{
+  std::unique_ptr<xmlBuffer, void(*)(xmlBufferPtr)> buffer{xmlBufferCreate(), xmlBufferFree};
+  xmlTextWriterPtr writer = xmlNewTextWriterMemory(buffer.get(), 0);
+  CPPUNIT_ASSERT(writer);
+  xmlTextWriterStartDocument(writer, 0, 0, 0);
+  libvisio::XmlDrawingGenerator painter(writer);
+
+  model.draw(&painter);
+
+  xmlTextWriterEndDocument(writer);
+  xmlFreeTextWriter(writer);
+  return std::string((const char *)xmlBufferContent(buffer.get()), xmlBufferLength(buffer.get()));
+}
+
+// The XML output of one document of a batch, set up on the thread that parses it
+class BatchOutput
+{
+public:
+  BatchOutput()
+    : m_buffer(xmlBufferCreate(), xmlBufferFree), m_writer(0)
+  {
+  }
+
+  // The parse destroys the painter before finish() is called
+  std::unique_ptr<librevenge::RVNGDrawingInterface> start()
+  {
+    m_writer = xmlNewTextWriterMemory(m_buffer.get(), 0);
+    xmlTextWriterStartDocument(m_writer, 0, 0, 0);
+    return std::unique_ptr<librevenge::RVNGDrawingInterface>(new libvisio::XmlDrawingGenerator(m_writer));
+  }
+
+  std::string finish()
+  {
+    xmlTextWriterEndDocument(m_writer);
+    xmlFreeTextWriter(m_writer);
+    m_writer = 0;
+    return std::string((const char *)xmlBufferContent(m_buffer.get()), xmlBufferLength(m_buffer.get()));
+  }
+
+private:
+  BatchOutput(const BatchOutput &);
+  BatchOutput &operator=(const BatchOutput &);
+
+  std::unique_ptr<xmlBuffer, void(*)(xmlBufferPtr)> m_buffer;
+  xmlTextWriterPtr m_writer;
+};
+
 }
 
 class ImportTest : public CPPUNIT_NS::TestFixture
@@ -219,6 +310,20 @@ class ImportTest : public CPPUNIT_NS::TestFixture
   CPPUNIT_TEST(testBmpFileHeader2);
   CPPUNIT_TEST(testVsdxImportDefaultFillColour);
   CPPUNIT_TEST(testVsdxQickStyleFillStyle);
+  CPPUNIT_TEST(testVsdSinglePass);
+  CPPUNIT_TEST(testDocumentModel);
+  CPPUNIT_TEST(testPageSelection);
+  CPPUNIT_TEST(testProgressive);
+  CPPUNIT_TEST(testModelCache);
+  CPPUNIT_TEST(testInterruption);
+  CPPUNIT_TEST(testLimits);
+  CPPUNIT_TEST(testStats);
+  CPPUNIT_TEST(testStreamCache);
+  CPPUNIT_TEST(testDecompressionThreads);
+  CPPUNIT_TEST(testBatch);
+  CPPUNIT_TEST(testTextOnly);
+  CPPUNIT_TEST(testMetaData);
+  CPPUNIT_TEST(testVsdxPageThreads);
   CPPUNIT_TEST_SUITE_END();
 
   void testVsdxMetadataTitle();
@@ -238,6 +343,20 @@ class ImportTest : public CPPUNIT_NS::TestFixture
   void testBmpFileHeader2();
   void testVsdxImportDefaultFillColour();
   void testVsdxQickStyleFillStyle();
+  void testVsdSinglePass();
+  void testDocumentModel();
+  void testPageSelection();
+  void testProgressive();
+  void testModelCache();
+  void testInterruption();
+  void testLimits();
+  void testStats();
+  void testStreamCache();
+  void testDecompressionThreads();
+  void testBatch();
+  void testTextOnly();
+  void testMetaData();
+  void testVsdxPageThreads();
 
   xmlBufferPtr m_buffer;
   xmlDocPtr m_doc;
@@ -545,6 +664,647 @@ void ImportTest::testVsdxQickStyleFillStyle()
   assertXPath(m_doc, "/document/page/layer[1]//setStyle[2]", "fill-color", "#ffffff");
 }
 
+void ImportTest::testVsdSinglePass()
+{
+  const char *const files[] =
+  {
+    "bitmaps.vsd",
+    "bitmaps2.vsd",
+    "dwg.vsd",
+    "fdo86729-ms1252.vsd",
+    "fdo86729-utf8.vsd",
+    "no-bgcolor.vsd",
+    "tdf76829-datetime-format.vsd",
+    "tdf76829-numeric-format.vsd",
+    "Visio11FormatLine.vsd",
+    "Visio11TextFieldsWithCurrency.vsd",
+    "Visio11TextFieldsWithUnits.vsd",
+    "Visio5TextFieldsWithUnits.vsd",
+    "Visio6TextFieldsWithUnits.vsd"
+  };
+  libvisio::VisioParseOptions singlePass;
+  singlePass.singlePass = true;
+
+  for (const char *file : files)
+  {
+    const std::string expected = parseToString(file);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, parseToString(file, singlePass));
+
+    librevenge::RVNGString path(TDOC "/");
+    path.append(file);
+    librevenge::RVNGFileStream input(path.cstr());
+    libvisio::VisioParseStatus status = libvisio::VISIO_PARSE_ERROR;
+    libvisio::VisioDocumentModel model;
+    libvisio::VisioParseStats stats;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, model, libvisio::VisioParseOptions(), status, stats));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, 2u, stats.passes);
+
+    // The document was not parsed the usual way after all
+    libvisio::VisioDocumentModel singlePassModel;
+    libvisio::VisioParseStats singlePassStats;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, singlePassModel, singlePass, status, singlePassStats));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, 1u, singlePassStats.passes);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, draw(singlePassModel));
+  }
+}
+
+void ImportTest::testDocumentModel()
+{
+  const char *const files[] =
+  {
+    "bitmaps.vsd",
+    "dwg.vsd",
+    "Visio11TextFieldsWithUnits.vsd",
+    "Visio5TextFieldsWithUnits.vsd",
+    "Visio6TextFieldsWithUnits.vsd",
+    "bgcolor.vsdx",
+    "dwg.vsdx",
+    "fdo86664.vsdx"
+  };
+
+  for (const char *file : files)
+  {
+    const std::string expected = parseToString(file);
+
+    librevenge::RVNGString path(TDOC "/");
+    path.append(file);
+    libvisio::VisioDocumentModel model;
+    {
+      librevenge::RVNGFileStream input(path.cstr());
+      CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, model));
+    }
+    CPPUNIT_ASSERT(!model.empty());
+
+    // The model outlives the input and can be drawn more than once.
+    for (int i = 0; i < 2; ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, draw(model));
+    }
+  }
+}
+
+void ImportTest::testPageSelection()
+{
+  const char *const files[] =
+  {
+    "dwg.vsd",
+    "Visio11TextFieldsWithUnits.vsd",
+    "Visio5TextFieldsWithUnits.vsd",
+    "Visio6TextFieldsWithUnits.vsd",
+    "dwg.vsdx",
+    "fdo86664.vsdx"
+  };
+
+  for (const char *file : files)
+  {
+    const std::string expected = parseToString(file);
+    const librevenge::RVNGString name = getXPath(readXml(expected).get(), "/document/page", "name");
+
+    libvisio::VisioParseOptions first;
+    first.pages.insert(0);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, parseToString(file, first));
+
+    libvisio::VisioParseOptions missing;
+    missing.pages.insert(1);
+    missing.pageNames.insert("no such page");
+    // Without any page, the painter does not even get a document
+    CPPUNIT_ASSERT_MESSAGE(file, parseToString(file, missing).find("<page") == std::string::npos);
+
+    if (!name.empty())
+    {
+      libvisio::VisioParseOptions named;
+      named.pageNames.insert(name.cstr());
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, parseToString(file, named));
+    }
+  }
+}
+
+void ImportTest::testProgressive()
+{
+  const char *const files[] =
+  {
+    "bitmaps.vsd",
+    "dwg.vsd",
+    "fdo86729-utf8.vsd",
+    "Visio11FormatLine.vsd",
+    "Visio5TextFieldsWithUnits.vsd",
+    "Visio6TextFieldsWithUnits.vsd",
+    "bgcolor.vsdx",
+    "color-boxes.vsdx",
+    "dwg.vsdx",
+    "multipage.vsdx"
+  };
+  libvisio::VisioParseOptions progressive;
+  progressive.progressive = true;
+  libvisio::VisioParseOptions progressiveSinglePass(progressive);
+  progressiveSinglePass.singlePass = true;
+
+  for (const char *file : files)
+  {
+    libvisio::VisioParseStats stats;
+    const std::string expected = parseToString(file, libvisio::VisioParseOptions(), &stats);
+    const unsigned long allPages = stats.peakBufferedPages;
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, parseToString(file, progressive, &stats));
+    CPPUNIT_ASSERT_MESSAGE(file, stats.peakBufferedPages <= allPages);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, parseToString(file, progressiveSinglePass, &stats));
+    CPPUNIT_ASSERT_MESSAGE(file, stats.peakBufferedPages <= allPages);
+  }
+
+  // Pages without a background are drawn as they are parsed instead of all being kept until the end
+  libvisio::VisioParseStats stats;
+  parseToString("multipage.vsdx", libvisio::VisioParseOptions(), &stats);
+  CPPUNIT_ASSERT_EQUAL(3UL, stats.peakBufferedPages);
+  parseToString("multipage.vsdx", progressive, &stats);
+  CPPUNIT_ASSERT_EQUAL(0UL, stats.peakBufferedPages);
+}
+
+void ImportTest::testModelCache()
+{
+  const char *const files[] =
+  {
+    "bitmaps.vsd",
+    "Visio11TextFieldsWithUnits.vsd",
+    "bgcolor.vsdx",
+    "fdo86664.vsdx"
+  };
+
+  for (const char *file : files)
+  {
+    const std::string expected = parseToString(file);
+
+    librevenge::RVNGString path(TDOC "/");
+    path.append(file);
+    librevenge::RVNGFileStream input(path.cstr());
+    libvisio::VisioDocumentModel model;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, model));
+    librevenge::RVNGBinaryData cache;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::writeCache(&input, model, cache));
+
+    std::unique_ptr<xmlBuffer, void(*)(xmlBufferPtr)> cacheBuffer{xmlBufferCreate(), xmlBufferFree};
+    xmlTextWriterPtr writer = xmlNewTextWriterMemory(cacheBuffer.get(), 0);
+    CPPUNIT_ASSERT(writer);
+    xmlTextWriterStartDocument(writer, 0, 0, 0);
+    libvisio::XmlDrawingGenerator painter(writer);
+    CPPUNIT_ASSERT(libvisio::VisioDocument::drawCache(&input, cache.getDataBuffer(), cache.size(), &painter));
+    xmlTextWriterEndDocument(writer);
+    xmlFreeTextWriter(writer);
+    const std::string actual((const char *)xmlBufferContent(cacheBuffer.get()), xmlBufferLength(cacheBuffer.get()));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, actual);
+
+    // The cache belongs to its input only
+    librevenge::RVNGString otherPath(TDOC "/");
+    otherPath.append(file == files[0] ? files[1] : files[0]);
+    librevenge::RVNGFileStream otherInput(otherPath.cstr());
+    libvisio::XmlDrawingGenerator otherPainter(nullptr);
+    CPPUNIT_ASSERT(!libvisio::VisioDocument::drawCache(&otherInput, cache.getDataBuffer(), cache.size(), &otherPainter));
+  }
+
+  // The cache of a selection is only drawn for the same selection
+  libvisio::VisioParseOptions firstPage;
+  firstPage.pages.insert(0);
+  libvisio::VisioParseOptions textOnly;
+  textOnly.textOnly = true;
+  librevenge::RVNGFileStream input(TDOC "/multipage.vsdx");
+  libvisio::VisioDocumentModel model;
+  CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, model, firstPage));
+  librevenge::RVNGBinaryData cache;
+  CPPUNIT_ASSERT(libvisio::VisioDocument::writeCache(&input, model, cache));
+  libvisio::XmlDrawingGenerator painter(nullptr);
+  CPPUNIT_ASSERT(!libvisio::VisioDocument::drawCache(&input, cache.getDataBuffer(), cache.size(), &painter));
+  CPPUNIT_ASSERT(!libvisio::VisioDocument::drawCache(&input, cache.getDataBuffer(), cache.size(), textOnly, &painter));
+  libvisio::VisioParseOptions firstPageByName;
+  firstPageByName.pageNames.insert("Page-1");
+  CPPUNIT_ASSERT(!libvisio::VisioDocument::drawCache(&input, cache.getDataBuffer(), cache.size(), firstPageByName, &painter));
+
+  // The same for a selection parsed with statistics
+  libvisio::VisioDocumentModel statsModel;
+  libvisio::VisioParseStatus status = libvisio::VISIO_PARSE_ERROR;
+  libvisio::VisioParseStats stats;
+  CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, statsModel, firstPage, status, stats));
+  librevenge::RVNGBinaryData statsCache;
+  CPPUNIT_ASSERT(libvisio::VisioDocument::writeCache(&input, statsModel, statsCache));
+  CPPUNIT_ASSERT(!libvisio::VisioDocument::drawCache(&input, statsCache.getDataBuffer(), statsCache.size(), &painter));
+  CPPUNIT_ASSERT(libvisio::VisioDocument::drawCache(&input, statsCache.getDataBuffer(), statsCache.size(), firstPage, &painter));
+
+  std::unique_ptr<xmlBuffer, void(*)(xmlBufferPtr)> cacheBuffer{xmlBufferCreate(), xmlBufferFree};
+  xmlTextWriterPtr writer = xmlNewTextWriterMemory(cacheBuffer.get(), 0);
+  CPPUNIT_ASSERT(writer);
+  xmlTextWriterStartDocument(writer, 0, 0, 0);
+  libvisio::XmlDrawingGenerator cachePainter(writer);
+  libvisio::VisioParseOptions firstPageWithThreads(firstPage);
+  firstPageWithThreads.pageThreads = 2;
+  CPPUNIT_ASSERT(libvisio::VisioDocument::drawCache(&input, cache.getDataBuffer(), cache.size(), firstPageWithThreads, &cachePainter));
+  xmlTextWriterEndDocument(writer);
+  xmlFreeTextWriter(writer);
+  const std::string actual((const char *)xmlBufferContent(cacheBuffer.get()), xmlBufferLength(cacheBuffer.get()));
+  CPPUNIT_ASSERT_EQUAL(parseToString("multipage.vsdx", firstPage), actual);
+}
+
+void ImportTest::testInterruption()
+{
+  const char *const files[] =
+  {
+    "bitmaps.vsd",
+    "Visio5TextFieldsWithUnits.vsd",
+    "Visio6TextFieldsWithUnits.vsd",
+    "bgcolor.vsdx",
+    "fdo86664.vsdx"
+  };
+
+  for (const char *file : files)
+  {
+    const std::string expected = parseToString(file);
+
+    // Neither a flag that is never set nor a distant deadline changes the output
+    std::atomic<bool> cancel(false);
+    libvisio::VisioParseOptions options;
+    options.cancel = &cancel;
+    options.deadline = std::chrono::steady_clock::now() + std::chrono::hours(1);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, parseToString(file, options));
+
+    librevenge::RVNGString path(TDOC "/");
+    path.append(file);
+    librevenge::RVNGFileStream input(path.cstr());
+    libvisio::VisioDocumentModel model;
+    libvisio::VisioParseStatus status = libvisio::VISIO_PARSE_OK;
+
+    cancel = true;
+    CPPUNIT_ASSERT(!libvisio::VisioDocument::parse(&input, model, options, status));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, libvisio::VISIO_PARSE_CANCELLED, status);
+    CPPUNIT_ASSERT(model.empty());
+
+    cancel = false;
+    options.deadline = std::chrono::steady_clock::now();
+    CPPUNIT_ASSERT(!libvisio::VisioDocument::parse(&input, model, options, status));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, libvisio::VISIO_PARSE_TIMED_OUT, status);
+
+    options.deadline = std::chrono::steady_clock::time_point::max();
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, model, options, status));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, libvisio::VISIO_PARSE_OK, status);
+  }
+}
+
+void ImportTest::testLimits()
+{
+  const char *const files[] =
+  {
+    "bitmaps.vsd",
+    "Visio11TextFieldsWithUnits.vsd",
+    "color-boxes.vsdx"
+  };
+
+  libvisio::VisioParseOptions generous;
+  generous.limits.maxDecompressedBytes = 1UL << 30;
+  generous.limits.maxShapesPerPage = 100000;
+  generous.limits.maxPathPoints = 1UL << 24;
+  generous.limits.maxEmbeddedBytes = 1UL << 30;
+  generous.limits.maxStreamDepth = 64;
+
+  for (const char *file : files)
+  {
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, parseToString(file), parseToString(file, generous));
+  }
+
+  std::vector<std::pair<const char *, libvisio::VisioParseOptions> > tooSmall(4);
+  tooSmall[0].first = "bitmaps.vsd";
+  tooSmall[0].second.limits.maxEmbeddedBytes = 1;
+  tooSmall[1].first = "bitmaps.vsd";
+  tooSmall[1].second.limits.maxDecompressedBytes = 1;
+  tooSmall[2].first = "Visio11TextFieldsWithUnits.vsd";
+  tooSmall[2].second.limits.maxStreamDepth = 1;
+  tooSmall[3].first = "color-boxes.vsdx";
+  tooSmall[3].second.limits.maxShapesPerPage = 1;
+
+  for (const auto &test : tooSmall)
+  {
+    librevenge::RVNGString path(TDOC "/");
+    path.append(test.first);
+    librevenge::RVNGFileStream input(path.cstr());
+    libvisio::VisioDocumentModel model;
+    libvisio::VisioParseStatus status = libvisio::VISIO_PARSE_OK;
+    CPPUNIT_ASSERT(!libvisio::VisioDocument::parse(&input, model, test.second, status));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(test.first, libvisio::VISIO_PARSE_LIMIT_EXCEEDED, status);
+  }
+
+  // None of the test documents has polylines, so use a small one with a polyline of 4 points
+  const char polyline[] =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+    "<VisioDocument xmlns=\"http://schemas.microsoft.com/visio/2003/core\"><Pages>"
+    "<Page ID=\"0\" NameU=\"Page-1\"><PageSheet><PageProps><PageWidth>8.5</PageWidth><PageHeight>11</PageHeight></PageProps></PageSheet>"
+    "<Shapes><Shape ID=\"1\" Type=\"Shape\"><XForm><PinX>1</PinX><PinY>1</PinY><Width>1</Width><Height>1</Height></XForm>"
+    "<Geom IX=\"0\"><MoveTo IX=\"1\"><X>0</X><Y>0</Y></MoveTo>"
+    "<PolylineTo IX=\"2\"><X>1</X><Y>1</Y><A>POLYLINE(0,0,0.2,0.5,0.4,0.2,0.6,0.8)</A></PolylineTo>"
+    "</Geom></Shape></Shapes></Page></Pages></VisioDocument>";
+  for (unsigned long maxPathPoints = 3; maxPathPoints <= 4; ++maxPathPoints)
+  {
+    librevenge::RVNGStringStream input(reinterpret_cast<const unsigned char *>(polyline), sizeof(polyline) - 1);
+    libvisio::VisioParseOptions options;
+    options.limits.maxPathPoints = maxPathPoints;
+    libvisio::VisioDocumentModel model;
+    libvisio::VisioParseStatus status = libvisio::VISIO_PARSE_ERROR;
+    const bool parsed = libvisio::VisioDocument::parse(&input, model, options, status);
+    CPPUNIT_ASSERT_EQUAL(maxPathPoints == 4, parsed);
+    CPPUNIT_ASSERT_EQUAL(maxPathPoints == 4 ? libvisio::VISIO_PARSE_OK : libvisio::VISIO_PARSE_LIMIT_EXCEEDED, status);
+  }
+}
+
+void ImportTest::testStats()
+{
+  const char *const files[] =
+  {
+    "Visio11FormatLine.vsd",
+    "color-boxes.vsdx"
+  };
+
+  for (const char *file : files)
+  {
+    librevenge::RVNGString path(TDOC "/");
+    path.append(file);
+    librevenge::RVNGFileStream input(path.cstr());
+    libvisio::VisioParseStatus status = libvisio::VISIO_PARSE_ERROR;
+    libvisio::VisioParseStats stats;
+    std::unique_ptr<xmlBuffer, void(*)(xmlBufferPtr)> buffer{xmlBufferCreate(), xmlBufferFree};
+    xmlTextWriterPtr writer = xmlNewTextWriterMemory(buffer.get(), 0);
+    CPPUNIT_ASSERT(writer);
+    libvisio::XmlDrawingGenerator painter(writer);
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, &painter, libvisio::VisioParseOptions(), status, stats));
+    xmlFreeTextWriter(writer);
+
+    CPPUNIT_ASSERT_MESSAGE(file, stats.detectionSeconds > 0.0);
+    CPPUNIT_ASSERT_MESSAGE(file, stats.firstPassSeconds > 0.0);
+    CPPUNIT_ASSERT_MESSAGE(file, stats.secondPassSeconds > 0.0);
+    CPPUNIT_ASSERT_MESSAGE(file, stats.drawSeconds > 0.0);
+    CPPUNIT_ASSERT_MESSAGE(file, stats.streams > 0);
+    CPPUNIT_ASSERT_MESSAGE(file, stats.chunks > stats.streams);
+    CPPUNIT_ASSERT_MESSAGE(file, stats.shapes > 0);
+    CPPUNIT_ASSERT_MESSAGE(file, stats.pathNodes > 0);
+    CPPUNIT_ASSERT_MESSAGE(file, stats.peakBufferedPages > 0);
+    CPPUNIT_ASSERT_MESSAGE(file, stats.peakBufferedElements > 0);
+
+    // A model is not drawn by the parse
+    libvisio::VisioDocumentModel model;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, model, libvisio::VisioParseOptions(), status, stats));
+    CPPUNIT_ASSERT_MESSAGE(file, stats.shapes > 0);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, 0.0, stats.drawSeconds);
+  }
+}
+
+void ImportTest::testStreamCache()
+{
+  const char *const files[] =
+  {
+    "bitmaps.vsd",
+    "Visio11FormatLine.vsd",
+    "Visio6TextFieldsWithUnits.vsd"
+  };
+  libvisio::VisioParseOptions small;
+  small.streamCacheLimit = 1024;
+
+  for (const char *file : files)
+  {
+    const std::string expected = parseToString(file);
+    librevenge::RVNGString path(TDOC "/");
+    path.append(file);
+    librevenge::RVNGFileStream input(path.cstr());
+    libvisio::VisioParseStatus status = libvisio::VISIO_PARSE_ERROR;
+
+    // The second pass finds the streams that the first one decompressed
+    libvisio::VisioDocumentModel model;
+    libvisio::VisioParseStats stats;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, model, libvisio::VisioParseOptions(), status, stats));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, draw(model));
+    CPPUNIT_ASSERT_MESSAGE(file, stats.streamCacheMisses > 0);
+    CPPUNIT_ASSERT_MESSAGE(file, stats.streamCacheHits > 0);
+    CPPUNIT_ASSERT_MESSAGE(file, stats.streamCacheSavedBytes > 0);
+
+    // A limited cache keeps fewer streams, which are then decompressed again
+    libvisio::VisioDocumentModel smallModel;
+    libvisio::VisioParseStats smallStats;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, smallModel, small, status, smallStats));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, draw(smallModel));
+    CPPUNIT_ASSERT_MESSAGE(file, smallStats.streamCacheHits < stats.streamCacheHits);
+    CPPUNIT_ASSERT_MESSAGE(file, smallStats.streamCacheSavedBytes <= small.streamCacheLimit * smallStats.streamCacheHits);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, stats.streamCacheHits + stats.streamCacheMisses, smallStats.streamCacheHits + smallStats.streamCacheMisses);
+  }
+}
+
+void ImportTest::testDecompressionThreads()
+{
+  const char *const files[] =
+  {
+    "bitmaps.vsd",
+    "dwg.vsd",
+    "fdo86729-utf8.vsd",
+    "Visio11FormatLine.vsd",
+    "Visio11TextFieldsWithUnits.vsd",
+    "Visio6TextFieldsWithUnits.vsd"
+  };
+  libvisio::VisioParseOptions threads;
+  threads.decompressionThreads = 4;
+
+  for (const char *file : files)
+  {
+    const std::string expected = parseToString(file);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, parseToString(file, threads));
+
+    // The threads decompress streams before they are opened, so fewer of them are missing from the cache
+    librevenge::RVNGString path(TDOC "/");
+    path.append(file);
+    librevenge::RVNGFileStream input(path.cstr());
+    libvisio::VisioParseStatus status = libvisio::VISIO_PARSE_ERROR;
+    libvisio::VisioDocumentModel model;
+    libvisio::VisioParseStats stats;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, model, libvisio::VisioParseOptions(), status, stats));
+    libvisio::VisioDocumentModel threadedModel;
+    libvisio::VisioParseStats threadedStats;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, threadedModel, threads, status, threadedStats));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, draw(threadedModel));
+    CPPUNIT_ASSERT_MESSAGE(file, threadedStats.streamCacheMisses < stats.streamCacheMisses);
+
+    // Streams over the limit are not decompressed by the threads either
+    libvisio::VisioParseOptions limited(threads);
+    limited.limits.maxDecompressedBytes = 1;
+    libvisio::VisioDocumentModel limitedModel;
+    CPPUNIT_ASSERT(!libvisio::VisioDocument::parse(&input, limitedModel, limited, status, stats));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, libvisio::VISIO_PARSE_LIMIT_EXCEEDED, status);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, 0.0, stats.decompressionSeconds);
+  }
+}
+
+void ImportTest::testBatch()
+{
+  const char *const files[] =
+  {
+    "bitmaps.vsd",
+    "fdo86729-ms1252.vsd",
+    "Visio5TextFieldsWithUnits.vsd",
+    "Visio11TextFieldsWithUnits.vsd",
+    "color-boxes.vsdx",
+    "dwg.vsdx"
+  };
+  const std::size_t fileCount = sizeof(files) / sizeof(files[0]);
+
+  std::vector<std::string> expected;
+  for (const char *file : files)
+    expected.push_back(parseToString(file));
+
+  // Several copies of each document, so that the same documents are parsed at the same time
+  std::vector<std::unique_ptr<librevenge::RVNGFileStream> > inputs;
+  std::vector<std::unique_ptr<BatchOutput> > outputs;
+  std::vector<libvisio::VisioBatchDocument> documents;
+  for (unsigned copy = 0; copy < 8; ++copy)
+  {
+    for (const char *file : files)
+    {
+      librevenge::RVNGString path(TDOC "/");
+      path.append(file);
+      inputs.push_back(std::unique_ptr<librevenge::RVNGFileStream>(new librevenge::RVNGFileStream(path.cstr())));
+      outputs.push_back(std::unique_ptr<BatchOutput>(new BatchOutput()));
+      BatchOutput *const output = outputs.back().get();
+      documents.push_back(libvisio::VisioBatchDocument(inputs.back().get(), [output]()
+      {
+        return output->start();
+      }));
+    }
+  }
+
+  CPPUNIT_ASSERT(libvisio::VisioDocument::parseBatch(documents, 4, libvisio::VisioParseOptions()));
+  for (std::size_t i = 0; i < documents.size(); ++i)
+  {
+    const char *const file = files[i % fileCount];
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, libvisio::VISIO_PARSE_OK, documents[i].status);
+    CPPUNIT_ASSERT_MESSAGE(file, documents[i].stats.shapes > 0);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected[i % fileCount], outputs[i]->finish());
+  }
+
+  // A document without a painter fails alone
+  std::vector<libvisio::VisioBatchDocument> unpainted;
+  unpainted.push_back(libvisio::VisioBatchDocument(inputs[0].get(), nullptr));
+  unpainted.push_back(libvisio::VisioBatchDocument(inputs[1].get(), [&outputs]()
+  {
+    return outputs[1]->start();
+  }));
+  CPPUNIT_ASSERT(!libvisio::VisioDocument::parseBatch(unpainted, 0, libvisio::VisioParseOptions()));
+  CPPUNIT_ASSERT_EQUAL(libvisio::VISIO_PARSE_ERROR, unpainted[0].status);
+  CPPUNIT_ASSERT_EQUAL(libvisio::VISIO_PARSE_OK, unpainted[1].status);
+  outputs[1]->finish();
+}
+
+void ImportTest::testTextOnly()
+{
+  const char *const files[] =
+  {
+    "bitmaps.vsd",
+    "fdo86729-ms1252.vsd",
+    "tdf76829-numeric-format.vsd",
+    "Visio11TextFieldsWithUnits.vsd",
+    "Visio5TextFieldsWithUnits.vsd",
+    "dwg.vsdx",
+    "fdo86664.vsdx"
+  };
+  libvisio::VisioParseOptions textOnly;
+  textOnly.textOnly = true;
+
+  for (const char *file : files)
+  {
+    const auto doc = readXml(parseToString(file));
+    const auto textDoc = readXml(parseToString(file, textOnly));
+
+    // The same text in the same pages and text objects, but nothing else
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, getXPathContent(doc.get(), "string(/document)"), getXPathContent(textDoc.get(), "string(/document)"));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, getXPathContent(doc.get(), "string(count(//page))"), getXPathContent(textDoc.get(), "string(count(//page))"));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, getXPathContent(doc.get(), "string(count(//textObject))"), getXPathContent(textDoc.get(), "string(count(//textObject))"));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, getXPathContent(doc.get(), "string(count(//insertField))"), getXPathContent(textDoc.get(), "string(count(//insertField))"));
+    assertXPathContent(textDoc.get(), "string(count(//drawRectangle|//drawEllipse|//drawPolyline|//drawPolygon|//drawPath|//drawGraphicObject))", "0");
+  }
+}
+
+void ImportTest::testMetaData()
+{
+  const char *const files[] =
+  {
+    "bitmaps.vsd",
+    "dwg.vsd",
+    "fdo86729-ms1252.vsd",
+    "fdo86729-utf8.vsd",
+    "Visio6TextFieldsWithUnits.vsd",
+    "dwg.vsdx",
+    "fdo86664.vsdx"
+  };
+
+  for (const char *file : files)
+  {
+    const auto doc = readXml(parseToString(file));
+
+    librevenge::RVNGString path(TDOC "/");
+    path.append(file);
+    librevenge::RVNGFileStream input(path.cstr());
+    librevenge::RVNGPropertyList metaData;
+    CPPUNIT_ASSERT_MESSAGE(file, libvisio::VisioDocument::parseMetaData(&input, metaData));
+
+    std::unique_ptr<xmlBuffer, void(*)(xmlBufferPtr)> metaBuffer{xmlBufferCreate(), xmlBufferFree};
+    xmlTextWriterPtr writer = xmlNewTextWriterMemory(metaBuffer.get(), 0);
+    CPPUNIT_ASSERT(writer);
+    xmlTextWriterStartDocument(writer, 0, 0, 0);
+    {
+      libvisio::XmlDrawingGenerator painter(writer);
+      painter.startDocument(librevenge::RVNGPropertyList());
+      painter.setDocumentMetaData(metaData);
+      painter.endDocument();
+    }
+    xmlTextWriterEndDocument(writer);
+    xmlFreeTextWriter(writer);
+    std::unique_ptr<xmlDoc, void(*)(xmlDocPtr)> metaDoc{xmlParseMemory((const char *)xmlBufferContent(metaBuffer.get()), xmlBufferLength(metaBuffer.get())), xmlFreeDoc};
+
+    // The same metadata as the full parse gives to the painter
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(file, dumpXPathNode(doc.get(), "/document/setDocumentMetaData"), dumpXPathNode(metaDoc.get(), "/document/setDocumentMetaData"));
+  }
+
+  // Only a supported document has metadata
+  librevenge::RVNGStringStream notVisio((const unsigned char *)"not a Visio document", 20);
+  librevenge::RVNGPropertyList metaData;
+  metaData.insert("dc:title", "stale");
+  CPPUNIT_ASSERT(!libvisio::VisioDocument::parseMetaData(&notVisio, metaData));
+  CPPUNIT_ASSERT(metaData.empty());
+}
+
+void ImportTest::testVsdxPageThreads()
+{
+  const char *const files[] =
+  {
+    "bgcolor.vsdx",
+    "dwg.vsdx",
+    "fdo86664.vsdx",
+    "multipage.vsdx"
+  };
+  libvisio::VisioParseOptions pageThreads;
+  pageThreads.pageThreads = 4;
+  libvisio::VisioParseOptions progressive(pageThreads);
+  progressive.progressive = true;
+
+  for (const char *file : files)
+  {
+    const std::string expected = parseToString(file);
+
+    // The masters and pages come in document order, whichever worker parsed them
+    for (const libvisio::VisioParseOptions &options : {pageThreads, progressive})
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(file, expected, parseToString(file, options));
+    }
+  }
+
+  // Only multipage.vsdx has more than one page for the workers
+  libvisio::VisioParseStats stats;
+  const auto doc = readXml(parseToString("multipage.vsdx", pageThreads, &stats));
+  CPPUNIT_ASSERT_EQUAL(3ul, stats.parallelParts);
+  assertXPath(doc.get(), "/document/page[1]", "name", "Page-1");
+  assertXPath(doc.get(), "/document/page[2]", "name", "Page-2");
+  assertXPath(doc.get(), "/document/page[3]", "name", "Page-3");
+  parseToString("multipage.vsdx", libvisio::VisioParseOptions(), &stats);
+  CPPUNIT_ASSERT_EQUAL(0ul, stats.parallelParts);
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(ImportTest);
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
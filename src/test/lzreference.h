@@ -0,0 +1,74 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef LZREFERENCE_H_INCLUDED
+#define LZREFERENCE_H_INCLUDED
+
+#include <vector>
+
+namespace test
+{
+
+/* The original byte-at-a-time decoder of VSDInternalStream, kept as the
+ * reference the optimized decoder must match.
+ */
+inline void lzDecompressReference(const unsigned char *input, unsigned long size, std::vector<unsigned char> &output)
+{
+  output.clear();
+
+  unsigned char buffer[4096] = { 0 };
+  unsigned pos = 0;
+  unsigned offset = 0;
+
+  while (offset < size)
+  {
+    unsigned flag = input[offset++];
+    if (offset > size-1)
+      break;
+
+    unsigned mask = 1;
+    for (unsigned bit = 0; bit < 8 && offset < size; ++bit)
+    {
+      if (flag & mask)
+      {
+        buffer[pos&4095] = input[offset++];
+        output.push_back(buffer[pos&4095]);
+        pos++;
+      }
+      else
+      {
+        if (offset > size-2)
+          break;
+        unsigned char addr1 = input[offset++];
+        unsigned char addr2 = input[offset++];
+
+        unsigned length = (addr2&15) + 3;
+        unsigned pointer = (((unsigned)addr2 & 0xF0) << 4) | addr1;
+        if (pointer > 4078)
+          pointer -= 4078;
+        else
+          pointer += 18;
+
+        for (unsigned j = 0; j < length; ++j)
+        {
+          buffer[(pos+j) & 4095] = buffer[(pointer+j) & 4095];
+          output.push_back(buffer[(pointer+j) & 4095]);
+        }
+        pos += length;
+      }
+      mask = mask << 1;
+    }
+  }
+}
+
+}
+
+#endif // LZREFERENCE_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,239 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/* Measures how long the binary parsers take to parse a document into a
+ * painter that discards everything, and how long reading only its
+ * metadata with VisioDocument::parseMetaData takes. Without arguments the
+ * Visio 5, 6 and 11 documents of the test data are measured (the Visio 6
+ * one is saved in the version 11 format, so no document of the test data
+ * exercises VSD6Parser); every argument is taken as a document to measure
+ * instead. Then copies of the same documents are parsed with
+ * VisioDocument::parseBatch on more and more threads, to show how the
+ * throughput scales with the cores. The program fails if a document comes
+ * out of a batch on several threads with another status or other counts
+ * than on one thread.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include <librevenge/librevenge.h>
+#include <librevenge-stream/librevenge-stream.h>
+#include <libvisio/libvisio.h>
+
+namespace
+{
+
+class NullDrawingGenerator : public librevenge::RVNGDrawingInterface
+{
+public:
+  void startDocument(const librevenge::RVNGPropertyList &) override {}
+  void endDocument() override {}
+  void setDocumentMetaData(const librevenge::RVNGPropertyList &) override {}
+  void defineEmbeddedFont(const librevenge::RVNGPropertyList &) override {}
+  void startPage(const librevenge::RVNGPropertyList &) override {}
+  void endPage() override {}
+  void startMasterPage(const librevenge::RVNGPropertyList &) override {}
+  void endMasterPage() override {}
+  void setStyle(const librevenge::RVNGPropertyList &) override {}
+  void startLayer(const librevenge::RVNGPropertyList &) override {}
+  void endLayer() override {}
+  void startEmbeddedGraphics(const librevenge::RVNGPropertyList &) override {}
+  void endEmbeddedGraphics() override {}
+  void openGroup(const librevenge::RVNGPropertyList &) override {}
+  void closeGroup() override {}
+  void drawRectangle(const librevenge::RVNGPropertyList &) override {}
+  void drawEllipse(const librevenge::RVNGPropertyList &) override {}
+  void drawPolygon(const librevenge::RVNGPropertyList &) override {}
+  void drawPolyline(const librevenge::RVNGPropertyList &) override {}
+  void drawPath(const librevenge::RVNGPropertyList &) override {}
+  void drawGraphicObject(const librevenge::RVNGPropertyList &) override {}
+  void drawConnector(const librevenge::RVNGPropertyList &) override {}
+  void startTextObject(const librevenge::RVNGPropertyList &) override {}
+  void endTextObject() override {}
+  void startTableObject(const librevenge::RVNGPropertyList &) override {}
+  void openTableRow(const librevenge::RVNGPropertyList &) override {}
+  void closeTableRow() override {}
+  void openTableCell(const librevenge::RVNGPropertyList &) override {}
+  void closeTableCell() override {}
+  void insertCoveredTableCell(const librevenge::RVNGPropertyList &) override {}
+  void endTableObject() override {}
+  void insertTab() override {}
+  void insertSpace() override {}
+  void insertText(const librevenge::RVNGString &) override {}
+  void insertLineBreak() override {}
+  void insertField(const librevenge::RVNGPropertyList &) override {}
+  void openOrderedListLevel(const librevenge::RVNGPropertyList &) override {}
+  void openUnorderedListLevel(const librevenge::RVNGPropertyList &) override {}
+  void closeOrderedListLevel() override {}
+  void closeUnorderedListLevel() override {}
+  void openListElement(const librevenge::RVNGPropertyList &) override {}
+  void closeListElement() override {}
+  void defineParagraphStyle(const librevenge::RVNGPropertyList &) override {}
+  void openParagraph(const librevenge::RVNGPropertyList &) override {}
+  void closeParagraph() override {}
+  void defineCharacterStyle(const librevenge::RVNGPropertyList &) override {}
+  void openSpan(const librevenge::RVNGPropertyList &) override {}
+  void closeSpan() override {}
+  void openLink(const librevenge::RVNGPropertyList &) override {}
+  void closeLink() override {}
+};
+
+// Returns the version byte of a binary document, or 0 if it is not one
+unsigned char getVersion(librevenge::RVNGInputStream &input)
+{
+  if (!input.isStructured())
+    return 0;
+  const std::unique_ptr<librevenge::RVNGInputStream> docStream(input.getSubStreamByName("VisioDocument"));
+  if (!docStream || docStream->seek(0x1A, librevenge::RVNG_SEEK_SET))
+    return 0;
+  unsigned long numBytesRead = 0;
+  const unsigned char *version = docStream->read(1, numBytesRead);
+  return numBytesRead == 1 ? version[0] : 0;
+}
+
+/* Runs work in ten batches of at least a tenth of a second each, and
+ * returns the seconds a round took in the fastest batch. Other processes
+ * and frequency scaling only ever slow a batch down, so the fastest one
+ * is the figure that can be compared between two builds.
+ */
+template<typename Work>
+double measure(Work work, unsigned &rounds)
+{
+  rounds = 0;
+  double best = 0.0;
+  for (unsigned batch = 0; batch < 10; ++batch)
+  {
+    unsigned batchRounds = 0;
+    const auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed(0);
+    do
+    {
+      work();
+      ++batchRounds;
+      elapsed = std::chrono::steady_clock::now() - start;
+    }
+    while (elapsed.count() < 0.1);
+    rounds += batchRounds;
+    if (batch == 0 || elapsed.count() / batchRounds < best)
+      best = elapsed.count() / batchRounds;
+  }
+  return best;
+}
+
+void report(const char *path)
+{
+  librevenge::RVNGFileStream input(path);
+  const unsigned version = getVersion(input);
+  if (!version)
+  {
+    printf("%-50s not a binary Visio document\n", path);
+    return;
+  }
+
+  NullDrawingGenerator painter;
+  unsigned rounds = 0;
+  bool parsed = true;
+  const double parseSeconds = measure([&]()
+  {
+    parsed = libvisio::VisioDocument::parse(&input, &painter) && parsed;
+  }, rounds);
+
+  unsigned metaDataRounds = 0;
+  const double metaDataSeconds = measure([&]()
+  {
+    librevenge::RVNGPropertyList metaData;
+    parsed = libvisio::VisioDocument::parseMetaData(&input, metaData) && parsed;
+  }, metaDataRounds);
+
+  printf("%-50s v%-2u %8.3f ms/parse %8.3f ms/metadata   %6u rounds%s\n",
+         path, version, 1000.0 * parseSeconds, 1000.0 * metaDataSeconds,
+         rounds + metaDataRounds, parsed ? "" : "   (parse failed)");
+}
+
+// Returns false if a batch on more threads gives other results than on one
+bool reportBatch(const std::vector<const char *> &paths)
+{
+  const unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  // Enough copies that every thread stays busy with the most threads
+  std::vector<std::unique_ptr<librevenge::RVNGFileStream> > inputs;
+  for (unsigned copy = 0; copy < 4 * maxThreads; ++copy)
+  {
+    for (const char *path : paths)
+      inputs.push_back(std::unique_ptr<librevenge::RVNGFileStream>(new librevenge::RVNGFileStream(path)));
+  }
+
+  std::vector<libvisio::VisioBatchDocument> documents;
+  for (auto &input : inputs)
+    documents.push_back(libvisio::VisioBatchDocument(input.get(), []()
+    {
+      return std::unique_ptr<librevenge::RVNGDrawingInterface>(new NullDrawingGenerator());
+    }));
+
+  double singleThreadRate = 0.0;
+  std::vector<libvisio::VisioBatchDocument> singleThread;
+  bool same = true;
+  for (unsigned threads = 1;; threads = std::min(2 * threads, maxThreads))
+  {
+    const auto start = std::chrono::steady_clock::now();
+    const bool parsed = libvisio::VisioDocument::parseBatch(documents, threads, libvisio::VisioParseOptions());
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double rate = documents.size() / elapsed.count();
+    if (threads == 1)
+    {
+      singleThreadRate = rate;
+      singleThread = documents;
+    }
+    printf("batch of %-4u documents on %3u threads %10.1f documents/s %6.2fx%s\n",
+           unsigned(documents.size()), threads, rate, rate / singleThreadRate, parsed ? "" : "   (parse failed)");
+
+    // Each document has to come out as it did when the documents were parsed one after another
+    for (std::size_t i = 0; i < documents.size(); ++i)
+    {
+      const libvisio::VisioParseStats &stats = documents[i].stats;
+      const libvisio::VisioParseStats &expected = singleThread[i].stats;
+      if (documents[i].status != singleThread[i].status || stats.shapes != expected.shapes || stats.pathNodes != expected.pathNodes
+          || stats.textSpans != expected.textSpans || stats.chunks != expected.chunks)
+      {
+        printf("%-50s differs on %u threads\n", paths[i % paths.size()], threads);
+        same = false;
+      }
+    }
+    if (threads == maxThreads)
+      break;
+  }
+  return same;
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+  std::vector<const char *> paths;
+  if (argc < 2)
+  {
+    paths.push_back(TDOC "/Visio5TextFieldsWithUnits.vsd");
+    paths.push_back(TDOC "/Visio6TextFieldsWithUnits.vsd");
+    paths.push_back(TDOC "/Visio11TextFieldsWithUnits.vsd");
+  }
+  for (int i = 1; i < argc; ++i)
+    paths.push_back(argv[i]);
+
+  for (const char *path : paths)
+    report(path);
+  return reportBatch(paths) ? 0 : 1;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
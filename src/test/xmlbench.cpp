@@ -0,0 +1,298 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/* Measures the XML readers on the attribute lookups that VSDXParser does
+ * for every Cell, Row and Section of a page: the N or T attribute that
+ * gives the element its token and the V attribute that holds its value.
+ * The baseline reads the XML with libxml2 alone and takes the attributes
+ * as copies, as the parsers did before VSDXMLReader. The first pass reads
+ * it through VSDXMLReader while recording the tape, and the second pass
+ * replays the tape, taking the attributes once as copies and once in
+ * place. The allocations of libxml2 and of operator new are counted.
+ * Without arguments a synthetic page is measured; every argument is taken
+ * as a VSDX document whose page parts are measured.
+ */
+
+#include <chrono>
+#include <memory>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include "VSDXMLReader.h"
+#include "VSDXMLTokenMap.h"
+#include "libvisio_xml.h"
+
+namespace
+{
+
+unsigned long allocations = 0;
+
+void *countingMalloc(size_t size)
+{
+  ++allocations;
+  return malloc(size);
+}
+
+void *countingRealloc(void *ptr, size_t size)
+{
+  ++allocations;
+  return realloc(ptr, size);
+}
+
+char *countingStrdup(const char *str)
+{
+  ++allocations;
+  return strdup(str);
+}
+
+} // anonymous namespace
+
+// The tape and the reader allocate with operator new
+void *operator new(std::size_t size)
+{
+  ++allocations;
+  void *const ptr = malloc(size ? size : 1);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+  free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  free(ptr);
+}
+
+namespace
+{
+
+std::string makeSyntheticPage()
+{
+  std::string page("<?xml version='1.0' encoding='utf-8'?>\n<PageContents><Shapes>");
+  for (unsigned shape = 1; shape <= 2000; ++shape)
+  {
+    page += "<Shape ID='" + std::to_string(shape) + "' Type='Shape' LineStyle='3' FillStyle='3' TextStyle='3'>";
+    page += "<Cell N='PinX' V='4.25'/><Cell N='PinY' V='5.5'/><Cell N='Width' V='1'/><Cell N='Height' V='0.75'/>";
+    page += "<Cell N='LocPinX' V='0.5' F='Width*0.5'/><Cell N='LocPinY' V='0.375' F='Height*0.5'/>";
+    page += "<Cell N='Angle' V='0'/><Cell N='FlipX' V='0'/><Cell N='FlipY' V='0'/><Cell N='LineWeight' V='0.01'/>";
+    page += "<Cell N='LineColor' V='#000000'/><Cell N='FillForegnd' V='#ffffff'/><Cell N='Rounding' V='0'/>";
+    page += "<Section N='Geometry' IX='0'><Cell N='NoFill' V='0'/>";
+    page += "<Row T='MoveTo' IX='1'><Cell N='X' V='0'/><Cell N='Y' V='0'/></Row>";
+    page += "<Row T='LineTo' IX='2'><Cell N='X' V='1'/><Cell N='Y' V='0'/></Row>";
+    page += "<Row T='LineTo' IX='3'><Cell N='X' V='1'/><Cell N='Y' V='0.75'/></Row>";
+    page += "<Row T='LineTo' IX='4'><Cell N='X' V='0'/><Cell N='Y' V='0'/></Row>";
+    page += "</Section></Shape>";
+  }
+  page += "</Shapes></PageContents>";
+  return page;
+}
+
+bool isMeasured(int token)
+{
+  return XML_CELL == token || XML_ROW == token || XML_SECTION == token;
+}
+
+// Reads xml with libxml2 alone, with the attributes as copies; returns the number of cells, rows and sections read
+unsigned long readBaseline(const std::string &xml, unsigned long &checksum)
+{
+  librevenge::RVNGStringStream input(reinterpret_cast<const unsigned char *>(xml.data()), (unsigned)xml.size());
+  const auto reader = libvisio::xmlReaderForStream(&input);
+  if (!reader)
+    return 0;
+  unsigned long elements = 0;
+  while (1 == xmlTextReaderRead(reader.get()))
+  {
+    const int token = libvisio::VSDXMLTokenMap::getTokenId(xmlTextReaderConstName(reader.get()));
+    if (XML_READER_TYPE_ELEMENT != xmlTextReaderNodeType(reader.get()) || !isMeasured(token))
+      continue;
+    ++elements;
+    xmlChar *name = xmlTextReaderGetAttribute(reader.get(), BAD_CAST("N"));
+    if (!name && XML_ROW == token)
+      name = xmlTextReaderGetAttribute(reader.get(), BAD_CAST("T"));
+    if (name)
+      checksum += libvisio::VSDXMLTokenMap::getTokenId(name);
+    xmlFree(name);
+    xmlChar *const value = xmlTextReaderGetAttribute(reader.get(), BAD_CAST("V"));
+    if (value)
+      checksum += value[0];
+    xmlFree(value);
+  }
+  return elements;
+}
+
+// Reads the attributes as copies, as getAttribute gives them
+unsigned long readCopies(libvisio::VSDXMLReader &reader, unsigned long &checksum)
+{
+  unsigned long elements = 0;
+  while (1 == reader.read())
+  {
+    const int token = reader.getToken();
+    if (XML_READER_TYPE_ELEMENT != reader.getNodeType() || !isMeasured(token))
+      continue;
+    ++elements;
+    xmlChar *name = reader.getAttribute(BAD_CAST("N"));
+    if (!name && XML_ROW == token)
+      name = reader.getAttribute(BAD_CAST("T"));
+    if (name)
+      checksum += libvisio::VSDXMLTokenMap::getTokenId(name);
+    xmlFree(name);
+    xmlChar *const value = reader.getAttribute(BAD_CAST("V"));
+    if (value)
+      checksum += value[0];
+    xmlFree(value);
+  }
+  return elements;
+}
+
+// Reads the same attributes in place
+unsigned long readInPlace(libvisio::VSDXMLReader &reader, unsigned long &checksum)
+{
+  unsigned long elements = 0;
+  while (1 == reader.read())
+  {
+    const int token = reader.getToken();
+    if (XML_READER_TYPE_ELEMENT != reader.getNodeType() || !isMeasured(token))
+      continue;
+    ++elements;
+    const xmlChar *name = reader.getConstAttribute(BAD_CAST("N"));
+    if (!name && XML_ROW == token)
+      name = reader.getConstAttribute(BAD_CAST("T"));
+    if (name)
+      checksum += libvisio::VSDXMLTokenMap::getTokenId(name);
+    const xmlChar *const value = reader.getConstAttribute(BAD_CAST("V"));
+    if (value)
+      checksum += value[0];
+  }
+  return elements;
+}
+
+// Reads xml as the first pass does, recording it into tape
+unsigned long readRecording(const std::string &xml, libvisio::VSDXMLTape &tape, unsigned long &checksum)
+{
+  librevenge::RVNGStringStream input(reinterpret_cast<const unsigned char *>(xml.data()), (unsigned)xml.size());
+  const auto xmlReader = libvisio::xmlReaderForStream(&input);
+  if (!xmlReader)
+    return 0;
+  libvisio::VSDXMLReader reader(xmlReader.get(), tape);
+  return readInPlace(reader, checksum);
+}
+
+// Runs read for at least a second and three rounds; prints the time and allocations per element
+template<typename Read>
+void measure(const char *label, Read read, unsigned long &checksum)
+{
+  unsigned rounds = 0;
+  unsigned long elements = 0;
+  const unsigned long startAllocations = allocations;
+  const auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed(0);
+  do
+  {
+    elements += read(checksum);
+    ++rounds;
+    elapsed = std::chrono::steady_clock::now() - start;
+  }
+  while (elapsed.count() < 1.0 || rounds < 3);
+
+  if (!elements)
+    return;
+  printf("  %-16s %8.1f ns/element %8.3f allocations/element   %8lu elements/round %6u rounds\n",
+         label, 1e9 * elapsed.count() / elements, double(allocations - startAllocations) / elements,
+         elements / rounds, rounds);
+}
+
+void report(const char *label, const std::string &xml)
+{
+  unsigned long checksum = 0;
+  libvisio::VSDXMLTape tape;
+  readRecording(xml, tape, checksum);
+  if (!tape.isComplete())
+    return;
+
+  printf("%s\n", label);
+  measure("baseline", [&xml](unsigned long &sum)
+  {
+    return readBaseline(xml, sum);
+  }, checksum);
+  // Each round frees its tape, as the parse does after the second pass
+  measure("record", [&xml](unsigned long &sum)
+  {
+    libvisio::VSDXMLTape recorded;
+    return readRecording(xml, recorded, sum);
+  }, checksum);
+  measure("replay copies", [&tape](unsigned long &sum)
+  {
+    libvisio::VSDXMLReader reader(tape);
+    return readCopies(reader, sum);
+  }, checksum);
+  measure("replay in place", [&tape](unsigned long &sum)
+  {
+    libvisio::VSDXMLReader reader(tape);
+    return readInPlace(reader, sum);
+  }, checksum);
+  // Keeps the lookups from being optimised away
+  if (!checksum)
+    printf("  (no attributes read)\n");
+}
+
+void reportDocument(const char *path)
+{
+  librevenge::RVNGFileStream input(path);
+  if (!input.isStructured())
+  {
+    printf("%s: not a VSDX document\n", path);
+    return;
+  }
+  for (unsigned i = 0; i < input.subStreamCount(); ++i)
+  {
+    const char *const name = input.subStreamName(i);
+    if (!name || strncmp(name, "visio/pages/page", 16) || !strstr(name, ".xml") || strstr(name, ".rels"))
+      continue;
+    const std::unique_ptr<librevenge::RVNGInputStream> page(input.getSubStreamByName(name));
+    if (!page)
+      continue;
+    std::string xml;
+    while (!page->isEnd())
+    {
+      unsigned long numBytesRead = 0;
+      const unsigned char *const data = page->read(4096, numBytesRead);
+      if (!numBytesRead)
+        break;
+      xml.append(reinterpret_cast<const char *>(data), numBytesRead);
+    }
+    const std::string label = std::string(path) + ": " + name;
+    report(label.c_str(), xml);
+  }
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+  // Before libxml2 allocates anything, so that every allocation is counted
+  xmlMemSetup(free, countingMalloc, countingRealloc, countingStrdup);
+
+  report("synthetic page", makeSyntheticPage());
+
+  for (int i = 1; i < argc; ++i)
+    reportDocument(argv[i]);
+  return 0;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */